@@ -31,12 +31,14 @@ set (CMAKE_MODULES_INSTALL_DIR
 
 set (MODULE_EVENTS "")
 set (MODULE_REMOTE_CLASSES "")
+set (MODULE_CONFIG_CLASSES "")
 set (MODULE_COMPLEX_TYPES "")
 set (MODULE_DIGEST "")
 set (MODULE_NAME "")
 
 set (EVENTS_PREFIX "Event:")
 set (REMOTE_CLASSES_PREFIX "RemoteClass:")
+set (CONFIG_CLASSES_PREFIX "ConfigClass:")
 set (COMPLEX_TYPES_PREFIX "ComplexType:")
 set (DIGEST_PREFIX "Digest:")
 
@@ -177,6 +179,14 @@ function (generate_sources)
     foreach (REMOTE_CLASS ${MODULE_REMOTE_CLASSES})
       list (APPEND GENERATED_SOURCE_FILES ${PARAM_GEN_FILES_DIR}/${REMOTE_CLASS}ImplInternal.cpp)
       list (APPEND GENERATED_HEADER_FILES ${PARAM_GEN_FILES_DIR}/${REMOTE_CLASS}ImplFactory.hpp)
+      list (APPEND GENERATED_SOURCE_FILES ${PARAM_GEN_FILES_DIR}/${REMOTE_CLASS}Client.cpp)
+      list (APPEND GENERATED_HEADER_FILES ${PARAM_GEN_FILES_DIR}/${REMOTE_CLASS}Client.hpp)
+    endforeach()
+
+    # Only classes declaring a config section get a typed config struct
+    foreach (CONFIG_CLASS ${MODULE_CONFIG_CLASSES})
+      list (APPEND GENERATED_SOURCE_FILES ${PARAM_GEN_FILES_DIR}/${CONFIG_CLASS}Config.cpp)
+      list (APPEND GENERATED_HEADER_FILES ${PARAM_GEN_FILES_DIR}/${CONFIG_CLASS}Config.hpp)
     endforeach()
   elseif ("cpp_server" STREQUAL ${PARAM_INTERNAL_TEMPLATES_DIR})
     # Generated directly
@@ -379,6 +389,11 @@ function (generate_kurento_libraries)
       string(REGEX REPLACE "\t+" "" _FILE ${_FILE})
       string(REGEX REPLACE " +" "" _FILE ${_FILE})
       list (APPEND MODULE_REMOTE_CLASSES ${_FILE})
+    elseif (${_FILE} MATCHES "${CONFIG_CLASSES_PREFIX}.*")
+      string(REPLACE ${CONFIG_CLASSES_PREFIX} "" _FILE ${_FILE})
+      string(REGEX REPLACE "\t+" "" _FILE ${_FILE})
+      string(REGEX REPLACE " +" "" _FILE ${_FILE})
+      list (APPEND MODULE_CONFIG_CLASSES ${_FILE})
     elseif (${_FILE} MATCHES "${COMPLEX_TYPES_PREFIX}.*")
       string(REPLACE ${COMPLEX_TYPES_PREFIX} "" _FILE ${_FILE})
       string(REGEX REPLACE "\t+" "" _FILE ${_FILE})
@@ -680,6 +680,32 @@ kms_base_hub_link_src_pad (KmsBaseHub * self, const gchar * gp_name,
   return ret;
 }
 
+/*
+ * Outputs taken from an agnosticbin carry the same media for every port, so
+ * ports can ask it for their encoded format and share its encoders. Other
+ * elements (e.g. per-port audio mixes) only produce raw media.
+ */
+static void
+kms_base_hub_set_shared_encoding (KmsBaseHub * self, gint id,
+    const gchar * property, GstElement * internal_element)
+{
+  GstElementFactory *factory = gst_element_get_factory (internal_element);
+  KmsBaseHubPortData *port_data;
+  gboolean shared;
+
+  shared = factory != NULL &&
+      g_strcmp0 (GST_OBJECT_NAME (factory), "agnosticbin") == 0;
+
+  KMS_BASE_HUB_LOCK (self);
+
+  port_data = g_hash_table_lookup (self->priv->ports, &id);
+  if (port_data != NULL) {
+    g_object_set (port_data->port, property, shared, NULL);
+  }
+
+  KMS_BASE_HUB_UNLOCK (self);
+}
+
 static gboolean
 kms_base_hub_link_audio_src_default (KmsBaseHub * self, gint id,
     GstElement * internal_element, const gchar * pad_name,
@@ -693,6 +719,11 @@ kms_base_hub_link_audio_src_default (KmsBaseHub * self, gint id,
       internal_element, pad_name, remove_on_unlink);
   g_free (gp_name);
 
+  if (ret) {
+    kms_base_hub_set_shared_encoding (self, id, "shared-audio-encoding",
+        internal_element);
+  }
+
   return ret;
 }
 
@@ -709,6 +740,11 @@ kms_base_hub_link_video_src_default (KmsBaseHub * self, gint id,
       internal_element, pad_name, remove_on_unlink);
   g_free (gp_name);
 
+  if (ret) {
+    kms_base_hub_set_shared_encoding (self, id, "shared-video-encoding",
+        internal_element);
+  }
+
   return ret;
 }
 
@@ -35,6 +35,7 @@
 #include "sdpagent/kmssdprtpavpfmediahandler.h"
 #include "kmsremb.h"
 #include "kmsrefstruct.h"
+#include "kmslatencyprofile.h"
 
 #include <gst/rtp/gstrtpdefs.h>
 #include <gst/rtp/gstrtpbuffer.h>
@@ -145,8 +146,6 @@ G_DEFINE_TYPE_WITH_PRIVATE (KmsBaseRtpEndpoint, kms_base_rtp_endpoint,
 )
 
 #define JB_INITIAL_LATENCY 0
-#define JB_READY_AUDIO_LATENCY 100
-#define JB_READY_VIDEO_LATENCY 500
 #define RTCP_FB_CCM_FIR   SDP_MEDIA_RTCP_FB_CCM " " SDP_MEDIA_RTCP_FB_FIR
 #define RTCP_FB_NACK_PLI  SDP_MEDIA_RTCP_FB_NACK " " SDP_MEDIA_RTCP_FB_PLI
 
@@ -2063,16 +2062,19 @@ kms_base_rtp_endpoint_rtpbin_new_jitterbuffer (GstElement * rtpbin,
     GstElement * jitterbuffer,
     guint session, guint ssrc, KmsBaseRtpEndpoint * self)
 {
+  const KmsLatencyTargets *targets;
   KmsRTPSessionStats *rtp_stats;
   KmsSSRCStats *ssrc_stats;
 
+  targets = kms_latency_profile_get_element_targets (GST_ELEMENT (self));
+
   g_object_set (jitterbuffer, "mode", 4 /* synced */, "do-lost", TRUE,
       "latency", JB_INITIAL_LATENCY, NULL);
 
   switch (session) {
     case AUDIO_RTP_SESSION: {
       kms_base_rtp_endpoint_jitterbuffer_set_latency (jitterbuffer,
-          JB_READY_AUDIO_LATENCY);
+          targets->jitter_buffer_audio);
 
       kms_base_rtp_endpoint_jitterbuffer_monitor_rtp_out (jitterbuffer,
           self->priv->sync_audio);
@@ -2085,7 +2087,7 @@ kms_base_rtp_endpoint_rtpbin_new_jitterbuffer (GstElement * rtpbin,
     }
     case VIDEO_RTP_SESSION: {
       kms_base_rtp_endpoint_jitterbuffer_set_latency (jitterbuffer,
-          JB_READY_VIDEO_LATENCY);
+          targets->jitter_buffer_video);
 
       kms_base_rtp_endpoint_jitterbuffer_monitor_rtp_out (jitterbuffer,
           self->priv->sync_video);
@@ -3525,7 +3527,8 @@ kms_base_rtp_endpoint_init (KmsBaseRtpEndpoint * self)
   g_signal_connect (self->priv->rtpbin, "request-aux-sender",
       G_CALLBACK (kms_base_rtp_endpoint_rtpbin_request_aux_sender), self);
 
-  g_object_set (self, "accept-eos", FALSE, NULL);
+  /* Live endpoint, joining one must not disturb the rest of the pipeline */
+  g_object_set (self, "accept-eos", FALSE, "latency-domain", TRUE, NULL);
 
   gst_bin_add (GST_BIN (self), self->priv->rtpbin);
 
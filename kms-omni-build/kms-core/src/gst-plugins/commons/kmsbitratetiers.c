@@ -0,0 +1,128 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "kmsbitratetiers.h"
+
+#define GST_DEFAULT_NAME "kmsbitratetiers"
+#define GST_CAT_DEFAULT kms_bitrate_tiers_debug
+GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
+
+static gint
+compare_estimates (gconstpointer a, gconstpointer b, gpointer estimates)
+{
+  guint ea = ((const guint *) estimates)[*(const guint *) a];
+  guint eb = ((const guint *) estimates)[*(const guint *) b];
+
+  /* Highest first */
+  return (ea < eb) - (ea > eb);
+}
+
+guint
+kms_bitrate_tiers_compute (const guint * estimates, guint n_estimates,
+    guint max_tiers, gdouble spacing, guint * tier_bitrates,
+    guint * membership)
+{
+  guint *order, *first, *top, *low;
+  guint i, t, n_tiers;
+
+  if (n_estimates == 0) {
+    return 0;
+  }
+
+  max_tiers = CLAMP (max_tiers, 1, KMS_BITRATE_TIERS_MAX);
+  spacing = MAX (spacing, 1.0);
+
+  order = g_new (guint, n_estimates);
+  for (i = 0; i < n_estimates; i++) {
+    order[i] = i;
+  }
+  g_qsort_with_data (order, n_estimates, sizeof (guint), compare_estimates,
+      (gpointer) estimates);
+
+  /* Start a new tier each time an estimate falls too far below the highest
+   * one of the current tier */
+  first = g_new (guint, n_estimates);
+  top = g_new (guint, n_estimates);
+  low = g_new (guint, n_estimates);
+  n_tiers = 0;
+
+  for (i = 0; i < n_estimates; i++) {
+    guint e = estimates[order[i]];
+
+    if (n_tiers == 0 || e * spacing < top[n_tiers - 1]) {
+      first[n_tiers] = i;
+      top[n_tiers] = e;
+      n_tiers++;
+    }
+
+    low[n_tiers - 1] = e;
+  }
+
+  /* Too many tiers, merge the two closest neighbours until they fit */
+  while (n_tiers > max_tiers) {
+    gdouble best_gap = G_MAXDOUBLE;
+    guint merge = 0;
+
+    for (t = 0; t + 1 < n_tiers; t++) {
+      gdouble gap = (gdouble) low[t] / MAX (top[t + 1], 1);
+
+      if (gap < best_gap) {
+        best_gap = gap;
+        merge = t;
+      }
+    }
+
+    low[merge] = low[merge + 1];
+
+    for (t = merge + 1; t + 1 < n_tiers; t++) {
+      first[t] = first[t + 1];
+      top[t] = top[t + 1];
+      low[t] = low[t + 1];
+    }
+
+    n_tiers--;
+  }
+
+  for (t = 0; t < n_tiers; t++) {
+    guint last = (t + 1 < n_tiers) ? first[t + 1] : n_estimates;
+
+    tier_bitrates[t] = low[t];
+
+    for (i = first[t]; i < last; i++) {
+      membership[order[i]] = t;
+    }
+
+    GST_TRACE ("Tier %u: %u consumers, bitrate %u", t, last - first[t],
+        low[t]);
+  }
+
+  g_free (order);
+  g_free (first);
+  g_free (top);
+  g_free (low);
+
+  return n_tiers;
+}
+
+static void init_debug (void) __attribute__ ((constructor));
+
+static void
+init_debug (void)
+{
+  GST_DEBUG_CATEGORY_INIT (GST_CAT_DEFAULT, GST_DEFAULT_NAME, 0,
+      GST_DEFAULT_NAME);
+}
@@ -0,0 +1,49 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __KMS_BITRATE_TIERS_H__
+#define __KMS_BITRATE_TIERS_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+#define KMS_BITRATE_TIERS_MAX 8
+
+/* Estimates closer than this ratio always share a tier */
+#define KMS_BITRATE_TIERS_DEFAULT_SPACING 1.5
+
+/*
+ * Groups the bandwidth estimates of the consumers of a stream into at most
+ * @max_tiers tiers. Tier 0 holds the highest estimates. Each tier is sent at
+ * the lowest estimate of its members, so that nobody in it gets more than
+ * what it reported, while a consumer on a poor link only drags down the ones
+ * with a similar link.
+ *
+ * @estimates: bitrates in bps, @n_estimates of them
+ * @tier_bitrates: (out): filled with the bitrate of each tier, must have room
+ *     for @max_tiers values
+ * @membership: (out): tier index of each estimate, @n_estimates of them
+ *
+ * Returns the number of tiers used.
+ */
+guint kms_bitrate_tiers_compute (const guint * estimates, guint n_estimates,
+    guint max_tiers, gdouble spacing, guint * tier_bitrates,
+    guint * membership);
+
+G_END_DECLS
+#endif /* __KMS_BITRATE_TIERS_H__ */
@@ -0,0 +1,548 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "kmscapturefile.h"
+
+#include <string.h>
+
+#define GST_DEFAULT_NAME "kmscapturefile"
+#define GST_CAT_DEFAULT kms_capture_file_debug
+GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
+
+#define CAPTURE_VERSION 1
+
+/* magic (8), version (4), profile (4) */
+#define HEADER_SIZE 16
+/* type (4), length (4) */
+#define RECORD_HEADER_SIZE 8
+/* track (4), media type (4), caps string */
+#define TRACK_FIELDS_SIZE 8
+/* track (4), flags (4), pts (8), dts (8), duration (8), arrival (8), data */
+#define BUFFER_FIELDS_SIZE 40
+/* entry type (4), track (4), pts (8), offset (8) */
+#define INDEX_ENTRY_SIZE 24
+/* index record offset (8), magic (8) */
+#define TRAILER_SIZE 16
+
+static const guint8 capture_magic[8] = { 'K', 'M', 'S', 'C', 'A', 'P', 0, 1 };
+static const guint8 trailer_magic[8] = { 'K', 'M', 'S', 'C', 'A', 'P', 'I', 'X' };
+
+/* Lock flags are not part of the buffer state */
+#define BUFFER_FLAGS_MASK (~(GST_MINI_OBJECT_FLAG_LAST - 1))
+
+typedef enum
+{
+  RECORD_TYPE_TRACK = 1,
+  RECORD_TYPE_BUFFER,
+  RECORD_TYPE_INDEX
+} RecordType;
+
+typedef enum
+{
+  INDEX_ENTRY_TRACK = 1,
+  INDEX_ENTRY_KEY_FRAME
+} IndexEntryType;
+
+typedef struct _IndexEntry
+{
+  guint32 type;
+  guint32 track;
+  guint64 pts;
+  guint64 offset;
+} IndexEntry;
+
+struct _KmsCaptureWriter
+{
+  KmsRecordingProfile profile;
+  guint64 offset;
+  GArray *index;
+  /* track id -> KmsMediaType */
+  GHashTable *tracks;
+  gboolean finished;
+};
+
+struct _KmsCaptureReader
+{
+  GMappedFile *file;
+  const guint8 *data;
+  gsize size;
+
+  KmsRecordingProfile profile;
+  /* Records are in [HEADER_SIZE, end) */
+  gsize end;
+  gsize pos;
+
+  GArray *index;
+  /* Offsets of track records to return before going on from pos */
+  GQueue pending;
+};
+
+static void
+write_record_header (guint8 * data, RecordType type, guint32 length)
+{
+  GST_WRITE_UINT32_LE (data, type);
+  GST_WRITE_UINT32_LE (data + 4, length);
+}
+
+static void
+kms_capture_writer_add_index_entry (KmsCaptureWriter * writer,
+    IndexEntryType type, guint track, GstClockTime pts)
+{
+  IndexEntry entry = { type, track, pts, writer->offset };
+
+  g_array_append_val (writer->index, entry);
+}
+
+KmsCaptureWriter *
+kms_capture_writer_new (KmsRecordingProfile profile)
+{
+  KmsCaptureWriter *writer = g_slice_new0 (KmsCaptureWriter);
+
+  writer->profile = profile;
+  writer->index = g_array_new (FALSE, FALSE, sizeof (IndexEntry));
+  writer->tracks = g_hash_table_new (NULL, NULL);
+
+  return writer;
+}
+
+void
+kms_capture_writer_free (KmsCaptureWriter * writer)
+{
+  g_array_unref (writer->index);
+  g_hash_table_unref (writer->tracks);
+  g_slice_free (KmsCaptureWriter, writer);
+}
+
+GstBuffer *
+kms_capture_writer_header (KmsCaptureWriter * writer)
+{
+  guint8 *data;
+
+  g_return_val_if_fail (writer->offset == 0, NULL);
+
+  data = g_malloc (HEADER_SIZE);
+
+  memcpy (data, capture_magic, sizeof (capture_magic));
+  GST_WRITE_UINT32_LE (data + 8, CAPTURE_VERSION);
+  GST_WRITE_UINT32_LE (data + 12, (guint32) writer->profile);
+
+  writer->offset += HEADER_SIZE;
+
+  return gst_buffer_new_wrapped (data, HEADER_SIZE);
+}
+
+GstBuffer *
+kms_capture_writer_track (KmsCaptureWriter * writer, guint track,
+    KmsMediaType type, const GstCaps * caps)
+{
+  gchar *caps_str;
+  gsize caps_len, size;
+  guint8 *data;
+
+  g_return_val_if_fail (!writer->finished, NULL);
+
+  caps_str = gst_caps_to_string (caps);
+  caps_len = strlen (caps_str);
+  size = RECORD_HEADER_SIZE + TRACK_FIELDS_SIZE + caps_len;
+  data = g_malloc (size);
+
+  write_record_header (data, RECORD_TYPE_TRACK, size - RECORD_HEADER_SIZE);
+  GST_WRITE_UINT32_LE (data + 8, track);
+  GST_WRITE_UINT32_LE (data + 12, type);
+  memcpy (data + RECORD_HEADER_SIZE + TRACK_FIELDS_SIZE, caps_str, caps_len);
+  g_free (caps_str);
+
+  g_hash_table_insert (writer->tracks, GUINT_TO_POINTER (track),
+      GINT_TO_POINTER (type));
+  kms_capture_writer_add_index_entry (writer, INDEX_ENTRY_TRACK, track,
+      GST_CLOCK_TIME_NONE);
+  writer->offset += size;
+
+  return gst_buffer_new_wrapped (data, size);
+}
+
+GstBuffer *
+kms_capture_writer_buffer (KmsCaptureWriter * writer, guint track,
+    GstBuffer * buffer, GstClockTime arrival)
+{
+  gsize size = RECORD_HEADER_SIZE + BUFFER_FIELDS_SIZE;
+  gsize payload = gst_buffer_get_size (buffer);
+  GstBuffer *record;
+  gpointer type;
+  guint8 *data;
+
+  g_return_val_if_fail (!writer->finished, NULL);
+
+  data = g_malloc (size);
+
+  write_record_header (data, RECORD_TYPE_BUFFER,
+      BUFFER_FIELDS_SIZE + payload);
+  GST_WRITE_UINT32_LE (data + 8, track);
+  GST_WRITE_UINT32_LE (data + 12, GST_BUFFER_FLAGS (buffer) &
+      BUFFER_FLAGS_MASK);
+  GST_WRITE_UINT64_LE (data + 16, GST_BUFFER_PTS (buffer));
+  GST_WRITE_UINT64_LE (data + 24, GST_BUFFER_DTS (buffer));
+  GST_WRITE_UINT64_LE (data + 32, GST_BUFFER_DURATION (buffer));
+  GST_WRITE_UINT64_LE (data + 40, arrival);
+
+  record = gst_buffer_new_wrapped (data, size);
+  /* Payload memory is shared with the incoming buffer */
+  gst_buffer_copy_into (record, buffer, GST_BUFFER_COPY_MEMORY, 0, -1);
+
+  if (g_hash_table_lookup_extended (writer->tracks, GUINT_TO_POINTER (track),
+          NULL, &type) && GPOINTER_TO_INT (type) == KMS_MEDIA_TYPE_VIDEO
+      && !GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT)) {
+    kms_capture_writer_add_index_entry (writer, INDEX_ENTRY_KEY_FRAME, track,
+        GST_BUFFER_PTS (buffer));
+  }
+
+  writer->offset += size + payload;
+
+  return record;
+}
+
+GstBuffer *
+kms_capture_writer_finish (KmsCaptureWriter * writer)
+{
+  gsize index_size = writer->index->len * INDEX_ENTRY_SIZE;
+  gsize size = RECORD_HEADER_SIZE + index_size + TRAILER_SIZE;
+  guint8 *data, *p;
+  guint i;
+
+  g_return_val_if_fail (!writer->finished, NULL);
+
+  data = g_malloc (size);
+
+  write_record_header (data, RECORD_TYPE_INDEX, index_size);
+  p = data + RECORD_HEADER_SIZE;
+
+  for (i = 0; i < writer->index->len; i++) {
+    IndexEntry *entry = &g_array_index (writer->index, IndexEntry, i);
+
+    GST_WRITE_UINT32_LE (p, entry->type);
+    GST_WRITE_UINT32_LE (p + 4, entry->track);
+    GST_WRITE_UINT64_LE (p + 8, entry->pts);
+    GST_WRITE_UINT64_LE (p + 16, entry->offset);
+    p += INDEX_ENTRY_SIZE;
+  }
+
+  GST_WRITE_UINT64_LE (p, writer->offset);
+  memcpy (p + 8, trailer_magic, sizeof (trailer_magic));
+
+  GST_DEBUG ("Capture finished, %u index entries", writer->index->len);
+
+  writer->offset += size;
+  writer->finished = TRUE;
+
+  return gst_buffer_new_wrapped (data, size);
+}
+
+static void
+kms_capture_reader_load_index (KmsCaptureReader * reader)
+{
+  const guint8 *trailer, *record;
+  guint64 index_offset;
+  guint32 length;
+  guint i, n;
+
+  if (reader->size < HEADER_SIZE + RECORD_HEADER_SIZE + TRAILER_SIZE) {
+    return;
+  }
+
+  trailer = reader->data + reader->size - TRAILER_SIZE;
+
+  if (memcmp (trailer + 8, trailer_magic, sizeof (trailer_magic)) != 0) {
+    GST_DEBUG ("No index found, capture was not closed");
+    return;
+  }
+
+  index_offset = GST_READ_UINT64_LE (trailer);
+  if (index_offset < HEADER_SIZE
+      || index_offset + RECORD_HEADER_SIZE > reader->size - TRAILER_SIZE) {
+    GST_WARNING ("Invalid index offset %" G_GUINT64_FORMAT, index_offset);
+    return;
+  }
+
+  record = reader->data + index_offset;
+  length = GST_READ_UINT32_LE (record + 4);
+
+  if (GST_READ_UINT32_LE (record) != RECORD_TYPE_INDEX
+      || index_offset + RECORD_HEADER_SIZE + length !=
+      reader->size - TRAILER_SIZE || length % INDEX_ENTRY_SIZE != 0) {
+    GST_WARNING ("Invalid index record");
+    return;
+  }
+
+  n = length / INDEX_ENTRY_SIZE;
+  reader->index = g_array_sized_new (FALSE, FALSE, sizeof (IndexEntry), n);
+
+  for (i = 0; i < n; i++) {
+    const guint8 *p = record + RECORD_HEADER_SIZE + i * INDEX_ENTRY_SIZE;
+    IndexEntry entry;
+
+    entry.type = GST_READ_UINT32_LE (p);
+    entry.track = GST_READ_UINT32_LE (p + 4);
+    entry.pts = GST_READ_UINT64_LE (p + 8);
+    entry.offset = GST_READ_UINT64_LE (p + 16);
+
+    g_array_append_val (reader->index, entry);
+  }
+
+  reader->end = index_offset;
+}
+
+KmsCaptureReader *
+kms_capture_reader_new (const gchar * path, GError ** error)
+{
+  KmsCaptureReader *reader;
+  GMappedFile *file;
+
+  file = g_mapped_file_new (path, FALSE, error);
+  if (file == NULL) {
+    return NULL;
+  }
+
+  if (g_mapped_file_get_length (file) < HEADER_SIZE
+      || memcmp (g_mapped_file_get_contents (file), capture_magic,
+          sizeof (capture_magic)) != 0) {
+    g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL,
+        "%s is not a capture file", path);
+    g_mapped_file_unref (file);
+    return NULL;
+  }
+
+  reader = g_slice_new0 (KmsCaptureReader);
+  reader->file = file;
+  reader->data = (const guint8 *) g_mapped_file_get_contents (file);
+  reader->size = g_mapped_file_get_length (file);
+  reader->end = reader->size;
+  reader->pos = HEADER_SIZE;
+  reader->profile = (gint32) GST_READ_UINT32_LE (reader->data + 12);
+  g_queue_init (&reader->pending);
+
+  if (GST_READ_UINT32_LE (reader->data + 8) != CAPTURE_VERSION) {
+    GST_WARNING ("Unknown capture version %u",
+        GST_READ_UINT32_LE (reader->data + 8));
+  }
+
+  kms_capture_reader_load_index (reader);
+
+  return reader;
+}
+
+void
+kms_capture_reader_free (KmsCaptureReader * reader)
+{
+  g_queue_clear (&reader->pending);
+
+  if (reader->index != NULL) {
+    g_array_unref (reader->index);
+  }
+
+  g_mapped_file_unref (reader->file);
+  g_slice_free (KmsCaptureReader, reader);
+}
+
+KmsRecordingProfile
+kms_capture_reader_get_profile (KmsCaptureReader * reader)
+{
+  return reader->profile;
+}
+
+gboolean
+kms_capture_reader_is_indexed (KmsCaptureReader * reader)
+{
+  return reader->index != NULL;
+}
+
+static KmsCaptureRecord
+kms_capture_reader_read (KmsCaptureReader * reader, gsize offset,
+    gsize * next, guint * track, KmsMediaType * type, GstCaps ** caps,
+    GstBuffer ** buffer, GstClockTime * arrival)
+{
+  const guint8 *p;
+  guint32 length;
+
+  while (TRUE) {
+    if (offset == reader->end) {
+      return KMS_CAPTURE_RECORD_END;
+    }
+
+    if (offset + RECORD_HEADER_SIZE > reader->end) {
+      goto truncated;
+    }
+
+    p = reader->data + offset;
+    length = GST_READ_UINT32_LE (p + 4);
+
+    if (offset + RECORD_HEADER_SIZE + length > reader->end) {
+      goto truncated;
+    }
+
+    *next = offset + RECORD_HEADER_SIZE + length;
+
+    switch (GST_READ_UINT32_LE (p)) {
+      case RECORD_TYPE_TRACK:{
+        gchar *caps_str;
+
+        if (length < TRACK_FIELDS_SIZE) {
+          goto truncated;
+        }
+
+        caps_str = g_strndup ((const gchar *) p + RECORD_HEADER_SIZE +
+            TRACK_FIELDS_SIZE, length - TRACK_FIELDS_SIZE);
+
+        *track = GST_READ_UINT32_LE (p + 8);
+        *type = GST_READ_UINT32_LE (p + 12);
+        *caps = gst_caps_from_string (caps_str);
+        g_free (caps_str);
+
+        return KMS_CAPTURE_RECORD_TRACK;
+      }
+      case RECORD_TYPE_BUFFER:{
+        gsize payload;
+
+        if (length < BUFFER_FIELDS_SIZE) {
+          goto truncated;
+        }
+
+        payload = length - BUFFER_FIELDS_SIZE;
+
+        /* Frames point into the mapped capture, nothing is copied */
+        *buffer = gst_buffer_new_wrapped_full (GST_MEMORY_FLAG_READONLY,
+            (gpointer) (p + RECORD_HEADER_SIZE + BUFFER_FIELDS_SIZE), payload,
+            0, payload, g_mapped_file_ref (reader->file),
+            (GDestroyNotify) g_mapped_file_unref);
+
+        *track = GST_READ_UINT32_LE (p + 8);
+        GST_BUFFER_FLAG_SET (*buffer, GST_READ_UINT32_LE (p + 12) &
+            BUFFER_FLAGS_MASK);
+        GST_BUFFER_PTS (*buffer) = GST_READ_UINT64_LE (p + 16);
+        GST_BUFFER_DTS (*buffer) = GST_READ_UINT64_LE (p + 24);
+        GST_BUFFER_DURATION (*buffer) = GST_READ_UINT64_LE (p + 32);
+        *arrival = GST_READ_UINT64_LE (p + 40);
+
+        return KMS_CAPTURE_RECORD_BUFFER;
+      }
+      default:
+        /* Unknown records are skipped */
+        GST_DEBUG ("Skipping record of type %u", GST_READ_UINT32_LE (p));
+        offset = *next;
+        break;
+    }
+  }
+
+truncated:
+  GST_WARNING ("Capture truncated at offset %" G_GSIZE_FORMAT, offset);
+
+  return KMS_CAPTURE_RECORD_ERROR;
+}
+
+KmsCaptureRecord
+kms_capture_reader_next (KmsCaptureReader * reader, guint * track,
+    KmsMediaType * type, GstCaps ** caps, GstBuffer ** buffer,
+    GstClockTime * arrival)
+{
+  KmsCaptureRecord ret;
+  gsize next;
+
+  if (!g_queue_is_empty (&reader->pending)) {
+    gsize offset = GPOINTER_TO_SIZE (g_queue_pop_head (&reader->pending));
+
+    return kms_capture_reader_read (reader, offset, &next, track, type, caps,
+        buffer, arrival);
+  }
+
+  ret = kms_capture_reader_read (reader, reader->pos, &next, track, type, caps,
+      buffer, arrival);
+
+  if (ret == KMS_CAPTURE_RECORD_TRACK || ret == KMS_CAPTURE_RECORD_BUFFER) {
+    reader->pos = next;
+  }
+
+  return ret;
+}
+
+static gint
+compare_offsets (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+  gsize oa = GPOINTER_TO_SIZE (a), ob = GPOINTER_TO_SIZE (b);
+
+  return oa < ob ? -1 : (oa > ob ? 1 : 0);
+}
+
+gboolean
+kms_capture_reader_seek (KmsCaptureReader * reader, GstClockTime pts)
+{
+  IndexEntry *key = NULL;
+  GHashTable *tracks;
+  GHashTableIter iter;
+  gpointer value;
+  guint i;
+
+  if (reader->index == NULL) {
+    return FALSE;
+  }
+
+  for (i = 0; i < reader->index->len; i++) {
+    IndexEntry *entry = &g_array_index (reader->index, IndexEntry, i);
+
+    if (entry->type == INDEX_ENTRY_KEY_FRAME && entry->pts <= pts
+        && (key == NULL || entry->pts >= key->pts)) {
+      key = entry;
+    }
+  }
+
+  g_queue_clear (&reader->pending);
+
+  if (key == NULL) {
+    reader->pos = HEADER_SIZE;
+    return TRUE;
+  }
+
+  /* Latest declaration of each track before the key frame */
+  tracks = g_hash_table_new (NULL, NULL);
+
+  for (i = 0; i < reader->index->len; i++) {
+    IndexEntry *entry = &g_array_index (reader->index, IndexEntry, i);
+
+    if (entry->type == INDEX_ENTRY_TRACK && entry->offset < key->offset) {
+      g_hash_table_insert (tracks, GUINT_TO_POINTER (entry->track),
+          GSIZE_TO_POINTER (entry->offset));
+    }
+  }
+
+  g_hash_table_iter_init (&iter, tracks);
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    g_queue_insert_sorted (&reader->pending, value, compare_offsets, NULL);
+  }
+
+  g_hash_table_unref (tracks);
+
+  reader->pos = key->offset;
+
+  return TRUE;
+}
+
+static void init_debug (void) __attribute__ ((constructor));
+
+static void
+init_debug (void)
+{
+  GST_DEBUG_CATEGORY_INIT (GST_CAT_DEFAULT, GST_DEFAULT_NAME, 0,
+      GST_DEFAULT_NAME);
+}
@@ -0,0 +1,93 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __KMS_CAPTURE_FILE_H__
+#define __KMS_CAPTURE_FILE_H__
+
+#include <gst/gst.h>
+#include "kmsmediatype.h"
+#include "kmsrecordingprofile.h"
+
+G_BEGIN_DECLS
+
+/*
+ * Raw capture files store the encoded frames received by a recorder, before
+ * muxing, so that the container can be produced later and somewhere else.
+ *
+ * The file is append-only: a header followed by records (track
+ * declarations and frames, each frame with its arrival time). When the
+ * capture is closed, an index of track declarations and key frames is
+ * appended, followed by a fixed-size trailer that points to it. A capture
+ * without trailer (e.g. the server died while recording) can still be read
+ * sequentially.
+ *
+ * All integers are little-endian.
+ */
+
+typedef enum
+{
+  KMS_CAPTURE_RECORD_ERROR = -1,
+  KMS_CAPTURE_RECORD_END,
+  KMS_CAPTURE_RECORD_TRACK,
+  KMS_CAPTURE_RECORD_BUFFER
+} KmsCaptureRecord;
+
+typedef struct _KmsCaptureWriter KmsCaptureWriter;
+typedef struct _KmsCaptureReader KmsCaptureReader;
+
+/*
+ * The writer only serializes: every call returns the bytes to append to the
+ * capture, so they can be sent to any sink (file, HTTP...). Frame payloads
+ * are referenced, not copied.
+ */
+KmsCaptureWriter *kms_capture_writer_new (KmsRecordingProfile profile);
+void kms_capture_writer_free (KmsCaptureWriter * writer);
+
+GstBuffer *kms_capture_writer_header (KmsCaptureWriter * writer);
+GstBuffer *kms_capture_writer_track (KmsCaptureWriter * writer, guint track,
+    KmsMediaType type, const GstCaps * caps);
+GstBuffer *kms_capture_writer_buffer (KmsCaptureWriter * writer, guint track,
+    GstBuffer * buffer, GstClockTime arrival);
+/* Index and trailer, nothing can be written afterwards */
+GstBuffer *kms_capture_writer_finish (KmsCaptureWriter * writer);
+
+KmsCaptureReader *kms_capture_reader_new (const gchar * path,
+    GError ** error);
+void kms_capture_reader_free (KmsCaptureReader * reader);
+
+KmsRecordingProfile kms_capture_reader_get_profile (KmsCaptureReader *
+    reader);
+gboolean kms_capture_reader_is_indexed (KmsCaptureReader * reader);
+
+/*
+ * Returns the next record. For KMS_CAPTURE_RECORD_TRACK, `type` and `caps`
+ * are set; for KMS_CAPTURE_RECORD_BUFFER, `buffer` and `arrival` are.
+ * Returned caps and buffers belong to the caller.
+ */
+KmsCaptureRecord kms_capture_reader_next (KmsCaptureReader * reader,
+    guint * track, KmsMediaType * type, GstCaps ** caps, GstBuffer ** buffer,
+    GstClockTime * arrival);
+
+/*
+ * Move to the last key frame at or before `pts`, using the index. The
+ * current declaration of every track is returned again before the frames.
+ */
+gboolean kms_capture_reader_seek (KmsCaptureReader * reader,
+    GstClockTime pts);
+
+G_END_DECLS
+#endif /* __KMS_CAPTURE_FILE_H__ */
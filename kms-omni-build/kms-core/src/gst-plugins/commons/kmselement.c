@@ -28,15 +28,26 @@
 #include "kmsutils.h"
 #include "kmsrefstruct.h"
 #include "constants.h"
+#include "kmsbitratetiers.h"
 
 #define PLUGIN_NAME "kmselement"
 #define DEFAULT_ACCEPT_EOS TRUE
+#define DEFAULT_LATENCY_DOMAIN FALSE
+#define LATENCY_DEBOUNCE_MS 20
 #define MAX_BITRATE "max-bitrate"
 #define MIN_BITRATE "min-bitrate"
 #define CODEC_CONFIG "codec-config"
+#define MAX_TIERS "max-tiers"
+#define GOP_CACHE_SIZE "gop-cache-size"
+#define SMOOTH_KEYFRAMES "smooth-keyframes"
+#define ENCODERS "encoders"
+#define TIERS "tiers"
 
 #define DEFAULT_MIN_OUTPUT_BITRATE 0
 #define DEFAULT_MAX_OUTPUT_BITRATE G_MAXINT
+#define DEFAULT_MAX_OUTPUT_TIERS 1
+#define DEFAULT_OUTPUT_GOP_CACHE_SIZE 0
+#define DEFAULT_OUTPUT_SMOOTH_KEYFRAMES FALSE
 #define MEDIA_FLOW_INTERNAL_TIME_MSEC 2000
 
 GST_DEBUG_CATEGORY_STATIC (kms_element_debug_category);
@@ -56,6 +67,11 @@ struct _KmsElementPrivate
   gboolean accept_eos;
   gboolean stats_enabled;
 
+  /* Latency changes of children are coalesced and their state changes are
+   * kept inside the element */
+  gboolean latency_domain;
+  gboolean latency_pending;
+
   GHashTable *output_elements;  /* KmsOutputElementData */
 
   /* Audio and video capabilities */
@@ -66,6 +82,9 @@ struct _KmsElementPrivate
 
   gint min_output_bitrate;
   gint max_output_bitrate;
+  guint max_output_tiers;
+  guint output_gop_cache_size;
+  gboolean output_smooth_keyframes;
 
   GstStructure *codec_config;
 
@@ -190,6 +209,10 @@ enum
   PROP_MAX_OUTPUT_BITRATE,
   PROP_MEDIA_STATS,
   PROP_CODEC_CONFIG,
+  PROP_LATENCY_DOMAIN,
+  PROP_MAX_OUTPUT_TIERS,
+  PROP_OUTPUT_GOP_CACHE_SIZE,
+  PROP_OUTPUT_SMOOTH_KEYFRAMES,
   PROP_LAST
 };
 
@@ -700,6 +723,15 @@ kms_element_set_video_output_properties (KmsElement * self,
 
   KMS_SET_OBJECT_PROPERTY_SAFELY (element, MIN_BITRATE,
       self->priv->min_output_bitrate);
+
+  KMS_SET_OBJECT_PROPERTY_SAFELY (element, MAX_TIERS,
+      self->priv->max_output_tiers);
+
+  KMS_SET_OBJECT_PROPERTY_SAFELY (element, GOP_CACHE_SIZE,
+      self->priv->output_gop_cache_size);
+
+  KMS_SET_OBJECT_PROPERTY_SAFELY (element, SMOOTH_KEYFRAMES,
+      self->priv->output_smooth_keyframes);
 }
 
 static void
@@ -1223,6 +1255,42 @@ set_max_output_bitrate (gchar * id, KmsOutputElementData * odata, KmsElement * s
   }
 }
 
+static void
+set_max_output_tiers (gchar * id, KmsOutputElementData * odata,
+    KmsElement * self)
+{
+  if (odata->type == KMS_ELEMENT_PAD_TYPE_VIDEO) {
+    if (odata->element != NULL) {
+      KMS_SET_OBJECT_PROPERTY_SAFELY (odata->element, MAX_TIERS,
+          self->priv->max_output_tiers);
+    }
+  }
+}
+
+static void
+set_output_gop_cache_size (gchar * id, KmsOutputElementData * odata,
+    KmsElement * self)
+{
+  if (odata->type == KMS_ELEMENT_PAD_TYPE_VIDEO) {
+    if (odata->element != NULL) {
+      KMS_SET_OBJECT_PROPERTY_SAFELY (odata->element, GOP_CACHE_SIZE,
+          self->priv->output_gop_cache_size);
+    }
+  }
+}
+
+static void
+set_output_smooth_keyframes (gchar * id, KmsOutputElementData * odata,
+    KmsElement * self)
+{
+  if (odata->type == KMS_ELEMENT_PAD_TYPE_VIDEO) {
+    if (odata->element != NULL) {
+      KMS_SET_OBJECT_PROPERTY_SAFELY (odata->element, SMOOTH_KEYFRAMES,
+          self->priv->output_smooth_keyframes);
+    }
+  }
+}
+
 static void
 set_codec_config (gchar * id, KmsOutputElementData * odata, KmsElement * self)
 {
@@ -1243,6 +1311,10 @@ kms_element_set_property (GObject * object, guint property_id,
     case PROP_ACCEPT_EOS:
       g_atomic_int_set (&self->priv->accept_eos, g_value_get_boolean (value));
       break;
+    case PROP_LATENCY_DOMAIN:
+      g_atomic_int_set (&self->priv->latency_domain,
+          g_value_get_boolean (value));
+      break;
     case PROP_AUDIO_CAPS:
       kms_element_endpoint_set_caps (self, gst_value_get_caps (value),
           &self->priv->audio_caps);
@@ -1281,6 +1353,27 @@ kms_element_set_property (GObject * object, guint property_id,
       KMS_ELEMENT_UNLOCK (self);
       break;
     }
+    case PROP_MAX_OUTPUT_TIERS:
+      KMS_ELEMENT_LOCK (self);
+      self->priv->max_output_tiers = g_value_get_uint (value);
+      g_hash_table_foreach (self->priv->output_elements,
+          (GHFunc) set_max_output_tiers, self);
+      KMS_ELEMENT_UNLOCK (self);
+      break;
+    case PROP_OUTPUT_GOP_CACHE_SIZE:
+      KMS_ELEMENT_LOCK (self);
+      self->priv->output_gop_cache_size = g_value_get_uint (value);
+      g_hash_table_foreach (self->priv->output_elements,
+          (GHFunc) set_output_gop_cache_size, self);
+      KMS_ELEMENT_UNLOCK (self);
+      break;
+    case PROP_OUTPUT_SMOOTH_KEYFRAMES:
+      KMS_ELEMENT_LOCK (self);
+      self->priv->output_smooth_keyframes = g_value_get_boolean (value);
+      g_hash_table_foreach (self->priv->output_elements,
+          (GHFunc) set_output_smooth_keyframes, self);
+      KMS_ELEMENT_UNLOCK (self);
+      break;
     case PROP_CODEC_CONFIG:{
       KMS_ELEMENT_LOCK (self);
       if (self->priv->codec_config) {
@@ -1322,6 +1415,10 @@ kms_element_get_property (GObject * object, guint property_id,
     case PROP_ACCEPT_EOS:
       g_value_set_boolean (value, g_atomic_int_get (&self->priv->accept_eos));
       break;
+    case PROP_LATENCY_DOMAIN:
+      g_value_set_boolean (value,
+          g_atomic_int_get (&self->priv->latency_domain));
+      break;
     case PROP_AUDIO_CAPS:
       g_value_take_boxed (value, kms_element_endpoint_get_caps (self,
               self->priv->audio_caps));
@@ -1340,6 +1437,21 @@ kms_element_get_property (GObject * object, guint property_id,
       g_value_set_int (value, self->priv->max_output_bitrate);
       KMS_ELEMENT_UNLOCK (self);
       break;
+    case PROP_MAX_OUTPUT_TIERS:
+      KMS_ELEMENT_LOCK (self);
+      g_value_set_uint (value, self->priv->max_output_tiers);
+      KMS_ELEMENT_UNLOCK (self);
+      break;
+    case PROP_OUTPUT_GOP_CACHE_SIZE:
+      KMS_ELEMENT_LOCK (self);
+      g_value_set_uint (value, self->priv->output_gop_cache_size);
+      KMS_ELEMENT_UNLOCK (self);
+      break;
+    case PROP_OUTPUT_SMOOTH_KEYFRAMES:
+      KMS_ELEMENT_LOCK (self);
+      g_value_set_boolean (value, self->priv->output_smooth_keyframes);
+      KMS_ELEMENT_UNLOCK (self);
+      break;
     case PROP_MEDIA_STATS:
       KMS_ELEMENT_LOCK (self);
       g_value_set_boolean (value, self->priv->stats_enabled);
@@ -1650,6 +1762,43 @@ kms_element_get_input_latency_stats (KmsElement * self, gchar * selector)
   return stats;
 }
 
+/* Collects the @property structure of every video output element */
+static GstStructure *
+kms_element_get_video_outputs_stats (KmsElement * self, const gchar * name,
+    const gchar * property)
+{
+  gpointer key, value;
+  GHashTableIter iter;
+  GstStructure *stats;
+
+  stats = gst_structure_new_empty (name);
+
+  KMS_ELEMENT_LOCK (self);
+
+  g_hash_table_iter_init (&iter, self->priv->output_elements);
+
+  while (g_hash_table_iter_next (&iter, &key, &value)) {
+    KmsOutputElementData *odata = value;
+    GstStructure *output = NULL;
+
+    if (odata->type != KMS_ELEMENT_PAD_TYPE_VIDEO || odata->element == NULL
+        || g_object_class_find_property (G_OBJECT_GET_CLASS (odata->element),
+            property) == NULL) {
+      continue;
+    }
+
+    g_object_get (odata->element, property, &output, NULL);
+    if (output != NULL) {
+      gst_structure_set (stats, key, GST_TYPE_STRUCTURE, output, NULL);
+      gst_structure_free (output);
+    }
+  }
+
+  KMS_ELEMENT_UNLOCK (self);
+
+  return stats;
+}
+
 static GstStructure *
 kms_element_stats_impl (KmsElement * self, gchar * selector)
 {
@@ -1667,6 +1816,22 @@ kms_element_stats_impl (KmsElement * self, gchar * selector)
         "input-latencies", GST_TYPE_STRUCTURE, l_stats, NULL);
     gst_structure_free (l_stats);
 
+    if (selector == NULL || g_strcmp0 (selector, VIDEO_STREAM_NAME) == 0) {
+      GstStructure *t_stats, *enc_stats;
+
+      t_stats = kms_element_get_video_outputs_stats (self, "output-tiers",
+          TIERS);
+      gst_structure_set (e_stats, "output-tiers", GST_TYPE_STRUCTURE, t_stats,
+          NULL);
+      gst_structure_free (t_stats);
+
+      enc_stats = kms_element_get_video_outputs_stats (self, "output-encoders",
+          ENCODERS);
+      gst_structure_set (e_stats, "output-encoders", GST_TYPE_STRUCTURE,
+          enc_stats, NULL);
+      gst_structure_free (enc_stats);
+    }
+
     gst_structure_set (stats, KMS_MEDIA_ELEMENT_FIELD, GST_TYPE_STRUCTURE,
         e_stats, NULL);
 
@@ -1782,10 +1947,60 @@ kms_element_create_output_element_default (KmsElement *self)
   return element;
 }
 
+static gboolean
+kms_element_post_latency (KmsElement * self)
+{
+  g_atomic_int_set (&self->priv->latency_pending, FALSE);
+
+  GST_DEBUG_OBJECT (self, "Posting latency change of children");
+  gst_element_post_message (GST_ELEMENT (self),
+      gst_message_new_latency (GST_OBJECT (self)));
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+kms_element_handle_message (GstBin * bin, GstMessage * message)
+{
+  KmsElement *self = KMS_ELEMENT (bin);
+
+  if (GST_MESSAGE_SRC (message) == GST_OBJECT (bin)
+      || !g_atomic_int_get (&self->priv->latency_domain)) {
+    goto forward;
+  }
+
+  switch (GST_MESSAGE_TYPE (message)) {
+    case GST_MESSAGE_LATENCY:
+      /* Sinks downstream of this element may be affected, so the pipeline
+       * still has to know. A burst of changes from children is coalesced
+       * into a single message from the element. */
+      if (g_atomic_int_compare_and_exchange (&self->priv->latency_pending,
+              FALSE, TRUE)) {
+        kms_loop_timeout_add_full (KMS_ELEMENT_GET_CLASS (self)->loop,
+            G_PRIORITY_DEFAULT, LATENCY_DEBOUNCE_MS,
+            (GSourceFunc) kms_element_post_latency, g_object_ref (self),
+            g_object_unref);
+      }
+      gst_message_unref (message);
+      return;
+    case GST_MESSAGE_STATE_CHANGED:
+      /* Children follow the state of the element, whose own messages are
+       * enough for the application */
+      gst_message_unref (message);
+      return;
+    default:
+      break;
+  }
+
+forward:
+  GST_BIN_CLASS (kms_element_parent_class)->handle_message (bin, message);
+}
+
 static void
 kms_element_class_init (KmsElementClass * klass)
 {
   GstElementClass *gstelement_class;
+  GstBinClass *gstbin_class;
   GObjectClass *gobject_class;
 
   gobject_class = G_OBJECT_CLASS (klass);
@@ -1800,6 +2015,9 @@ kms_element_class_init (KmsElementClass * klass)
       "Base class for elements",
       "José Antonio Santos Cadenas <santoscadenas@kurento.com>");
 
+  gstbin_class = GST_BIN_CLASS (klass);
+  gstbin_class->handle_message = GST_DEBUG_FUNCPTR (kms_element_handle_message);
+
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&audio_src_factory));
   gst_element_class_add_pad_template (gstelement_class,
@@ -1835,6 +2053,27 @@ kms_element_class_init (KmsElementClass * klass)
           "Configure the maximum output bitrate to media encoding",
           0, G_MAXINT, DEFAULT_MAX_OUTPUT_BITRATE, G_PARAM_READWRITE));
 
+  g_object_class_install_property (gobject_class, PROP_MAX_OUTPUT_TIERS,
+      g_param_spec_uint ("max-output-tiers", "max output tiers",
+          "Maximum number of video encodings of the same format, used to "
+          "serve consumers with different bandwidth estimates",
+          1, KMS_BITRATE_TIERS_MAX, DEFAULT_MAX_OUTPUT_TIERS,
+          G_PARAM_READWRITE));
+
+  g_object_class_install_property (gobject_class, PROP_OUTPUT_GOP_CACHE_SIZE,
+      g_param_spec_uint ("output-gop-cache-size", "output GOP cache size",
+          "Bytes of the last GOP kept for each encoded video output, used to "
+          "start new consumers right away (0 = disabled)",
+          0, G_MAXUINT, DEFAULT_OUTPUT_GOP_CACHE_SIZE, G_PARAM_READWRITE));
+
+  g_object_class_install_property (gobject_class,
+      PROP_OUTPUT_SMOOTH_KEYFRAMES,
+      g_param_spec_boolean ("output-smooth-keyframes",
+          "output smooth keyframes",
+          "Answer video keyframe requests from receivers that already decode "
+          "the stream without sending a full keyframe to each one",
+          DEFAULT_OUTPUT_SMOOTH_KEYFRAMES, G_PARAM_READWRITE));
+
   g_object_class_install_property (gobject_class, PROP_MEDIA_STATS,
       g_param_spec_boolean ("media-stats", "Media stats",
           "Indicates wheter this element is collecting stats or not",
@@ -1844,6 +2083,12 @@ kms_element_class_init (KmsElementClass * klass)
       g_param_spec_boxed ("codec-config", "codec config",
           "Codec configuration", GST_TYPE_STRUCTURE, G_PARAM_READWRITE));
 
+  g_object_class_install_property (gobject_class, PROP_LATENCY_DOMAIN,
+      g_param_spec_boolean ("latency-domain", "Latency domain",
+          "Coalesce latency changes of children into one message from the "
+          "element and keep their state changes inside the element",
+          DEFAULT_LATENCY_DOMAIN, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   klass->sink_query = GST_DEBUG_FUNCPTR (kms_element_sink_query_default);
   klass->collect_media_stats =
       GST_DEBUG_FUNCPTR (kms_element_collect_media_stats_impl);
@@ -1931,9 +2176,13 @@ kms_element_init (KmsElement * element)
 element->priv = kms_element_get_instance_private (element);
 
   element->priv->accept_eos = DEFAULT_ACCEPT_EOS;
+  element->priv->latency_domain = DEFAULT_LATENCY_DOMAIN;
 
   element->priv->min_output_bitrate = DEFAULT_MIN_OUTPUT_BITRATE;
   element->priv->max_output_bitrate = DEFAULT_MAX_OUTPUT_BITRATE;
+  element->priv->max_output_tiers = DEFAULT_MAX_OUTPUT_TIERS;
+  element->priv->output_gop_cache_size = DEFAULT_OUTPUT_GOP_CACHE_SIZE;
+  element->priv->output_smooth_keyframes = DEFAULT_OUTPUT_SMOOTH_KEYFRAMES;
 
   element->priv->pendingpads = g_hash_table_new_full (g_str_hash, g_str_equal,
       g_free, (GDestroyNotify) destroy_pendingpads);
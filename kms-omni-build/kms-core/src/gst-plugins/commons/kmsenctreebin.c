@@ -21,12 +21,14 @@
 
 #include "kmsenctreebin.h"
 #include "kmsutils.h"
+#include "kmslatencyprofile.h"
+
+#include <gst/video/video.h>
 
 #define GST_DEFAULT_NAME "enctreebin"
 #define GST_CAT_DEFAULT kms_enc_tree_bin_debug
 GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
 
-#define LEAKY_TIME 600000000    /*600 ms */
 #define kms_enc_tree_bin_parent_class parent_class
 G_DEFINE_TYPE (KmsEncTreeBin, kms_enc_tree_bin, KMS_TYPE_TREE_BIN);
 
@@ -41,6 +43,16 @@ G_DEFINE_TYPE (KmsEncTreeBin, kms_enc_tree_bin, KMS_TYPE_TREE_BIN);
 #define KMS_ENC_TREE_BIN_LIMIT(obj, value) \
   MAX((obj)->priv->min_bitrate,MIN((obj)->priv->max_bitrate, (value)))
 
+/* Frames that an x264 intra refresh wave takes to cover the whole picture */
+#define SMOOTH_REFRESH_PERIOD 30
+/* Biggest VP8 keyframe, in percent of the average frame size */
+#define SMOOTH_MAX_INTRA_BITRATE 300
+/* Refresh requests closer than this get a single keyframe */
+#define SMOOTH_KEYFRAME_INTERVAL G_USEC_PER_SEC
+
+/* Frames per peak-to-mean measurement */
+#define FRAME_STATS_WINDOW 300
+
 typedef enum
 {
   VP8,
@@ -54,6 +66,7 @@ struct _KmsEncTreeBinPrivate
 {
   GstElement *enc;
   EncoderType enc_type;
+  GstElement *queue;
   RembEventManager *remb_manager;
 
   gint remb_bitrate;
@@ -63,6 +76,20 @@ struct _KmsEncTreeBinPrivate
 
   gint max_bitrate;
   gint min_bitrate;
+
+  /* Protected by the object lock */
+  gboolean smooth_keyframes;
+  gboolean intra_refresh;
+  gint64 last_keyframe_request;
+  guint64 keyframes;
+  guint64 forwarded_requests;
+  guint64 absorbed_requests;
+
+  guint window_frames;
+  guint64 window_bytes;
+  guint window_peak;
+  gdouble mean_frame_size;
+  guint peak_frame_size;
 };
 
 static const gchar *
@@ -134,9 +161,34 @@ set_encoder_configuration (GstElement * encoder, GstStructure * codec_configs,
   }
 }
 
+/*
+ * Makes keyframes cheaper for the encoders that allow it. Only new encoders
+ * get this, most of these properties cannot be changed once encoding.
+ */
+static void
+configure_encoder_smooth_keyframes (GstElement * encoder, EncoderType type)
+{
+  switch (type) {
+    case VP8:
+      if (g_object_class_find_property (G_OBJECT_GET_CLASS (encoder),
+              "max-intra-bitrate") != NULL) {
+        g_object_set (G_OBJECT (encoder), "max-intra-bitrate",
+            SMOOTH_MAX_INTRA_BITRATE, NULL);
+      }
+      break;
+    case X264:
+      /* Rolling intra columns instead of IDR frames */
+      g_object_set (G_OBJECT (encoder), "intra-refresh", TRUE,
+          "key-int-max", SMOOTH_REFRESH_PERIOD, NULL);
+      break;
+    default:
+      break;
+  }
+}
+
 static void
 configure_encoder (GstElement * encoder, EncoderType type, gint target_bitrate,
-    GstStructure * codec_configs)
+    gboolean smooth_keyframes, GstStructure * codec_configs)
 {
   GST_DEBUG ("Configure encoder: %" GST_PTR_FORMAT, encoder);
   switch (type) {
@@ -188,10 +240,25 @@ configure_encoder (GstElement * encoder, EncoderType type, gint target_bitrate,
           " not configured because it is not supported", encoder);
       break;
   }
+  if (smooth_keyframes) {
+    configure_encoder_smooth_keyframes (encoder, type);
+  }
   set_encoder_configuration (encoder, codec_configs,
       kms_enc_tree_bin_get_name_from_type (type));
 }
 
+static gboolean
+encoder_has_intra_refresh (GstElement * encoder, EncoderType type)
+{
+  gboolean intra_refresh = FALSE;
+
+  if (type == X264) {
+    g_object_get (G_OBJECT (encoder), "intra-refresh", &intra_refresh, NULL);
+  }
+
+  return intra_refresh;
+}
+
 static void
 kms_enc_tree_bin_set_encoder_type (KmsEncTreeBin * self)
 {
@@ -216,7 +283,8 @@ kms_enc_tree_bin_set_encoder_type (KmsEncTreeBin * self)
 
 static void
 kms_enc_tree_bin_create_encoder_for_caps (KmsEncTreeBin * self,
-    const GstCaps * caps, gint target_bitrate, GstStructure * codec_configs)
+    const GstCaps * caps, gint target_bitrate, gboolean smooth_keyframes,
+    GstStructure * codec_configs)
 {
   GList *encoder_list, *filtered_list, *l;
   GstElementFactory *encoder_factory = NULL;
@@ -250,7 +318,7 @@ kms_enc_tree_bin_create_encoder_for_caps (KmsEncTreeBin * self,
     self->priv->enc = gst_element_factory_create (encoder_factory, NULL);
     kms_enc_tree_bin_set_encoder_type (self);
     configure_encoder (self->priv->enc, self->priv->enc_type, target_bitrate,
-        codec_configs);
+        smooth_keyframes, codec_configs);
   }
 
   gst_plugin_feature_list_free (filtered_list);
@@ -384,6 +452,89 @@ tag_event_probe (GstPad * pad, GstPadProbeInfo * info, gpointer data)
   return GST_PAD_PROBE_OK;
 }
 
+/*
+ * Refresh requests without headers come from receivers that already decode
+ * the stream and lost some of it (RTCP PLI). In smooth mode they do not get
+ * an IDR each: an x264 created with intra refresh repairs them with its next
+ * wave, other encoders send one keyframe for all the requests of a short
+ * interval.
+ * Requests with headers (new branches, FIR) always get a real keyframe.
+ */
+static GstPadProbeReturn
+force_key_unit_probe (GstPad * pad, GstPadProbeInfo * info, gpointer data)
+{
+  KmsEncTreeBin *self = data;
+  GstEvent *event = gst_pad_probe_info_get_event (info);
+  gboolean all_headers, forward = TRUE;
+  gint64 now;
+
+  if (!gst_video_event_is_force_key_unit (event)
+      || !gst_video_event_parse_upstream_force_key_unit (event, NULL,
+          &all_headers, NULL)) {
+    return GST_PAD_PROBE_OK;
+  }
+
+  now = g_get_monotonic_time ();
+
+  GST_OBJECT_LOCK (self);
+
+  if (self->priv->smooth_keyframes && !all_headers) {
+    if (self->priv->intra_refresh) {
+      forward = FALSE;
+    } else {
+      forward = now - self->priv->last_keyframe_request >=
+          SMOOTH_KEYFRAME_INTERVAL;
+    }
+  }
+
+  if (forward) {
+    self->priv->last_keyframe_request = now;
+    self->priv->forwarded_requests++;
+  } else {
+    self->priv->absorbed_requests++;
+  }
+
+  GST_OBJECT_UNLOCK (self);
+
+  if (!forward) {
+    GST_DEBUG_OBJECT (self, "Refresh request absorbed");
+    return GST_PAD_PROBE_DROP;
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn
+frame_stats_probe (GstPad * pad, GstPadProbeInfo * info, gpointer data)
+{
+  KmsEncTreeBin *self = data;
+  GstBuffer *buffer = gst_pad_probe_info_get_buffer (info);
+  guint size = gst_buffer_get_size (buffer);
+
+  GST_OBJECT_LOCK (self);
+
+  if (!GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT)) {
+    self->priv->keyframes++;
+  }
+
+  self->priv->window_frames++;
+  self->priv->window_bytes += size;
+  self->priv->window_peak = MAX (self->priv->window_peak, size);
+
+  if (self->priv->window_frames == FRAME_STATS_WINDOW) {
+    self->priv->mean_frame_size =
+        (gdouble) self->priv->window_bytes / self->priv->window_frames;
+    self->priv->peak_frame_size = self->priv->window_peak;
+    self->priv->window_frames = 0;
+    self->priv->window_bytes = 0;
+    self->priv->window_peak = 0;
+  }
+
+  GST_OBJECT_UNLOCK (self);
+
+  return GST_PAD_PROBE_OK;
+}
+
 /*
  * FIXME: This is a hack to make x264 work.
  *
@@ -442,7 +593,8 @@ check_caps_probe (GstPad * pad, GstPadProbeInfo * info, gpointer data)
 
 static gboolean
 kms_enc_tree_bin_configure (KmsEncTreeBin * self, const GstCaps * caps,
-    gint target_bitrate, GstStructure * codec_configs)
+    gint target_bitrate, gboolean smooth_keyframes,
+    GstStructure * codec_configs)
 {
   KmsTreeBin *tree_bin = KMS_TREE_BIN (self);
   GstElement *rate, *convert, *mediator, *output_tee, *capsfilter = NULL;
@@ -451,8 +603,9 @@ kms_enc_tree_bin_configure (KmsEncTreeBin * self, const GstCaps * caps,
 
   self->priv->current_bitrate = target_bitrate;
 
+  self->priv->smooth_keyframes = smooth_keyframes;
   kms_enc_tree_bin_create_encoder_for_caps (self, caps, target_bitrate,
-      codec_configs);
+      smooth_keyframes, codec_configs);
 
   if (self->priv->enc == NULL) {
     GST_WARNING_OBJECT (self, "Invalid encoder for caps: %" GST_PTR_FORMAT,
@@ -462,19 +615,29 @@ kms_enc_tree_bin_configure (KmsEncTreeBin * self, const GstCaps * caps,
 
   GST_DEBUG_OBJECT (self, "Encoder found: %" GST_PTR_FORMAT, self->priv->enc);
 
+  self->priv->intra_refresh =
+      encoder_has_intra_refresh (self->priv->enc, self->priv->enc_type);
+
   enc_src = gst_element_get_static_pad (self->priv->enc, "src");
   self->priv->remb_manager = kms_utils_remb_event_manager_create (enc_src);
   kms_utils_remb_event_manager_set_callback (self->priv->remb_manager,
       bitrate_callback, self, NULL);
   gst_pad_add_probe (enc_src, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
       tag_event_probe, self, NULL);
+  gst_pad_add_probe (enc_src, GST_PAD_PROBE_TYPE_EVENT_UPSTREAM,
+      force_key_unit_probe, self, NULL);
+  gst_pad_add_probe (enc_src, GST_PAD_PROBE_TYPE_BUFFER, frame_stats_probe,
+      self, NULL);
   g_object_unref (enc_src);
 
   rate = kms_utils_create_rate_for_caps (caps);
   convert = kms_utils_create_convert_for_caps (caps);
   mediator = kms_utils_create_mediator_element (caps);
   queue = kms_utils_element_factory_make ("queue", "enctreebin");
-  g_object_set (queue, "leaky", 2, "max-size-time", LEAKY_TIME, NULL);
+  g_object_set (queue, "leaky", 2, "max-size-time",
+      kms_latency_profile_get_element_targets (GST_ELEMENT (self))->queue_time,
+      NULL);
+  self->priv->queue = queue;
 
   if (rate) {
     gst_bin_add (GST_BIN (self), rate);
@@ -528,9 +691,57 @@ kms_enc_tree_bin_configure (KmsEncTreeBin * self, const GstCaps * caps,
   return TRUE;
 }
 
+void
+kms_enc_tree_bin_set_smooth_keyframes (KmsEncTreeBin * self,
+    gboolean smooth_keyframes)
+{
+  GST_OBJECT_LOCK (self);
+  self->priv->smooth_keyframes = smooth_keyframes;
+  GST_OBJECT_UNLOCK (self);
+}
+
+GstStructure *
+kms_enc_tree_bin_get_stats (KmsEncTreeBin * self)
+{
+  GstStructure *stats;
+  gdouble mean;
+  guint peak;
+
+  GST_OBJECT_LOCK (self);
+
+  if (self->priv->mean_frame_size > 0) {
+    mean = self->priv->mean_frame_size;
+    peak = self->priv->peak_frame_size;
+  } else if (self->priv->window_frames > 0) {
+    /* Not a whole window yet */
+    mean = (gdouble) self->priv->window_bytes / self->priv->window_frames;
+    peak = self->priv->window_peak;
+  } else {
+    mean = 0;
+    peak = 0;
+  }
+
+  stats = gst_structure_new ("encoder",
+      "codec", G_TYPE_STRING,
+      kms_enc_tree_bin_get_name_from_type (self->priv->enc_type),
+      "smooth-keyframes", G_TYPE_BOOLEAN, self->priv->smooth_keyframes,
+      "intra-refresh", G_TYPE_BOOLEAN, self->priv->intra_refresh,
+      "keyframes", G_TYPE_UINT64, self->priv->keyframes,
+      "forwarded-requests", G_TYPE_UINT64, self->priv->forwarded_requests,
+      "absorbed-requests", G_TYPE_UINT64, self->priv->absorbed_requests,
+      "mean-frame-size", G_TYPE_DOUBLE, mean,
+      "peak-frame-size", G_TYPE_UINT, peak,
+      "peak-to-mean", G_TYPE_DOUBLE, mean > 0 ? peak / mean : 0.0, NULL);
+
+  GST_OBJECT_UNLOCK (self);
+
+  return stats;
+}
+
 KmsEncTreeBin *
 kms_enc_tree_bin_new (const GstCaps * caps, gint target_bitrate,
-    gint min_bitrate, gint max_bitrate, GstStructure * codec_configs)
+    gint min_bitrate, gint max_bitrate, gboolean smooth_keyframes,
+    GstStructure * codec_configs)
 {
   KmsEncTreeBin *enc;
 
@@ -539,7 +750,8 @@ kms_enc_tree_bin_new (const GstCaps * caps, gint target_bitrate,
   enc->priv->min_bitrate = min_bitrate;
 
   target_bitrate = KMS_ENC_TREE_BIN_LIMIT (enc, target_bitrate);
-  if (!kms_enc_tree_bin_configure (enc, caps, target_bitrate, codec_configs)) {
+  if (!kms_enc_tree_bin_configure (enc, caps, target_bitrate,
+          smooth_keyframes, codec_configs)) {
     g_object_unref (enc);
     return NULL;
   }
@@ -560,6 +772,8 @@ kms_enc_tree_bin_init (KmsEncTreeBin * self)
 
   self->priv->max_bitrate = G_MAXINT;
   self->priv->min_bitrate = 0;
+
+  self->priv->last_keyframe_request = G_MININT64 / 2;
 }
 
 static void
@@ -578,6 +792,31 @@ kms_enc_tree_bin_dispose (GObject * object)
   G_OBJECT_CLASS (kms_enc_tree_bin_parent_class)->dispose (object);
 }
 
+static void
+kms_enc_tree_bin_set_context (GstElement * element, GstContext * context)
+{
+  KmsEncTreeBin *self = KMS_ENC_TREE_BIN (element);
+  KmsLatencyProfile profile;
+
+  /* Also called when added to a bin, so it covers newly built trees */
+  if (kms_latency_profile_parse_context (context, &profile)) {
+    const KmsLatencyTargets *targets =
+        kms_latency_profile_get_targets (profile);
+
+    if (self->priv->queue != NULL) {
+      g_object_set (self->priv->queue, "max-size-time", targets->queue_time,
+          NULL);
+    }
+
+    if (self->priv->enc != NULL && self->priv->enc_type == VP8) {
+      g_object_set (self->priv->enc, "deadline", targets->encoder_deadline,
+          NULL);
+    }
+  }
+
+  GST_ELEMENT_CLASS (parent_class)->set_context (element, context);
+}
+
 static void
 kms_enc_tree_bin_class_init (KmsEncTreeBinClass * klass)
 {
@@ -595,5 +834,8 @@ kms_enc_tree_bin_class_init (KmsEncTreeBinClass * klass)
 
   gobject_class->dispose = kms_enc_tree_bin_dispose;
 
+  gstelement_class->set_context =
+      GST_DEBUG_FUNCPTR (kms_enc_tree_bin_set_context);
+
   // g_type_class_add_private (klass, sizeof (KmsEncTreeBinPrivate));
 }
@@ -52,10 +52,21 @@ struct _KmsEncTreeBinClass
 
 GType kms_enc_tree_bin_get_type (void);
 
-KmsEncTreeBin * kms_enc_tree_bin_new (const GstCaps * caps, gint target_bitrate, gint min_bitrate, gint max_bitrate, GstStructure *codec_configs);
+KmsEncTreeBin * kms_enc_tree_bin_new (const GstCaps * caps, gint target_bitrate, gint min_bitrate, gint max_bitrate, gboolean smooth_keyframes, GstStructure *codec_configs);
 void kms_enc_tree_bin_set_bitrate_limits (KmsEncTreeBin *self, gint min_bitrate, gint max_bitrate);
 gint kms_enc_tree_bin_get_min_bitrate (KmsEncTreeBin *self);
 gint kms_enc_tree_bin_get_max_bitrate (KmsEncTreeBin *self);
 
+/*
+ * In smooth mode, keyframe requests without headers (RTCP PLI from receivers
+ * that already decode the stream) do not get a full keyframe each. The
+ * encoder settings for it are only applied on creation, so an encoder that
+ * was created without intra refresh keeps answering them with keyframes.
+ */
+void kms_enc_tree_bin_set_smooth_keyframes (KmsEncTreeBin *self, gboolean smooth_keyframes);
+
+/* Keyframe requests handled and peak-to-mean frame size of the output */
+GstStructure * kms_enc_tree_bin_get_stats (KmsEncTreeBin *self);
+
 G_END_DECLS
 #endif /* __KMS_ENC_TREE_BIN_H__ */
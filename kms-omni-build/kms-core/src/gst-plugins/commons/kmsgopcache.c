@@ -0,0 +1,173 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "kmsgopcache.h"
+
+#define GST_DEFAULT_NAME "kmsgopcache"
+#define GST_CAT_DEFAULT kms_gop_cache_debug
+GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
+
+#define buffer_is_keyframe(buffer) \
+    (!GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT))
+
+struct _KmsGopCache
+{
+  GMutex mutex;
+
+  /* GstBuffer, the head is always a keyframe */
+  GQueue buffers;
+  gsize size;
+  gsize max_size;
+
+  gint64 max_age;
+  /* Arrival of the cached keyframe, -1 while there is none */
+  gint64 keyframe_time;
+};
+
+/* Call this function holding the lock */
+static void
+kms_gop_cache_reset (KmsGopCache * self)
+{
+  g_queue_free_full (&self->buffers, (GDestroyNotify) gst_buffer_unref);
+  g_queue_init (&self->buffers);
+  self->size = 0;
+  self->keyframe_time = -1;
+}
+
+KmsGopCache *
+kms_gop_cache_new (gsize max_size, gint64 max_age)
+{
+  KmsGopCache *self = g_slice_new0 (KmsGopCache);
+
+  g_mutex_init (&self->mutex);
+  g_queue_init (&self->buffers);
+  self->max_size = max_size;
+  self->max_age = max_age;
+  self->keyframe_time = -1;
+
+  return self;
+}
+
+void
+kms_gop_cache_free (KmsGopCache * self)
+{
+  kms_gop_cache_reset (self);
+  g_mutex_clear (&self->mutex);
+  g_slice_free (KmsGopCache, self);
+}
+
+void
+kms_gop_cache_set_max_size (KmsGopCache * self, gsize max_size)
+{
+  g_mutex_lock (&self->mutex);
+  self->max_size = max_size;
+  if (self->size > max_size) {
+    kms_gop_cache_reset (self);
+  }
+  g_mutex_unlock (&self->mutex);
+}
+
+gsize
+kms_gop_cache_get_max_size (KmsGopCache * self)
+{
+  gsize max_size;
+
+  g_mutex_lock (&self->mutex);
+  max_size = self->max_size;
+  g_mutex_unlock (&self->mutex);
+
+  return max_size;
+}
+
+void
+kms_gop_cache_push (KmsGopCache * self, GstBuffer * buffer)
+{
+  gsize size = gst_buffer_get_size (buffer);
+
+  g_mutex_lock (&self->mutex);
+
+  if (self->max_size == 0) {
+    goto end;
+  }
+
+  if (buffer_is_keyframe (buffer)) {
+    kms_gop_cache_reset (self);
+    self->keyframe_time = g_get_monotonic_time ();
+  } else if (self->keyframe_time < 0) {
+    /* Waiting for a keyframe */
+    goto end;
+  }
+
+  if (self->size + size > self->max_size) {
+    GST_DEBUG ("GOP over %" G_GSIZE_FORMAT " bytes, not cached until the "
+        "next keyframe", self->max_size);
+    kms_gop_cache_reset (self);
+    goto end;
+  }
+
+  g_queue_push_tail (&self->buffers, gst_buffer_ref (buffer));
+  self->size += size;
+
+end:
+  g_mutex_unlock (&self->mutex);
+}
+
+void
+kms_gop_cache_clear (KmsGopCache * self)
+{
+  g_mutex_lock (&self->mutex);
+  kms_gop_cache_reset (self);
+  g_mutex_unlock (&self->mutex);
+}
+
+GstBufferList *
+kms_gop_cache_get (KmsGopCache * self)
+{
+  GstBufferList *list = NULL;
+  GList *l;
+
+  g_mutex_lock (&self->mutex);
+
+  if (self->keyframe_time < 0) {
+    GST_TRACE ("No keyframe cached");
+    goto end;
+  }
+
+  if (g_get_monotonic_time () - self->keyframe_time > self->max_age) {
+    GST_DEBUG ("Cached keyframe is stale");
+    goto end;
+  }
+
+  list = gst_buffer_list_new_sized (g_queue_get_length (&self->buffers));
+  for (l = self->buffers.head; l != NULL; l = l->next) {
+    gst_buffer_list_add (list, gst_buffer_ref (l->data));
+  }
+
+end:
+  g_mutex_unlock (&self->mutex);
+
+  return list;
+}
+
+static void init_debug (void) __attribute__ ((constructor));
+
+static void
+init_debug (void)
+{
+  GST_DEBUG_CATEGORY_INIT (GST_CAT_DEFAULT, GST_DEFAULT_NAME, 0,
+      GST_DEFAULT_NAME);
+}
@@ -0,0 +1,58 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __KMS_GOP_CACHE_H__
+#define __KMS_GOP_CACHE_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/* A cached keyframe older than this is not worth sending to a new consumer */
+#define KMS_GOP_CACHE_DEFAULT_MAX_AGE (10 * G_USEC_PER_SEC)
+
+typedef struct _KmsGopCache KmsGopCache;
+
+/*
+ * Keeps the last keyframe of an encoded stream and the delta frames that
+ * followed it, so that a consumer joining late can be started right away
+ * instead of waiting for the next keyframe.
+ *
+ * @max_size: bytes that the cached frames may take, 0 disables the cache.
+ *     A GOP that does not fit is dropped until the next keyframe.
+ * @max_age: microseconds after which the cached keyframe is stale.
+ */
+KmsGopCache * kms_gop_cache_new (gsize max_size, gint64 max_age);
+void kms_gop_cache_free (KmsGopCache * self);
+
+void kms_gop_cache_set_max_size (KmsGopCache * self, gsize max_size);
+gsize kms_gop_cache_get_max_size (KmsGopCache * self);
+
+/* Called for every buffer of the stream, in order */
+void kms_gop_cache_push (KmsGopCache * self, GstBuffer * buffer);
+
+/* Forgets the current GOP, i.e. when the format of the stream changes */
+void kms_gop_cache_clear (KmsGopCache * self);
+
+/*
+ * Returns the cached frames, starting with the keyframe, or NULL when there
+ * is no complete GOP or its keyframe is stale.
+ */
+GstBufferList * kms_gop_cache_get (KmsGopCache * self);
+
+G_END_DECLS
+#endif /* __KMS_GOP_CACHE_H__ */
@@ -44,11 +44,31 @@ GST_DEBUG_CATEGORY_STATIC (kms_hub_port_debug_category);
   )                                             \
 )
 
+#define DEFAULT_SHARED_AUDIO_ENCODING FALSE
+#define DEFAULT_SHARED_VIDEO_ENCODING FALSE
+
+enum
+{
+  PROP_0,
+  PROP_SHARED_AUDIO_ENCODING,
+  PROP_SHARED_VIDEO_ENCODING,
+  N_PROPERTIES
+};
+
 struct _KmsHubPortPrivate
 {
-  void *dummy;
+  GstElement *audio_input_tee;
+  GstElement *video_input_tee;
+
+  gboolean shared_audio_encoding;
+  gboolean shared_video_encoding;
 };
 
+/* Encoded formats that can be produced once by the hub for several ports */
+static GstStaticCaps static_shareable_caps =
+    GST_STATIC_CAPS (KMS_AGNOSTIC_FORMATS_AUDIO_CAPS
+    KMS_AGNOSTIC_FORMATS_VIDEO_CAPS);
+
 /* Pad templates */
 static GstStaticPadTemplate hub_audio_sink_factory =
 GST_STATIC_PAD_TEMPLATE (HUB_AUDIO_SINK_PAD,
@@ -96,6 +116,232 @@ G_DEFINE_TYPE_WITH_PRIVATE (KmsHubPort, kms_hub_port,
 //    GST_DEBUG_CATEGORY_INIT (kms_hub_port_debug_category, PLUGIN_NAME,
 //        0, "debug category for hubport element"));
 
+static gboolean
+kms_hub_port_is_sharing (KmsHubPort * self, const gchar * sink_name)
+{
+  gboolean ret;
+
+  GST_OBJECT_LOCK (self);
+  if (g_strcmp0 (sink_name, HUB_AUDIO_SINK_PAD) == 0) {
+    ret = self->priv->shared_audio_encoding;
+  } else if (g_strcmp0 (sink_name, HUB_VIDEO_SINK_PAD) == 0) {
+    ret = self->priv->shared_video_encoding;
+  } else {
+    ret = FALSE;
+  }
+  GST_OBJECT_UNLOCK (self);
+
+  return ret;
+}
+
+static gboolean
+kms_hub_port_has_own_encoding_params (KmsHubPort * self)
+{
+  GstStructure *codec_config = NULL;
+  gint min_bitrate, max_bitrate;
+  gboolean ret;
+
+  g_object_get (self, "min-output-bitrate", &min_bitrate,
+      "max-output-bitrate", &max_bitrate, "codec-config", &codec_config, NULL);
+
+  ret = min_bitrate != 0 || max_bitrate != G_MAXINT || codec_config != NULL;
+
+  if (codec_config != NULL) {
+    gst_structure_free (codec_config);
+  }
+
+  return ret;
+}
+
+/*
+ * Returns the encoded caps preferred by every consumer of @output, or NULL if
+ * they do not agree on one format, or if any of them prefers raw media.
+ * Consumers usually accept raw media too, so only the first structure of
+ * their caps, the one negotiation would pick, is taken into account.
+ */
+static GstCaps *
+kms_hub_port_get_shared_caps (KmsHubPort * self, GstElement * output)
+{
+  GstCaps *shareable, *shared = NULL;
+  gboolean done = FALSE, valid = TRUE;
+  GstIterator *it;
+  GValue item = G_VALUE_INIT;
+
+  if (kms_hub_port_has_own_encoding_params (self)) {
+    return NULL;
+  }
+
+  shareable = gst_static_caps_get (&static_shareable_caps);
+  it = gst_element_iterate_src_pads (output);
+
+  while (!done && valid) {
+    switch (gst_iterator_next (it, &item)) {
+      case GST_ITERATOR_OK:{
+        GstPad *pad = g_value_get_object (&item);
+        GstCaps *caps, *preferred;
+
+        if (!gst_pad_is_linked (pad)) {
+          g_value_reset (&item);
+          break;
+        }
+
+        caps = gst_pad_peer_query_caps (pad, NULL);
+
+        if (gst_caps_is_empty (caps) || gst_caps_is_any (caps)) {
+          gst_caps_unref (caps);
+          valid = FALSE;
+          g_value_reset (&item);
+          break;
+        }
+
+        preferred = gst_caps_copy_nth (caps, 0);
+        gst_caps_unref (caps);
+
+        if (!gst_caps_is_always_compatible (preferred, shareable)) {
+          valid = FALSE;
+        } else if (shared == NULL) {
+          shared = gst_caps_ref (preferred);
+        } else {
+          GstCaps *common = gst_caps_intersect (shared, preferred);
+
+          gst_caps_unref (shared);
+          shared = common;
+          valid = !gst_caps_is_empty (shared);
+        }
+
+        gst_caps_unref (preferred);
+        g_value_reset (&item);
+        break;
+      }
+      case GST_ITERATOR_RESYNC:
+        gst_iterator_resync (it);
+        gst_caps_replace (&shared, NULL);
+        break;
+      case GST_ITERATOR_ERROR:
+        valid = FALSE;
+        break;
+      case GST_ITERATOR_DONE:
+        done = TRUE;
+        break;
+    }
+  }
+
+  g_value_unset (&item);
+  gst_iterator_free (it);
+  gst_caps_unref (shareable);
+
+  if (!valid) {
+    gst_caps_replace (&shared, NULL);
+  }
+
+  return shared;
+}
+
+/*
+ * When the hub feeds this port from an agnosticbin, ask it for the encoded
+ * format our consumers need instead of raw media. The agnosticbin keeps one
+ * encoder per format, so every port that wants the same caps gets the same
+ * encoded stream and this port's own agnosticbin just passes it through.
+ */
+static gboolean
+kms_hub_port_sink_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  KmsHubPort *self = KMS_HUB_PORT (parent);
+  GstElement *output;
+  GstCaps *shared;
+
+  if ((GST_QUERY_TYPE (query) != GST_QUERY_CAPS &&
+          GST_QUERY_TYPE (query) != GST_QUERY_ACCEPT_CAPS) ||
+      !kms_hub_port_is_sharing (self, GST_OBJECT_NAME (pad))) {
+    return gst_pad_query_default (pad, parent, query);
+  }
+
+  output = g_object_get_qdata (G_OBJECT (pad), key_elem_data_quark ());
+  shared = kms_hub_port_get_shared_caps (self, output);
+
+  if (shared == NULL) {
+    return gst_pad_query_default (pad, parent, query);
+  }
+
+  if (GST_QUERY_TYPE (query) == GST_QUERY_CAPS) {
+    GstCaps *filter, *result;
+
+    gst_query_parse_caps (query, &filter);
+
+    if (filter != NULL) {
+      result = gst_caps_intersect_full (filter, shared,
+          GST_CAPS_INTERSECT_FIRST);
+    } else {
+      result = gst_caps_ref (shared);
+    }
+
+    gst_query_set_caps_result (query, result);
+    gst_caps_unref (result);
+  } else {
+    GstCaps *caps;
+
+    gst_query_parse_accept_caps (query, &caps);
+    gst_query_set_accept_caps_result (query,
+        gst_caps_can_intersect (caps, shared));
+  }
+
+  GST_LOG_OBJECT (pad, "Shared caps: %" GST_PTR_FORMAT, shared);
+  gst_caps_unref (shared);
+
+  return TRUE;
+}
+
+static void
+kms_hub_port_reconfigure_sink (KmsHubPort * self, const gchar * name)
+{
+  GstPad *sink = gst_element_get_static_pad (GST_ELEMENT (self), name);
+
+  if (sink == NULL) {
+    return;
+  }
+
+  GST_DEBUG_OBJECT (self, "Reconfigure %" GST_PTR_FORMAT, sink);
+  gst_pad_push_event (sink, gst_event_new_reconfigure ());
+  g_object_unref (sink);
+}
+
+static void
+kms_hub_port_src_pad_link_changed (GstPad * pad, GstPad * peer,
+    KmsHubPort * self)
+{
+  const gchar *sink_name;
+
+  switch (kms_element_get_pad_type (KMS_ELEMENT (self), pad)) {
+    case KMS_ELEMENT_PAD_TYPE_AUDIO:
+      sink_name = HUB_AUDIO_SINK_PAD;
+      break;
+    case KMS_ELEMENT_PAD_TYPE_VIDEO:
+      sink_name = HUB_VIDEO_SINK_PAD;
+      break;
+    default:
+      return;
+  }
+
+  /* Consumers changed, the shared format may be a different one now */
+  if (kms_hub_port_is_sharing (self, sink_name)) {
+    kms_hub_port_reconfigure_sink (self, sink_name);
+  }
+}
+
+static void
+kms_hub_port_pad_added (KmsHubPort * self, GstPad * pad, gpointer data)
+{
+  if (gst_pad_get_direction (pad) != GST_PAD_SRC ||
+      g_str_has_prefix (GST_OBJECT_NAME (pad), "hub_")) {
+    return;
+  }
+
+  g_signal_connect_object (pad, "linked",
+      G_CALLBACK (kms_hub_port_src_pad_link_changed), self, 0);
+  g_signal_connect_object (pad, "unlinked",
+      G_CALLBACK (kms_hub_port_src_pad_link_changed), self, 0);
+}
+
 static GstPad *
 kms_hub_port_generate_sink_pad (GstElement * element,
     GstPadTemplate * templ, const gchar * name, const GstCaps * caps,
@@ -107,6 +353,9 @@ kms_hub_port_generate_sink_pad (GstElement * element,
   pad = gst_ghost_pad_new_from_template (name, output_pad, templ);
   g_object_unref (output_pad);
 
+  g_object_set_qdata (G_OBJECT (pad), key_elem_data_quark (), output);
+  gst_pad_set_query_function (pad, kms_hub_port_sink_query);
+
   if (GST_STATE (element) >= GST_STATE_PAUSED
       || GST_STATE_PENDING (element) >= GST_STATE_PAUSED
       || GST_STATE_TARGET (element) >= GST_STATE_PAUSED) {
@@ -251,17 +500,21 @@ end:
   g_object_unref (self);
 }
 
-static void
+static GstElement *
 kms_hub_port_start_media_type (KmsElement * self, KmsElementPadType type,
     GstPadTemplate * templ, const gchar * pad_name)
 {
   GstElement *capsfilter = gst_element_factory_make ("capsfilter", NULL);
-  GstPad *src = gst_element_get_static_pad (capsfilter, "src");
-  GstPad *internal_src;
+  GstElement *tee = gst_element_factory_make ("tee", NULL);
+  GstPad *src, *internal_src;
 
-  gst_bin_add (GST_BIN (self), capsfilter);
+  gst_bin_add_many (GST_BIN (self), capsfilter, tee, NULL);
+  gst_element_link (capsfilter, tee);
+  gst_element_sync_state_with_parent (tee);
   gst_element_sync_state_with_parent (capsfilter);
 
+  /* The tee also feeds the hub input outputs, if they are requested */
+  src = gst_element_request_pad_simple (tee, "src_%u");
   internal_src = gst_ghost_pad_new_from_template (pad_name, src, templ);
 
   g_object_set_qdata_full (G_OBJECT (internal_src), key_elem_data_quark (),
@@ -280,6 +533,100 @@ kms_hub_port_start_media_type (KmsElement * self, KmsElementPadType type,
 
   gst_element_add_pad (GST_ELEMENT (self), internal_src);
   g_object_unref (src);
+
+  return tee;
+}
+
+static KmsRequestNewSrcElementReturn
+kms_hub_port_request_new_src_element (KmsElement * element,
+    KmsElementPadType type, const gchar * description, const gchar * name)
+{
+  KmsHubPort *self = KMS_HUB_PORT (element);
+  GstElement *tee, *output;
+
+  if (g_strcmp0 (description, HUB_INPUT_DESCRIPTION) != 0) {
+    return KMS_ELEMENT_CLASS (kms_hub_port_parent_class)->request_new_src_element
+        (element, type, description, name);
+  }
+
+  switch (type) {
+    case KMS_ELEMENT_PAD_TYPE_AUDIO:
+      tee = self->priv->audio_input_tee;
+      break;
+    case KMS_ELEMENT_PAD_TYPE_VIDEO:
+      tee = self->priv->video_input_tee;
+      break;
+    default:
+      return KMS_REQUEST_NEW_SRC_ELEMENT_NOT_SUPPORTED;
+  }
+
+  GST_DEBUG_OBJECT (self, "Exposing hub input for %s", name);
+
+  output = kms_element_get_output_element (element, type, description);
+  if (!gst_element_link (tee, output)) {
+    GST_ERROR_OBJECT (self, "Cannot link hub input to %" GST_PTR_FORMAT,
+        output);
+    return KMS_REQUEST_NEW_SRC_ELEMENT_NOT_SUPPORTED;
+  }
+
+  return KMS_REQUEST_NEW_SRC_ELEMENT_OK;
+}
+
+static void
+kms_hub_port_set_property (GObject * object, guint property_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  KmsHubPort *self = KMS_HUB_PORT (object);
+  const gchar *sink_name;
+  gboolean *shared, v = g_value_get_boolean (value);
+
+  switch (property_id) {
+    case PROP_SHARED_AUDIO_ENCODING:
+      shared = &self->priv->shared_audio_encoding;
+      sink_name = HUB_AUDIO_SINK_PAD;
+      break;
+    case PROP_SHARED_VIDEO_ENCODING:
+      shared = &self->priv->shared_video_encoding;
+      sink_name = HUB_VIDEO_SINK_PAD;
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      return;
+  }
+
+  GST_OBJECT_LOCK (self);
+  if (*shared == v) {
+    GST_OBJECT_UNLOCK (self);
+    return;
+  }
+  *shared = v;
+  GST_OBJECT_UNLOCK (self);
+
+  /* Let the hub renegotiate what it sends to this port */
+  kms_hub_port_reconfigure_sink (self, sink_name);
+}
+
+static void
+kms_hub_port_get_property (GObject * object, guint property_id,
+    GValue * value, GParamSpec * pspec)
+{
+  KmsHubPort *self = KMS_HUB_PORT (object);
+
+  GST_OBJECT_LOCK (self);
+
+  switch (property_id) {
+    case PROP_SHARED_AUDIO_ENCODING:
+      g_value_set_boolean (value, self->priv->shared_audio_encoding);
+      break;
+    case PROP_SHARED_VIDEO_ENCODING:
+      g_value_set_boolean (value, self->priv->shared_video_encoding);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      break;
+  }
+
+  GST_OBJECT_UNLOCK (self);
 }
 
 static void
@@ -299,6 +646,7 @@ kms_hub_port_class_init (KmsHubPortClass * klass)
 {
   GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
   GstElementClass *gstelement_class = GST_ELEMENT_CLASS (klass);
+  KmsElementClass *kmselement_class = KMS_ELEMENT_CLASS (klass);
 
   gst_element_class_set_static_metadata (GST_ELEMENT_CLASS (klass),
       "HubPort", "Generic", "Kurento plugin for mixer connection",
@@ -306,10 +654,15 @@ kms_hub_port_class_init (KmsHubPortClass * klass)
 
   gobject_class->dispose = kms_hub_port_dispose;
   gobject_class->finalize = kms_hub_port_finalize;
+  gobject_class->set_property = kms_hub_port_set_property;
+  gobject_class->get_property = kms_hub_port_get_property;
 
   gstelement_class->request_new_pad =
       GST_DEBUG_FUNCPTR (kms_hub_port_request_new_pad);
 
+  kmselement_class->request_new_src_element =
+      GST_DEBUG_FUNCPTR (kms_hub_port_request_new_src_element);
+
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&hub_audio_sink_factory));
   gst_element_class_add_pad_template (gstelement_class,
@@ -324,6 +677,20 @@ kms_hub_port_class_init (KmsHubPortClass * klass)
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&hub_data_src_factory));
 
+  g_object_class_install_property (gobject_class, PROP_SHARED_AUDIO_ENCODING,
+      g_param_spec_boolean ("shared-audio-encoding", "Shared audio encoding",
+          "Ask the hub for audio already encoded in the format consumers "
+          "need, so that ports with the same format share one encoder",
+          DEFAULT_SHARED_AUDIO_ENCODING,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_SHARED_VIDEO_ENCODING,
+      g_param_spec_boolean ("shared-video-encoding", "Shared video encoding",
+          "Ask the hub for video already encoded in the format consumers "
+          "need, so that ports with the same format share one encoder",
+          DEFAULT_SHARED_VIDEO_ENCODING,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   /* Registers a private structure for the instantiatable type */
   // g_type_class_add_private (klass, sizeof (KmsHubPortPrivate));
 }
@@ -336,17 +703,24 @@ kms_hub_port_init (KmsHubPort * self)
 
 //  self->priv = KMS_HUB_PORT_GET_PRIVATE (self);
   self->priv = kms_hub_port_get_instance_private (self);
+  self->priv->shared_audio_encoding = DEFAULT_SHARED_AUDIO_ENCODING;
+  self->priv->shared_video_encoding = DEFAULT_SHARED_VIDEO_ENCODING;
 
   kmselement = KMS_ELEMENT (self);
 
+  g_signal_connect (self, "pad-added", G_CALLBACK (kms_hub_port_pad_added),
+      NULL);
+
   templ = gst_static_pad_template_get (&hub_video_src_factory);
-  kms_hub_port_start_media_type (kmselement, KMS_ELEMENT_PAD_TYPE_VIDEO, templ,
-      HUB_VIDEO_SRC_PAD);
+  self->priv->video_input_tee =
+      kms_hub_port_start_media_type (kmselement, KMS_ELEMENT_PAD_TYPE_VIDEO,
+      templ, HUB_VIDEO_SRC_PAD);
   g_object_unref (templ);
 
   templ = gst_static_pad_template_get (&hub_audio_src_factory);
-  kms_hub_port_start_media_type (kmselement, KMS_ELEMENT_PAD_TYPE_AUDIO, templ,
-      HUB_AUDIO_SRC_PAD);
+  self->priv->audio_input_tee =
+      kms_hub_port_start_media_type (kmselement, KMS_ELEMENT_PAD_TYPE_AUDIO,
+      templ, HUB_AUDIO_SRC_PAD);
   g_object_unref (templ);
 
   templ = gst_static_pad_template_get (&hub_data_src_factory);
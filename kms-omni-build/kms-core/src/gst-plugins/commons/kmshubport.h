@@ -27,6 +27,10 @@
 #define HUB_VIDEO_SRC_PAD "hub_video_src"
 #define HUB_DATA_SRC_PAD "hub_data_src"
 
+/* Source description of the outputs that carry the media entering the port,
+ * instead of the media coming from the hub */
+#define HUB_INPUT_DESCRIPTION "hubinput"
+
 G_BEGIN_DECLS
 #define KMS_TYPE_HUB_PORT kms_hub_port_get_type()
 #define KMS_HUB_PORT(obj) (                     \
@@ -0,0 +1,120 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "kmslatencyprofile.h"
+
+#define PROFILE_FIELD "profile"
+
+/* *INDENT-OFF* */
+static const KmsLatencyTargets targets[] = {
+  [KMS_LATENCY_PROFILE_DEFAULT] = {
+    .jitter_buffer_audio = 100,
+    .jitter_buffer_video = 500,
+    .queue_time = 600 * GST_MSECOND,
+    .encoder_deadline = 200000,
+    .video_mixer_latency = 600 * GST_MSECOND,
+    .audio_mixer_latency = 150 * GST_MSECOND,
+  },
+  [KMS_LATENCY_PROFILE_INTERACTIVE] = {
+    .jitter_buffer_audio = 50,
+    .jitter_buffer_video = 150,
+    .queue_time = 200 * GST_MSECOND,
+    .encoder_deadline = 1,
+    .video_mixer_latency = 100 * GST_MSECOND,
+    .audio_mixer_latency = 40 * GST_MSECOND,
+  },
+  [KMS_LATENCY_PROFILE_BROADCAST] = {
+    .jitter_buffer_audio = 200,
+    .jitter_buffer_video = 1000,
+    .queue_time = 1000 * GST_MSECOND,
+    .encoder_deadline = 200000,
+    .video_mixer_latency = 1000 * GST_MSECOND,
+    .audio_mixer_latency = 200 * GST_MSECOND,
+  },
+  [KMS_LATENCY_PROFILE_RECORDING] = {
+    .jitter_buffer_audio = 300,
+    .jitter_buffer_video = 2000,
+    .queue_time = 2000 * GST_MSECOND,
+    .encoder_deadline = 400000,
+    .video_mixer_latency = 1000 * GST_MSECOND,
+    .audio_mixer_latency = 300 * GST_MSECOND,
+  },
+};
+/* *INDENT-ON* */
+
+const KmsLatencyTargets *
+kms_latency_profile_get_targets (KmsLatencyProfile profile)
+{
+  if (profile > KMS_LATENCY_PROFILE_RECORDING) {
+    profile = KMS_LATENCY_PROFILE_DEFAULT;
+  }
+
+  return &targets[profile];
+}
+
+GstContext *
+kms_latency_profile_context_new (KmsLatencyProfile profile)
+{
+  GstContext *context;
+  GstStructure *s;
+
+  /* Persistent, so elements added later to the pipeline get it too */
+  context = gst_context_new (KMS_LATENCY_PROFILE_CONTEXT_TYPE, TRUE);
+  s = gst_context_writable_structure (context);
+  gst_structure_set (s, PROFILE_FIELD, G_TYPE_INT, profile, NULL);
+
+  return context;
+}
+
+gboolean
+kms_latency_profile_parse_context (GstContext * context,
+    KmsLatencyProfile * profile)
+{
+  const GstStructure *s;
+  gint value;
+
+  if (!gst_context_has_context_type (context,
+          KMS_LATENCY_PROFILE_CONTEXT_TYPE)) {
+    return FALSE;
+  }
+
+  s = gst_context_get_structure (context);
+  if (!gst_structure_get_int (s, PROFILE_FIELD, &value)) {
+    return FALSE;
+  }
+
+  *profile = value;
+
+  return TRUE;
+}
+
+const KmsLatencyTargets *
+kms_latency_profile_get_element_targets (GstElement * element)
+{
+  KmsLatencyProfile profile = KMS_LATENCY_PROFILE_DEFAULT;
+  GstContext *context;
+
+  context = gst_element_get_context (element,
+      KMS_LATENCY_PROFILE_CONTEXT_TYPE);
+
+  if (context != NULL) {
+    kms_latency_profile_parse_context (context, &profile);
+    gst_context_unref (context);
+  }
+
+  return kms_latency_profile_get_targets (profile);
+}
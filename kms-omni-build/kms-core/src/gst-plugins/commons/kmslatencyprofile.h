@@ -0,0 +1,70 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __KMS_LATENCY_PROFILE_H__
+#define __KMS_LATENCY_PROFILE_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/*
+ * Latency profiles are set on a whole pipeline as a GstContext, so they reach
+ * every element in it: bins forward contexts to their children, including the
+ * ones added later. Elements read the targets from their own context when they
+ * create the affected objects, and may override GstElement::set_context to
+ * update live ones when the profile changes.
+ */
+#define KMS_LATENCY_PROFILE_CONTEXT_TYPE "kms.latency-profile"
+
+typedef enum
+{
+  KMS_LATENCY_PROFILE_DEFAULT,
+  KMS_LATENCY_PROFILE_INTERACTIVE,
+  KMS_LATENCY_PROFILE_BROADCAST,
+  KMS_LATENCY_PROFILE_RECORDING
+} KmsLatencyProfile;
+
+typedef struct _KmsLatencyTargets
+{
+  /* Jitter buffer latency once media is flowing, in ms */
+  guint jitter_buffer_audio;
+  guint jitter_buffer_video;
+  /* Size of the leaky queues in front of converters and encoders */
+  GstClockTime queue_time;
+  /* Time allowed to the VP8 encoder per frame, in us (1 means realtime) */
+  gint64 encoder_deadline;
+  /* Latency reported by the video compositor and the audio mixer */
+  GstClockTime video_mixer_latency;
+  GstClockTime audio_mixer_latency;
+} KmsLatencyTargets;
+
+const KmsLatencyTargets *kms_latency_profile_get_targets (KmsLatencyProfile
+    profile);
+
+GstContext *kms_latency_profile_context_new (KmsLatencyProfile profile);
+
+/* FALSE if the context is not a latency profile */
+gboolean kms_latency_profile_parse_context (GstContext * context,
+    KmsLatencyProfile * profile);
+
+/* Targets of the profile set on the element, or of the default one */
+const KmsLatencyTargets *kms_latency_profile_get_element_targets (GstElement *
+    element);
+
+G_END_DECLS
+#endif /* __KMS_LATENCY_PROFILE_H__ */
@@ -26,6 +26,9 @@
 #include "kmsdectreebin.h"
 #include "kmsenctreebin.h"
 #include "kmsrtppaytreebin.h"
+#include "kmslatencyprofile.h"
+#include "kmsbitratetiers.h"
+#include "kmsgopcache.h"
 
 #include "kms-core-enumtypes.h"
 
@@ -34,6 +37,21 @@
 #define UNLINKING_DATA "unlinking-data"
 G_DEFINE_QUARK (UNLINKING_DATA, unlinking_data);
 
+#define TIER_DATA "tier-data"
+G_DEFINE_QUARK (TIER_DATA, tier_data);
+
+#define TIER_BIN "tier-bin"
+G_DEFINE_QUARK (TIER_BIN, tier_bin);
+
+#define TIER_IDLE_PROBE "tier-idle-probe"
+G_DEFINE_QUARK (TIER_IDLE_PROBE, tier_idle_probe);
+
+#define GOP_CACHE "gop-cache"
+G_DEFINE_QUARK (GOP_CACHE, gop_cache);
+
+#define GOP_CACHE_PRIME "gop-cache-prime"
+G_DEFINE_QUARK (GOP_CACHE_PRIME, gop_cache_prime);
+
 #define KMS_AGNOSTIC_PAD_STARTED (GST_PAD_FLAG_LAST << 1)
 
 static GstStaticCaps static_raw_audio_caps =
@@ -68,7 +86,22 @@ G_DEFINE_TYPE (KmsAgnosticBin2, kms_agnostic_bin2, GST_TYPE_BIN);
 #define TARGET_BITRATE_DEFAULT 300000
 #define MIN_BITRATE_DEFAULT 0
 #define MAX_BITRATE_DEFAULT G_MAXINT
-#define LEAKY_TIME 600000000    /*600 ms */
+#define MAX_TIERS_DEFAULT 1
+#define GOP_CACHE_SIZE_DEFAULT 0
+#define SMOOTH_KEYFRAMES_DEFAULT FALSE
+
+/* Moving an output to another tier costs a keyframe, do it rarely */
+#define TIERS_UPDATE_INTERVAL (5 * G_USEC_PER_SEC)
+/* Outputs that stop sending REMB go back to the first tier */
+#define TIER_ESTIMATE_TIMEOUT (10 * G_USEC_PER_SEC)
+
+/* Attached to src pads once their consumer reports a bandwidth estimate */
+typedef struct _KmsOutputTierData
+{
+  guint estimate;
+  gint64 updated;
+  guint tier;
+} KmsOutputTierData;
 
 enum
 {
@@ -103,6 +136,18 @@ struct _KmsAgnosticBin2Private
   gboolean bitrate_unlimited;
 
   gboolean transcoding_emitted;
+
+  /* Outputs of the same format are split in up to max_tiers encodings,
+   * tier 0 being served by the regular bin for that format */
+  guint max_tiers;
+  guint n_tiers;
+  guint tier_bitrates[KMS_BITRATE_TIERS_MAX];
+  gint64 tiers_updated;
+
+  /* Bytes of the GOP cache of each encoded video output, 0 disables it */
+  guint gop_cache_size;
+
+  gboolean smooth_keyframes;
 };
 
 enum
@@ -111,6 +156,11 @@ enum
   PROP_MIN_BITRATE,
   PROP_MAX_BITRATE,
   PROP_CODEC_CONFIG,
+  PROP_MAX_TIERS,
+  PROP_TIERS,
+  PROP_GOP_CACHE_SIZE,
+  PROP_SMOOTH_KEYFRAMES,
+  PROP_ENCODERS,
   N_PROPERTIES
 };
 
@@ -165,6 +215,19 @@ send_dummy_event (GstPad * pad)
   g_object_unref (parent);
 }
 
+static gboolean
+is_gop_cache_prime_pending (GstPad * pad)
+{
+  gboolean pending;
+
+  GST_OBJECT_LOCK (pad);
+  pending = GPOINTER_TO_INT (g_object_get_qdata (G_OBJECT (pad),
+          gop_cache_prime_quark ()));
+  GST_OBJECT_UNLOCK (pad);
+
+  return pending;
+}
+
 static GstPadProbeReturn
 tee_src_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
 {
@@ -172,8 +235,12 @@ tee_src_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
     GstEvent *event = gst_pad_probe_info_get_event (info);
 
     if (GST_EVENT_TYPE (event) == GST_EVENT_RECONFIGURE) {
-      // Request keyframe to upstream elements
-      kms_utils_drop_until_keyframe (pad, TRUE);
+      // Branches started from the GOP cache only need a keyframe if the
+      // cache cannot serve them, tee_src_prime_probe decides it
+      if (!is_gop_cache_prime_pending (pad)) {
+        // Request keyframe to upstream elements
+        kms_utils_drop_until_keyframe (pad, TRUE);
+      }
       return GST_PAD_PROBE_DROP;
     }
   }
@@ -181,6 +248,122 @@ tee_src_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
   return GST_PAD_PROBE_OK;
 }
 
+static gboolean
+gop_cache_push_buffer (GstBuffer ** buffer, guint idx, gpointer cache)
+{
+  kms_gop_cache_push (cache, *buffer);
+
+  return TRUE;
+}
+
+static GstPadProbeReturn
+gop_cache_fill_probe (GstPad * pad, GstPadProbeInfo * info, gpointer cache)
+{
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_BUFFER) {
+    kms_gop_cache_push (cache, gst_pad_probe_info_get_buffer (info));
+  } else if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_BUFFER_LIST) {
+    gst_buffer_list_foreach (gst_pad_probe_info_get_buffer_list (info),
+        gop_cache_push_buffer, cache);
+  } else if (GST_PAD_PROBE_INFO_TYPE (info) &
+      GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM) {
+    GstEvent *event = gst_pad_probe_info_get_event (info);
+
+    switch (GST_EVENT_TYPE (event)) {
+      case GST_EVENT_CAPS:
+      case GST_EVENT_STREAM_START:
+      case GST_EVENT_FLUSH_STOP:
+        kms_gop_cache_clear (cache);
+        break;
+      default:
+        break;
+    }
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+/*
+ * Runs on the first data that reaches a new branch. The tee has already
+ * added it to the cache, so the cached frames that come before it are fed to
+ * the branch first and it starts at the cached keyframe.
+ */
+static GstPadProbeReturn
+tee_src_prime_probe (GstPad * pad, GstPadProbeInfo * info, gpointer cache)
+{
+  GstBufferList *live = NULL, *cached;
+  GstBuffer *first;
+  GstPad *peer;
+  guint n_live = 1, n_cached = 0, i;
+  gboolean primed;
+
+  GST_OBJECT_LOCK (pad);
+  if (!g_object_get_qdata (G_OBJECT (pad), gop_cache_prime_quark ())) {
+    /* Already decided on the data that came before */
+    GST_OBJECT_UNLOCK (pad);
+    return GST_PAD_PROBE_REMOVE;
+  }
+  g_object_set_qdata (G_OBJECT (pad), gop_cache_prime_quark (), NULL);
+  GST_OBJECT_UNLOCK (pad);
+
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_BUFFER_LIST) {
+    live = gst_pad_probe_info_get_buffer_list (info);
+    n_live = gst_buffer_list_length (live);
+    first = n_live > 0 ? gst_buffer_list_get (live, 0) : NULL;
+  } else {
+    first = gst_pad_probe_info_get_buffer (info);
+  }
+
+  if (first == NULL
+      || !GST_BUFFER_FLAG_IS_SET (first, GST_BUFFER_FLAG_DELTA_UNIT)) {
+    /* Starts by itself */
+    return GST_PAD_PROBE_REMOVE;
+  }
+
+  cached = kms_gop_cache_get (cache);
+  if (cached != NULL) {
+    n_cached = gst_buffer_list_length (cached);
+  }
+
+  primed = n_cached > n_live;
+  for (i = 0; primed && i < n_live; i++) {
+    GstBuffer *buffer = live != NULL ? gst_buffer_list_get (live, i) : first;
+
+    primed = gst_buffer_list_get (cached, n_cached - n_live + i) == buffer;
+  }
+
+  if (!primed) {
+    if (cached != NULL) {
+      gst_buffer_list_unref (cached);
+    }
+
+    GST_DEBUG_OBJECT (pad, "GOP cache cannot start the branch");
+    kms_utils_drop_until_keyframe (pad, TRUE);
+
+    return GST_PAD_PROBE_DROP;
+  }
+
+  GST_DEBUG_OBJECT (pad, "Starting branch with %u cached buffers",
+      n_cached - n_live);
+
+  gst_buffer_list_remove (cached, n_cached - n_live, n_live);
+
+  peer = gst_pad_get_peer (pad);
+  if (peer != NULL) {
+    GstFlowReturn ret = gst_pad_chain_list (peer, cached);
+
+    if (ret != GST_FLOW_OK) {
+      GST_DEBUG_OBJECT (pad, "Cached buffers not accepted: %s",
+          gst_flow_get_name (ret));
+    }
+
+    g_object_unref (peer);
+  } else {
+    gst_buffer_list_unref (cached);
+  }
+
+  return GST_PAD_PROBE_REMOVE;
+}
+
 static void
 remove_on_unlinked_async (gpointer data, gpointer not_used)
 {
@@ -323,16 +506,25 @@ remove_tee_pad_on_unlink (GstPad * pad, GstPad * peer, gpointer user_data)
 }
 
 static void
-link_element_to_tee (GstElement * tee, GstElement * element)
+link_element_to_tee (GstElement * tee, GstElement * element, gboolean prime)
 {
   GstPad *tee_src = gst_element_request_pad_simple (tee, "src_%u");
   GstPad *element_sink = gst_element_get_static_pad (element, "sink");
+  KmsGopCache *cache = g_object_get_qdata (G_OBJECT (tee), gop_cache_quark ());
   GstPadLinkReturn ret;
 
   remove_element_on_unlinked (element, "src", "sink");
   g_signal_connect (tee_src, "unlinked", G_CALLBACK (remove_tee_pad_on_unlink),
       NULL);
 
+  if (prime && cache != NULL && kms_gop_cache_get_max_size (cache) > 0) {
+    g_object_set_qdata (G_OBJECT (tee_src), gop_cache_prime_quark (),
+        GINT_TO_POINTER (TRUE));
+    gst_pad_add_probe (tee_src,
+        GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST,
+        tee_src_prime_probe, cache, NULL);
+  }
+
   gst_pad_add_probe (tee_src, GST_PAD_PROBE_TYPE_EVENT_UPSTREAM, tee_src_probe,
       NULL, NULL);
 
@@ -347,6 +539,38 @@ link_element_to_tee (GstElement * tee, GstElement * element)
   g_object_unref (tee_src);
 }
 
+/* Encoded video outputs keep their last GOP to start the branches added later */
+static void
+kms_agnostic_bin2_add_gop_cache (KmsAgnosticBin2 * self, KmsTreeBin * bin,
+    const GstCaps * caps)
+{
+  GstElement *tee;
+  GstPad *sink;
+  KmsGopCache *cache;
+
+  if (caps == NULL || !kms_utils_caps_is_video (caps)
+      || kms_utils_caps_is_raw (caps) || kms_utils_caps_is_rtp (caps)) {
+    return;
+  }
+
+  tee = kms_tree_bin_get_output_tee (bin);
+  if (g_object_get_qdata (G_OBJECT (tee), gop_cache_quark ()) != NULL) {
+    return;
+  }
+
+  cache = kms_gop_cache_new (self->priv->gop_cache_size,
+      KMS_GOP_CACHE_DEFAULT_MAX_AGE);
+  g_object_set_qdata_full (G_OBJECT (tee), gop_cache_quark (), cache,
+      (GDestroyNotify) kms_gop_cache_free);
+
+  sink = gst_element_get_static_pad (tee, "sink");
+  gst_pad_add_probe (sink,
+      GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST |
+      GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM | GST_PAD_PROBE_TYPE_EVENT_FLUSH,
+      gop_cache_fill_probe, cache, NULL);
+  g_object_unref (sink);
+}
+
 static GstPadProbeReturn
 remove_target_pad_block (GstPad * pad, GstPadProbeInfo * info, gpointer gp)
 {
@@ -420,6 +644,10 @@ kms_agnostic_bin2_link_to_tee (KmsAgnosticBin2 * self, GstPad * pad,
   GstElement *queue = kms_utils_element_factory_make ("queue", "agnosticbin");
   GstPad *target;
   GstProxyPad *proxy;
+  gboolean prime;
+
+  /* Only outputs that never got media can start with older frames */
+  prime = !gst_pad_has_current_caps (pad);
 
   gst_bin_add (GST_BIN (self), queue);
   gst_element_sync_state_with_parent (queue);
@@ -430,7 +658,9 @@ kms_agnostic_bin2_link_to_tee (KmsAgnosticBin2 * self, GstPad * pad,
     GstElement *rate = kms_utils_create_rate_for_caps (caps);
     GstElement *mediator = kms_utils_create_mediator_element (caps);
 
-    g_object_set (queue, "leaky", 2, "max-size-time", LEAKY_TIME, NULL);
+    g_object_set (queue, "leaky", 2, "max-size-time",
+        kms_latency_profile_get_element_targets (GST_ELEMENT (self))->queue_time,
+        NULL);
 
     remove_element_on_unlinked (convert, "src", "sink");
     if (rate) {
@@ -470,7 +700,7 @@ kms_agnostic_bin2_link_to_tee (KmsAgnosticBin2 * self, GstPad * pad,
   g_object_unref (proxy);
 
   g_object_unref (target);
-  link_element_to_tee (tee, queue);
+  link_element_to_tee (tee, queue, prime);
 }
 
 static gboolean
@@ -532,6 +762,11 @@ kms_agnostic_bin2_find_bin_for_caps (KmsAgnosticBin2 * self, GstCaps * caps)
       continue;
     }
 
+    if (g_object_get_qdata (G_OBJECT (tree_bin), tier_bin_quark ())) {
+      // Skip: only outputs assigned to its tier use it
+      continue;
+    }
+
     if (check_bin (tree_bin, caps)) {
       bin = GST_BIN_CAST (tree_bin);
     }
@@ -653,12 +888,43 @@ kms_agnostic_bin2_create_rtp_pay_bin (KmsAgnosticBin2 * self, GstCaps * caps)
 }
 
 static GstBin *
-kms_agnostic_bin2_create_bin_for_caps (KmsAgnosticBin2 * self, GstCaps * caps)
+kms_agnostic_bin2_create_enc_bin (KmsAgnosticBin2 * self, GstBin * dec_bin,
+    GstCaps * caps, gint target_bitrate, guint tier)
 {
-  GstBin *dec_bin;
   KmsEncTreeBin *enc_bin;
   GstElement *input_element, *output_tee;
 
+  enc_bin =
+      kms_enc_tree_bin_new (caps, target_bitrate,
+      self->priv->min_bitrate, self->priv->max_bitrate,
+      self->priv->smooth_keyframes, self->priv->codec_config);
+  if (enc_bin == NULL) {
+    return NULL;
+  }
+
+  if (tier > 0) {
+    g_object_set_qdata (G_OBJECT (enc_bin), tier_bin_quark (),
+        GUINT_TO_POINTER (tier));
+  }
+
+  gst_bin_add (GST_BIN (self), GST_ELEMENT (enc_bin));
+  gst_element_sync_state_with_parent (GST_ELEMENT (enc_bin));
+
+  output_tee = kms_tree_bin_get_output_tee (KMS_TREE_BIN (dec_bin));
+  input_element = kms_tree_bin_get_input_element (KMS_TREE_BIN (enc_bin));
+  gst_element_link (output_tee, input_element);
+
+  kms_agnostic_bin2_add_gop_cache (self, KMS_TREE_BIN (enc_bin), caps);
+  kms_agnostic_bin2_insert_bin (self, GST_BIN (enc_bin));
+
+  return GST_BIN (enc_bin);
+}
+
+static GstBin *
+kms_agnostic_bin2_create_bin_for_caps (KmsAgnosticBin2 * self, GstCaps * caps)
+{
+  GstBin *dec_bin;
+
   if (kms_utils_caps_is_rtp (caps)) {
     return kms_agnostic_bin2_create_rtp_pay_bin (self, caps);
   }
@@ -672,24 +938,88 @@ kms_agnostic_bin2_create_bin_for_caps (KmsAgnosticBin2 * self, GstCaps * caps)
     return dec_bin;
   }
 
-  enc_bin =
-      kms_enc_tree_bin_new (caps, TARGET_BITRATE_DEFAULT,
-      self->priv->min_bitrate, self->priv->max_bitrate,
-      self->priv->codec_config);
-  if (enc_bin == NULL) {
-    return NULL;
+  return kms_agnostic_bin2_create_enc_bin (self, dec_bin, caps,
+      TARGET_BITRATE_DEFAULT, 0);
+}
+
+static GstPadProbeReturn
+tier_bin_idle_probe (GstPad * pad, GstPadProbeInfo * info, gpointer data)
+{
+  return GST_PAD_PROBE_DROP;
+}
+
+/*
+ * A tier encoder without outputs drops its input instead of encoding it. It
+ * is kept, as agnosticbin does with other encoders, because the tier is
+ * likely to be used again when estimates change. It should be always called
+ * with the agnostic lock held.
+ */
+static void
+kms_agnostic_bin2_set_tier_bin_active (KmsAgnosticBin2 * self, GstBin * bin,
+    gboolean active)
+{
+  GstElement *input;
+  GstPad *sink;
+  gulong id;
+
+  id = GPOINTER_TO_SIZE (g_object_get_qdata (G_OBJECT (bin),
+          tier_idle_probe_quark ()));
+
+  if (active == (id == 0)) {
+    return;
   }
 
-  gst_bin_add (GST_BIN (self), GST_ELEMENT (enc_bin));
-  gst_element_sync_state_with_parent (GST_ELEMENT (enc_bin));
+  input = kms_tree_bin_get_input_element (KMS_TREE_BIN (bin));
+  sink = gst_element_get_static_pad (input, "sink");
 
-  output_tee = kms_tree_bin_get_output_tee (KMS_TREE_BIN (dec_bin));
-  input_element = kms_tree_bin_get_input_element (KMS_TREE_BIN (enc_bin));
-  gst_element_link (output_tee, input_element);
+  if (active) {
+    GST_DEBUG_OBJECT (self, "Resuming %" GST_PTR_FORMAT, bin);
+    gst_pad_remove_probe (sink, id);
+    id = 0;
+  } else {
+    GST_DEBUG_OBJECT (self, "No outputs left in %" GST_PTR_FORMAT, bin);
+    id = gst_pad_add_probe (sink,
+        GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST,
+        tier_bin_idle_probe, NULL, NULL);
+  }
 
-  kms_agnostic_bin2_insert_bin (self, GST_BIN (enc_bin));
+  g_object_set_qdata (G_OBJECT (bin), tier_idle_probe_quark (),
+      GSIZE_TO_POINTER (id));
+  g_object_unref (sink);
+}
 
-  return GST_BIN (enc_bin);
+static GstBin *
+kms_agnostic_bin2_find_or_create_tier_bin (KmsAgnosticBin2 * self,
+    GstCaps * caps, guint tier)
+{
+  GList *bins, *l;
+  GstBin *bin = NULL, *dec_bin;
+
+  bins = g_hash_table_get_values (self->priv->bins);
+  for (l = bins; l != NULL && bin == NULL; l = l->next) {
+    if (GPOINTER_TO_UINT (g_object_get_qdata (l->data,
+                tier_bin_quark ())) == tier
+        && check_bin (KMS_TREE_BIN (l->data), caps)) {
+      bin = GST_BIN_CAST (l->data);
+    }
+  }
+  g_list_free (bins);
+
+  if (bin != NULL) {
+    kms_agnostic_bin2_set_tier_bin_active (self, bin, TRUE);
+    return bin;
+  }
+
+  dec_bin = kms_agnostic_bin2_get_or_create_dec_bin (self, caps);
+  if (dec_bin == NULL) {
+    return NULL;
+  }
+
+  GST_DEBUG_OBJECT (self, "Creating encoder for tier %u at %u bps", tier,
+      self->priv->tier_bitrates[tier]);
+
+  return kms_agnostic_bin2_create_enc_bin (self, dec_bin, caps,
+      self->priv->tier_bitrates[tier], tier);
 }
 
 static GstBin *
@@ -751,6 +1081,28 @@ kms_agnostic_bin2_find_or_create_bin_for_caps (KmsAgnosticBin2 * self,
   return bin;
 }
 
+static gboolean
+kms_agnostic_bin2_caps_support_tiers (const GstCaps * caps)
+{
+  /* Raw and RTP outputs are not encoded here, they can only be forwarded */
+  return !(gst_caps_is_any (caps) || gst_caps_is_empty (caps))
+      && !kms_utils_caps_is_raw (caps) && !kms_utils_caps_is_rtp (caps);
+}
+
+static guint
+kms_agnostic_bin2_get_pad_tier (KmsAgnosticBin2 * self, GstPad * pad)
+{
+  KmsOutputTierData *data;
+
+  data = g_object_get_qdata (G_OBJECT (pad), tier_data_quark ());
+
+  if (data == NULL || data->tier >= self->priv->n_tiers) {
+    return 0;
+  }
+
+  return data->tier;
+}
+
 /**
  * Link a pad internally
  *
@@ -763,6 +1115,7 @@ kms_agnostic_bin2_link_pad (KmsAgnosticBin2 * self, GstPad * pad, GstPad * peer)
 {
   GstCaps *pad_caps, *peer_caps;
   GstBin *bin;
+  guint tier;
 
   GST_TRACE_OBJECT (self, "Linking: %" GST_PTR_FORMAT
       " to %" GST_PTR_FORMAT, pad, peer);
@@ -780,7 +1133,13 @@ kms_agnostic_bin2_link_pad (KmsAgnosticBin2 * self, GstPad * pad, GstPad * peer)
 
   GST_DEBUG_OBJECT (self, "Downstream wanted caps: %" GST_PTR_FORMAT, peer_caps);
 
-  bin = kms_agnostic_bin2_find_or_create_bin_for_caps (self, peer_caps);
+  tier = kms_agnostic_bin2_get_pad_tier (self, pad);
+
+  if (tier > 0 && kms_agnostic_bin2_caps_support_tiers (peer_caps)) {
+    bin = kms_agnostic_bin2_find_or_create_tier_bin (self, peer_caps, tier);
+  } else {
+    bin = kms_agnostic_bin2_find_or_create_bin_for_caps (self, peer_caps);
+  }
 
   if (bin != NULL) {
     GstElement *tee = kms_tree_bin_get_output_tee (KMS_TREE_BIN (bin));
@@ -857,6 +1216,248 @@ kms_agnostic_bin2_process_pad (KmsAgnosticBin2 * self, GstPad * pad)
   return TRUE;
 }
 
+typedef struct _KmsTierCandidates
+{
+  gint64 now;
+  GPtrArray *pads;
+  GArray *estimates;
+  GPtrArray *stale_pads;
+} KmsTierCandidates;
+
+static void
+collect_tier_candidate (GstPad * pad, KmsTierCandidates * candidates)
+{
+  KmsOutputTierData *data;
+  GstCaps *caps;
+  gboolean supported;
+
+  data = g_object_get_qdata (G_OBJECT (pad), tier_data_quark ());
+
+  if (data == NULL || !gst_pad_is_linked (pad)
+      || !GST_OBJECT_FLAG_IS_SET (pad, KMS_AGNOSTIC_PAD_STARTED)) {
+    return;
+  }
+
+  caps = gst_pad_get_current_caps (pad);
+  if (caps == NULL) {
+    return;
+  }
+
+  supported = kms_agnostic_bin2_caps_support_tiers (caps);
+  gst_caps_unref (caps);
+
+  if (!supported) {
+    return;
+  }
+
+  if (candidates->now - data->updated > TIER_ESTIMATE_TIMEOUT) {
+    g_ptr_array_add (candidates->stale_pads, pad);
+  } else {
+    g_ptr_array_add (candidates->pads, pad);
+    g_array_append_val (candidates->estimates, data->estimate);
+  }
+}
+
+static void
+kms_agnostic_bin2_set_pad_tier (KmsAgnosticBin2 * self, GstPad * pad,
+    guint tier)
+{
+  KmsOutputTierData *data;
+  GstPad *peer;
+
+  data = g_object_get_qdata (G_OBJECT (pad), tier_data_quark ());
+
+  if (data->tier == tier) {
+    return;
+  }
+
+  GST_DEBUG_OBJECT (self, "Moving %" GST_PTR_FORMAT " from tier %u to %u",
+      pad, data->tier, tier);
+
+  data->tier = tier;
+
+  peer = gst_pad_get_peer (pad);
+  if (peer != NULL) {
+    remove_target_pad (pad);
+    kms_agnostic_bin2_link_pad (self, pad, peer);
+  }
+}
+
+typedef struct _KmsUsedTiers
+{
+  KmsAgnosticBin2 *self;
+  gboolean used[KMS_BITRATE_TIERS_MAX];
+} KmsUsedTiers;
+
+static void
+mark_pad_tier_used (GstPad * pad, KmsUsedTiers * tiers)
+{
+  if (gst_pad_is_linked (pad)) {
+    tiers->used[kms_agnostic_bin2_get_pad_tier (tiers->self, pad)] = TRUE;
+  }
+}
+
+/*
+ * Idle the tier encoders that no output is linked to. It should be always
+ * called with the agnostic lock held.
+ */
+static void
+kms_agnostic_bin2_idle_unused_tiers (KmsAgnosticBin2 * self)
+{
+  KmsUsedTiers tiers = { NULL };
+  GList *bins, *l;
+
+  tiers.self = self;
+  kms_element_for_each_src_pad (GST_ELEMENT (self),
+      (KmsPadIterationAction) mark_pad_tier_used, &tiers);
+
+  bins = g_hash_table_get_values (self->priv->bins);
+  for (l = bins; l != NULL; l = l->next) {
+    guint tier = GPOINTER_TO_UINT (g_object_get_qdata (l->data,
+            tier_bin_quark ()));
+
+    if (tier > 0) {
+      kms_agnostic_bin2_set_tier_bin_active (self, l->data,
+          tier < self->priv->n_tiers && tiers.used[tier]);
+    }
+  }
+  g_list_free (bins);
+}
+
+/*
+ * Regroup the outputs by their last estimates. It should be always called
+ * with the agnostic lock held.
+ */
+static void
+kms_agnostic_bin2_update_tiers (KmsAgnosticBin2 * self, gint64 now)
+{
+  KmsTierCandidates candidates;
+  guint *membership;
+  guint i;
+
+  self->priv->tiers_updated = now;
+
+  candidates.now = now;
+  candidates.pads = g_ptr_array_new ();
+  candidates.estimates = g_array_new (FALSE, FALSE, sizeof (guint));
+  candidates.stale_pads = g_ptr_array_new ();
+
+  kms_element_for_each_src_pad (GST_ELEMENT (self),
+      (KmsPadIterationAction) collect_tier_candidate, &candidates);
+
+  membership = g_new0 (guint, candidates.pads->len);
+  self->priv->n_tiers =
+      kms_bitrate_tiers_compute ((const guint *) candidates.estimates->data,
+      candidates.estimates->len, self->priv->max_tiers,
+      KMS_BITRATE_TIERS_DEFAULT_SPACING, self->priv->tier_bitrates,
+      membership);
+
+  GST_DEBUG_OBJECT (self, "%u outputs grouped in %u tiers",
+      candidates.pads->len, self->priv->n_tiers);
+
+  for (i = 0; i < candidates.pads->len; i++) {
+    kms_agnostic_bin2_set_pad_tier (self,
+        g_ptr_array_index (candidates.pads, i), membership[i]);
+  }
+
+  for (i = 0; i < candidates.stale_pads->len; i++) {
+    kms_agnostic_bin2_set_pad_tier (self,
+        g_ptr_array_index (candidates.stale_pads, i), 0);
+  }
+
+  kms_agnostic_bin2_idle_unused_tiers (self);
+
+  g_free (membership);
+  g_ptr_array_unref (candidates.pads);
+  g_array_unref (candidates.estimates);
+  g_ptr_array_unref (candidates.stale_pads);
+}
+
+static void
+kms_agnostic_bin2_update_estimate (KmsAgnosticBin2 * self, GstPad * pad,
+    guint bitrate)
+{
+  KmsOutputTierData *data;
+  gint64 now = g_get_monotonic_time ();
+
+  KMS_AGNOSTIC_BIN2_LOCK (self);
+
+  data = g_object_get_qdata (G_OBJECT (pad), tier_data_quark ());
+  if (data == NULL) {
+    data = g_new0 (KmsOutputTierData, 1);
+    g_object_set_qdata_full (G_OBJECT (pad), tier_data_quark (), data,
+        g_free);
+  }
+
+  data->estimate = bitrate;
+  data->updated = now;
+
+  if (self->priv->max_tiers > 1 && self->priv->started
+      && now - self->priv->tiers_updated >= TIERS_UPDATE_INTERVAL) {
+    kms_agnostic_bin2_update_tiers (self, now);
+  }
+
+  KMS_AGNOSTIC_BIN2_UNLOCK (self);
+}
+
+typedef struct _KmsTiersStats
+{
+  KmsAgnosticBin2 *self;
+  GValue outputs[KMS_BITRATE_TIERS_MAX];
+} KmsTiersStats;
+
+static void
+add_pad_to_tiers_stats (GstPad * pad, KmsTiersStats * stats)
+{
+  GValue name = G_VALUE_INIT;
+
+  if (!gst_pad_is_linked (pad)) {
+    return;
+  }
+
+  g_value_init (&name, G_TYPE_STRING);
+  g_value_set_string (&name, GST_OBJECT_NAME (pad));
+  gst_value_array_append_value (&stats->outputs[kms_agnostic_bin2_get_pad_tier
+          (stats->self, pad)], &name);
+  g_value_unset (&name);
+}
+
+static GstStructure *
+kms_agnostic_bin2_get_tiers_stats (KmsAgnosticBin2 * self)
+{
+  KmsTiersStats stats = { NULL };
+  GstStructure *tiers;
+  guint t, n_tiers;
+
+  stats.self = self;
+
+  tiers = gst_structure_new_empty ("bitrate-tiers");
+  n_tiers = MAX (self->priv->n_tiers, 1);
+
+  for (t = 0; t < n_tiers; t++) {
+    g_value_init (&stats.outputs[t], GST_TYPE_ARRAY);
+  }
+
+  kms_element_for_each_src_pad (GST_ELEMENT (self),
+      (KmsPadIterationAction) add_pad_to_tiers_stats, &stats);
+
+  for (t = 0; t < n_tiers; t++) {
+    GstStructure *tier;
+    gchar *name;
+
+    tier = gst_structure_new ("tier", "bitrate", G_TYPE_UINT,
+        (self->priv->n_tiers > 0) ? self->priv->tier_bitrates[t] : 0, NULL);
+    gst_structure_take_value (tier, "outputs", &stats.outputs[t]);
+
+    name = g_strdup_printf ("tier_%u", t);
+    gst_structure_set (tiers, name, GST_TYPE_STRUCTURE, tier, NULL);
+    gst_structure_free (tier);
+    g_free (name);
+  }
+
+  return tiers;
+}
+
 static void
 add_linked_pads (GstPad * pad, KmsAgnosticBin2 * self)
 {
@@ -896,6 +1497,7 @@ input_bin_src_caps_probe (GstPad * pad, GstPadProbeInfo * info, gpointer bin)
   gst_event_parse_caps (event, &current_caps);
   GST_DEBUG_OBJECT (self, "Set input caps: %" GST_PTR_FORMAT, current_caps);
   self->priv->input_bin_src_caps = gst_caps_copy (current_caps);
+  kms_agnostic_bin2_add_gop_cache (self, KMS_TREE_BIN (bin), current_caps);
   kms_agnostic_bin2_insert_bin (self, GST_BIN (bin));
 
   kms_element_for_each_src_pad (GST_ELEMENT (self),
@@ -996,14 +1598,16 @@ kms_agnostic_bin2_sink_caps_probe (GstPad * pad, GstPadProbeInfo * info,
     gst_structure_remove_fields (st, "width", "height", "framerate",
         "streamheader", "codec_data", NULL);
 
+    // Raw format changes are handled by the converters, but switching
+    // between raw and encoded input (e.g. a hub port that starts receiving
+    // an encoding shared with other ports) needs a new input bin
     if (!gst_caps_can_intersect (new_caps, current_caps)
-        && !kms_utils_caps_is_raw (current_caps)
-        && !kms_utils_caps_is_raw (new_caps)) {
+        && !(kms_utils_caps_is_raw (current_caps)
+            && kms_utils_caps_is_raw (new_caps))) {
       GST_LOG_OBJECT (self, "Set new input caps: %" GST_PTR_FORMAT, new_caps);
       kms_agnostic_bin2_configure_input (self, new_caps);
     }
     else {
-      // REVIEW: Why no need when old or new caps are RAW?
       GST_LOG_OBJECT (self, "No need to set new input caps");
     }
 
@@ -1046,6 +1650,13 @@ kms_agnostic_bin2_src_reconfigure_probe (GstPad * pad, GstPadProbeInfo * info,
       GST_OBJECT_FLAG_SET (pad, KMS_AGNOSTIC_PAD_STARTED);
       kms_agnostic_bin2_process_pad (self, pad);
       KMS_AGNOSTIC_BIN2_UNLOCK (self);
+    } else {
+      guint bitrate, ssrc;
+
+      /* Keep the estimate of each consumer, the event goes on upstream */
+      if (kms_utils_remb_event_upstream_parse (event, &bitrate, &ssrc)) {
+        kms_agnostic_bin2_update_estimate (user_data, pad, bitrate);
+      }
     }
   }
 
@@ -1061,7 +1672,9 @@ kms_agnostic_bin2_src_unlinked (GstPad * pad, GstPad * peer,
   GST_TRACE_OBJECT (pad, "Unlinked");
   KMS_AGNOSTIC_BIN2_LOCK (self);
   GST_OBJECT_FLAG_UNSET (pad, KMS_AGNOSTIC_PAD_STARTED);
+  g_object_set_qdata (G_OBJECT (pad), tier_data_quark (), NULL);
   remove_target_pad (pad);
+  kms_agnostic_bin2_idle_unused_tiers (self);
   KMS_AGNOSTIC_BIN2_UNLOCK (self);
 }
 
@@ -1165,6 +1778,69 @@ kms_agnostic_bin_set_encoders_bitrate (KmsAgnosticBin2 * self)
   }
 }
 
+static void
+kms_agnostic_bin2_set_smooth_keyframes (KmsAgnosticBin2 * self)
+{
+  GList *bins, *l;
+
+  bins = g_hash_table_get_values (self->priv->bins);
+  for (l = bins; l != NULL; l = l->next) {
+    if (KMS_IS_ENC_TREE_BIN (l->data)) {
+      kms_enc_tree_bin_set_smooth_keyframes (KMS_ENC_TREE_BIN (l->data),
+          self->priv->smooth_keyframes);
+    }
+  }
+  g_list_free (bins);
+}
+
+static GstStructure *
+kms_agnostic_bin2_get_encoders_stats (KmsAgnosticBin2 * self)
+{
+  GstStructure *encoders;
+  GList *bins, *l;
+
+  encoders = gst_structure_new_empty ("encoders");
+
+  bins = g_hash_table_get_values (self->priv->bins);
+  for (l = bins; l != NULL; l = l->next) {
+    GstStructure *stats;
+
+    if (!KMS_IS_ENC_TREE_BIN (l->data)) {
+      continue;
+    }
+
+    stats = kms_enc_tree_bin_get_stats (KMS_ENC_TREE_BIN (l->data));
+    gst_structure_set (stats, "tier", G_TYPE_UINT,
+        GPOINTER_TO_UINT (g_object_get_qdata (l->data, tier_bin_quark ())),
+        "idle", G_TYPE_BOOLEAN,
+        g_object_get_qdata (l->data, tier_idle_probe_quark ()) != NULL, NULL);
+    gst_structure_set (encoders, GST_OBJECT_NAME (l->data),
+        GST_TYPE_STRUCTURE, stats, NULL);
+    gst_structure_free (stats);
+  }
+  g_list_free (bins);
+
+  return encoders;
+}
+
+static void
+kms_agnostic_bin2_set_gop_cache_size (KmsAgnosticBin2 * self)
+{
+  GList *bins, *l;
+
+  bins = g_hash_table_get_values (self->priv->bins);
+  for (l = bins; l != NULL; l = l->next) {
+    GstElement *tee = kms_tree_bin_get_output_tee (KMS_TREE_BIN (l->data));
+    KmsGopCache *cache =
+        g_object_get_qdata (G_OBJECT (tee), gop_cache_quark ());
+
+    if (cache != NULL) {
+      kms_gop_cache_set_max_size (cache, self->priv->gop_cache_size);
+    }
+  }
+  g_list_free (bins);
+}
+
 void
 kms_agnostic_bin2_set_property (GObject * object, guint property_id,
     const GValue * value, GParamSpec * pspec)
@@ -1221,6 +1897,26 @@ kms_agnostic_bin2_set_property (GObject * object, guint property_id,
       self->priv->codec_config = g_value_dup_boxed (value);
       KMS_AGNOSTIC_BIN2_UNLOCK (self);
       break;
+    case PROP_MAX_TIERS:
+      KMS_AGNOSTIC_BIN2_LOCK (self);
+      self->priv->max_tiers = g_value_get_uint (value);
+      if (self->priv->started) {
+        kms_agnostic_bin2_update_tiers (self, g_get_monotonic_time ());
+      }
+      KMS_AGNOSTIC_BIN2_UNLOCK (self);
+      break;
+    case PROP_GOP_CACHE_SIZE:
+      KMS_AGNOSTIC_BIN2_LOCK (self);
+      self->priv->gop_cache_size = g_value_get_uint (value);
+      kms_agnostic_bin2_set_gop_cache_size (self);
+      KMS_AGNOSTIC_BIN2_UNLOCK (self);
+      break;
+    case PROP_SMOOTH_KEYFRAMES:
+      KMS_AGNOSTIC_BIN2_LOCK (self);
+      self->priv->smooth_keyframes = g_value_get_boolean (value);
+      kms_agnostic_bin2_set_smooth_keyframes (self);
+      KMS_AGNOSTIC_BIN2_UNLOCK (self);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -1253,12 +1949,72 @@ kms_agnostic_bin2_get_property (GObject * object, guint property_id,
       g_value_set_boxed (value, self->priv->codec_config);
       KMS_AGNOSTIC_BIN2_UNLOCK (self);
       break;
+    case PROP_MAX_TIERS:
+      KMS_AGNOSTIC_BIN2_LOCK (self);
+      g_value_set_uint (value, self->priv->max_tiers);
+      KMS_AGNOSTIC_BIN2_UNLOCK (self);
+      break;
+    case PROP_TIERS:
+      KMS_AGNOSTIC_BIN2_LOCK (self);
+      g_value_take_boxed (value, kms_agnostic_bin2_get_tiers_stats (self));
+      KMS_AGNOSTIC_BIN2_UNLOCK (self);
+      break;
+    case PROP_GOP_CACHE_SIZE:
+      KMS_AGNOSTIC_BIN2_LOCK (self);
+      g_value_set_uint (value, self->priv->gop_cache_size);
+      KMS_AGNOSTIC_BIN2_UNLOCK (self);
+      break;
+    case PROP_SMOOTH_KEYFRAMES:
+      KMS_AGNOSTIC_BIN2_LOCK (self);
+      g_value_set_boolean (value, self->priv->smooth_keyframes);
+      KMS_AGNOSTIC_BIN2_UNLOCK (self);
+      break;
+    case PROP_ENCODERS:
+      KMS_AGNOSTIC_BIN2_LOCK (self);
+      g_value_take_boxed (value, kms_agnostic_bin2_get_encoders_stats (self));
+      KMS_AGNOSTIC_BIN2_UNLOCK (self);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
   }
 }
 
+static void
+kms_agnostic_bin2_update_queue_time (const GValue * item, gpointer user_data)
+{
+  GstElement *element = g_value_get_object (item);
+  const KmsLatencyTargets *targets = user_data;
+  gint leaky;
+
+  if (g_strcmp0 (G_OBJECT_TYPE_NAME (element), "GstQueue") != 0) {
+    return;
+  }
+
+  /* Only the leaky queues placed in front of raw outputs */
+  g_object_get (element, "leaky", &leaky, NULL);
+  if (leaky == 2) {
+    g_object_set (element, "max-size-time", targets->queue_time, NULL);
+  }
+}
+
+static void
+kms_agnostic_bin2_set_context (GstElement * element, GstContext * context)
+{
+  KmsLatencyProfile profile;
+
+  if (kms_latency_profile_parse_context (context, &profile)) {
+    GstIterator *it = gst_bin_iterate_elements (GST_BIN (element));
+
+    gst_iterator_foreach (it, kms_agnostic_bin2_update_queue_time,
+        (gpointer) kms_latency_profile_get_targets (profile));
+    gst_iterator_free (it);
+  }
+
+  GST_ELEMENT_CLASS (kms_agnostic_bin2_parent_class)->set_context (element,
+      context);
+}
+
 static void
 kms_agnostic_bin2_class_init (KmsAgnosticBin2Class * klass)
 {
@@ -1290,6 +2046,8 @@ kms_agnostic_bin2_class_init (KmsAgnosticBin2Class * klass)
       GST_DEBUG_FUNCPTR (kms_agnostic_bin2_request_new_pad);
   gstelement_class->release_pad =
       GST_DEBUG_FUNCPTR (kms_agnostic_bin2_release_pad);
+  gstelement_class->set_context =
+      GST_DEBUG_FUNCPTR (kms_agnostic_bin2_set_context);
 
   g_object_class_install_property (gobject_class, PROP_MIN_BITRATE,
       g_param_spec_int ("min-bitrate", "min bitrate",
@@ -1305,6 +2063,35 @@ kms_agnostic_bin2_class_init (KmsAgnosticBin2Class * klass)
       g_param_spec_boxed ("codec-config", "codec config",
           "Codec configuration", GST_TYPE_STRUCTURE, G_PARAM_READWRITE));
 
+  g_object_class_install_property (gobject_class, PROP_MAX_TIERS,
+      g_param_spec_uint ("max-tiers", "max tiers",
+          "Maximum number of encodings of the same format, each one sent "
+          "to the outputs with a similar bandwidth estimate",
+          1, KMS_BITRATE_TIERS_MAX, MAX_TIERS_DEFAULT, G_PARAM_READWRITE));
+
+  g_object_class_install_property (gobject_class, PROP_TIERS,
+      g_param_spec_boxed ("tiers", "tiers",
+          "Bitrate of each tier and the outputs that it serves",
+          GST_TYPE_STRUCTURE, G_PARAM_READABLE));
+
+  g_object_class_install_property (gobject_class, PROP_GOP_CACHE_SIZE,
+      g_param_spec_uint ("gop-cache-size", "GOP cache size",
+          "Bytes kept from the last keyframe onwards of each encoded video "
+          "output, used to start new consumers without requesting a "
+          "keyframe upstream (0 = disabled)",
+          0, G_MAXUINT, GOP_CACHE_SIZE_DEFAULT, G_PARAM_READWRITE));
+
+  g_object_class_install_property (gobject_class, PROP_SMOOTH_KEYFRAMES,
+      g_param_spec_boolean ("smooth-keyframes", "smooth keyframes",
+          "Answer keyframe requests from receivers that already decode the "
+          "stream without sending a full keyframe to each one",
+          SMOOTH_KEYFRAMES_DEFAULT, G_PARAM_READWRITE));
+
+  g_object_class_install_property (gobject_class, PROP_ENCODERS,
+      g_param_spec_boxed ("encoders", "encoders",
+          "Keyframe requests and frame size stats of each encoder",
+          GST_TYPE_STRUCTURE, G_PARAM_READABLE));
+
   /* Signal "KmsAgnosticBin::media-transcoding"
    * Arguments:
    * - Is transcoding?
@@ -1478,6 +2265,10 @@ kms_agnostic_bin2_init (KmsAgnosticBin2 * self)
   self->priv->max_bitrate = MAX_BITRATE_DEFAULT;
   self->priv->bitrate_unlimited = FALSE;
   self->priv->transcoding_emitted = FALSE;
+  self->priv->max_tiers = MAX_TIERS_DEFAULT;
+  self->priv->n_tiers = 0;
+  self->priv->gop_cache_size = GOP_CACHE_SIZE_DEFAULT;
+  self->priv->smooth_keyframes = SMOOTH_KEYFRAMES_DEFAULT;
 }
 
 gboolean
@@ -25,10 +25,10 @@
 #include "kmsloop.h"
 #include "kmsrefstruct.h"
 #include "kmsagnosticbin.h"
+#include "kmslatencyprofile.h"
 
 #define PLUGIN_NAME "kmsaudiomixer"
 
-#define LATENCY 150             //ms
 
 #define KMS_AUDIO_MIXER_LOCK(mixer) \
   (g_rec_mutex_lock (&(mixer)->priv->mutex))
@@ -107,15 +107,26 @@ static GstPadProbeReturn
 cb_latency (GstPad * pad, GstPadProbeInfo * info, gpointer data)
 {
   GstQuery *query = gst_pad_probe_info_get_query (info);
+  GstElement *adder;
+  GstClockTime latency;
 
   if (GST_QUERY_TYPE (query) != GST_QUERY_LATENCY) {
     return GST_PAD_PROBE_OK;
   }
 
+  adder = gst_pad_get_parent_element (pad);
+  if (adder == NULL) {
+    return GST_PAD_PROBE_OK;
+  }
+
+  /* The adder is in our bin, so it has the pipeline latency profile */
+  latency = kms_latency_profile_get_element_targets (adder)->audio_mixer_latency;
+  g_object_unref (adder);
+
   GST_LOG_OBJECT (pad, "Modifing latency query. New latency %" G_GUINT64_FORMAT,
-      (guint64) (LATENCY * GST_MSECOND));
+      latency);
 
-  gst_query_set_latency (query, TRUE, 0, LATENCY * GST_MSECOND);
+  gst_query_set_latency (query, TRUE, 0, latency);
 
   return GST_PAD_PROBE_HANDLED;
 }
@@ -836,8 +847,9 @@ kms_audio_mixer_add_src_pad (KmsAudioMixer * self, const char *padname)
 
   g_object_set (tee, "allow-not-linked", TRUE, NULL);
   g_object_set (fakesink, "sync", FALSE, "async", FALSE, NULL);
-  g_object_set (adder, "latency", LATENCY * GST_MSECOND, "start-time-selection",
-    1, NULL);
+  g_object_set (adder, "latency",
+      kms_latency_profile_get_element_targets (GST_ELEMENT
+          (self))->audio_mixer_latency, "start-time-selection", 1, NULL);
 
   g_object_set_qdata_full (G_OBJECT (adder), key_sink_pad_name_quark (),
       g_strdup (padname), g_free);
@@ -1028,6 +1040,34 @@ kms_audio_mixer_release_pad (GstElement * element, GstPad * pad)
   gst_element_remove_pad (element, pad);
 }
 
+static void
+kms_audio_mixer_update_latency (const GValue * item, gpointer user_data)
+{
+  GstElement *element = g_value_get_object (item);
+  const KmsLatencyTargets *targets = user_data;
+
+  if (g_strcmp0 (G_OBJECT_TYPE_NAME (element), "GstAudioMixer") == 0) {
+    g_object_set (element, "latency", targets->audio_mixer_latency, NULL);
+  }
+}
+
+static void
+kms_audio_mixer_set_context (GstElement * element, GstContext * context)
+{
+  KmsLatencyProfile profile;
+
+  if (kms_latency_profile_parse_context (context, &profile)) {
+    GstIterator *it = gst_bin_iterate_elements (GST_BIN (element));
+
+    gst_iterator_foreach (it, kms_audio_mixer_update_latency,
+        (gpointer) kms_latency_profile_get_targets (profile));
+    gst_iterator_free (it);
+  }
+
+  GST_ELEMENT_CLASS (kms_audio_mixer_parent_class)->set_context (element,
+      context);
+}
+
 static void
 kms_audio_mixer_class_init (KmsAudioMixerClass * klass)
 {
@@ -1043,6 +1083,8 @@ kms_audio_mixer_class_init (KmsAudioMixerClass * klass)
       GST_DEBUG_FUNCPTR (kms_audio_mixer_request_new_pad);
   gstelement_class->release_pad =
       GST_DEBUG_FUNCPTR (kms_audio_mixer_release_pad);
+  gstelement_class->set_context =
+      GST_DEBUG_FUNCPTR (kms_audio_mixer_set_context);
   gst_element_class_add_pad_template (gstelement_class,
       gst_static_pad_template_get (&audio_sink_factory));
   gst_element_class_add_pad_template (gstelement_class,
@@ -54,18 +54,40 @@ struct _KmsBufferInjectorPrivate
   GstPad *sinkpad;
   GstPad *srcpad;
   gboolean configured;
-  gboolean still_waiting;
   MediaType type;
   GstBuffer *previous_buffer;
-  GMutex mutex_generate;
-  GCond cond_generate;
+  /* Last gap pushed, retimed in place once downstream releases it */
+  GstBuffer *gap_buffer;
   /* milliseconds */
   gint64 wait_time;
   /* nanoseconds */
   gint64 acumulated_time;
   gint64 factor_wait_time;
+
+  /* Protected by the scheduler mutex */
+  gboolean running;
+  gboolean injecting;
+  /* monotonic time, microseconds */
+  gint64 deadline;
+  gint heap_index;
 };
 
+/*
+ * All injectors share one thread that sleeps until the earliest deadline.
+ * Gap buffers are pushed from a small pool, so that a downstream element
+ * blocking one push does not delay the other injectors.
+ */
+typedef struct _KmsInjectorScheduler
+{
+  GMutex mutex;
+  GCond cond;
+  /* Signaled when an injector finishes pushing */
+  GCond idle;
+  /* KmsBufferInjector, ordered by deadline */
+  GPtrArray *heap;
+  GThreadPool *pushers;
+} KmsInjectorScheduler;
+
 G_DEFINE_TYPE_WITH_PRIVATE (KmsBufferInjector, kms_buffer_injector,
     GST_TYPE_ELEMENT)
 
@@ -82,10 +104,6 @@ G_DEFINE_TYPE_WITH_PRIVATE (KmsBufferInjector, kms_buffer_injector,
   )                                          \
 )
 
-#define KMS_BUFFER_INJECTOR_GET_COND(obj) (       \
-  &KMS_BUFFER_INJECTOR (obj)->priv->thread_cond   \
-)
-
 #define KMS_BUFFER_INJECTOR_LOCK(obj) (                           \
   g_rec_mutex_lock (&KMS_BUFFER_INJECTOR (obj)->priv->thread_mutex)   \
 )
@@ -122,69 +140,285 @@ kms_buffer_injector_check_segment_event (KmsBufferInjector * self)
   gst_segment_free (segment);
 }
 
+static KmsInjectorScheduler *kms_injector_scheduler_get (void);
+
+#define HEAP_DEADLINE(sched, i) \
+  (KMS_BUFFER_INJECTOR (g_ptr_array_index ((sched)->heap, (i)))->priv->deadline)
+
+static void
+kms_injector_scheduler_swap (KmsInjectorScheduler * sched, guint a, guint b)
+{
+  KmsBufferInjector *tmp = g_ptr_array_index (sched->heap, a);
+
+  g_ptr_array_index (sched->heap, a) = g_ptr_array_index (sched->heap, b);
+  g_ptr_array_index (sched->heap, b) = tmp;
+
+  KMS_BUFFER_INJECTOR (g_ptr_array_index (sched->heap, a))->priv->heap_index =
+      a;
+  KMS_BUFFER_INJECTOR (g_ptr_array_index (sched->heap, b))->priv->heap_index =
+      b;
+}
+
+static void
+kms_injector_scheduler_sift (KmsInjectorScheduler * sched, guint i)
+{
+  while (i > 0 && HEAP_DEADLINE (sched, i) < HEAP_DEADLINE (sched,
+          (i - 1) / 2)) {
+    kms_injector_scheduler_swap (sched, i, (i - 1) / 2);
+    i = (i - 1) / 2;
+  }
+
+  for (;;) {
+    guint left = 2 * i + 1, right = left + 1, min = i;
+
+    if (left < sched->heap->len
+        && HEAP_DEADLINE (sched, left) < HEAP_DEADLINE (sched, min)) {
+      min = left;
+    }
+
+    if (right < sched->heap->len
+        && HEAP_DEADLINE (sched, right) < HEAP_DEADLINE (sched, min)) {
+      min = right;
+    }
+
+    if (min == i) {
+      break;
+    }
+
+    kms_injector_scheduler_swap (sched, i, min);
+    i = min;
+  }
+}
+
+/* Called with the scheduler mutex held, the heap owns a reference */
 static void
-kms_buffer_injector_generate_buffers (KmsBufferInjector * self)
+kms_injector_scheduler_insert (KmsInjectorScheduler * sched,
+    KmsBufferInjector * self, gint64 deadline)
+{
+  self->priv->deadline = deadline;
+
+  if (self->priv->heap_index < 0) {
+    self->priv->heap_index = sched->heap->len;
+    g_ptr_array_add (sched->heap, gst_object_ref (self));
+  }
+
+  kms_injector_scheduler_sift (sched, self->priv->heap_index);
+
+  if (self->priv->heap_index == 0) {
+    g_cond_signal (&sched->cond);
+  }
+}
+
+/* Called with the scheduler mutex held, returns the heap reference */
+static KmsBufferInjector *
+kms_injector_scheduler_remove (KmsInjectorScheduler * sched,
+    KmsBufferInjector * self)
+{
+  guint i, last;
+
+  if (self->priv->heap_index < 0) {
+    return NULL;
+  }
+
+  i = self->priv->heap_index;
+  last = sched->heap->len - 1;
+
+  if (i != last) {
+    kms_injector_scheduler_swap (sched, i, last);
+  }
+
+  g_ptr_array_remove_index (sched->heap, last);
+  self->priv->heap_index = -1;
+
+  if (i < sched->heap->len) {
+    kms_injector_scheduler_sift (sched, i);
+  }
+
+  return self;
+}
+
+static gpointer
+kms_injector_scheduler_run (KmsInjectorScheduler * sched)
+{
+  g_mutex_lock (&sched->mutex);
+
+  for (;;) {
+    KmsBufferInjector *self;
+
+    if (sched->heap->len == 0) {
+      g_cond_wait (&sched->cond, &sched->mutex);
+      continue;
+    }
+
+    self = g_ptr_array_index (sched->heap, 0);
+
+    if (self->priv->deadline > g_get_monotonic_time ()) {
+      g_cond_wait_until (&sched->cond, &sched->mutex, self->priv->deadline);
+      continue;
+    }
+
+    /* The reference held by the heap goes with the push */
+    kms_injector_scheduler_remove (sched, self);
+    self->priv->injecting = TRUE;
+    g_thread_pool_push (sched->pushers, self, NULL);
+  }
+
+  g_mutex_unlock (&sched->mutex);
+
+  return NULL;
+}
+
+static gint64
+kms_buffer_injector_next_deadline (KmsBufferInjector * self)
 {
-  gint64 end_time;              /* microseconds */
   gint64 offset_time;           /* milliseconds */
 
   KMS_BUFFER_INJECTOR_LOCK (self);
-  if ((!self->priv->configured) || (self->priv->previous_buffer == NULL)) {
-    GST_WARNING_OBJECT (self,
-        "Buffer injector is not correctly configured, there is no buffer to send");
-    KMS_BUFFER_INJECTOR_UNLOCK (self);
-    g_usleep (10000);
-    return;
+  offset_time = self->priv->factor_wait_time * self->priv->wait_time;
+  KMS_BUFFER_INJECTOR_UNLOCK (self);
+
+  return g_get_monotonic_time () + offset_time * G_TIME_SPAN_MILLISECOND;
+}
+
+/* A new buffer arrived or injection starts, wait a full period again */
+static void
+kms_buffer_injector_reschedule (KmsBufferInjector * self)
+{
+  KmsInjectorScheduler *sched = kms_injector_scheduler_get ();
+  gint64 deadline = kms_buffer_injector_next_deadline (self);
+
+  g_mutex_lock (&sched->mutex);
+
+  /* While injecting, the pusher schedules the next deadline when done */
+  if (self->priv->running && !self->priv->injecting) {
+    kms_injector_scheduler_insert (sched, self, deadline);
   }
 
-  offset_time = (self->priv->factor_wait_time * self->priv->wait_time);
-  end_time = g_get_monotonic_time () + (offset_time) * G_TIME_SPAN_MILLISECOND;
+  g_mutex_unlock (&sched->mutex);
+}
 
-  self->priv->acumulated_time =
-      self->priv->acumulated_time + (offset_time * G_TIME_SPAN_SECOND);
+static void
+kms_buffer_injector_start (KmsBufferInjector * self)
+{
+  KmsInjectorScheduler *sched = kms_injector_scheduler_get ();
 
-  KMS_BUFFER_INJECTOR_UNLOCK (self);
+  g_mutex_lock (&sched->mutex);
+  self->priv->running = TRUE;
+  g_mutex_unlock (&sched->mutex);
 
-  g_mutex_lock (&self->priv->mutex_generate);
+  kms_buffer_injector_reschedule (self);
+}
 
-  if (!self->priv->still_waiting) {
-    g_mutex_unlock (&self->priv->mutex_generate);
-    return;
+static void
+kms_buffer_injector_stop (KmsBufferInjector * self)
+{
+  KmsInjectorScheduler *sched = kms_injector_scheduler_get ();
+  KmsBufferInjector *removed;
+
+  g_mutex_lock (&sched->mutex);
+  self->priv->running = FALSE;
+  removed = kms_injector_scheduler_remove (sched, self);
+
+  /* Like stopping a pad task, wait for a push already handed to the pool */
+  while (self->priv->injecting) {
+    g_cond_wait (&sched->idle, &sched->mutex);
   }
 
-  if (!g_cond_wait_until (&self->priv->cond_generate,
-          &self->priv->mutex_generate, end_time)) {
-    GstBuffer *copy;
+  g_mutex_unlock (&sched->mutex);
 
-    //timeout reached, it is necessary to inject a new buffer
-    GST_DEBUG_OBJECT (self->priv->srcpad, "Injecting buffer");
-    KMS_BUFFER_INJECTOR_LOCK (self);
-    if (!self->priv->previous_buffer) {
-      KMS_BUFFER_INJECTOR_UNLOCK (self);
-      g_mutex_unlock (&self->priv->mutex_generate);
-      return;
+  if (removed != NULL) {
+    gst_object_unref (removed);
+  }
+}
+
+static void
+kms_buffer_injector_inject (KmsBufferInjector * self,
+    KmsInjectorScheduler * sched)
+{
+  GstBuffer *gap = NULL;
+  gint64 offset_time;           /* milliseconds */
+
+  KMS_BUFFER_INJECTOR_LOCK (self);
+
+  offset_time = self->priv->factor_wait_time * self->priv->wait_time;
+
+  if ((!self->priv->configured) || (self->priv->previous_buffer == NULL)) {
+    GST_LOG_OBJECT (self, "Not configured yet, there is no buffer to send");
+  } else {
+    self->priv->acumulated_time =
+        self->priv->acumulated_time + (offset_time * G_TIME_SPAN_SECOND);
+
+    GstBuffer *previous = self->priv->previous_buffer;
+
+    /* Only one header is made per input buffer: while downstream has already
+     * released the last gap, it is the only reference left and it can be
+     * retimed and pushed again */
+    if (self->priv->gap_buffer == NULL
+        || !gst_buffer_is_writable (self->priv->gap_buffer)) {
+      gst_buffer_replace (&self->priv->gap_buffer, NULL);
+      self->priv->gap_buffer = gst_buffer_copy (previous);
+      GST_BUFFER_FLAG_SET (self->priv->gap_buffer, GST_BUFFER_FLAG_GAP);
+      GST_BUFFER_FLAG_SET (self->priv->gap_buffer, GST_BUFFER_FLAG_DROPPABLE);
     }
-    copy = gst_buffer_copy (self->priv->previous_buffer);
 
-    if (GST_BUFFER_DTS_IS_VALID (copy)) {
-      GST_BUFFER_DTS (copy) =
-          GST_BUFFER_DTS (copy) + self->priv->acumulated_time;
+    gap = self->priv->gap_buffer;
+
+    if (GST_BUFFER_DTS_IS_VALID (previous)) {
+      GST_BUFFER_DTS (gap) =
+          GST_BUFFER_DTS (previous) + self->priv->acumulated_time;
     }
-    if (GST_BUFFER_PTS_IS_VALID (copy)) {
-      GST_BUFFER_PTS (copy) =
-          GST_BUFFER_PTS (copy) + self->priv->acumulated_time;
+    if (GST_BUFFER_PTS_IS_VALID (previous)) {
+      GST_BUFFER_PTS (gap) =
+          GST_BUFFER_PTS (previous) + self->priv->acumulated_time;
     }
 
-    GST_BUFFER_FLAG_SET (copy, GST_BUFFER_FLAG_GAP);
-    GST_BUFFER_FLAG_SET (copy, GST_BUFFER_FLAG_DROPPABLE);
-    KMS_BUFFER_INJECTOR_UNLOCK (self);
+    gst_buffer_ref (gap);
+  }
+
+  KMS_BUFFER_INJECTOR_UNLOCK (self);
+
+  if (gap != NULL) {
+    GST_DEBUG_OBJECT (self->priv->srcpad, "Injecting buffer");
 
     /* We need to check if segment event is present,
      * we could have receive a flush */
     kms_buffer_injector_check_segment_event (self);
-    gst_pad_push (self->priv->srcpad, copy);
+    gst_pad_push (self->priv->srcpad, gap);
+  }
+
+  g_mutex_lock (&sched->mutex);
+  self->priv->injecting = FALSE;
+  g_cond_broadcast (&sched->idle);
+  if (self->priv->running) {
+    kms_injector_scheduler_insert (sched, self,
+        g_get_monotonic_time () + offset_time * G_TIME_SPAN_MILLISECOND);
   }
-  g_mutex_unlock (&self->priv->mutex_generate);
+  g_mutex_unlock (&sched->mutex);
+
+  gst_object_unref (self);
+}
+
+static KmsInjectorScheduler *
+kms_injector_scheduler_get (void)
+{
+  static gsize init = 0;
+  static KmsInjectorScheduler sched;
+
+  if (g_once_init_enter (&init)) {
+    g_mutex_init (&sched.mutex);
+    g_cond_init (&sched.cond);
+    g_cond_init (&sched.idle);
+    sched.heap = g_ptr_array_new ();
+    sched.pushers =
+        g_thread_pool_new ((GFunc) kms_buffer_injector_inject, &sched,
+        MAX (2, g_get_num_processors ()), FALSE, NULL);
+    g_thread_unref (g_thread_new ("bufferinjector",
+            (GThreadFunc) kms_injector_scheduler_run, &sched));
+
+    g_once_init_leave (&init, 1);
+  }
+
+  return &sched;
 }
 
 static gboolean
@@ -218,6 +452,7 @@ kms_buffer_injector_config (KmsBufferInjector * self, GstCaps * caps)
 
     GST_DEBUG_OBJECT (self, "Resetting last buffer");
     gst_buffer_replace (&self->priv->previous_buffer, NULL);
+    gst_buffer_replace (&self->priv->gap_buffer, NULL);
     KMS_BUFFER_INJECTOR_UNLOCK (self);
 
     GST_DEBUG ("Video: Wait time %" G_GINT64_FORMAT, self->priv->wait_time);
@@ -257,14 +492,12 @@ kms_buffer_injector_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
   }
 
   gst_buffer_replace (&buffer_injector->priv->previous_buffer, buffer);
+  gst_buffer_replace (&buffer_injector->priv->gap_buffer, NULL);
   buffer_injector->priv->acumulated_time = 0;
 
   KMS_BUFFER_INJECTOR_UNLOCK (buffer_injector);
 
-  //wake up pad task
-  g_mutex_lock (&buffer_injector->priv->mutex_generate);
-  g_cond_signal (&buffer_injector->priv->cond_generate);
-  g_mutex_unlock (&buffer_injector->priv->mutex_generate);
+  kms_buffer_injector_reschedule (buffer_injector);
 
   return gst_pad_push (buffer_injector->priv->srcpad, buffer);
 }
@@ -298,12 +531,11 @@ kms_buffer_injector_activate_mode (GstPad * pad, GstObject * parent,
   switch (mode) {
     case GST_PAD_MODE_PUSH:
       if (active) {
-        res = gst_pad_start_task (pad,
-            (GstTaskFunction) kms_buffer_injector_generate_buffers,
-            buffer_injector, NULL);
+        kms_buffer_injector_start (buffer_injector);
       } else {
-        res = gst_pad_stop_task (pad);
+        kms_buffer_injector_stop (buffer_injector);
       }
+      res = TRUE;
       break;
     case GST_PAD_MODE_PULL:
       res = TRUE;
@@ -338,54 +570,28 @@ kms_buffer_injector_init (KmsBufferInjector * self)
       kms_buffer_injector_activate_mode);
 
   g_rec_mutex_init (&self->priv->thread_mutex);
-  g_mutex_init (&self->priv->mutex_generate);
-  g_cond_init (&self->priv->cond_generate);
 
   self->priv->wait_time = DEFAULT_WAITING_TIME;
   self->priv->configured = FALSE;
-  self->priv->still_waiting = TRUE;
   self->priv->acumulated_time = 0;
+  self->priv->heap_index = -1;
 
   self->priv->factor_wait_time = 2;
 }
 
-static GstStateChangeReturn
-kms_buffer_injector_change_state (GstElement * element,
-    GstStateChange transition)
-{
-  KmsBufferInjector *buffer_injector = KMS_BUFFER_INJECTOR (element);
-  GstStateChangeReturn ret = GST_STATE_CHANGE_SUCCESS;
-
-  switch (transition) {
-    case GST_STATE_CHANGE_PAUSED_TO_READY:
-      g_mutex_lock (&buffer_injector->priv->mutex_generate);
-      buffer_injector->priv->still_waiting = FALSE;
-      g_cond_signal (&buffer_injector->priv->cond_generate);
-      g_mutex_unlock (&buffer_injector->priv->mutex_generate);
-      gst_pad_pause_task (buffer_injector->priv->srcpad);
-      break;
-    default:
-      break;
-  }
-
-  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
-
-  return ret;
-}
-
 static void
 kms_buffer_injector_finalize (GObject * object)
 {
   KmsBufferInjector *buffer_injector = KMS_BUFFER_INJECTOR (object);
 
   g_rec_mutex_clear (&buffer_injector->priv->thread_mutex);
-  g_mutex_clear (&buffer_injector->priv->mutex_generate);
-  g_cond_clear (&buffer_injector->priv->cond_generate);
 
   if (buffer_injector->priv->previous_buffer != NULL) {
     gst_buffer_unref (buffer_injector->priv->previous_buffer);
   }
 
+  gst_buffer_replace (&buffer_injector->priv->gap_buffer, NULL);
+
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
 
@@ -436,7 +642,6 @@ kms_buffer_injector_class_init (KmsBufferInjectorClass * klass)
 
   gstelement_class = GST_ELEMENT_CLASS (klass);
 
-  gstelement_class->change_state = kms_buffer_injector_change_state;
   gobject_class->set_property = kms_buffer_injector_set_property;
   gobject_class->get_property = kms_buffer_injector_get_property;
 
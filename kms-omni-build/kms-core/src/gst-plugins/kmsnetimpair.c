@@ -0,0 +1,1007 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include "kmsnetimpair.h"
+
+#include <stdio.h>
+
+#define PLUGIN_NAME "netimpair"
+
+#define GST_CAT_DEFAULT kms_net_impair_debug
+GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
+
+#define kms_net_impair_parent_class parent_class
+G_DEFINE_TYPE_WITH_PRIVATE (KmsNetImpair, kms_net_impair, GST_TYPE_ELEMENT);
+
+#define KMS_NET_IMPAIR_LOCK(obj) \
+  (g_mutex_lock (&KMS_NET_IMPAIR (obj)->priv->mutex))
+#define KMS_NET_IMPAIR_UNLOCK(obj) \
+  (g_mutex_unlock (&KMS_NET_IMPAIR (obj)->priv->mutex))
+
+#define DEFAULT_SEED 0
+#define DEFAULT_LOSS_GOOD 0.0
+#define DEFAULT_LOSS_BAD 1.0
+#define DEFAULT_GOOD_TO_BAD 0.0
+#define DEFAULT_BAD_TO_GOOD 1.0
+#define DEFAULT_DELAY 0         /* ms */
+#define DEFAULT_JITTER 0        /* ms */
+#define DEFAULT_SPIKE_PROBABILITY 0.0
+#define DEFAULT_SPIKE_DELAY 0   /* ms */
+#define DEFAULT_SPIKE_DURATION 1000     /* ms */
+#define DEFAULT_REORDER_PROBABILITY 0.0
+#define DEFAULT_REORDER_DELAY 10        /* ms */
+#define DEFAULT_DUPLICATE_PROBABILITY 0.0
+#define DEFAULT_BANDWIDTH 0     /* bps, unlimited */
+#define DEFAULT_QUEUE_SIZE 65536        /* bytes */
+#define DEFAULT_TRACE_LOCATION NULL
+
+enum
+{
+  PROP_0,
+  PROP_SEED,
+  PROP_LOSS_GOOD,
+  PROP_LOSS_BAD,
+  PROP_GOOD_TO_BAD,
+  PROP_BAD_TO_GOOD,
+  PROP_DELAY,
+  PROP_JITTER,
+  PROP_SPIKE_PROBABILITY,
+  PROP_SPIKE_DELAY,
+  PROP_SPIKE_DURATION,
+  PROP_REORDER_PROBABILITY,
+  PROP_REORDER_DELAY,
+  PROP_DUPLICATE_PROBABILITY,
+  PROP_BANDWIDTH,
+  PROP_QUEUE_SIZE,
+  PROP_TRACE_LOCATION,
+  PROP_STATS,
+  N_PROPERTIES
+};
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+/* Link conditions from a trace file, in force from `offset` on */
+typedef struct _KmsNetImpairTracePoint
+{
+  GstClockTime offset;
+  guint bandwidth;
+  guint delay;
+  gdouble loss;
+} KmsNetImpairTracePoint;
+
+typedef struct _KmsNetImpairItem
+{
+  GstMiniObject *object;
+  GstClockTime departure;
+} KmsNetImpairItem;
+
+struct _KmsNetImpairPrivate
+{
+  GstPad *sinkpad;
+  GstPad *srcpad;
+
+  GMutex mutex;
+  GCond cond;
+
+  /* Configuration */
+  guint seed;
+  gdouble loss_good;
+  gdouble loss_bad;
+  gdouble good_to_bad;
+  gdouble bad_to_good;
+  guint delay;
+  guint jitter;
+  gdouble spike_probability;
+  guint spike_delay;
+  guint spike_duration;
+  gdouble reorder_probability;
+  guint reorder_delay;
+  gdouble duplicate_probability;
+  guint bandwidth;
+  guint queue_size;
+  gchar *trace_location;
+  GArray *trace;
+
+  /* Link state, reset each time the element starts */
+  GRand *rand;
+  gboolean bad_state;
+  GstClockTime spike_start;
+  GstClockTime link_free;
+  GstClockTime last_departure;
+  GstClockTime trace_start;
+
+  /* KmsNetImpairItem, ordered by departure time */
+  GQueue *queue;
+  GstClockID clock_id;
+  gboolean flushing;
+  GstFlowReturn srcresult;
+
+  guint64 packets_in;
+  guint64 packets_out;
+  guint64 lost;
+  guint64 queue_dropped;
+  guint64 duplicated;
+  guint64 reordered;
+};
+
+static void
+kms_net_impair_item_free (KmsNetImpairItem * item)
+{
+  if (item->object != NULL) {
+    gst_mini_object_unref (item->object);
+  }
+
+  g_slice_free (KmsNetImpairItem, item);
+}
+
+static GstClock *
+kms_net_impair_get_clock (KmsNetImpair * self)
+{
+  GstClock *clock = gst_element_get_clock (GST_ELEMENT (self));
+
+  if (clock == NULL) {
+    clock = gst_system_clock_obtain ();
+  }
+
+  return clock;
+}
+
+static GstClockTime
+kms_net_impair_now (KmsNetImpair * self)
+{
+  GstClock *clock = kms_net_impair_get_clock (self);
+  GstClockTime now = gst_clock_get_time (clock);
+
+  gst_object_unref (clock);
+
+  return now;
+}
+
+/* Called with the lock held */
+static void
+kms_net_impair_reset (KmsNetImpair * self)
+{
+  if (self->priv->rand != NULL) {
+    g_rand_free (self->priv->rand);
+  }
+
+  self->priv->rand = g_rand_new_with_seed (self->priv->seed);
+  self->priv->bad_state = FALSE;
+  self->priv->spike_start = GST_CLOCK_TIME_NONE;
+  self->priv->link_free = 0;
+  self->priv->last_departure = 0;
+  self->priv->trace_start = GST_CLOCK_TIME_NONE;
+
+  self->priv->packets_in = 0;
+  self->priv->packets_out = 0;
+  self->priv->lost = 0;
+  self->priv->queue_dropped = 0;
+  self->priv->duplicated = 0;
+  self->priv->reordered = 0;
+}
+
+/* Called with the lock held, takes ownership of the object */
+static void
+kms_net_impair_enqueue (KmsNetImpair * self, GstMiniObject * object,
+    GstClockTime departure)
+{
+  KmsNetImpairItem *item;
+  GList *l;
+
+  item = g_slice_new (KmsNetImpairItem);
+  item->object = object;
+  item->departure = departure;
+
+  /* Mostly appended, search from the tail. Equal times keep arrival order */
+  for (l = self->priv->queue->tail; l != NULL; l = l->prev) {
+    KmsNetImpairItem *other = l->data;
+
+    if (other->departure <= departure) {
+      break;
+    }
+  }
+
+  if (l == NULL) {
+    g_queue_push_head (self->priv->queue, item);
+
+    /* The task may be waiting for a later packet */
+    if (self->priv->clock_id != NULL) {
+      gst_clock_id_unschedule (self->priv->clock_id);
+    }
+  } else {
+    g_queue_insert_after (self->priv->queue, l, item);
+  }
+
+  g_cond_signal (&self->priv->cond);
+}
+
+/* Called with the lock held */
+static GstClockTime
+kms_net_impair_tail_departure (KmsNetImpair * self, GstClockTime now)
+{
+  KmsNetImpairItem *tail = g_queue_peek_tail (self->priv->queue);
+
+  if (tail == NULL) {
+    return now;
+  }
+
+  return MAX (tail->departure, now);
+}
+
+/* Called with the lock held */
+static void
+kms_net_impair_apply_trace (KmsNetImpair * self, GstClockTime now,
+    guint * bandwidth, guint * delay, gdouble * loss)
+{
+  KmsNetImpairTracePoint *point = NULL;
+  GstClockTime offset;
+  guint i;
+
+  if (self->priv->trace == NULL || self->priv->trace->len == 0) {
+    return;
+  }
+
+  if (!GST_CLOCK_TIME_IS_VALID (self->priv->trace_start)) {
+    self->priv->trace_start = now;
+  }
+
+  offset = now - self->priv->trace_start;
+
+  for (i = 0; i < self->priv->trace->len; i++) {
+    KmsNetImpairTracePoint *p =
+        &g_array_index (self->priv->trace, KmsNetImpairTracePoint, i);
+
+    if (p->offset > offset) {
+      break;
+    }
+
+    point = p;
+  }
+
+  if (point != NULL) {
+    *bandwidth = point->bandwidth;
+    *delay = point->delay;
+    *loss = point->loss;
+  }
+}
+
+/*
+ * Called with the lock held. Returns FALSE if the packet is dropped,
+ * otherwise the time it has to leave the element.
+ */
+static gboolean
+kms_net_impair_schedule_packet (KmsNetImpair * self, gsize size,
+    GstClockTime now, GstClockTime * departure, gboolean * duplicate)
+{
+  KmsNetImpairPrivate *priv = self->priv;
+  guint bandwidth = priv->bandwidth, delay = priv->delay;
+  gdouble loss_good = priv->loss_good;
+  gdouble r_state, r_loss, r_jitter, r_spike, r_reorder, r_duplicate;
+  GstClockTime base = now, extra = 0;
+  gboolean reorder;
+
+  /*
+   * Always draw the same amount of numbers per packet, so that enabling one
+   * impairment does not change the pattern of the others.
+   */
+  r_state = g_rand_double (priv->rand);
+  r_loss = g_rand_double (priv->rand);
+  r_jitter = g_rand_double (priv->rand);
+  r_spike = g_rand_double (priv->rand);
+  r_reorder = g_rand_double (priv->rand);
+  r_duplicate = g_rand_double (priv->rand);
+
+  kms_net_impair_apply_trace (self, now, &bandwidth, &delay, &loss_good);
+
+  /* Gilbert-Elliott loss */
+  if (priv->bad_state) {
+    priv->bad_state = r_state >= priv->bad_to_good;
+  } else {
+    priv->bad_state = r_state < priv->good_to_bad;
+  }
+
+  if (r_loss < (priv->bad_state ? priv->loss_bad : loss_good)) {
+    priv->lost++;
+    return FALSE;
+  }
+
+  /* Bandwidth cap, the queue holds what the link has not sent yet */
+  if (bandwidth > 0) {
+    guint64 backlog = 0;
+
+    if (priv->link_free > now) {
+      backlog = gst_util_uint64_scale (priv->link_free - now, bandwidth,
+          8 * GST_SECOND);
+    }
+
+    if (backlog + size > priv->queue_size) {
+      GST_LOG_OBJECT (self, "Queue full (%" G_GUINT64_FORMAT " bytes)",
+          backlog);
+      priv->queue_dropped++;
+      return FALSE;
+    }
+
+    priv->link_free = MAX (priv->link_free, now) +
+        gst_util_uint64_scale (size, 8 * GST_SECOND, bandwidth);
+    base = priv->link_free;
+  }
+
+  /* Delay spikes, decaying linearly as if a queue somewhere drained */
+  if (r_spike < priv->spike_probability
+      && (!GST_CLOCK_TIME_IS_VALID (priv->spike_start)
+          || now - priv->spike_start >= priv->spike_duration * GST_MSECOND)) {
+    priv->spike_start = now;
+  }
+
+  if (GST_CLOCK_TIME_IS_VALID (priv->spike_start)
+      && now - priv->spike_start < priv->spike_duration * GST_MSECOND) {
+    GstClockTime left =
+        priv->spike_duration * GST_MSECOND - (now - priv->spike_start);
+
+    extra = gst_util_uint64_scale (priv->spike_delay * GST_MSECOND, left,
+        priv->spike_duration * GST_MSECOND);
+  }
+
+  *departure = base + delay * GST_MSECOND + extra +
+      (GstClockTime) (r_jitter * priv->jitter * GST_MSECOND);
+
+  /* Packets keep their order unless picked to be reordered */
+  reorder = r_reorder < priv->reorder_probability;
+  if (reorder) {
+    *departure += priv->reorder_delay * GST_MSECOND;
+    priv->reordered++;
+  } else {
+    *departure = MAX (*departure, priv->last_departure);
+    priv->last_departure = *departure;
+  }
+
+  *duplicate = r_duplicate < priv->duplicate_probability;
+  if (*duplicate) {
+    priv->duplicated++;
+  }
+
+  return TRUE;
+}
+
+static GstFlowReturn
+kms_net_impair_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  KmsNetImpair *self = KMS_NET_IMPAIR (parent);
+  GstClockTime now = kms_net_impair_now (self), departure;
+  gboolean duplicate;
+  GstFlowReturn ret;
+
+  KMS_NET_IMPAIR_LOCK (self);
+
+  ret = self->priv->srcresult;
+  if (self->priv->flushing) {
+    ret = GST_FLOW_FLUSHING;
+  }
+
+  if (ret != GST_FLOW_OK) {
+    KMS_NET_IMPAIR_UNLOCK (self);
+    gst_buffer_unref (buffer);
+    return ret;
+  }
+
+  self->priv->packets_in++;
+
+  if (!kms_net_impair_schedule_packet (self, gst_buffer_get_size (buffer),
+          now, &departure, &duplicate)) {
+    GST_LOG_OBJECT (self, "Dropping %" GST_PTR_FORMAT, buffer);
+    gst_buffer_unref (buffer);
+  } else {
+    if (duplicate) {
+      kms_net_impair_enqueue (self,
+          GST_MINI_OBJECT_CAST (gst_buffer_ref (buffer)), departure);
+    }
+    kms_net_impair_enqueue (self, GST_MINI_OBJECT_CAST (buffer), departure);
+  }
+
+  KMS_NET_IMPAIR_UNLOCK (self);
+
+  return GST_FLOW_OK;
+}
+
+static void
+kms_net_impair_loop (KmsNetImpair * self)
+{
+  KmsNetImpairItem *item;
+  GstMiniObject *object;
+  GstClock *clock;
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  KMS_NET_IMPAIR_LOCK (self);
+
+  while (!self->priv->flushing && g_queue_is_empty (self->priv->queue)) {
+    g_cond_wait (&self->priv->cond, &self->priv->mutex);
+  }
+
+  if (self->priv->flushing) {
+    KMS_NET_IMPAIR_UNLOCK (self);
+    gst_pad_pause_task (self->priv->srcpad);
+    return;
+  }
+
+  item = g_queue_peek_head (self->priv->queue);
+  clock = kms_net_impair_get_clock (self);
+
+  if (item->departure > gst_clock_get_time (clock)) {
+    GstClockID id = gst_clock_new_single_shot_id (clock, item->departure);
+
+    self->priv->clock_id = id;
+    KMS_NET_IMPAIR_UNLOCK (self);
+
+    gst_clock_id_wait (id, NULL);
+
+    KMS_NET_IMPAIR_LOCK (self);
+    self->priv->clock_id = NULL;
+    KMS_NET_IMPAIR_UNLOCK (self);
+
+    gst_clock_id_unref (id);
+    gst_object_unref (clock);
+
+    /* Check again, an earlier packet may have arrived meanwhile */
+    return;
+  }
+
+  gst_object_unref (clock);
+
+  g_queue_pop_head (self->priv->queue);
+  object = item->object;
+  item->object = NULL;
+  kms_net_impair_item_free (item);
+
+  if (GST_IS_BUFFER (object)) {
+    self->priv->packets_out++;
+  }
+
+  KMS_NET_IMPAIR_UNLOCK (self);
+
+  if (GST_IS_BUFFER (object)) {
+    ret = gst_pad_push (self->priv->srcpad, GST_BUFFER_CAST (object));
+  } else {
+    GstEvent *event = GST_EVENT_CAST (object);
+    gboolean eos = GST_EVENT_TYPE (event) == GST_EVENT_EOS;
+
+    gst_pad_push_event (self->priv->srcpad, event);
+
+    if (eos) {
+      ret = GST_FLOW_EOS;
+    }
+  }
+
+  if (ret == GST_FLOW_OK) {
+    return;
+  }
+
+  GST_DEBUG_OBJECT (self, "Pausing task, reason %s", gst_flow_get_name (ret));
+
+  KMS_NET_IMPAIR_LOCK (self);
+  self->priv->srcresult = ret;
+  KMS_NET_IMPAIR_UNLOCK (self);
+
+  gst_pad_pause_task (self->priv->srcpad);
+}
+
+static void
+kms_net_impair_set_flushing (KmsNetImpair * self, gboolean flushing)
+{
+  KMS_NET_IMPAIR_LOCK (self);
+
+  self->priv->flushing = flushing;
+
+  if (flushing) {
+    if (self->priv->clock_id != NULL) {
+      gst_clock_id_unschedule (self->priv->clock_id);
+    }
+    g_cond_signal (&self->priv->cond);
+  } else {
+    g_queue_clear_full (self->priv->queue,
+        (GDestroyNotify) kms_net_impair_item_free);
+    self->priv->srcresult = GST_FLOW_OK;
+  }
+
+  KMS_NET_IMPAIR_UNLOCK (self);
+}
+
+static gboolean
+kms_net_impair_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  KmsNetImpair *self = KMS_NET_IMPAIR (parent);
+  gboolean ret;
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_FLUSH_START:
+      kms_net_impair_set_flushing (self, TRUE);
+      ret = gst_pad_push_event (self->priv->srcpad, event);
+      gst_pad_pause_task (self->priv->srcpad);
+      return ret;
+    case GST_EVENT_FLUSH_STOP:
+      kms_net_impair_set_flushing (self, FALSE);
+      ret = gst_pad_push_event (self->priv->srcpad, event);
+      gst_pad_start_task (self->priv->srcpad,
+          (GstTaskFunction) kms_net_impair_loop, self, NULL);
+      return ret;
+    default:
+      break;
+  }
+
+  if (!GST_EVENT_IS_SERIALIZED (event)) {
+    return gst_pad_event_default (pad, parent, event);
+  }
+
+  /* Serialized events must not overtake packets still in the link */
+  KMS_NET_IMPAIR_LOCK (self);
+
+  if (self->priv->flushing) {
+    KMS_NET_IMPAIR_UNLOCK (self);
+    gst_event_unref (event);
+    return FALSE;
+  }
+
+  kms_net_impair_enqueue (self, GST_MINI_OBJECT_CAST (event),
+      kms_net_impair_tail_departure (self, kms_net_impair_now (self)));
+
+  KMS_NET_IMPAIR_UNLOCK (self);
+
+  return TRUE;
+}
+
+static gboolean
+kms_net_impair_src_activate_mode (GstPad * pad, GstObject * parent,
+    GstPadMode mode, gboolean active)
+{
+  KmsNetImpair *self = KMS_NET_IMPAIR (parent);
+
+  if (mode != GST_PAD_MODE_PUSH) {
+    return FALSE;
+  }
+
+  if (active) {
+    KMS_NET_IMPAIR_LOCK (self);
+    kms_net_impair_reset (self);
+    KMS_NET_IMPAIR_UNLOCK (self);
+
+    kms_net_impair_set_flushing (self, FALSE);
+
+    return gst_pad_start_task (pad, (GstTaskFunction) kms_net_impair_loop,
+        self, NULL);
+  }
+
+  kms_net_impair_set_flushing (self, TRUE);
+
+  return gst_pad_stop_task (pad);
+}
+
+/*
+ * One line per change of conditions:
+ *   <time ms> <bandwidth bps> <delay ms> <loss 0..1>
+ * Time counts from the first packet. Empty lines and '#' comments are
+ * skipped. After the last line its values stay in force.
+ */
+static GArray *
+kms_net_impair_load_trace (KmsNetImpair * self, const gchar * location)
+{
+  GError *err = NULL;
+  gchar *contents, **lines, **line;
+  GArray *trace;
+
+  if (!g_file_get_contents (location, &contents, NULL, &err)) {
+    GST_ELEMENT_WARNING (self, RESOURCE, OPEN_READ,
+        ("Cannot read trace file %s", location), ("%s", err->message));
+    g_error_free (err);
+    return NULL;
+  }
+
+  trace = g_array_new (FALSE, FALSE, sizeof (KmsNetImpairTracePoint));
+  lines = g_strsplit (contents, "\n", -1);
+  g_free (contents);
+
+  for (line = lines; *line != NULL; line++) {
+    KmsNetImpairTracePoint point;
+    guint64 offset;
+    gchar *text = g_strstrip (*line);
+
+    if (text[0] == '\0' || text[0] == '#') {
+      continue;
+    }
+
+    if (sscanf (text, "%" G_GUINT64_FORMAT " %u %u %lf", &offset,
+            &point.bandwidth, &point.delay, &point.loss) != 4) {
+      GST_WARNING_OBJECT (self, "Ignoring bad trace line '%s'", text);
+      continue;
+    }
+
+    point.offset = offset * GST_MSECOND;
+    point.loss = CLAMP (point.loss, 0.0, 1.0);
+    g_array_append_val (trace, point);
+  }
+
+  g_strfreev (lines);
+
+  GST_DEBUG_OBJECT (self, "Loaded %u trace points from %s", trace->len,
+      location);
+
+  return trace;
+}
+
+static GstStructure *
+kms_net_impair_create_stats (KmsNetImpair * self)
+{
+  return gst_structure_new ("netimpair-stats",
+      "packets-in", G_TYPE_UINT64, self->priv->packets_in,
+      "packets-out", G_TYPE_UINT64, self->priv->packets_out,
+      "lost", G_TYPE_UINT64, self->priv->lost,
+      "queue-dropped", G_TYPE_UINT64, self->priv->queue_dropped,
+      "duplicated", G_TYPE_UINT64, self->priv->duplicated,
+      "reordered", G_TYPE_UINT64, self->priv->reordered,
+      "queued", G_TYPE_UINT, g_queue_get_length (self->priv->queue), NULL);
+}
+
+static void
+kms_net_impair_set_property (GObject * object, guint property_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  KmsNetImpair *self = KMS_NET_IMPAIR (object);
+  GArray *trace = NULL;
+
+  if (property_id == PROP_TRACE_LOCATION && g_value_get_string (value)) {
+    trace = kms_net_impair_load_trace (self, g_value_get_string (value));
+  }
+
+  KMS_NET_IMPAIR_LOCK (self);
+
+  switch (property_id) {
+    case PROP_SEED:
+      self->priv->seed = g_value_get_uint (value);
+      g_rand_set_seed (self->priv->rand, self->priv->seed);
+      break;
+    case PROP_LOSS_GOOD:
+      self->priv->loss_good = g_value_get_double (value);
+      break;
+    case PROP_LOSS_BAD:
+      self->priv->loss_bad = g_value_get_double (value);
+      break;
+    case PROP_GOOD_TO_BAD:
+      self->priv->good_to_bad = g_value_get_double (value);
+      break;
+    case PROP_BAD_TO_GOOD:
+      self->priv->bad_to_good = g_value_get_double (value);
+      break;
+    case PROP_DELAY:
+      self->priv->delay = g_value_get_uint (value);
+      break;
+    case PROP_JITTER:
+      self->priv->jitter = g_value_get_uint (value);
+      break;
+    case PROP_SPIKE_PROBABILITY:
+      self->priv->spike_probability = g_value_get_double (value);
+      break;
+    case PROP_SPIKE_DELAY:
+      self->priv->spike_delay = g_value_get_uint (value);
+      break;
+    case PROP_SPIKE_DURATION:
+      self->priv->spike_duration = g_value_get_uint (value);
+      break;
+    case PROP_REORDER_PROBABILITY:
+      self->priv->reorder_probability = g_value_get_double (value);
+      break;
+    case PROP_REORDER_DELAY:
+      self->priv->reorder_delay = g_value_get_uint (value);
+      break;
+    case PROP_DUPLICATE_PROBABILITY:
+      self->priv->duplicate_probability = g_value_get_double (value);
+      break;
+    case PROP_BANDWIDTH:
+      self->priv->bandwidth = g_value_get_uint (value);
+      break;
+    case PROP_QUEUE_SIZE:
+      self->priv->queue_size = g_value_get_uint (value);
+      break;
+    case PROP_TRACE_LOCATION:
+      g_free (self->priv->trace_location);
+      self->priv->trace_location = g_value_dup_string (value);
+      if (self->priv->trace != NULL) {
+        g_array_unref (self->priv->trace);
+      }
+      self->priv->trace = trace;
+      self->priv->trace_start = GST_CLOCK_TIME_NONE;
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      break;
+  }
+
+  KMS_NET_IMPAIR_UNLOCK (self);
+}
+
+static void
+kms_net_impair_get_property (GObject * object, guint property_id,
+    GValue * value, GParamSpec * pspec)
+{
+  KmsNetImpair *self = KMS_NET_IMPAIR (object);
+
+  KMS_NET_IMPAIR_LOCK (self);
+
+  switch (property_id) {
+    case PROP_SEED:
+      g_value_set_uint (value, self->priv->seed);
+      break;
+    case PROP_LOSS_GOOD:
+      g_value_set_double (value, self->priv->loss_good);
+      break;
+    case PROP_LOSS_BAD:
+      g_value_set_double (value, self->priv->loss_bad);
+      break;
+    case PROP_GOOD_TO_BAD:
+      g_value_set_double (value, self->priv->good_to_bad);
+      break;
+    case PROP_BAD_TO_GOOD:
+      g_value_set_double (value, self->priv->bad_to_good);
+      break;
+    case PROP_DELAY:
+      g_value_set_uint (value, self->priv->delay);
+      break;
+    case PROP_JITTER:
+      g_value_set_uint (value, self->priv->jitter);
+      break;
+    case PROP_SPIKE_PROBABILITY:
+      g_value_set_double (value, self->priv->spike_probability);
+      break;
+    case PROP_SPIKE_DELAY:
+      g_value_set_uint (value, self->priv->spike_delay);
+      break;
+    case PROP_SPIKE_DURATION:
+      g_value_set_uint (value, self->priv->spike_duration);
+      break;
+    case PROP_REORDER_PROBABILITY:
+      g_value_set_double (value, self->priv->reorder_probability);
+      break;
+    case PROP_REORDER_DELAY:
+      g_value_set_uint (value, self->priv->reorder_delay);
+      break;
+    case PROP_DUPLICATE_PROBABILITY:
+      g_value_set_double (value, self->priv->duplicate_probability);
+      break;
+    case PROP_BANDWIDTH:
+      g_value_set_uint (value, self->priv->bandwidth);
+      break;
+    case PROP_QUEUE_SIZE:
+      g_value_set_uint (value, self->priv->queue_size);
+      break;
+    case PROP_TRACE_LOCATION:
+      g_value_set_string (value, self->priv->trace_location);
+      break;
+    case PROP_STATS:
+      g_value_take_boxed (value, kms_net_impair_create_stats (self));
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      break;
+  }
+
+  KMS_NET_IMPAIR_UNLOCK (self);
+}
+
+static void
+kms_net_impair_finalize (GObject * object)
+{
+  KmsNetImpair *self = KMS_NET_IMPAIR (object);
+
+  g_queue_free_full (self->priv->queue,
+      (GDestroyNotify) kms_net_impair_item_free);
+
+  if (self->priv->rand != NULL) {
+    g_rand_free (self->priv->rand);
+  }
+
+  if (self->priv->trace != NULL) {
+    g_array_unref (self->priv->trace);
+  }
+
+  g_free (self->priv->trace_location);
+  g_mutex_clear (&self->priv->mutex);
+  g_cond_clear (&self->priv->cond);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static void
+kms_net_impair_init (KmsNetImpair * self)
+{
+  self->priv = kms_net_impair_get_instance_private (self);
+
+  self->priv->sinkpad =
+      gst_pad_new_from_static_template (&sinktemplate, "sink");
+  gst_pad_set_chain_function (self->priv->sinkpad,
+      GST_DEBUG_FUNCPTR (kms_net_impair_chain));
+  gst_pad_set_event_function (self->priv->sinkpad,
+      GST_DEBUG_FUNCPTR (kms_net_impair_sink_event));
+  GST_PAD_SET_PROXY_CAPS (self->priv->sinkpad);
+  GST_PAD_SET_PROXY_ALLOCATION (self->priv->sinkpad);
+  gst_element_add_pad (GST_ELEMENT (self), self->priv->sinkpad);
+
+  self->priv->srcpad = gst_pad_new_from_static_template (&srctemplate, "src");
+  gst_pad_set_activatemode_function (self->priv->srcpad,
+      GST_DEBUG_FUNCPTR (kms_net_impair_src_activate_mode));
+  GST_PAD_SET_PROXY_CAPS (self->priv->srcpad);
+  gst_element_add_pad (GST_ELEMENT (self), self->priv->srcpad);
+
+  g_mutex_init (&self->priv->mutex);
+  g_cond_init (&self->priv->cond);
+  self->priv->queue = g_queue_new ();
+  self->priv->flushing = TRUE;
+  self->priv->srcresult = GST_FLOW_FLUSHING;
+
+  self->priv->seed = DEFAULT_SEED;
+  self->priv->loss_good = DEFAULT_LOSS_GOOD;
+  self->priv->loss_bad = DEFAULT_LOSS_BAD;
+  self->priv->good_to_bad = DEFAULT_GOOD_TO_BAD;
+  self->priv->bad_to_good = DEFAULT_BAD_TO_GOOD;
+  self->priv->delay = DEFAULT_DELAY;
+  self->priv->jitter = DEFAULT_JITTER;
+  self->priv->spike_probability = DEFAULT_SPIKE_PROBABILITY;
+  self->priv->spike_delay = DEFAULT_SPIKE_DELAY;
+  self->priv->spike_duration = DEFAULT_SPIKE_DURATION;
+  self->priv->reorder_probability = DEFAULT_REORDER_PROBABILITY;
+  self->priv->reorder_delay = DEFAULT_REORDER_DELAY;
+  self->priv->duplicate_probability = DEFAULT_DUPLICATE_PROBABILITY;
+  self->priv->bandwidth = DEFAULT_BANDWIDTH;
+  self->priv->queue_size = DEFAULT_QUEUE_SIZE;
+  self->priv->trace_location = DEFAULT_TRACE_LOCATION;
+
+  kms_net_impair_reset (self);
+}
+
+static void
+kms_net_impair_class_init (KmsNetImpairClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstElementClass *gstelement_class = GST_ELEMENT_CLASS (klass);
+
+  gobject_class->set_property = kms_net_impair_set_property;
+  gobject_class->get_property = kms_net_impair_get_property;
+  gobject_class->finalize = kms_net_impair_finalize;
+
+  gst_element_class_set_details_simple (gstelement_class,
+      "Network impairment emulator",
+      "Filter/Network",
+      "Reproducibly drops, delays, reorders and duplicates packets",
+      "Kurento <kurento@googlegroups.com>");
+
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&srctemplate));
+  gst_element_class_add_pad_template (gstelement_class,
+      gst_static_pad_template_get (&sinktemplate));
+
+  g_object_class_install_property (gobject_class, PROP_SEED,
+      g_param_spec_uint ("seed", "Seed",
+          "Seed of the random generator, the same seed gives the same "
+          "impairments", 0, G_MAXUINT, DEFAULT_SEED,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_LOSS_GOOD,
+      g_param_spec_double ("loss-good", "Loss in good state",
+          "Packet loss probability in the good state (plain random loss if "
+          "the bad state is never entered)", 0.0, 1.0, DEFAULT_LOSS_GOOD,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_LOSS_BAD,
+      g_param_spec_double ("loss-bad", "Loss in bad state",
+          "Packet loss probability in the bad (burst) state", 0.0, 1.0,
+          DEFAULT_LOSS_BAD, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_GOOD_TO_BAD,
+      g_param_spec_double ("good-to-bad", "Good to bad",
+          "Probability of moving to the bad state on each packet", 0.0, 1.0,
+          DEFAULT_GOOD_TO_BAD, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_BAD_TO_GOOD,
+      g_param_spec_double ("bad-to-good", "Bad to good",
+          "Probability of moving back to the good state on each packet",
+          0.0, 1.0, DEFAULT_BAD_TO_GOOD,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_DELAY,
+      g_param_spec_uint ("delay", "Delay",
+          "Fixed one-way delay (ms)", 0, G_MAXUINT, DEFAULT_DELAY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_JITTER,
+      g_param_spec_uint ("jitter", "Jitter",
+          "Maximum random delay added to each packet (ms)", 0, G_MAXUINT,
+          DEFAULT_JITTER, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_SPIKE_PROBABILITY,
+      g_param_spec_double ("spike-probability", "Spike probability",
+          "Probability that a packet starts a delay spike", 0.0, 1.0,
+          DEFAULT_SPIKE_PROBABILITY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_SPIKE_DELAY,
+      g_param_spec_uint ("spike-delay", "Spike delay",
+          "Extra delay at the start of a spike, decreasing to zero along "
+          "the spike duration (ms)", 0, G_MAXUINT, DEFAULT_SPIKE_DELAY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_SPIKE_DURATION,
+      g_param_spec_uint ("spike-duration", "Spike duration",
+          "Duration of a delay spike (ms)", 1, G_MAXUINT,
+          DEFAULT_SPIKE_DURATION,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_REORDER_PROBABILITY,
+      g_param_spec_double ("reorder-probability", "Reorder probability",
+          "Probability that a packet is held back and overtaken by the "
+          "following ones", 0.0, 1.0, DEFAULT_REORDER_PROBABILITY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_REORDER_DELAY,
+      g_param_spec_uint ("reorder-delay", "Reorder delay",
+          "Extra delay of reordered packets (ms)", 0, G_MAXUINT,
+          DEFAULT_REORDER_DELAY, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class,
+      PROP_DUPLICATE_PROBABILITY, g_param_spec_double ("duplicate-probability",
+          "Duplicate probability", "Probability that a packet is sent twice",
+          0.0, 1.0, DEFAULT_DUPLICATE_PROBABILITY,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_BANDWIDTH,
+      g_param_spec_uint ("bandwidth", "Bandwidth",
+          "Link capacity in bps (0 = unlimited)", 0, G_MAXUINT,
+          DEFAULT_BANDWIDTH, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_QUEUE_SIZE,
+      g_param_spec_uint ("queue-size", "Queue size",
+          "Bytes waiting for the link before packets are dropped, only with "
+          "a bandwidth limit", 0, G_MAXUINT, DEFAULT_QUEUE_SIZE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_TRACE_LOCATION,
+      g_param_spec_string ("trace-location", "Trace location",
+          "File with lines '<time ms> <bandwidth bps> <delay ms> <loss>' "
+          "that override bandwidth, delay and loss-good over time",
+          DEFAULT_TRACE_LOCATION, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_STATS,
+      g_param_spec_boxed ("stats", "Stats",
+          "Counters of the packets affected by each impairment",
+          GST_TYPE_STRUCTURE, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  GST_DEBUG_CATEGORY_INIT (GST_CAT_DEFAULT, PLUGIN_NAME, 0, PLUGIN_NAME);
+}
+
+gboolean
+kms_net_impair_plugin_init (GstPlugin * plugin)
+{
+  return gst_element_register (plugin, PLUGIN_NAME, GST_RANK_NONE,
+      KMS_TYPE_NET_IMPAIR);
+}
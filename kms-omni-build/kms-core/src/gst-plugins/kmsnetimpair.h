@@ -0,0 +1,68 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __KMS_NET_IMPAIR_H__
+#define __KMS_NET_IMPAIR_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+/* #defines don't like whitespacey bits */
+#define KMS_TYPE_NET_IMPAIR \
+  (kms_net_impair_get_type())
+#define KMS_NET_IMPAIR(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),KMS_TYPE_NET_IMPAIR,KmsNetImpair))
+#define KMS_NET_IMPAIR_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),KMS_TYPE_NET_IMPAIR,KmsNetImpairClass))
+#define KMS_IS_NET_IMPAIR(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),KMS_TYPE_NET_IMPAIR))
+#define KMS_IS_NET_IMPAIR_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),KMS_TYPE_NET_IMPAIR))
+#define KMS_NET_IMPAIR_CAST(obj) ((KmsNetImpair*)(obj))
+
+typedef struct _KmsNetImpair KmsNetImpair;
+typedef struct _KmsNetImpairClass KmsNetImpairClass;
+typedef struct _KmsNetImpairPrivate KmsNetImpairPrivate;
+
+/*
+ * Emulates an impaired network link for packets going through it: loss
+ * following a Gilbert-Elliott model, fixed, jittered and bursty delay,
+ * reordering, duplication and a bandwidth cap with a drop-tail queue, all
+ * optionally driven by a trace file.
+ *
+ * Every random decision comes from a generator seeded with the "seed"
+ * property, and packets leave at times of the pipeline clock, so runs with
+ * the same input and a GstTestClock are exactly reproducible.
+ */
+struct _KmsNetImpair
+{
+  GstElement parent;
+
+  KmsNetImpairPrivate *priv;
+};
+
+struct _KmsNetImpairClass
+{
+  GstElementClass parent_class;
+};
+
+GType kms_net_impair_get_type (void);
+
+gboolean kms_net_impair_plugin_init (GstPlugin * plugin);
+
+G_END_DECLS
+#endif /* __KMS_NET_IMPAIR_H__ */
@@ -0,0 +1,120 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ClientSession.hpp"
+#include "EventHandler.hpp"
+#include "MediaSet.hpp"
+#include "UUIDGenerator.hpp"
+
+#include <KurentoException.hpp>
+#include <MediaObjectImpl.hpp>
+#include <gst/gst.h>
+
+#define GST_CAT_DEFAULT kurento_client_session
+GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
+#define GST_DEFAULT_NAME "KurentoClientSession"
+
+namespace kurento
+{
+
+ClientSession::ClientSession (const boost::property_tree::ptree &config,
+                              const std::string &sessionId) : config (config),
+  sessionId (sessionId)
+{
+  if (this->sessionId.empty () ) {
+    this->sessionId = generateUUID ();
+  }
+
+  GST_DEBUG ("New in-process session %s", this->sessionId.c_str () );
+}
+
+ClientSession::~ClientSession ()
+{
+  try {
+    MediaSet::getMediaSet ()->unrefSession (sessionId);
+  } catch (...) {
+    GST_WARNING ("Error releasing session %s", sessionId.c_str () );
+  }
+}
+
+void
+ClientSession::keepAlive ()
+{
+  try {
+    MediaSet::getMediaSet ()->keepAliveSession (sessionId);
+  } catch (KurentoException &e) {
+    if (e.getCode () != INVALID_SESSION) {
+      throw;
+    }
+
+    /* Nothing referenced yet, the first object creates the session */
+  }
+}
+
+std::shared_ptr<MediaObjectImpl>
+ClientSession::adopt (MediaObjectImpl *object)
+{
+  std::shared_ptr<MediaObjectImpl> ref;
+
+  ref = MediaSet::getMediaSet ()->ref (object);
+  MediaSet::getMediaSet ()->ref (sessionId, ref);
+
+  return ref;
+}
+
+std::shared_ptr<MediaObjectImpl>
+ClientSession::getObject (const std::string &objectId)
+{
+  keepAlive ();
+
+  return MediaSet::getMediaSet ()->getMediaObject (sessionId, objectId);
+}
+
+void
+ClientSession::checkObject (std::shared_ptr<MediaObject> object)
+{
+  if (!object) {
+    throw KurentoException (MEDIA_OBJECT_NOT_FOUND, "Invalid object");
+  }
+
+  MediaSet::getMediaSet ()->getMediaObject (object->getId () );
+}
+
+void
+ClientSession::release (std::shared_ptr<MediaObject> object)
+{
+  checkObject (object);
+  keepAlive ();
+
+  MediaSet::getMediaSet ()->release (object->getId () );
+}
+
+void
+ClientSession::postEvent (std::function<void () > cb)
+{
+  EventHandler::post (cb);
+}
+
+ClientSession::StaticConstructor ClientSession::staticConstructor;
+
+ClientSession::StaticConstructor::StaticConstructor()
+{
+  GST_DEBUG_CATEGORY_INIT (GST_CAT_DEFAULT, GST_DEFAULT_NAME, 0,
+                           GST_DEFAULT_NAME);
+}
+
+} /* kurento */
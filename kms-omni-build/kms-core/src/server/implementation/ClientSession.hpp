@@ -0,0 +1,92 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __CLIENT_SESSION_HPP__
+#define __CLIENT_SESSION_HPP__
+
+#include <boost/property_tree/ptree.hpp>
+
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace kurento
+{
+
+class MediaObject;
+class MediaObjectImpl;
+
+/*
+ * Session used by server-side code to drive other media objects through the
+ * generated `<Type>Client` stubs, with direct typed calls instead of JSON
+ * requests.
+ *
+ * Objects created or looked up through a session are referenced by it in the
+ * MediaSet, so they are kept alive, reclaimed when idle and collected exactly
+ * like the objects of a remote session. Each call checks that the objects it
+ * involves have not been released, as the server does when it resolves the
+ * ids of a request. Calls run in the calling thread and complete
+ * synchronously, like requests that cannot be deferred, even when they are
+ * made while serving a deferrable request. Event handlers run in the same
+ * thread pool that sends events to remote clients.
+ *
+ * The objects only referenced by the session are released with it.
+ */
+class ClientSession
+{
+public:
+  ClientSession (const boost::property_tree::ptree &config,
+                 const std::string &sessionId = "");
+  ~ClientSession ();
+
+  const std::string &getId () const
+  {
+    return sessionId;
+  }
+
+  const boost::property_tree::ptree &getConfig () const
+  {
+    return config;
+  }
+
+  void keepAlive ();
+
+  /* Takes a newly created object, as Factory::createObject() does */
+  std::shared_ptr<MediaObjectImpl> adopt (MediaObjectImpl *object);
+  std::shared_ptr<MediaObjectImpl> getObject (const std::string &objectId);
+  /* Throws MEDIA_OBJECT_NOT_FOUND if the object is missing or released */
+  void checkObject (std::shared_ptr<MediaObject> object);
+  void release (std::shared_ptr<MediaObject> object);
+
+  static void postEvent (std::function<void () > cb);
+
+private:
+  boost::property_tree::ptree config;
+  std::string sessionId;
+
+  class StaticConstructor
+  {
+  public:
+    StaticConstructor();
+  };
+
+  static StaticConstructor staticConstructor;
+};
+
+} /* kurento */
+
+#endif /* __CLIENT_SESSION_HPP__ */
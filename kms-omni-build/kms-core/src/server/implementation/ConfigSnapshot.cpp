@@ -0,0 +1,159 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ConfigSnapshot.hpp"
+
+#include <gst/gst.h>
+
+#include <atomic>
+
+#define GST_CAT_DEFAULT kurento_config_snapshot
+GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
+#define GST_DEFAULT_NAME "KurentoConfigSnapshot"
+
+namespace kurento
+{
+
+struct PublishedSnapshot {
+  const boost::property_tree::ptree *config;
+  std::shared_ptr<const ConfigSnapshot> snapshot;
+};
+
+static std::shared_ptr<const PublishedSnapshot> published;
+
+/* Same layout produced by boost::property_tree::write_json() */
+static Json::Value
+toJson (const boost::property_tree::ptree &tree)
+{
+  if (tree.empty () ) {
+    return Json::Value (tree.data () );
+  }
+
+  bool isArray = true;
+
+  for (const auto &child : tree) {
+    if (!child.first.empty () ) {
+      isArray = false;
+      break;
+    }
+  }
+
+  if (isArray) {
+    Json::Value array (Json::arrayValue);
+
+    for (const auto &child : tree) {
+      array.append (toJson (child.second) );
+    }
+
+    return array;
+  }
+
+  Json::Value object (Json::objectValue);
+
+  for (const auto &child : tree) {
+    // get_child() returns the first match for repeated keys
+    if (!object.isMember (child.first) ) {
+      object[child.first] = toJson (child.second);
+    }
+  }
+
+  return object;
+}
+
+ConfigSnapshot::ConfigSnapshot (const boost::property_tree::ptree &tree) :
+  root (toJson (tree) )
+{
+  // Values are indexed once the tree is complete, so addresses are stable
+  index (root, "");
+
+  GST_DEBUG ("Config snapshot created with %zu keys", values.size () );
+}
+
+void
+ConfigSnapshot::index (const Json::Value &value, const std::string &path)
+{
+  if (!value.isObject () ) {
+    return;
+  }
+
+  for (auto it = value.begin (); it != value.end (); it++) {
+    std::string key = path.empty () ? it.name () : path + "." + it.name ();
+
+    values[key] = & (*it);
+    index (*it, key);
+  }
+}
+
+const Json::Value *
+ConfigSnapshot::find (const std::string &key) const
+{
+  auto it = values.find (key);
+
+  if (it == values.end () ) {
+    return nullptr;
+  }
+
+  return it->second;
+}
+
+void
+ConfigSnapshot::logDeserializeError (const std::string &key,
+                                     const std::exception &e)
+{
+  GST_ERROR ("Error deserializing '%s' from config: %s", key.c_str (),
+             e.what () );
+}
+
+void
+ConfigSnapshot::publish (const boost::property_tree::ptree &config,
+                         std::shared_ptr<const ConfigSnapshot> snapshot)
+{
+  std::shared_ptr<PublishedSnapshot> entry;
+
+  if (snapshot) {
+    entry = std::make_shared<PublishedSnapshot> ();
+    entry->config = &config;
+    entry->snapshot = snapshot;
+  }
+
+  std::atomic_store (&published,
+                     std::shared_ptr<const PublishedSnapshot> (entry) );
+
+  GST_INFO ("Config snapshot %p published", snapshot.get () );
+}
+
+std::shared_ptr<const ConfigSnapshot>
+ConfigSnapshot::get (const boost::property_tree::ptree &config)
+{
+  std::shared_ptr<const PublishedSnapshot> entry = std::atomic_load (&published);
+
+  if (!entry || entry->config != &config) {
+    return nullptr;
+  }
+
+  return entry->snapshot;
+}
+
+ConfigSnapshot::StaticConstructor ConfigSnapshot::staticConstructor;
+
+ConfigSnapshot::StaticConstructor::StaticConstructor ()
+{
+  GST_DEBUG_CATEGORY_INIT (GST_CAT_DEFAULT, GST_DEFAULT_NAME, 0,
+                           GST_DEFAULT_NAME);
+}
+
+} /* kurento */
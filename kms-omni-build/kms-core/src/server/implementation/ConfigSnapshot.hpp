@@ -0,0 +1,165 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __CONFIG_SNAPSHOT_HPP__
+#define __CONFIG_SNAPSHOT_HPP__
+
+#include <boost/property_tree/ptree.hpp>
+#include <json/json.h>
+#include <jsonrpc/JsonSerializer.hpp>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+
+namespace kurento
+{
+
+/*
+ * Immutable view of the server configuration, converted once to JSON.
+ *
+ * Every path of the property tree is indexed, so looking up a key is a single
+ * hash lookup instead of a `get_child()` walk followed by a JSON write and
+ * parse round trip. The values keep the representation given by
+ * `write_json()` (all leaves are strings), so deserializing them behaves
+ * exactly as reading the property tree directly.
+ *
+ * The current snapshot is published for the property tree it was built
+ * from, and can be replaced at any time to reload configuration: objects
+ * created afterwards read the new values, while readers holding the old
+ * snapshot keep using it until they release it.
+ *
+ * Modules declare the configuration of their classes in the kmd files, and
+ * kurento-module-creator generates a typed struct for each of them
+ * (e.g. `WebRtcEndpointConfig`). Those structs are sections of the snapshot:
+ * they are deserialized the first time they are requested and shared by
+ * every later reader, so constructors only copy plain fields.
+ */
+class ConfigSnapshot
+{
+public:
+  ConfigSnapshot (const boost::property_tree::ptree &tree);
+  ConfigSnapshot (const ConfigSnapshot &) = delete;
+  ConfigSnapshot &operator= (const ConfigSnapshot &) = delete;
+
+  /* Returns nullptr if the key does not exist */
+  const Json::Value *find (const std::string &key) const;
+
+  /* Returns false if the key does not exist or has the wrong type */
+  template <class T>
+  bool read (T *value, const std::string &key) const
+  {
+    const Json::Value *found = find (key);
+
+    if (found == nullptr) {
+      return false;
+    }
+
+    return deserialize (value, *found, key);
+  }
+
+  /* Deserializes `json` as a configuration value */
+  template <class T>
+  static bool deserialize (T *value, const Json::Value &json,
+                           const std::string &key)
+  {
+    kurento::JsonSerializer serializer (false);
+    serializer.JsonValue["val"] = json;
+
+    try {
+      serializer.Serialize ("val", *value);
+    } catch (const std::exception &e) {
+      logDeserializeError (key, e);
+      return false;
+    }
+
+    return true;
+  }
+
+  /*
+   * Typed section `T` of this snapshot, built on first use with
+   * `T (const ConfigSnapshot &)`
+   */
+  template <class T>
+  std::shared_ptr<const T> getSection () const
+  {
+    std::unique_lock<std::mutex> lock (sectionsMutex);
+    std::shared_ptr<const void> &section = sections[std::type_index (typeid (
+        T) )];
+
+    if (!section) {
+      section = std::make_shared<const T> (*this);
+    }
+
+    return std::static_pointer_cast<const T> (section);
+  }
+
+  /*
+   * Typed section `T` of the snapshot published for `config`. Trees with no
+   * published snapshot (e.g. in tests) get a section built just for them.
+   */
+  template <class T>
+  static std::shared_ptr<const T> getSection (
+    const boost::property_tree::ptree &config)
+  {
+    std::shared_ptr<const ConfigSnapshot> snapshot = get (config);
+
+    if (!snapshot) {
+      return ConfigSnapshot (config).getSection<T> ();
+    }
+
+    return snapshot->getSection<T> ();
+  }
+
+  /*
+   * Make `snapshot` the configuration seen by the objects created with
+   * `config`. Passing nullptr removes it.
+   */
+  static void publish (const boost::property_tree::ptree &config,
+                       std::shared_ptr<const ConfigSnapshot> snapshot);
+
+  /* Returns nullptr if nothing was published for `config` */
+  static std::shared_ptr<const ConfigSnapshot> get (
+    const boost::property_tree::ptree &config);
+
+private:
+  void index (const Json::Value &value, const std::string &path);
+  static void logDeserializeError (const std::string &key,
+                                   const std::exception &e);
+
+  Json::Value root;
+  std::unordered_map<std::string, const Json::Value *> values;
+
+  /* Sections are a cache of `values`, so they are not part of the state */
+  mutable std::mutex sectionsMutex;
+  mutable std::unordered_map<std::type_index, std::shared_ptr<const void>>
+  sections;
+
+  class StaticConstructor
+  {
+  public:
+    StaticConstructor ();
+  };
+
+  static StaticConstructor staticConstructor;
+};
+
+} /* kurento */
+
+#endif /* __CONFIG_SNAPSHOT_HPP__ */
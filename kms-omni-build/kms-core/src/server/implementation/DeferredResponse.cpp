@@ -0,0 +1,180 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "DeferredResponse.hpp"
+#include "WorkerPool.hpp"
+
+#include <KurentoException.hpp>
+#include <gst/gst.h>
+
+#define GST_CAT_DEFAULT kurento_deferred_response
+GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
+#define GST_DEFAULT_NAME "KurentoDeferredResponse"
+
+namespace kurento
+{
+
+static thread_local DeferredResponse::Scope *currentScope = nullptr;
+
+static WorkerPool &
+getWorkers ()
+{
+  // Use a single thread pool for all deferred completions
+  static WorkerPool workers {};
+
+  return workers;
+}
+
+DeferredResponse::Scope::Scope (bool enabled) : previous (currentScope),
+  enabled (enabled)
+{
+  currentScope = this;
+}
+
+DeferredResponse::Scope::~Scope ()
+{
+  currentScope = previous;
+}
+
+std::shared_ptr<DeferredResponse>
+DeferredResponse::defer ()
+{
+  Scope *scope = currentScope;
+
+  if (scope == nullptr || !scope->enabled || scope->deferred) {
+    return nullptr;
+  }
+
+  scope->deferred = std::shared_ptr<DeferredResponse> (new DeferredResponse () );
+
+  GST_DEBUG ("Response deferred: %p", scope->deferred.get () );
+
+  return scope->deferred;
+}
+
+bool
+DeferredResponse::isDeferred ()
+{
+  return currentScope != nullptr && currentScope->deferred;
+}
+
+DeferredResponse::~DeferredResponse ()
+{
+  if (finished || !callback) {
+    return;
+  }
+
+  GST_WARNING ("Deferred response %p dropped without completion", this);
+
+  try {
+    callback (Json::Value::null, std::make_exception_ptr (KurentoException (
+                UNEXPECTED_ERROR, "Operation was abandoned before completion") ) );
+  } catch (...) {
+    GST_ERROR ("Error delivering abandoned deferred response");
+  }
+}
+
+void
+DeferredResponse::finish (const Json::Value &value, std::exception_ptr error)
+{
+  Callback cb;
+
+  {
+    std::unique_lock<std::mutex> lock (mutex);
+
+    if (finished) {
+      return;
+    }
+
+    finished = true;
+    this->value = value;
+    this->error = error;
+    cb = callback;
+  }
+
+  /* Not armed yet: arm() will deliver it */
+  if (cb) {
+    cb (value, error);
+  }
+}
+
+void
+DeferredResponse::complete ()
+{
+  finish (Json::Value::null, nullptr);
+}
+
+void
+DeferredResponse::completeValue (const Json::Value &value)
+{
+  finish (value, nullptr);
+}
+
+void
+DeferredResponse::fail (std::exception_ptr error)
+{
+  finish (Json::Value::null, error);
+}
+
+void
+DeferredResponse::arm (Callback callback)
+{
+  bool deliver;
+
+  {
+    std::unique_lock<std::mutex> lock (mutex);
+
+    this->callback = callback;
+    deliver = finished;
+  }
+
+  if (deliver) {
+    callback (value, error);
+  }
+}
+
+void
+DeferredResponse::cancel ()
+{
+  std::unique_lock<std::mutex> lock (mutex);
+
+  finished = true;
+  callback = nullptr;
+}
+
+void
+DeferredResponse::post (std::function<void () > task)
+{
+  getWorkers ().post (task);
+}
+
+void
+DeferredResponse::postAfter (std::chrono::steady_clock::duration delay,
+                             std::function<void () > task)
+{
+  getWorkers ().postAfter (delay, task);
+}
+
+DeferredResponse::StaticConstructor DeferredResponse::staticConstructor;
+
+DeferredResponse::StaticConstructor::StaticConstructor ()
+{
+  GST_DEBUG_CATEGORY_INIT (GST_CAT_DEFAULT, GST_DEFAULT_NAME, 0,
+                           GST_DEFAULT_NAME);
+}
+
+} /* kurento */
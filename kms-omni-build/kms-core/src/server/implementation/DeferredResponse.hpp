@@ -0,0 +1,153 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __DEFERRED_RESPONSE_HPP__
+#define __DEFERRED_RESPONSE_HPP__
+
+#include <jsonrpc/JsonSerializer.hpp>
+
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace kurento
+{
+
+/*
+ * Completion handle for an RPC method whose result is produced later.
+ *
+ * A method that would otherwise park the calling thread (waiting for a media
+ * state change, sleeping for a sampling period, walking a big pipeline...)
+ * calls `DeferredResponse::defer()` and returns immediately. The response is
+ * sent to the client once `complete()` or `fail()` is called on the handle,
+ * from whatever thread the media side signals completion.
+ *
+ * Deferring is only possible while the request is being dispatched inside a
+ * `DeferredResponse::Scope`, which the server opens for single requests that
+ * come from a transport able to send responses asynchronously. Everywhere
+ * else (batches, transactions, direct C++ calls) `defer()` returns nullptr
+ * and the method has to complete synchronously, as it always did.
+ */
+class DeferredResponse : public std::enable_shared_from_this<DeferredResponse>
+{
+public:
+  typedef std::function<void (const Json::Value &value,
+                              std::exception_ptr error) > Callback;
+
+  ~DeferredResponse ();
+
+  /*
+   * Claim the response of the request being dispatched in this thread.
+   * Returns nullptr if the request cannot be deferred.
+   */
+  static std::shared_ptr<DeferredResponse> defer ();
+
+  /* Whether the method running in this thread has deferred its response */
+  static bool isDeferred ();
+
+  void complete ();
+  void completeValue (const Json::Value &value);
+  void fail (std::exception_ptr error);
+
+  template <typename T>
+  void complete (T ret)
+  {
+    JsonSerializer responseSerializer (true);
+
+    responseSerializer.SerializeNVP (ret);
+    completeValue (responseSerializer.JsonValue["ret"]);
+  }
+
+  /* Run blocking work in a shared pool and complete with its result */
+  template <typename T>
+  void completeAsync (std::function<T () > work)
+  {
+    std::shared_ptr<DeferredResponse> self = shared_from_this ();
+
+    post ([self, work] () {
+      try {
+        self->complete<T> (work () );
+      } catch (...) {
+        self->fail (std::current_exception () );
+      }
+    });
+  }
+
+  static void post (std::function<void () > task);
+  static void postAfter (std::chrono::steady_clock::duration delay,
+                         std::function<void () > task);
+
+  /*
+   * Opens a deferrable dispatch in the current thread. Once the request
+   * handler returns, `getDeferred()` tells whether the method took the
+   * response; in that case the caller must `arm()` it with the function
+   * that sends the response, or `cancel()` it if the request failed anyway.
+   *
+   * A scope opened with `enabled = false` hides any outer one, so that
+   * requests nested in a transaction are always completed synchronously.
+   */
+  class Scope
+  {
+  public:
+    Scope (bool enabled = true);
+    ~Scope ();
+
+    std::shared_ptr<DeferredResponse> getDeferred () const
+    {
+      return deferred;
+    }
+
+  private:
+    Scope *previous;
+    bool enabled;
+    std::shared_ptr<DeferredResponse> deferred;
+
+    friend class DeferredResponse;
+  };
+
+  /*
+   * Install the function that delivers the result. If the method already
+   * completed, it is called right away from the current thread.
+   */
+  void arm (Callback callback);
+  void cancel ();
+
+private:
+  DeferredResponse () = default;
+
+  void finish (const Json::Value &value, std::exception_ptr error);
+
+  std::mutex mutex;
+  Callback callback;
+  bool finished = false;
+  Json::Value value;
+  std::exception_ptr error;
+
+  class StaticConstructor
+  {
+  public:
+    StaticConstructor ();
+  };
+
+  static StaticConstructor staticConstructor;
+};
+
+} /* kurento */
+
+#endif /* __DEFERRED_RESPONSE_HPP__ */
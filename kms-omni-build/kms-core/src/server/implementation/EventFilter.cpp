@@ -0,0 +1,168 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "EventFilter.hpp"
+
+#include <KurentoException.hpp>
+
+#define FIELDS "fields"
+#define MAX_RATE "maxRate"
+#define LATEST_ONLY "latestOnly"
+
+namespace kurento
+{
+
+EventFilter::EventFilter (const Json::Value &spec) : spec (spec)
+{
+  if (!spec.isObject () ) {
+    throw KurentoException (MEDIA_OBJECT_ILLEGAL_PARAM_ERROR,
+                            "Event filter must be an object");
+  }
+
+  for (const std::string &name : spec.getMemberNames () ) {
+    const Json::Value &value = spec[name];
+
+    if (name == FIELDS) {
+      if (!value.isObject () ) {
+        throw KurentoException (MEDIA_OBJECT_ILLEGAL_PARAM_ERROR,
+                                "Event filter '" FIELDS "' must be an object");
+      }
+
+      for (const std::string &field : value.getMemberNames () ) {
+        fields[field] = value[field];
+      }
+    } else if (name == MAX_RATE) {
+      if (!value.isNumeric () || value.asDouble () <= 0) {
+        throw KurentoException (MEDIA_OBJECT_ILLEGAL_PARAM_ERROR,
+                                "Event filter '" MAX_RATE "' must be a positive number");
+      }
+
+      minInterval = std::chrono::duration_cast<Clock::duration> (
+                      std::chrono::duration<double> (1.0 / value.asDouble () ) );
+    } else if (name == LATEST_ONLY) {
+      if (!value.isBool () ) {
+        throw KurentoException (MEDIA_OBJECT_ILLEGAL_PARAM_ERROR,
+                                "Event filter '" LATEST_ONLY "' must be a boolean");
+      }
+
+      latestOnly = value.asBool ();
+    } else {
+      throw KurentoException (MEDIA_OBJECT_ILLEGAL_PARAM_ERROR,
+                              "Unknown event filter option '" + name + "'");
+    }
+  }
+}
+
+bool
+EventFilter::matches (const FieldGetter &getField) const
+{
+  for (auto &predicate : fields) {
+    Json::Value value;
+
+    if (!getField (predicate.first, value) || value != predicate.second) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void
+EventFilter::submit (std::function<void () > send, const Scheduler &schedule,
+                     Clock::time_point now)
+{
+  std::unique_lock<std::mutex> lock (mutex);
+  Clock::duration wait = Clock::duration::zero ();
+
+  if (sent && now < lastSent + minInterval) {
+    wait = lastSent + minInterval - now;
+  }
+
+  if (!latestOnly) {
+    if (wait > Clock::duration::zero () ) {
+      dropped++;
+      return;
+    }
+
+    sent = true;
+    lastSent = now;
+    lock.unlock ();
+
+    schedule (Clock::duration::zero (), send);
+    return;
+  }
+
+  if (pending) {
+    dropped++;
+  }
+
+  pending = send;
+
+  if (scheduled) {
+    // The queued flush will send this one instead
+    return;
+  }
+
+  // The slot is taken now so that later events wait for this one
+  scheduled = true;
+  sent = true;
+  lastSent = now + wait;
+
+  std::shared_ptr<EventFilter> self = shared_from_this ();
+  lock.unlock ();
+
+  schedule (wait, [self] () {
+    self->flush ();
+  });
+}
+
+void
+EventFilter::flush ()
+{
+  std::function<void () > send;
+
+  {
+    std::unique_lock<std::mutex> lock (mutex);
+
+    send.swap (pending);
+    scheduled = false;
+  }
+
+  if (send) {
+    send ();
+  }
+}
+
+std::string
+EventFilter::getKey () const
+{
+  Json::StreamWriterBuilder writerFactory;
+
+  writerFactory["indentation"] = "";
+
+  return Json::writeString (writerFactory, spec);
+}
+
+uint64_t
+EventFilter::getDropped () const
+{
+  std::unique_lock<std::mutex> lock (mutex);
+
+  return dropped;
+}
+
+} /* kurento */
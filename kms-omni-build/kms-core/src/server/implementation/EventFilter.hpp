@@ -0,0 +1,90 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __EVENT_FILTER_HPP__
+#define __EVENT_FILTER_HPP__
+
+#include <json/json.h>
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace kurento
+{
+
+/*
+ * Server-side filter of an event subscription, given by the client in the
+ * "filter" parameter of `subscribe`:
+ *
+ *   {
+ *     "fields": { "mediaType": "VIDEO", "state": "FLOWING" },
+ *     "maxRate": 2,
+ *     "latestOnly": true
+ *   }
+ *
+ * `fields` are equality predicates on the event properties, checked before
+ * the event is copied or serialized. `maxRate` is the maximum number of
+ * events per second: extra events are dropped, or, with `latestOnly`,
+ * coalesced so that only the most recent one is sent when the rate allows
+ * it. `latestOnly` alone coalesces events that are still waiting to be sent.
+ */
+class EventFilter : public std::enable_shared_from_this<EventFilter>
+{
+public:
+  typedef std::chrono::steady_clock Clock;
+  typedef std::function<bool (const std::string &field, Json::Value &value) >
+  FieldGetter;
+  typedef std::function<void (Clock::duration delay,
+                              std::function<void () > task) > Scheduler;
+
+  /* Throws KurentoException if the filter is not valid */
+  EventFilter (const Json::Value &spec);
+
+  bool matches (const FieldGetter &getField) const;
+
+  /* Hands `send` to `schedule` now, later or never, as the limits allow */
+  void submit (std::function<void () > send, const Scheduler &schedule,
+               Clock::time_point now = Clock::now () );
+
+  /* Canonical form, equal for equivalent filters */
+  std::string getKey () const;
+
+  uint64_t getDropped () const;
+
+private:
+  void flush ();
+
+  std::map<std::string, Json::Value> fields;
+  Clock::duration minInterval = Clock::duration::zero ();
+  bool latestOnly = false;
+  Json::Value spec;
+
+  mutable std::mutex mutex;
+  bool sent = false;
+  Clock::time_point lastSent;
+  std::function<void () > pending;
+  bool scheduled = false;
+  uint64_t dropped = 0;
+};
+
+} /* kurento */
+
+#endif /* __EVENT_FILTER_HPP__ */
@@ -21,13 +21,29 @@
 namespace kurento
 {
 
-static void
-post_task (std::function <void () > cb)
+static kurento::WorkerPool &
+get_workers ()
 {
   // Use a single thread pool for all EventHandlers
   static kurento::WorkerPool workers {};
 
-  workers.post (cb);
+  return workers;
+}
+
+static void
+post_task (std::function <void () > cb)
+{
+  get_workers ().post (cb);
+}
+
+static void
+schedule_task (EventFilter::Clock::duration delay, std::function <void () > cb)
+{
+  if (delay > EventFilter::Clock::duration::zero () ) {
+    get_workers ().postAfter (delay, cb);
+  } else {
+    get_workers ().post (cb);
+  }
 }
 
 EventHandler::EventHandler (std::shared_ptr <MediaObjectImpl> object) :
@@ -49,6 +65,16 @@ EventHandler::~EventHandler()
 
 void
 EventHandler::sendEventAsync  (std::function <void () > cb)
+{
+  if (filter) {
+    filter->submit (cb, schedule_task);
+  } else {
+    post_task (cb);
+  }
+}
+
+void
+EventHandler::post (std::function <void () > cb)
 {
   post_task (cb);
 }
@@ -24,6 +24,8 @@
 #include <json/json.h>
 #include <functional>
 
+#include "EventFilter.hpp"
+
 namespace kurento
 {
 
@@ -38,6 +40,25 @@ public:
 
   virtual void sendEvent (Json::Value &value) = 0;
   void sendEventAsync  (std::function <void () > cb);
+  /* Runs cb in the thread pool where events are sent */
+  static void post (std::function <void () > cb);
+
+  /* Set before connecting the handler, it is not changed afterwards */
+  void setFilter (std::shared_ptr<EventFilter> filter)
+  {
+    this->filter = filter;
+  }
+
+  std::shared_ptr<EventFilter> getFilter () const
+  {
+    return filter;
+  }
+
+  /* Whether an event with these fields passes the subscription filter */
+  bool accepts (const EventFilter::FieldGetter &getField) const
+  {
+    return !filter || filter->matches (getField);
+  }
 
   void setConnection (sigc::connection conn)
   {
@@ -47,6 +68,7 @@ public:
 private:
   std::weak_ptr<MediaObjectImpl> object;
   sigc::connection conn;
+  std::shared_ptr<EventFilter> filter;
 };
 
 } /* kurento */
@@ -22,7 +22,9 @@
 #include <MediaPipelineImpl.hpp>
 #include <ServerManagerImpl.hpp>
 
+#include <algorithm>
 #include <functional>
+#include <malloc.h>
 
 /* This is included to avoid problems with slots and lamdas */
 #include <memory>
@@ -40,7 +42,19 @@ static const std::chrono::seconds COLLECTOR_INTERVAL_DEFAULT =
   std::chrono::seconds (
     240);
 
+/* Pausing a pipeline stops its endpoints, and WebRtcEndpoint loses its
+ * ICE/DTLS/SRTP state with it, so staging is only done when configured */
+static const std::chrono::seconds PAUSE_TIMEOUT_DEFAULT =
+  std::chrono::seconds (0);
+static const std::chrono::seconds TRIM_TIMEOUT_DEFAULT =
+  std::chrono::seconds (0);
+
 std::chrono::seconds MediaSet::collectorInterval = COLLECTOR_INTERVAL_DEFAULT;
+std::chrono::seconds MediaSet::pauseTimeout = PAUSE_TIMEOUT_DEFAULT;
+std::chrono::seconds MediaSet::trimTimeout = TRIM_TIMEOUT_DEFAULT;
+
+static std::mutex clockMutex;
+static MediaSet::Clock clockFunc;
 
 void
 MediaSet::setCollectorInterval (std::chrono::seconds interval)
@@ -54,6 +68,95 @@ MediaSet::getCollectorInterval()
   return collectorInterval;
 }
 
+void
+MediaSet::setIdleTimeouts (std::chrono::seconds pause,
+                           std::chrono::seconds trim)
+{
+  pauseTimeout = pause;
+  trimTimeout = trim;
+}
+
+std::chrono::seconds
+MediaSet::getPauseTimeout()
+{
+  return pauseTimeout;
+}
+
+std::chrono::seconds
+MediaSet::getTrimTimeout()
+{
+  return trimTimeout;
+}
+
+std::chrono::seconds
+MediaSet::getCheckInterval()
+{
+  std::chrono::seconds shortest = collectorInterval;
+
+  if (pauseTimeout.count() > 0 && pauseTimeout < shortest) {
+    shortest = pauseTimeout;
+  }
+
+  if (trimTimeout.count() > 0 && trimTimeout < shortest) {
+    shortest = trimTimeout;
+  }
+
+  // A stage is reached at most a quarter of its timeout late
+  return std::max (shortest / 4, std::chrono::seconds (1) );
+}
+
+void
+MediaSet::setClock (Clock clock)
+{
+  std::unique_lock <std::mutex> lock (clockMutex);
+
+  clockFunc = clock;
+}
+
+std::chrono::steady_clock::time_point
+MediaSet::now ()
+{
+  std::unique_lock <std::mutex> lock (clockMutex);
+
+  if (clockFunc) {
+    return clockFunc ();
+  }
+
+  return std::chrono::steady_clock::now ();
+}
+
+static const char *
+stage_name (MediaSet::SessionStage stage)
+{
+  switch (stage) {
+  case MediaSet::SessionStage::ACTIVE:
+    return "active";
+
+  case MediaSet::SessionStage::PAUSED:
+    return "paused";
+
+  case MediaSet::SessionStage::TRIMMED:
+    return "trimmed";
+  }
+
+  return "unknown";
+}
+
+static GstState
+stage_state (MediaSet::SessionStage stage)
+{
+  switch (stage) {
+  case MediaSet::SessionStage::PAUSED:
+    return GST_STATE_READY;
+
+  case MediaSet::SessionStage::TRIMMED:
+    return GST_STATE_NULL;
+
+  default:
+    return GST_STATE_PLAYING;
+  }
+}
+
 
 static std::shared_ptr<MediaSet> mediaSet;
 static std::recursive_mutex mutex;
@@ -113,23 +216,164 @@ MediaSet::deleteMediaSet()
 
 void MediaSet::doGarbageCollection ()
 {
+  std::unique_lock <std::mutex> collectLock (collectMutex);
   std::unique_lock <std::recursive_mutex> lock (recMutex);
-  auto sessions = sessionInUse;
+  auto time = now();
+  std::list<std::string> expired;
+  std::map<std::string, std::pair<std::shared_ptr<MediaPipelineImpl>, SessionStage>>
+      targets;
+  std::list<std::pair<std::shared_ptr<MediaPipelineImpl>, SessionStage>> changes;
+  bool trimmed = false;
+
+  GST_DEBUG ("Running garbage collector");
+
+  for (auto &it : sessionState) {
+    auto idle = time - it.second.lastSeen;
+    SessionStage stage = SessionStage::ACTIVE;
+
+    if (idle >= collectorInterval) {
+      expired.push_back (it.first);
+      continue;
+    }
+
+    if (trimTimeout.count() > 0 && idle >= trimTimeout) {
+      stage = SessionStage::TRIMMED;
+    } else if (pauseTimeout.count() > 0 && idle >= pauseTimeout) {
+      stage = SessionStage::PAUSED;
+    }
+
+    if (stage != it.second.stage) {
+      GST_INFO ("Session %s is idle, now %s", it.first.c_str(),
+                stage_name (stage) );
+      it.second.stage = stage;
+    }
+  }
+
+  /* A pipeline goes as far as the most active of its sessions allows */
+  for (auto &it : sessionMap) {
+    auto state = sessionState.find (it.first);
+    SessionStage stage = SessionStage::ACTIVE;
+
+    if (state != sessionState.end() ) {
+      stage = state->second.stage;
+    }
+
+    for (auto &obj : it.second) {
+      auto pipeline = std::dynamic_pointer_cast<MediaPipelineImpl> (obj.second);
+
+      if (!pipeline) {
+        continue;
+      }
+
+      auto target = targets.find (obj.first);
+
+      if (target == targets.end() ) {
+        targets[obj.first] = std::make_pair (pipeline, stage);
+      } else if (stage < target->second.second) {
+        target->second.second = stage;
+      }
+    }
+  }
+
+  for (auto it = pipelineStage.begin(); it != pipelineStage.end(); ) {
+    if (targets.find (it->first) == targets.end() ) {
+      it = pipelineStage.erase (it);
+    } else {
+      ++it;
+    }
+  }
+
+  for (auto &it : targets) {
+    auto current = pipelineStage.find (it.first);
+    SessionStage stage = it.second.second;
+
+    if (current == pipelineStage.end() ) {
+      if (stage == SessionStage::ACTIVE) {
+        continue;
+      }
+    } else if (current->second == stage) {
+      continue;
+    }
+
+    if (stage == SessionStage::ACTIVE) {
+      pipelineStage.erase (it.first);
+    } else {
+      pipelineStage[it.first] = stage;
+    }
+
+    trimmed |= (stage == SessionStage::TRIMMED);
+    changes.push_back (it.second);
+  }
 
   lock.unlock();
 
-  GST_DEBUG ("Running garbage collector");
+  /* Changing the state can take a while, do not block other requests */
+  for (auto &it : changes) {
+    it.first->setIdleState (stage_state (it.second) );
+  }
 
-  for (auto it : sessions) {
-    if (it.second) {
-      lock.lock();
-      sessionInUse[it.first] = false;
-      lock.unlock();
+  if (trimmed) {
+    /* Give back to the system what the pipelines released */
+    malloc_trim (0);
+  }
+
+  for (auto &it : expired) {
+    GST_WARNING ("Removing inactive session: %s", it.c_str() );
+    unrefSession (it);
+
+    lock.lock();
+    collectedSessions++;
+    lock.unlock();
+  }
+}
+
+MediaSet::SessionStage
+MediaSet::getSessionStage (const std::string &sessionId)
+{
+  std::unique_lock <std::recursive_mutex> lock (recMutex);
+  auto it = sessionState.find (sessionId);
+
+  if (it == sessionState.end() ) {
+    throw KurentoException (INVALID_SESSION, "Invalid session");
+  }
+
+  return it->second.stage;
+}
+
+MediaSet::ReclaimStats
+MediaSet::getReclaimStats ()
+{
+  std::unique_lock <std::recursive_mutex> lock (recMutex);
+  ReclaimStats stats = {};
+
+  for (auto &it : sessionState) {
+    switch (it.second.stage) {
+    case SessionStage::ACTIVE:
+      stats.activeSessions++;
+      break;
+
+    case SessionStage::PAUSED:
+      stats.pausedSessions++;
+      break;
+
+    case SessionStage::TRIMMED:
+      stats.trimmedSessions++;
+      break;
+    }
+  }
+
+  for (auto &it : pipelineStage) {
+    if (it.second == SessionStage::PAUSED) {
+      stats.pausedPipelines++;
     } else {
-      GST_WARNING ("Removing inactive session: %s", it.first.c_str() );
-      unrefSession (it.first);
+      stats.trimmedPipelines++;
     }
   }
+
+  stats.resumedSessions = resumedSessions;
+  stats.collectedSessions = collectedSessions;
+
+  return stats;
 }
 
 MediaSet::MediaSet () : workers {}
@@ -139,18 +383,25 @@ MediaSet::MediaSet () : workers {}
   thread = std::thread ( [&] () {
     std::unique_lock <std::recursive_mutex> lock (recMutex);
 
-    while (!terminated && waitCond.wait_for (lock,
-           collectorInterval) == std::cv_status::timeout) {
+    while (!terminated) {
+      waitCond.wait_for (lock, getCheckInterval(), [this] () {
+        return terminated || resumePending;
+      });
 
       if (terminated) {
         return;
       }
 
+      resumePending = false;
+      lock.unlock();
+
       try {
         doGarbageCollection();
       } catch (...) {
         GST_ERROR ("Error during garbage collection");
       }
+
+      lock.lock();
     }
 
   });
@@ -299,16 +550,26 @@ MediaSet::keepAliveSession (const std::string &sessionId, bool create)
 {
   std::unique_lock <std::recursive_mutex> lock (recMutex);
 
-  auto it = sessionInUse.find (sessionId);
+  auto it = sessionState.find (sessionId);
 
-  if (it == sessionInUse.end() ) {
+  if (it == sessionState.end() ) {
     if (create) {
-      sessionInUse[sessionId] = true;
+      sessionState[sessionId] = {now(), SessionStage::ACTIVE};
     } else {
       throw KurentoException (INVALID_SESSION, "Invalid session");
     }
   } else {
-    it->second = true;
+    it->second.lastSeen = now();
+
+    if (it->second.stage != SessionStage::ACTIVE) {
+      GST_INFO ("Session %s is back, resuming it", sessionId.c_str() );
+      it->second.stage = SessionStage::ACTIVE;
+      resumedSessions++;
+
+      /* Let the collector thread restart its pipelines */
+      resumePending = true;
+      waitCond.notify_all();
+    }
   }
 }
 
@@ -328,7 +589,7 @@ MediaSet::releaseSession (const std::string &sessionId)
   }
 
   sessionMap.erase (sessionId);
-  sessionInUse.erase (sessionId);
+  sessionState.erase (sessionId);
   eventHandler.erase (sessionId);
   lock.unlock ();
 
@@ -350,7 +611,7 @@ MediaSet::unrefSession (const std::string &sessionId)
   }
 
   sessionMap.erase (sessionId);
-  sessionInUse.erase (sessionId);
+  sessionState.erase (sessionId);
   eventHandler.erase (sessionId);
 
   lock.unlock();
@@ -27,6 +27,8 @@
 #include <thread>
 #include <condition_variable>
 #include <atomic>
+#include <chrono>
+#include <functional>
 
 #include "WorkerPool.hpp"
 
@@ -40,6 +42,31 @@ class ServerManagerImpl;
 class MediaSet
 {
 public:
+  /*
+   * Sessions that stop sending keep-alives are reclaimed in stages: first
+   * their pipelines are paused to free CPU, later they release the rest of
+   * their resources, and finally, after the collector interval, the session
+   * is removed. Until then any request or keep-alive resumes it. The first
+   * two stages are disabled unless their timeouts are set.
+   */
+  enum class SessionStage {
+    ACTIVE,
+    PAUSED,
+    TRIMMED
+  };
+
+  struct ReclaimStats {
+    int activeSessions;
+    int pausedSessions;
+    int trimmedSessions;
+    int pausedPipelines;
+    int trimmedPipelines;
+    int64_t resumedSessions;
+    int64_t collectedSessions;
+  };
+
+  typedef std::function<std::chrono::steady_clock::time_point () > Clock;
+
   ~MediaSet ();
 
   void ref (const std::string &sessionId,
@@ -62,6 +89,11 @@ public:
   void releaseSession (const std::string &sessionId);
   void unrefSession (const std::string &sessionId);
   void keepAliveSession (const std::string &sessionId);
+  SessionStage getSessionStage (const std::string &sessionId);
+
+  /* Runs a pass of the collector, it is also run periodically */
+  void doGarbageCollection ();
+  ReclaimStats getReclaimStats ();
 
   void release (std::shared_ptr<MediaObjectImpl> mediaObject);
   void release (const std::string &mediaObjectRef);
@@ -85,14 +117,28 @@ public:
   static void deleteMediaSet();
   static void setCollectorInterval (std::chrono::seconds interval);
   static std::chrono::seconds getCollectorInterval();
+  /* Idle time before pausing and trimming a session, 0 disables the stage */
+  static void setIdleTimeouts (std::chrono::seconds pause,
+                               std::chrono::seconds trim);
+  static std::chrono::seconds getPauseTimeout();
+  static std::chrono::seconds getTrimTimeout();
+  /* How often sessions are checked, and so how often to keep them alive */
+  static std::chrono::seconds getCheckInterval();
+  /* Replaces the steady clock, for tests. An empty function restores it */
+  static void setClock (Clock clock);
 
   sigc::signal<void> signalEmptyLocked;
   sigc::signal<void> signalEmpty;
 
 private:
 
+  struct SessionState {
+    std::chrono::steady_clock::time_point lastSeen;
+    SessionStage stage;
+  };
+
   void keepAliveSession (const std::string &sessionId, bool create);
-  void doGarbageCollection ();
+  static std::chrono::steady_clock::time_point now ();
 
   std::thread thread;
 
@@ -108,6 +154,9 @@ private:
   std::recursive_mutex recMutex;
   std::condition_variable_any waitCond;
   std::atomic<bool> terminated{};
+  bool resumePending = false;
+  /* Serializes collector passes, taken before recMutex */
+  std::mutex collectMutex;
 
   std::shared_ptr <ServerManagerImpl> serverManager;
 
@@ -141,8 +190,16 @@ private:
 
   std::map<
       std::string,  // Session ID
-      bool
-  > sessionInUse;
+      SessionState
+  > sessionState;
+
+  std::map<
+      std::string,  // Pipeline ID
+      SessionStage  // Never ACTIVE
+  > pipelineStage;
+
+  int64_t resumedSessions = 0;
+  int64_t collectedSessions = 0;
 
   std::map<
       std::string,  // Session ID
@@ -158,6 +215,8 @@ private:
   WorkerPool workers;
 
   static std::chrono::seconds collectorInterval;
+  static std::chrono::seconds pauseTimeout;
+  static std::chrono::seconds trimTimeout;
 
   class StaticConstructor
   {
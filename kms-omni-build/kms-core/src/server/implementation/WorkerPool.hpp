@@ -24,6 +24,7 @@
 #include <boost/thread/thread.hpp>
 
 #include <chrono>
+#include <memory>
 
 namespace kurento
 {
@@ -46,6 +47,22 @@ public:
     return io_service.post (handler);
   }
 
+  /*
+   * Run `handler` in the thread pool once `delay` has elapsed, without
+   * blocking any thread while waiting.
+   */
+  template <typename CompletionHandler>
+  void
+  postAfter (std::chrono::steady_clock::duration delay,
+      CompletionHandler handler)
+  {
+    auto timer = std::make_shared<boost::asio::steady_timer> (io_service);
+
+    timer->expires_from_now (delay);
+    timer->async_wait (
+        [timer, handler] (const boost::system::error_code &) { handler (); });
+  }
+
 private:
   // Boost Asio tools for handling a thread pool
   boost::asio::io_service io_service; // Boost Asio task runner
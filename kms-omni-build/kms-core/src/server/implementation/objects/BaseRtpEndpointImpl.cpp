@@ -17,6 +17,7 @@
 
 #include <gst/gst.h>
 #include "BaseRtpEndpointImpl.hpp"
+#include "BaseRtpEndpointConfig.hpp"
 #include <jsonrpc/JsonSerializer.hpp>
 #include <KurentoException.hpp>
 #include <MediaState.hpp>
@@ -47,9 +48,6 @@ GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
 #define KMS_STATISTIC_FIELD_PREFIX_SESSION "session-"
 #define KMS_STATISTIC_FIELD_PREFIX_SSRC "ssrc-"
 
-#define PARAM_MIN_PORT "minPort"
-#define PARAM_MAX_PORT "maxPort"
-#define PARAM_MTU "mtu"
 
 #define PROP_MIN_PORT "min-port"
 #define PROP_MAX_PORT "max-port"
@@ -96,20 +94,22 @@ BaseRtpEndpointImpl::BaseRtpEndpointImpl (const boost::property_tree::ptree
                        (ConnectionState::DISCONNECTED);
   connStateChangedHandlerId = 0;
 
-  guint minPort = 0;
-  if (getConfigValue<guint, BaseRtpEndpoint> (&minPort, PARAM_MIN_PORT)) {
-    g_object_set (getGstreamerElement (), PROP_MIN_PORT, minPort, NULL);
+  std::shared_ptr<const BaseRtpEndpointConfig> rtpConfig =
+    BaseRtpEndpointConfig::get (config);
+
+  if (rtpConfig->__isSetMinPort) {
+    g_object_set (getGstreamerElement (), PROP_MIN_PORT,
+                  (guint) rtpConfig->minPort, NULL);
   }
 
-  guint maxPort = 0;
-  if (getConfigValue <guint, BaseRtpEndpoint> (&maxPort, PARAM_MAX_PORT)) {
-    g_object_set (getGstreamerElement (), PROP_MAX_PORT, maxPort, NULL);
+  if (rtpConfig->__isSetMaxPort) {
+    g_object_set (getGstreamerElement (), PROP_MAX_PORT,
+                  (guint) rtpConfig->maxPort, NULL);
   }
 
-  guint mtu;
-  if (getConfigValue <guint, BaseRtpEndpoint> (&mtu, PARAM_MTU)) {
-    GST_INFO ("Predefined RTP MTU: %u", mtu);
-    g_object_set (G_OBJECT (element), PROP_MTU, mtu, NULL);
+  if (rtpConfig->__isSetMtu) {
+    GST_INFO ("Predefined RTP MTU: %d", rtpConfig->mtu);
+    g_object_set (G_OBJECT (element), PROP_MTU, (guint) rtpConfig->mtu, NULL);
   } else {
     GST_DEBUG ("No predefined RTP MTU found in config; using default");
   }
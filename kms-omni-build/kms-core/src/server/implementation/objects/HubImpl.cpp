@@ -16,6 +16,8 @@
  */
 #include <gst/gst.h>
 #include "HubImpl.hpp"
+#include "HubPortImpl.hpp"
+#include <MediaSet.hpp>
 #include <jsonrpc/JsonSerializer.hpp>
 #include <KurentoException.hpp>
 #include <MediaPipelineImpl.hpp>
@@ -43,6 +45,23 @@ std::string HubImpl::getGstreamerDot()
       std::make_shared<GstreamerDotDetails>(GstreamerDotDetails::SHOW_VERBOSE));
 }
 
+std::vector<std::shared_ptr<HubPortImpl>> HubImpl::getPorts ()
+{
+  std::vector<std::shared_ptr<HubPortImpl>> ports;
+
+  for (auto child : MediaSet::getMediaSet ()->getChildren (
+         std::dynamic_pointer_cast<MediaObjectImpl> (shared_from_this () ) ) ) {
+    std::shared_ptr<HubPortImpl> port =
+      std::dynamic_pointer_cast<HubPortImpl> (child);
+
+    if (port) {
+      ports.push_back (port);
+    }
+  }
+
+  return ports;
+}
+
 HubImpl::HubImpl (const boost::property_tree::ptree &config,
                   std::shared_ptr<MediaObjectImpl> parent,
                   const std::string &factoryName) : MediaObjectImpl (config, parent)
@@ -26,6 +26,7 @@ namespace kurento
 {
 
 class HubImpl;
+class HubPortImpl;
 
 void Serialize (std::shared_ptr<HubImpl> &object, JsonSerializer &serializer);
 
@@ -45,6 +46,12 @@ public:
     return element;
   }
 
+  /* Ports currently attached to this hub */
+  std::vector<std::shared_ptr<HubPortImpl>> getPorts ();
+
+  /* Emitted once a new port is attached and ready to be connected */
+  sigc::signal<void, std::shared_ptr<HubPortImpl>> signalPortAdded;
+
   virtual std::string getGstreamerDot ();
   virtual std::string getGstreamerDot (std::shared_ptr<GstreamerDotDetails>
                                        details);
@@ -38,6 +38,18 @@ HubPortImpl::HubPortImpl (const boost::property_tree::ptree &config,
                          element, &handlerId);
 }
 
+void
+HubPortImpl::postConstructor ()
+{
+  std::shared_ptr<HubImpl> hub;
+
+  MediaElementImpl::postConstructor ();
+
+  hub = std::dynamic_pointer_cast<HubImpl> (getParent() );
+  hub->signalPortAdded.emit (std::dynamic_pointer_cast<HubPortImpl>
+                             (shared_from_this() ) );
+}
+
 HubPortImpl::~HubPortImpl()
 {
   g_signal_emit_by_name (std::dynamic_pointer_cast<HubImpl>
@@ -56,6 +56,9 @@ public:
 
   virtual void Serialize (JsonSerializer &serializer) override;
 
+protected:
+  virtual void postConstructor () override;
+
 private:
   int handlerId{};
 
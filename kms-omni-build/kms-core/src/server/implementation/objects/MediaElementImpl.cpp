@@ -17,6 +17,8 @@
 #include <gst/gst.h>
 #include "MediaType.hpp"
 #include "MediaLatencyStat.hpp"
+#include "BitrateTier.hpp"
+#include "EncoderStats.hpp"
 #include "MediaType.hpp"
 #include "AudioCaps.hpp"
 #include "VideoCaps.hpp"
@@ -36,6 +38,7 @@
 #include "ElementStats.hpp"
 #include "kmsstats.h"
 #include <SignalHandler.hpp>
+#include <DeferredResponse.hpp>
 
 #include <chrono>
 #include <memory>
@@ -49,6 +52,9 @@ GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
 
 #define MIN_OUTPUT_BITRATE "min-output-bitrate"
 #define MAX_OUTPUT_BITRATE "max-output-bitrate"
+#define MAX_OUTPUT_TIERS "max-output-tiers"
+#define OUTPUT_GOP_CACHE_SIZE "output-gop-cache-size"
+#define OUTPUT_SMOOTH_KEYFRAMES "output-smooth-keyframes"
 
 #define TYPE_VIDEO "video_"
 #define TYPE_AUDIO "audio_"
@@ -666,14 +672,10 @@ MediaElementImpl::postConstructor ()
 
   const auto pipelineImpl =
       std::dynamic_pointer_cast<MediaPipelineImpl> (getMediaPipeline ());
-  GstBus *bus =
-      gst_pipeline_get_bus (GST_PIPELINE (pipelineImpl->getPipeline ()));
-  gst_bus_add_signal_watch (bus);
-  busMessageHandler = register_signal_handler (G_OBJECT (bus), "message",
-      std::function<void (GstBus *, GstMessage *)> (std::bind (
-          &MediaElementImpl::processBusMessage, this, std::placeholders::_2)),
-      std::dynamic_pointer_cast<MediaElementImpl> (shared_from_this ()));
-  g_object_unref (bus);
+  pipelineImpl->addBusMessageHandler (element,
+      std::bind (&MediaElementImpl::processBusMessage, this,
+          std::placeholders::_1),
+      shared_from_this ());
 
   mediaFlowOutHandler = register_signal_handler (G_OBJECT (element),
                         "flow-out-media",
@@ -722,8 +724,6 @@ MediaElementImpl::MediaElementImpl (const boost::property_tree::ptree &config,
     g_object_set (G_OBJECT (element), MIN_OUTPUT_BITRATE, bitrate,
                   MAX_OUTPUT_BITRATE, bitrate, NULL);
   }
-
-  busMessageHandler = 0;
 }
 
 MediaElementImpl::~MediaElementImpl ()
@@ -752,20 +752,13 @@ MediaElementImpl::~MediaElementImpl ()
 
   const auto pipelineImpl =
       std::dynamic_pointer_cast<MediaPipelineImpl> (getMediaPipeline ());
-  GstBus *bus =
-      gst_pipeline_get_bus (GST_PIPELINE (pipelineImpl->getPipeline ()));
+
+  pipelineImpl->removeBusMessageHandler (element);
 
   gst_element_set_locked_state (element, TRUE);
   gst_element_set_state (element, GST_STATE_NULL);
   gst_bin_remove (GST_BIN (pipelineImpl->getPipeline ()), element);
 
-  if (busMessageHandler > 0) {
-    unregister_signal_handler (bus, busMessageHandler);
-    busMessageHandler = 0;
-  }
-
-  gst_bus_remove_signal_watch (bus);
-  g_object_unref (bus);
   g_object_unref (element);
 }
 
@@ -1358,6 +1351,61 @@ void MediaElementImpl::setMaxOutputBitrate (int maxOutputBitrate)
                 NULL);
 }
 
+int MediaElementImpl::getMaxOutputTiers ()
+{
+  guint tiers;
+
+  g_object_get (G_OBJECT (element), MAX_OUTPUT_TIERS, &tiers, NULL);
+
+  return tiers;
+}
+
+void MediaElementImpl::setMaxOutputTiers (int maxOutputTiers)
+{
+  if (maxOutputTiers < 1 || maxOutputTiers > 8) {
+    throw KurentoException (MEDIA_OBJECT_ILLEGAL_PARAM_ERROR,
+                            "maxOutputTiers must be between 1 and 8");
+  }
+
+  g_object_set (G_OBJECT (element), MAX_OUTPUT_TIERS, (guint) maxOutputTiers,
+                NULL);
+}
+
+int MediaElementImpl::getOutputGopCacheSize ()
+{
+  guint size;
+
+  g_object_get (G_OBJECT (element), OUTPUT_GOP_CACHE_SIZE, &size, NULL);
+
+  return size;
+}
+
+void MediaElementImpl::setOutputGopCacheSize (int outputGopCacheSize)
+{
+  if (outputGopCacheSize < 0) {
+    throw KurentoException (MEDIA_OBJECT_ILLEGAL_PARAM_ERROR,
+                            "outputGopCacheSize cannot be negative");
+  }
+
+  g_object_set (G_OBJECT (element), OUTPUT_GOP_CACHE_SIZE,
+                (guint) outputGopCacheSize, NULL);
+}
+
+bool MediaElementImpl::getOutputSmoothKeyframes ()
+{
+  gboolean smooth;
+
+  g_object_get (G_OBJECT (element), OUTPUT_SMOOTH_KEYFRAMES, &smooth, NULL);
+
+  return smooth;
+}
+
+void MediaElementImpl::setOutputSmoothKeyframes (bool outputSmoothKeyframes)
+{
+  g_object_set (G_OBJECT (element), OUTPUT_SMOOTH_KEYFRAMES,
+                (gboolean) outputSmoothKeyframes, NULL);
+}
+
 std::map <std::string, std::shared_ptr<Stats>>
     MediaElementImpl::generateStats (const gchar *selector)
 {
@@ -1378,10 +1426,31 @@ std::map <std::string, std::shared_ptr<Stats>>
   return statsReport;
 }
 
+std::map <std::string, std::shared_ptr<Stats>>
+    MediaElementImpl::getDeferredStats (const gchar *selector)
+{
+  std::shared_ptr<DeferredResponse> deferred = DeferredResponse::defer ();
+
+  if (!deferred) {
+    return generateStats (selector);
+  }
+
+  // Walking the element graph can take long, do it out of the RPC thread
+  std::shared_ptr<MediaElementImpl> self =
+      std::dynamic_pointer_cast<MediaElementImpl> (shared_from_this () );
+
+  deferred->completeAsync<std::map <std::string, std::shared_ptr<Stats>>> (
+  [self, selector] () {
+    return self->generateStats (selector);
+  });
+
+  return {};
+}
+
 std::map <std::string, std::shared_ptr<Stats>>
     MediaElementImpl::getStats ()
 {
-  return generateStats(nullptr);
+  return getDeferredStats (nullptr);
 }
 
 std::map <std::string, std::shared_ptr<Stats>>
@@ -1407,7 +1476,7 @@ std::map <std::string, std::shared_ptr<Stats>>
                             "Unsupported media type: " + mediaType->getString() );
   }
 
-  return generateStats (selector);
+  return getDeferredStats (selector);
 }
 
 static std::shared_ptr<MediaType>
@@ -1457,6 +1526,102 @@ MediaElementImpl::collectLatencyStats (
   }
 }
 
+static void
+collectTierStats (std::vector<std::shared_ptr<BitrateTier>> &tierStats,
+                  const GstStructure *stats)
+{
+  gint streams = gst_structure_n_fields (stats);
+
+  for (gint i = 0; i < streams; i++) {
+    const gchar *stream = gst_structure_nth_field_name (stats, i);
+    const GValue *val = gst_structure_get_value (stats, stream);
+    const GstStructure *tiers;
+
+    if (!GST_VALUE_HOLDS_STRUCTURE (val) ) {
+      GST_DEBUG ("Ignore unexpected value for field %s", stream);
+      continue;
+    }
+
+    tiers = gst_value_get_structure (val);
+
+    for (gint t = 0; t < gst_structure_n_fields (tiers); t++) {
+      const GValue *tierVal = gst_structure_get_value (tiers,
+                              gst_structure_nth_field_name (tiers, t) );
+      const GstStructure *tier;
+      const GValue *outputsVal;
+      std::vector<std::string> outputs;
+      guint bitrate = 0;
+
+      if (!GST_VALUE_HOLDS_STRUCTURE (tierVal) ) {
+        continue;
+      }
+
+      tier = gst_value_get_structure (tierVal);
+      gst_structure_get_uint (tier, "bitrate", &bitrate);
+      outputsVal = gst_structure_get_value (tier, "outputs");
+
+      if (outputsVal != nullptr && GST_VALUE_HOLDS_ARRAY (outputsVal) ) {
+        for (guint o = 0; o < gst_value_array_get_size (outputsVal); o++) {
+          outputs.push_back (g_value_get_string (
+                               gst_value_array_get_value (outputsVal, o) ) );
+        }
+      }
+
+      tierStats.push_back (std::make_shared <BitrateTier> (stream, t, bitrate,
+                           outputs) );
+    }
+  }
+}
+
+static void
+collectEncoderStats (std::vector<std::shared_ptr<EncoderStats>> &encoderStats,
+                     const GstStructure *stats)
+{
+  gint streams = gst_structure_n_fields (stats);
+
+  for (gint i = 0; i < streams; i++) {
+    const gchar *stream = gst_structure_nth_field_name (stats, i);
+    const GValue *val = gst_structure_get_value (stats, stream);
+    const GstStructure *encoders;
+
+    if (!GST_VALUE_HOLDS_STRUCTURE (val) ) {
+      GST_DEBUG ("Ignore unexpected value for field %s", stream);
+      continue;
+    }
+
+    encoders = gst_value_get_structure (val);
+
+    for (gint e = 0; e < gst_structure_n_fields (encoders); e++) {
+      const gchar *name = gst_structure_nth_field_name (encoders, e);
+      const GValue *encVal = gst_structure_get_value (encoders, name);
+      const GstStructure *enc;
+      const gchar *codec;
+      gboolean smooth = FALSE;
+      guint64 keyframes = 0, forwarded = 0, absorbed = 0;
+      gdouble mean = 0, ratio = 0;
+      guint peak = 0;
+
+      if (!GST_VALUE_HOLDS_STRUCTURE (encVal) ) {
+        continue;
+      }
+
+      enc = gst_value_get_structure (encVal);
+      codec = gst_structure_get_string (enc, "codec");
+      gst_structure_get (enc, "smooth-keyframes", G_TYPE_BOOLEAN, &smooth,
+                         "keyframes", G_TYPE_UINT64, &keyframes,
+                         "forwarded-requests", G_TYPE_UINT64, &forwarded,
+                         "absorbed-requests", G_TYPE_UINT64, &absorbed,
+                         "mean-frame-size", G_TYPE_DOUBLE, &mean,
+                         "peak-frame-size", G_TYPE_UINT, &peak,
+                         "peak-to-mean", G_TYPE_DOUBLE, &ratio, NULL);
+
+      encoderStats.push_back (std::make_shared <EncoderStats> (stream, name,
+                              codec != nullptr ? codec : "", smooth, keyframes,
+                              forwarded, absorbed, mean, peak, ratio) );
+    }
+  }
+}
+
 static void
 setDeprecatedProperties (std::shared_ptr<ElementStats> eStats)
 {
@@ -1501,6 +1666,9 @@ MediaElementImpl::fillStatsReport (std::map
   }
 
   std::vector<std::shared_ptr<MediaLatencyStat>> inputLatencies;
+  std::vector<std::shared_ptr<BitrateTier>> outputTiers;
+  std::vector<std::shared_ptr<EncoderStats>> outputEncoders;
+  GstStructure *tiers, *encoders;
 
   if (gst_structure_get (gst_value_get_structure (value), "input-latencies",
                          GST_TYPE_STRUCTURE, &latencies, NULL) ) {
@@ -1508,6 +1676,18 @@ MediaElementImpl::fillStatsReport (std::map
     gst_structure_free (latencies);
   }
 
+  if (gst_structure_get (gst_value_get_structure (value), "output-tiers",
+                         GST_TYPE_STRUCTURE, &tiers, NULL) ) {
+    collectTierStats (outputTiers, tiers);
+    gst_structure_free (tiers);
+  }
+
+  if (gst_structure_get (gst_value_get_structure (value), "output-encoders",
+                         GST_TYPE_STRUCTURE, &encoders, NULL) ) {
+    collectEncoderStats (outputEncoders, encoders);
+    gst_structure_free (encoders);
+  }
+
   if (report.find (getId () ) != report.end() ) {
     std::shared_ptr<ElementStats> eStats =
       std::dynamic_pointer_cast <ElementStats> (report[getId ()]);
@@ -1519,6 +1699,16 @@ MediaElementImpl::fillStatsReport (std::map
     report[getId ()] = elementStats;
   }
 
+  if (!outputTiers.empty () ) {
+    std::dynamic_pointer_cast <ElementStats> (report[getId ()])->setOutputTiers
+    (outputTiers);
+  }
+
+  if (!outputEncoders.empty () ) {
+    std::dynamic_pointer_cast <ElementStats>
+    (report[getId ()])->setOutputEncoders (outputEncoders);
+  }
+
   setDeprecatedProperties (std::dynamic_pointer_cast <ElementStats>
                            (report[getId ()]) );
 }
@@ -141,6 +141,13 @@ public:
   virtual int getMaxOutputBitrate () override;
   virtual void setMaxOutputBitrate (int maxOutputBitrate) override;
 
+  virtual int getMaxOutputTiers () override;
+  virtual void setMaxOutputTiers (int maxOutputTiers) override;
+  virtual int getOutputGopCacheSize () override;
+  virtual void setOutputGopCacheSize (int outputGopCacheSize) override;
+  virtual bool getOutputSmoothKeyframes () override;
+  virtual void setOutputSmoothKeyframes (bool outputSmoothKeyframes) override;
+
   /* Next methods are automatically implemented by code generator */
   virtual bool connect (const std::string &eventType,
                         std::shared_ptr<EventHandler> handler) override;
@@ -192,12 +199,13 @@ private:
   gulong mediaFlowOutHandler = 0;
   gulong mediaFlowInHandler = 0;
   gulong mediaTranscodingHandler = 0;
-  gulong busMessageHandler = 0;
 
   void disconnectAll();
   void performConnection (std::shared_ptr <ElementConnectionDataInternal> data);
   std::map <std::string, std::shared_ptr<Stats>> generateStats (
         const gchar *selector);
+  std::map <std::string, std::shared_ptr<Stats>> getDeferredStats (
+        const gchar *selector);
   void mediaFlowOutStateChanged (gboolean isFlowing, gchar *padName,
                                  KmsElementPadType type);
   void mediaFlowInStateChanged (gboolean isFlowing, gchar *padName,
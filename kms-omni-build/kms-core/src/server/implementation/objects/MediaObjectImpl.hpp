@@ -22,6 +22,7 @@
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/json_parser.hpp>
 #include <jsonrpc/JsonSerializer.hpp>
+#include <ConfigSnapshot.hpp>
 #include <KurentoException.hpp>
 #include <mutex>
 #include <map>
@@ -96,6 +97,21 @@ public:
   static bool getConfigValue (T *value, const std::string &key,
                               const boost::property_tree::ptree &config)
   {
+    std::shared_ptr<const ConfigSnapshot> snapshot =
+        ConfigSnapshot::get (config);
+
+    if (snapshot) {
+      const Json::Value *found = snapshot->find (key);
+
+      if (found == nullptr) {
+        GST_DEBUG ("Key '%s' not found in config", key.c_str ());
+        return false;
+      }
+
+      GST_DEBUG ("Key '%s' found in config snapshot", key.c_str ());
+      return ConfigSnapshot::deserialize (value, *found, key);
+    }
+
     boost::property_tree::ptree array;
     try {
       auto child = config.get_child (key);
@@ -115,18 +131,7 @@ public:
     Json::Value val;
     reader.parse (ss.str (), val);
 
-    kurento::JsonSerializer serializer (false);
-    serializer.JsonValue = val;
-
-    try {
-      serializer.Serialize ("val", *value);
-    } catch (const std::exception &e) {
-      GST_ERROR (
-          "Error deserializing '%s' from config: %s", key.c_str (), e.what ());
-      return false;
-    }
-
-    return true;
+    return ConfigSnapshot::deserialize (value, val["val"], key);
   }
 
 protected:
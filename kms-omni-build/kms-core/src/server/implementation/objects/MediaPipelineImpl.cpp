@@ -22,19 +22,34 @@
 #include <gst/gst.h>
 #include <DotGraph.hpp>
 #include <GstreamerDotDetails.hpp>
+#include <SignalHandler.hpp>
 #include <memory>
 #include "kmselement.h"
+#include "kmslatencyprofile.h"
 
 #define GST_CAT_DEFAULT kurento_media_pipeline_impl
 GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
 #define GST_DEFAULT_NAME "KurentoMediaPipelineImpl"
 
+#define PARAM_LATENCY_PROFILE "latencyProfile"
+
 namespace kurento
 {
 
 void MediaPipelineImpl::postConstructor ()
 {
+  GstBus *bus;
+
   MediaObjectImpl::postConstructor ();
+
+  bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline) );
+  gst_bus_add_signal_watch (bus);
+  busMessageHandler = register_signal_handler (G_OBJECT (bus), "message",
+                      std::function<void (GstBus *, GstMessage *) > (std::bind (
+                            &MediaPipelineImpl::processBusMessage, this,
+                            std::placeholders::_2) ),
+                      shared_from_this () );
+  g_object_unref (bus);
 }
 
 MediaPipelineImpl::MediaPipelineImpl (const boost::property_tree::ptree &config)
@@ -53,16 +68,49 @@ MediaPipelineImpl::MediaPipelineImpl (const boost::property_tree::ptree &config)
   gst_pipeline_use_clock (GST_PIPELINE (pipeline), clock);
   g_object_unref (clock);
 
+  LatencyProfile profile;
+
+  if (getConfigValue<LatencyProfile, MediaPipeline> (&profile,
+      PARAM_LATENCY_PROFILE) ) {
+    GST_INFO ("Default pipeline latency profile: %s",
+              profile.getString ().c_str () );
+    setLatencyProfile (std::make_shared<LatencyProfile> (profile) );
+  } else {
+    latencyProfile = std::make_shared<LatencyProfile> (LatencyProfile::DEFAULT);
+  }
+
   gst_element_set_state (pipeline, GST_STATE_PLAYING);
 }
 
 MediaPipelineImpl::~MediaPipelineImpl ()
 {
+  if (busMessageHandler > 0) {
+    GstBus *bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline) );
+
+    unregister_signal_handler (bus, busMessageHandler);
+    gst_bus_remove_signal_watch (bus);
+    g_object_unref (bus);
+  }
+
   gst_element_set_state (pipeline, GST_STATE_NULL);
 
   g_object_unref (pipeline);
 }
 
+void
+MediaPipelineImpl::setIdleState (GstState state)
+{
+  std::unique_lock <std::recursive_mutex> lock (recMutex);
+
+  GST_INFO ("Pipeline %s goes to %s", getId ().c_str (),
+            gst_element_state_get_name (state) );
+
+  if (gst_element_set_state (pipeline, state) == GST_STATE_CHANGE_FAILURE) {
+    GST_WARNING ("Pipeline %s failed to go to %s", getId ().c_str (),
+                 gst_element_state_get_name (state) );
+  }
+}
+
 std::string MediaPipelineImpl::getGstreamerDot (
   std::shared_ptr<GstreamerDotDetails> details)
 {
@@ -126,6 +174,29 @@ MediaPipelineImpl::setLatencyStats (bool latencyStats)
   gst_iterator_free (it);
 }
 
+std::shared_ptr<LatencyProfile>
+MediaPipelineImpl::getLatencyProfile ()
+{
+  std::unique_lock <std::recursive_mutex> lock (recMutex);
+  return latencyProfile;
+}
+
+void
+MediaPipelineImpl::setLatencyProfile (std::shared_ptr<LatencyProfile>
+                                      latencyProfile)
+{
+  GstContext *context;
+  std::unique_lock <std::recursive_mutex> lock (recMutex);
+
+  this->latencyProfile = latencyProfile;
+
+  /* The pipeline hands the context to all its elements, current and future */
+  context = kms_latency_profile_context_new ( (KmsLatencyProfile)
+            latencyProfile->getValue () );
+  gst_element_set_context (pipeline, context);
+  gst_context_unref (context);
+}
+
 bool
 MediaPipelineImpl::addElement (GstElement *element)
 {
@@ -145,6 +216,77 @@ MediaPipelineImpl::addElement (GstElement *element)
   return ret;
 }
 
+void
+MediaPipelineImpl::addBusMessageHandler (GstElement *element,
+    std::function<void (GstMessage *) > func,
+    std::shared_ptr<MediaObjectImpl> object)
+{
+  std::unique_lock <std::mutex> lock (busHandlersMutex);
+
+  busHandlers[element] = BusMessageHandler {func, object};
+}
+
+void
+MediaPipelineImpl::removeBusMessageHandler (GstElement *element)
+{
+  std::unique_lock <std::mutex> lock (busHandlersMutex);
+
+  busHandlers.erase (element);
+}
+
+void
+MediaPipelineImpl::processBusMessage (GstMessage *msg)
+{
+  GstMessageType type = GST_MESSAGE_TYPE (msg);
+  GstObject *object;
+  BusMessageHandler handler;
+
+  if (type != GST_MESSAGE_ERROR && type != GST_MESSAGE_WARNING) {
+    return;
+  }
+
+  if (GST_MESSAGE_SRC (msg) == nullptr) {
+    return;
+  }
+
+  /* Walk up to the child of the pipeline that contains the source */
+  object = GST_OBJECT (gst_object_ref (GST_MESSAGE_SRC (msg) ) );
+
+  while (object != nullptr) {
+    GstObject *parent = gst_object_get_parent (object);
+
+    if (parent == GST_OBJECT (pipeline) ) {
+      gst_object_unref (parent);
+      break;
+    }
+
+    gst_object_unref (object);
+    object = parent;
+  }
+
+  if (object == nullptr) {
+    return;
+  }
+
+  {
+    std::unique_lock <std::mutex> lock (busHandlersMutex);
+    auto it = busHandlers.find ( (GstElement *) object);
+
+    if (it != busHandlers.end () ) {
+      handler = it->second;
+    }
+  }
+
+  gst_object_unref (object);
+
+  /* Keep the element alive while it handles the message */
+  std::shared_ptr<MediaObjectImpl> owner = handler.object.lock ();
+
+  if (owner && handler.func) {
+    handler.func (msg);
+  }
+}
+
 MediaObjectImpl *
 MediaPipelineImplFactory::createObject (const boost::property_tree::ptree &pt)
 const
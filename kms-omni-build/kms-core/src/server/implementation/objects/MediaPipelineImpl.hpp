@@ -19,9 +19,13 @@
 
 #include "MediaObjectImpl.hpp"
 #include "MediaPipeline.hpp"
+#include "LatencyProfile.hpp"
 #include <EventHandler.hpp>
 #include <gst/gst.h>
 #include <boost/property_tree/ptree.hpp>
+#include <functional>
+#include <map>
+#include <mutex>
 #include <string>
 
 namespace kurento
@@ -53,6 +57,10 @@ public:
   virtual bool getLatencyStats ();
   virtual void setLatencyStats (bool latencyStats);
 
+  virtual std::shared_ptr<LatencyProfile> getLatencyProfile ();
+  virtual void setLatencyProfile (std::shared_ptr<LatencyProfile>
+                                  latencyProfile);
+
   /* Next methods are automatically implemented by code generator */
   virtual bool connect (const std::string &eventType,
                         std::shared_ptr<EventHandler> handler);
@@ -65,14 +73,44 @@ public:
 
   bool addElement (GstElement *element);
 
+  /*
+   * Errors and warnings posted on the pipeline bus are delivered to the
+   * handler of the pipeline child they come from. A single bus watch looks
+   * the child up, so the cost of a message does not grow with the number of
+   * elements in the pipeline.
+   */
+  void addBusMessageHandler (GstElement *element,
+                             std::function<void (GstMessage *) > func,
+                             std::shared_ptr<MediaObjectImpl> object);
+  void removeBusMessageHandler (GstElement *element);
+
+  /*
+   * Used by the garbage collector when all the sessions of the pipeline stop
+   * sending keep-alives. READY stops streaming and releases the encoders,
+   * NULL frees every other resource, PLAYING resumes normal operation.
+   */
+  void setIdleState (GstState state);
+
 protected:
   virtual void postConstructor ();
 
 private:
+  struct BusMessageHandler {
+    std::function<void (GstMessage *) > func;
+    std::weak_ptr<MediaObjectImpl> object;
+  };
+
+  void processBusMessage (GstMessage *msg);
+
   GstElement *pipeline;
 
+  gulong busMessageHandler = 0;
+  std::mutex busHandlersMutex;
+  std::map<GstElement *, BusMessageHandler> busHandlers;
+
   std::recursive_mutex recMutex;
   bool latencyStats = false;
+  std::shared_ptr<LatencyProfile> latencyProfile;
 
   class StaticConstructor
   {
@@ -16,6 +16,7 @@
  */
 #include <gst/gst.h>
 #include "SdpEndpointImpl.hpp"
+#include "SdpEndpointConfig.hpp"
 #include <jsonrpc/JsonSerializer.hpp>
 #include <KurentoException.hpp>
 #include <gst/gst.h>
@@ -28,11 +29,7 @@
 GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
 #define GST_DEFAULT_NAME "KurentoSdpEndpointImpl"
 
-#define PARAM_NUM_AUDIO_MEDIAS "numAudioMedias"
-#define PARAM_NUM_VIDEO_MEDIAS "numVideoMedias"
 #define PARAM_CODEC_NAME "name"
-#define PARAM_AUDIO_CODECS "audioCodecs"
-#define PARAM_VIDEO_CODECS "videoCodecs"
 
 namespace kurento
 {
@@ -128,27 +125,19 @@ SdpEndpointImpl::SdpEndpointImpl (const boost::property_tree::ptree &config,
   //   g_signal_connect (element, "media-start", G_CALLBACK (media_start_cb), this);
   //   g_signal_connect (element, "media-stop", G_CALLBACK (media_stop_cb), this);
 
-  guint audio_medias = 0;
-  getConfigValue <guint, SdpEndpoint> (&audio_medias, PARAM_NUM_AUDIO_MEDIAS, 1);
+  std::shared_ptr<const SdpEndpointConfig> sdpConfig =
+    SdpEndpointConfig::get (config);
 
-  guint video_medias = 0;
-  getConfigValue <guint, SdpEndpoint> (&video_medias, PARAM_NUM_VIDEO_MEDIAS, 1);
+  guint audio_medias = sdpConfig->numAudioMedias;
+  guint video_medias = sdpConfig->numVideoMedias;
 
-  std::vector<std::shared_ptr<CodecConfiguration>> acodec_list;
-  getConfigValue <std::vector<std::shared_ptr<CodecConfiguration>>, SdpEndpoint>
-      (&acodec_list, PARAM_AUDIO_CODECS);
-
-  for (std::shared_ptr<CodecConfiguration> conf : acodec_list) {
+  for (std::shared_ptr<CodecConfiguration> conf : sdpConfig->audioCodecs) {
     if (!conf->getName().empty()) {
       append_codec_to_array (audio_codecs, conf->getName().c_str() );
     }
   }
 
-  std::vector<std::shared_ptr<CodecConfiguration>> vcodec_list;
-  getConfigValue <std::vector<std::shared_ptr<CodecConfiguration>>, SdpEndpoint>
-      (&vcodec_list, PARAM_VIDEO_CODECS);
-
-  for (std::shared_ptr<CodecConfiguration> conf : vcodec_list) {
+  for (std::shared_ptr<CodecConfiguration> conf : sdpConfig->videoCodecs) {
     if (!conf->getName().empty()) {
       append_codec_to_array (video_codecs, conf->getName().c_str() );
     }
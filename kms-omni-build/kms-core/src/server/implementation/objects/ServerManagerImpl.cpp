@@ -18,10 +18,12 @@
 #include "ServerInfo.hpp"
 #include "MediaPipelineImpl.hpp"
 #include "ServerManagerImpl.hpp"
+#include "SessionReclaimStats.hpp"
 #include "process-tools/linux-process.hpp"
 #include <jsonrpc/JsonSerializer.hpp>
 #include <KurentoException.hpp>
 #include <MediaSet.hpp>
+#include <DeferredResponse.hpp>
 
 #include <boost/property_tree/json_parser.hpp>
 #include <gst/gst.h>
@@ -90,6 +92,15 @@ std::string ServerManagerImpl::getMetadata ()
   return metadata;
 }
 
+std::shared_ptr<SessionReclaimStats> ServerManagerImpl::getReclaimStats ()
+{
+  MediaSet::ReclaimStats stats = MediaSet::getMediaSet ()->getReclaimStats ();
+
+  return std::make_shared<SessionReclaimStats> (stats.activeSessions,
+         stats.pausedSessions, stats.trimmedSessions, stats.pausedPipelines,
+         stats.trimmedPipelines, stats.resumedSessions, stats.collectedSessions);
+}
+
 std::string ServerManagerImpl::getKmd (const std::string &moduleName)
 {
   for (auto moduleIt : moduleManager.getModules () ) {
@@ -114,7 +125,20 @@ float
 ServerManagerImpl::getUsedCpu (int interval)
 {
   struct ::cpustat_t cpustat;
+  std::shared_ptr<DeferredResponse> deferred = DeferredResponse::defer ();
+
   cpuPercentBegin (&cpustat);
+
+  if (deferred) {
+    // Sample again when the interval is over, without holding this thread
+    DeferredResponse::postAfter (std::chrono::milliseconds (interval),
+    [deferred, cpustat] () {
+      deferred->complete<float> (cpuPercentEnd (&cpustat) );
+    });
+
+    return 0;
+  }
+
   std::this_thread::sleep_for (std::chrono::milliseconds (interval));
   return cpuPercentEnd (&cpustat);
 }
@@ -38,6 +38,7 @@ void Serialize (std::shared_ptr<kurento::ServerManagerImpl> &object,
 namespace kurento
 {
 class ServerInfo;
+class SessionReclaimStats;
 class MediaPipelineImpl;
 } /* kurento */
 
@@ -70,6 +71,8 @@ public:
 
   virtual std::string getMetadata () override;
 
+  virtual std::shared_ptr<SessionReclaimStats> getReclaimStats () override;
+
   virtual int getCpuCount () override;
 
   virtual float getUsedCpu (int interval) override;
@@ -1429,6 +1429,541 @@ GST_START_TEST (test_codec_config_openh264)
 }
 
 GST_END_TEST;
+#define N_GOP_CACHE_SUBSCRIBERS 4
+#define GOP_CACHE_BUFFERS 5
+
+typedef struct _GopCacheData
+{
+  GMainLoop *loop;
+  GstElement *pipeline;
+  GstElement *agnosticbin;
+  gint counting;
+  gint keyframe_requests;
+  gint delta_starts;
+  gint started;
+} GopCacheData;
+
+static GstPadProbeReturn
+count_keyframe_requests (GstPad * pad, GstPadProbeInfo * info,
+    gpointer user_data)
+{
+  GopCacheData *data = user_data;
+  GstEvent *event = gst_pad_probe_info_get_event (info);
+
+  if (gst_event_has_name (event, "GstForceKeyUnit")
+      && g_atomic_int_get (&data->counting)) {
+    GST_DEBUG_OBJECT (pad, "Keyframe requested");
+    g_atomic_int_inc (&data->keyframe_requests);
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+static void
+gop_cache_hand_off (GstElement * fakesink, GstBuffer * buf, GstPad * pad,
+    gpointer user_data)
+{
+  GopCacheData *data = user_data;
+  gint received;
+
+  received = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (fakesink),
+          "received"));
+
+  if (received == 0 && GST_BUFFER_FLAG_IS_SET (buf,
+          GST_BUFFER_FLAG_DELTA_UNIT)) {
+    g_atomic_int_inc (&data->delta_starts);
+  }
+
+  g_object_set_data (G_OBJECT (fakesink), "received",
+      GINT_TO_POINTER (++received));
+
+  if (received == GOP_CACHE_BUFFERS
+      && g_atomic_int_add (&data->started, 1) == N_GOP_CACHE_SUBSCRIBERS - 1) {
+    g_idle_add (quit_main_loop_idle, data->loop);
+  }
+}
+
+static gboolean
+connect_gop_cache_subscribers (gpointer user_data)
+{
+  GopCacheData *data = user_data;
+  gint i;
+
+  GST_INFO ("Connecting %d subscribers", N_GOP_CACHE_SUBSCRIBERS);
+
+  g_atomic_int_set (&data->counting, TRUE);
+
+  for (i = 0; i < N_GOP_CACHE_SUBSCRIBERS; i++) {
+    GstElement *fakesink = gst_element_factory_make ("fakesink", NULL);
+
+    g_object_set (G_OBJECT (fakesink), "sync", FALSE, "async", FALSE,
+        "signal-handoffs", TRUE, NULL);
+    g_signal_connect (G_OBJECT (fakesink), "handoff",
+        G_CALLBACK (gop_cache_hand_off), data);
+
+    gst_bin_add (GST_BIN (data->pipeline), fakesink);
+    gst_element_sync_state_with_parent (fakesink);
+    fail_unless (gst_element_link (data->agnosticbin, fakesink));
+  }
+
+  return FALSE;
+}
+
+GST_START_TEST (gop_cache_start)
+{
+  GopCacheData data = { 0 };
+  GstElement *videotestsrc = gst_element_factory_make ("videotestsrc", NULL);
+  GstElement *encoder = gst_element_factory_make ("vp8enc", NULL);
+  GstBus *bus;
+  GstPad *encoder_src;
+
+  data.loop = g_main_loop_new (NULL, TRUE);
+  data.pipeline = gst_pipeline_new (__FUNCTION__);
+  data.agnosticbin = gst_element_factory_make ("agnosticbin", NULL);
+  loop = data.loop;
+
+  g_object_set (G_OBJECT (videotestsrc), "is-live", TRUE, NULL);
+  g_object_set (G_OBJECT (encoder), "deadline", G_GINT64_CONSTANT (1),
+      "keyframe-max-dist", 60, NULL);
+  g_object_set (G_OBJECT (data.agnosticbin), "gop-cache-size", 1024 * 1024,
+      NULL);
+
+  bus = gst_pipeline_get_bus (GST_PIPELINE (data.pipeline));
+  gst_bus_add_signal_watch (bus);
+  g_signal_connect (bus, "message", G_CALLBACK (bus_msg), data.pipeline);
+
+  gst_bin_add_many (GST_BIN (data.pipeline), videotestsrc, encoder,
+      data.agnosticbin, NULL);
+  fail_unless (gst_element_link_many (videotestsrc, encoder, data.agnosticbin,
+          NULL));
+
+  encoder_src = gst_element_get_static_pad (encoder, "src");
+  gst_pad_add_probe (encoder_src, GST_PAD_PROBE_TYPE_EVENT_UPSTREAM,
+      count_keyframe_requests, &data, NULL);
+  g_object_unref (encoder_src);
+
+  gst_element_set_state (data.pipeline, GST_STATE_PLAYING);
+
+  /* Late enough for the first keyframe to be cached */
+  g_timeout_add (1500, connect_gop_cache_subscribers, &data);
+  g_timeout_add_seconds (10, timeout_check, data.pipeline);
+
+  mark_point ();
+  g_main_loop_run (data.loop);
+  mark_point ();
+
+  fail_unless (g_atomic_int_get (&data.delta_starts) == 0,
+      "%d subscribers did not start with a keyframe", data.delta_starts);
+  fail_unless (g_atomic_int_get (&data.keyframe_requests) == 0,
+      "%d keyframes requested upstream", data.keyframe_requests);
+
+  gst_element_set_state (data.pipeline, GST_STATE_NULL);
+  gst_bus_remove_signal_watch (bus);
+  g_object_unref (bus);
+  g_object_unref (data.pipeline);
+  g_main_loop_unref (data.loop);
+}
+
+GST_END_TEST;
+
+#define SMOOTH_KEYFRAMES_PLIS 5
+#define SMOOTH_KEYFRAMES_PLI_BUFFER 10
+#define SMOOTH_KEYFRAMES_BUFFERS 60
+
+static gboolean
+send_plis (gpointer fakesink)
+{
+  GstPad *sink = gst_element_get_static_pad (GST_ELEMENT (fakesink), "sink");
+  gint i;
+
+  /* What rtpsession sends upstream for each RTCP PLI */
+  for (i = 0; i < SMOOTH_KEYFRAMES_PLIS; i++) {
+    GstStructure *s = gst_structure_new ("GstForceKeyUnit",
+        "all-headers", G_TYPE_BOOLEAN, FALSE, NULL);
+
+    gst_pad_push_event (sink, gst_event_new_custom (GST_EVENT_CUSTOM_UPSTREAM,
+            s));
+  }
+
+  g_object_unref (sink);
+
+  return FALSE;
+}
+
+static void
+smooth_keyframes_hand_off (GstElement * fakesink, GstBuffer * buf,
+    GstPad * pad, gpointer loop)
+{
+  gint received;
+
+  received = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (fakesink),
+          "received"));
+  g_object_set_data (G_OBJECT (fakesink), "received",
+      GINT_TO_POINTER (++received));
+
+  if (received == SMOOTH_KEYFRAMES_PLI_BUFFER) {
+    g_idle_add (send_plis, fakesink);
+  } else if (received == SMOOTH_KEYFRAMES_BUFFERS) {
+    g_idle_add (quit_main_loop_idle, loop);
+  }
+}
+
+GST_START_TEST (smooth_keyframes)
+{
+  GstElement *pipeline = gst_pipeline_new (__FUNCTION__);
+  GstElement *videotestsrc = gst_element_factory_make ("videotestsrc", NULL);
+  GstElement *agnosticbin = gst_element_factory_make ("agnosticbin", NULL);
+  GstElement *capsfilter = gst_element_factory_make ("capsfilter", NULL);
+  GstElement *fakesink = gst_element_factory_make ("fakesink", NULL);
+  GstStructure *encoders, *stats = NULL;
+  guint64 absorbed = 0;
+  gdouble peak_to_mean = 0;
+  GstCaps *caps;
+  GstBus *bus;
+
+  loop = g_main_loop_new (NULL, TRUE);
+
+  caps = gst_caps_from_string ("video/x-vp8");
+  g_object_set (G_OBJECT (capsfilter), "caps", caps, NULL);
+  gst_caps_unref (caps);
+
+  g_object_set (G_OBJECT (videotestsrc), "is-live", TRUE, NULL);
+  g_object_set (G_OBJECT (agnosticbin), "smooth-keyframes", TRUE, NULL);
+  g_object_set (G_OBJECT (fakesink), "sync", FALSE, "async", FALSE,
+      "signal-handoffs", TRUE, NULL);
+  g_signal_connect (G_OBJECT (fakesink), "handoff",
+      G_CALLBACK (smooth_keyframes_hand_off), loop);
+
+  bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
+  gst_bus_add_signal_watch (bus);
+  g_signal_connect (bus, "message", G_CALLBACK (bus_msg), pipeline);
+
+  gst_bin_add_many (GST_BIN (pipeline), videotestsrc, agnosticbin, capsfilter,
+      fakesink, NULL);
+  fail_unless (gst_element_link_many (videotestsrc, agnosticbin, capsfilter,
+          fakesink, NULL));
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  g_timeout_add_seconds (10, timeout_check, pipeline);
+
+  mark_point ();
+  g_main_loop_run (loop);
+  mark_point ();
+
+  g_object_get (G_OBJECT (agnosticbin), "encoders", &encoders, NULL);
+  fail_unless (gst_structure_n_fields (encoders) == 1);
+  gst_structure_get (encoders, gst_structure_nth_field_name (encoders, 0),
+      GST_TYPE_STRUCTURE, &stats, NULL);
+  gst_structure_free (encoders);
+
+  fail_unless (stats != NULL);
+  GST_DEBUG ("Encoder stats: %" GST_PTR_FORMAT, stats);
+
+  /* The burst of PLIs must be merged in one keyframe at most */
+  fail_unless (gst_structure_get_uint64 (stats, "absorbed-requests",
+          &absorbed));
+  fail_unless (absorbed >= SMOOTH_KEYFRAMES_PLIS - 1,
+      "%" G_GUINT64_FORMAT " requests absorbed", absorbed);
+  fail_unless (gst_structure_get_double (stats, "peak-to-mean",
+          &peak_to_mean));
+  fail_unless (peak_to_mean >= 1.0);
+  gst_structure_free (stats);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_bus_remove_signal_watch (bus);
+  g_object_unref (bus);
+  g_object_unref (pipeline);
+  g_main_loop_unref (loop);
+}
+
+GST_END_TEST;
+
+static gboolean
+enable_smooth_keyframes (gpointer agnosticbin)
+{
+  g_object_set (G_OBJECT (agnosticbin), "smooth-keyframes", TRUE, NULL);
+
+  return FALSE;
+}
+
+static void
+smooth_keyframes_late_hand_off (GstElement * fakesink, GstBuffer * buf,
+    GstPad * pad, gpointer loop)
+{
+  gint received;
+
+  received = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (fakesink),
+          "received"));
+
+  /* The encoder is running by now, without intra refresh */
+  if (received == 0) {
+    g_idle_add (enable_smooth_keyframes, g_object_get_data (G_OBJECT
+            (fakesink), "agnosticbin"));
+  }
+
+  smooth_keyframes_hand_off (fakesink, buf, pad, loop);
+}
+
+GST_START_TEST (smooth_keyframes_late)
+{
+  GstElement *pipeline = gst_pipeline_new (__FUNCTION__);
+  GstElement *videotestsrc = gst_element_factory_make ("videotestsrc", NULL);
+  GstElement *agnosticbin = gst_element_factory_make ("agnosticbin", NULL);
+  GstElement *capsfilter = gst_element_factory_make ("capsfilter", NULL);
+  GstElement *fakesink = gst_element_factory_make ("fakesink", NULL);
+  GstStructure *encoders, *stats = NULL;
+  gboolean smooth = FALSE, intra_refresh = TRUE;
+  guint64 forwarded = 0;
+  GstCaps *caps;
+  GstBus *bus;
+
+  loop = g_main_loop_new (NULL, TRUE);
+
+  caps = gst_caps_from_string ("video/x-h264");
+  g_object_set (G_OBJECT (capsfilter), "caps", caps, NULL);
+  gst_caps_unref (caps);
+
+  g_object_set (G_OBJECT (videotestsrc), "is-live", TRUE, NULL);
+  g_object_set (G_OBJECT (fakesink), "sync", FALSE, "async", FALSE,
+      "signal-handoffs", TRUE, NULL);
+  g_object_set_data (G_OBJECT (fakesink), "agnosticbin", agnosticbin);
+  g_signal_connect (G_OBJECT (fakesink), "handoff",
+      G_CALLBACK (smooth_keyframes_late_hand_off), loop);
+
+  bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
+  gst_bus_add_signal_watch (bus);
+  g_signal_connect (bus, "message", G_CALLBACK (bus_msg), pipeline);
+
+  gst_bin_add_many (GST_BIN (pipeline), videotestsrc, agnosticbin, capsfilter,
+      fakesink, NULL);
+  fail_unless (gst_element_link_many (videotestsrc, agnosticbin, capsfilter,
+          fakesink, NULL));
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  g_timeout_add_seconds (10, timeout_check, pipeline);
+
+  mark_point ();
+  g_main_loop_run (loop);
+  mark_point ();
+
+  g_object_get (G_OBJECT (agnosticbin), "encoders", &encoders, NULL);
+  fail_unless (gst_structure_n_fields (encoders) == 1);
+  gst_structure_get (encoders, gst_structure_nth_field_name (encoders, 0),
+      GST_TYPE_STRUCTURE, &stats, NULL);
+  gst_structure_free (encoders);
+
+  fail_unless (stats != NULL);
+  GST_DEBUG ("Encoder stats: %" GST_PTR_FORMAT, stats);
+
+  /* Enabled on an encoder without intra refresh, PLIs still get keyframes */
+  fail_unless (gst_structure_get_boolean (stats, "smooth-keyframes", &smooth));
+  fail_unless (smooth);
+  fail_unless (gst_structure_get_boolean (stats, "intra-refresh",
+          &intra_refresh));
+  fail_if (intra_refresh);
+  fail_unless (gst_structure_get_uint64 (stats, "forwarded-requests",
+          &forwarded));
+  fail_unless (forwarded >= 1, "%" G_GUINT64_FORMAT " requests forwarded",
+      forwarded);
+  gst_structure_free (stats);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_bus_remove_signal_watch (bus);
+  g_object_unref (bus);
+  g_object_unref (pipeline);
+  g_main_loop_unref (loop);
+}
+
+GST_END_TEST;
+
+#define TIERS_BUFFERS 20
+#define TIERS_CONSUMERS 2
+
+static void
+tiers_hand_off (GstElement * fakesink, GstBuffer * buf, GstPad * pad,
+    gpointer user_data)
+{
+  gint received;
+
+  if (!g_object_get_data (G_OBJECT (fakesink), "waiting")) {
+    return;
+  }
+
+  received = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (fakesink),
+          "received"));
+  g_object_set_data (G_OBJECT (fakesink), "received",
+      GINT_TO_POINTER (++received));
+
+  if (received == TIERS_BUFFERS) {
+    g_object_set_data (G_OBJECT (fakesink), "waiting", NULL);
+    g_idle_add (quit_main_loop_idle, loop);
+  }
+}
+
+static void
+wait_for_buffers (GstElement * fakesink)
+{
+  g_object_set_data (G_OBJECT (fakesink), "received", NULL);
+  g_object_set_data (G_OBJECT (fakesink), "waiting", GINT_TO_POINTER (TRUE));
+
+  mark_point ();
+  g_main_loop_run (loop);
+  mark_point ();
+}
+
+static void
+send_remb (GstElement * fakesink, guint bitrate)
+{
+  GstPad *pad = gst_element_get_static_pad (fakesink, "sink");
+
+  fail_unless (gst_pad_push_event (pad,
+          gst_event_new_custom (GST_EVENT_CUSTOM_UPSTREAM,
+              gst_structure_new ("REMB", "bitrate", G_TYPE_UINT, bitrate,
+                  "ssrc", G_TYPE_UINT, 0, NULL))));
+  g_object_unref (pad);
+}
+
+static void
+count_tier_encoders (GstElement * agnosticbin, guint * total, guint * active,
+    guint * idle)
+{
+  GstStructure *encoders;
+  guint i;
+
+  *total = *active = *idle = 0;
+
+  g_object_get (G_OBJECT (agnosticbin), "encoders", &encoders, NULL);
+
+  for (i = 0; i < gst_structure_n_fields (encoders); i++) {
+    GstStructure *stats = NULL;
+    gboolean is_idle;
+    guint tier;
+
+    gst_structure_get (encoders, gst_structure_nth_field_name (encoders, i),
+        GST_TYPE_STRUCTURE, &stats, NULL);
+    fail_unless (stats != NULL);
+    fail_unless (gst_structure_get_uint (stats, "tier", &tier));
+    fail_unless (gst_structure_get_boolean (stats, "idle", &is_idle));
+    gst_structure_free (stats);
+
+    (*total)++;
+
+    if (tier > 0) {
+      (*(is_idle ? idle : active))++;
+    }
+  }
+
+  gst_structure_free (encoders);
+}
+
+static guint
+count_tier_outputs (GstElement * agnosticbin, const gchar * tier_name)
+{
+  GstStructure *tiers, *tier = NULL;
+  guint outputs = 0;
+
+  g_object_get (G_OBJECT (agnosticbin), "tiers", &tiers, NULL);
+
+  if (gst_structure_get (tiers, tier_name, GST_TYPE_STRUCTURE, &tier, NULL)) {
+    outputs = gst_value_array_get_size (gst_structure_get_value (tier,
+            "outputs"));
+    gst_structure_free (tier);
+  }
+
+  gst_structure_free (tiers);
+
+  return outputs;
+}
+
+GST_START_TEST (bitrate_tiers)
+{
+  GstElement *pipeline = gst_pipeline_new (__FUNCTION__);
+  GstElement *videotestsrc = gst_element_factory_make ("videotestsrc", NULL);
+  GstElement *agnosticbin = gst_element_factory_make ("agnosticbin", NULL);
+  GstElement *fakesinks[TIERS_CONSUMERS];
+  guint total, active, idle, i;
+  GstCaps *caps;
+  GstBus *bus;
+
+  loop = g_main_loop_new (NULL, TRUE);
+
+  g_object_set (G_OBJECT (videotestsrc), "is-live", TRUE, NULL);
+  g_object_set (G_OBJECT (agnosticbin), "max-tiers", 2, NULL);
+
+  bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
+  gst_bus_add_signal_watch (bus);
+  g_signal_connect (bus, "message", G_CALLBACK (bus_msg), pipeline);
+
+  gst_bin_add_many (GST_BIN (pipeline), videotestsrc, agnosticbin, NULL);
+  fail_unless (gst_element_link (videotestsrc, agnosticbin));
+
+  caps = gst_caps_from_string ("video/x-vp8");
+
+  for (i = 0; i < TIERS_CONSUMERS; i++) {
+    GstElement *capsfilter = gst_element_factory_make ("capsfilter", NULL);
+
+    fakesinks[i] = gst_element_factory_make ("fakesink", NULL);
+    g_object_set (G_OBJECT (capsfilter), "caps", caps, NULL);
+    g_object_set (G_OBJECT (fakesinks[i]), "sync", FALSE, "async", FALSE,
+        "signal-handoffs", TRUE, NULL);
+    g_signal_connect (G_OBJECT (fakesinks[i]), "handoff",
+        G_CALLBACK (tiers_hand_off), NULL);
+
+    gst_bin_add_many (GST_BIN (pipeline), capsfilter, fakesinks[i], NULL);
+    fail_unless (gst_element_link_many (agnosticbin, capsfilter, fakesinks[i],
+            NULL));
+  }
+
+  gst_caps_unref (caps);
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  for (i = 0; i < TIERS_CONSUMERS; i++) {
+    wait_for_buffers (fakesinks[i]);
+  }
+
+  /* One consumer on a poor link, regrouped right away instead of waiting
+   * for the update interval */
+  send_remb (fakesinks[0], 2000000);
+  send_remb (fakesinks[1], 200000);
+  g_object_set (G_OBJECT (agnosticbin), "max-tiers", 2, NULL);
+
+  fail_unless_equals_int (count_tier_outputs (agnosticbin, "tier_0"), 1);
+  fail_unless_equals_int (count_tier_outputs (agnosticbin, "tier_1"), 1);
+
+  /* The relinked consumer is fed by its own encoder */
+  wait_for_buffers (fakesinks[1]);
+  count_tier_encoders (agnosticbin, &total, &active, &idle);
+  fail_unless_equals_int (total, 2);
+  fail_unless_equals_int (active, 1);
+  fail_unless_equals_int (idle, 0);
+
+  /* The link recovers, both consumers go back to the first tier */
+  send_remb (fakesinks[1], 2000000);
+  g_object_set (G_OBJECT (agnosticbin), "max-tiers", 2, NULL);
+
+  fail_unless_equals_int (count_tier_outputs (agnosticbin, "tier_0"), 2);
+
+  wait_for_buffers (fakesinks[1]);
+  wait_for_buffers (fakesinks[0]);
+
+  /* Nobody uses the tier encoder now, it must not keep encoding */
+  count_tier_encoders (agnosticbin, &total, &active, &idle);
+  fail_unless_equals_int (total, 2);
+  fail_unless_equals_int (active, 0);
+  fail_unless_equals_int (idle, 1);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_bus_remove_signal_watch (bus);
+  g_object_unref (bus);
+  g_object_unref (pipeline);
+  g_main_loop_unref (loop);
+}
+
+GST_END_TEST;
+
 /*
  * End of test cases
  */
@@ -1465,6 +2000,11 @@ agnostic2_suite (void)
   tcase_add_test (tc_chain, test_raw_to_rtp);
   tcase_add_test (tc_chain, test_codec_to_rtp);
 
+  tcase_add_test (tc_chain, gop_cache_start);
+  tcase_add_test (tc_chain, smooth_keyframes);
+  tcase_add_test (tc_chain, smooth_keyframes_late);
+  tcase_add_test (tc_chain, bitrate_tiers);
+
   return s;
 }
 
@@ -191,6 +191,131 @@ GST_START_TEST (buffer_injector_drop_buffers)
 
 GST_END_TEST;
 
+typedef struct _GapData
+{
+  GMutex mutex;
+  GstBuffer *last;
+  gboolean shared;
+  /* First gap after the last real buffer, not referenced */
+  GstBuffer *first_gap;
+  gboolean first_gap_freed;
+  gboolean reused;
+} GapData;
+
+static void
+gap_buffer_freed (gpointer data, GstMiniObject * obj)
+{
+  GapData *gap_data = data;
+
+  g_mutex_lock (&gap_data->mutex);
+
+  if ((GstMiniObject *) gap_data->first_gap == obj) {
+    gap_data->first_gap_freed = TRUE;
+  }
+
+  g_mutex_unlock (&gap_data->mutex);
+}
+
+/* Called with the mutex held */
+static void
+gap_data_forget_first_gap (GapData * gap_data)
+{
+  if (gap_data->first_gap != NULL && !gap_data->first_gap_freed) {
+    gst_mini_object_weak_unref (GST_MINI_OBJECT (gap_data->first_gap),
+        gap_buffer_freed, gap_data);
+  }
+
+  gap_data->first_gap = NULL;
+}
+
+static void
+fakesink_hand_off_gap (GstElement * fakesink, GstBuffer * buf, GstPad * pad,
+    gpointer data)
+{
+  GapData *gap_data = data;
+  GstElement *pipeline =
+      GST_ELEMENT (gst_element_get_parent (GST_OBJECT (fakesink)));
+
+  g_mutex_lock (&gap_data->mutex);
+
+  if (!GST_BUFFER_FLAG_IS_SET (buf, GST_BUFFER_FLAG_GAP)) {
+    gst_buffer_replace (&gap_data->last, buf);
+    gap_data_forget_first_gap (gap_data);
+  } else if (gap_data->last != NULL && gap_data->first_gap == NULL) {
+    GST_DEBUG ("Gap buffer received: %" GST_PTR_FORMAT, buf);
+
+    gap_data->shared = gst_buffer_n_memory (buf) == 1 &&
+        gst_buffer_peek_memory (buf, 0) ==
+        gst_buffer_peek_memory (gap_data->last, 0);
+
+    gap_data->first_gap = buf;
+    gap_data->first_gap_freed = FALSE;
+    gst_mini_object_weak_ref (GST_MINI_OBJECT (buf), gap_buffer_freed,
+        gap_data);
+  } else if (gap_data->first_gap != NULL) {
+    GST_DEBUG ("Next gap buffer received: %" GST_PTR_FORMAT, buf);
+
+    /* The same header, kept alive by the injector in between */
+    gap_data->reused = buf == gap_data->first_gap
+        && !gap_data->first_gap_freed;
+
+    gst_element_post_message (pipeline,
+        gst_message_new_eos (GST_OBJECT (pipeline)));
+  }
+
+  g_mutex_unlock (&gap_data->mutex);
+
+  g_object_unref (pipeline);
+}
+
+GST_START_TEST (gap_buffers_share_memory)
+{
+  GstElement *pipeline, *fakesink;
+  GMainLoop *loop = g_main_loop_new (NULL, FALSE);
+  GapData gap_data = { 0 };
+  GstBus *bus;
+
+  g_mutex_init (&gap_data.mutex);
+
+  pipeline =
+      gst_parse_launch
+      ("videotestsrc is-live=true ! video/x-raw,framerate=30/1 ! identity sleep-time=500000 ! bufferinjector ! fakesink name=fakesink signal-handoffs=true enable-last-sample=false",
+      NULL);
+  bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
+
+  gst_bus_add_signal_watch (bus);
+  g_signal_connect (bus, "message", G_CALLBACK (bus_msg), loop);
+
+  fakesink = gst_bin_get_by_name (GST_BIN (pipeline), "fakesink");
+  g_signal_connect (G_OBJECT (fakesink), "handoff",
+      G_CALLBACK (fakesink_hand_off_gap), &gap_data);
+  g_object_unref (fakesink);
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  g_main_loop_run (loop);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+
+  fail_unless (gap_data.shared,
+      "Gap buffer does not reuse the memory of the previous buffer");
+  fail_unless (gap_data.reused,
+      "Gap buffers are not reused once released by downstream");
+
+  g_mutex_lock (&gap_data.mutex);
+  gap_data_forget_first_gap (&gap_data);
+  g_mutex_unlock (&gap_data.mutex);
+
+  gst_buffer_replace (&gap_data.last, NULL);
+  gst_bus_remove_signal_watch (bus);
+  gst_object_unref (GST_OBJECT (bus));
+  gst_object_unref (GST_OBJECT (pipeline));
+  g_mutex_clear (&gap_data.mutex);
+  g_main_loop_unref (loop);
+}
+
+GST_END_TEST;
+
 static GstPadProbeReturn
 caps_probe (GstPad * pad, GstPadProbeInfo * info, gpointer data)
 {
@@ -279,6 +404,7 @@ buffer_injector_suite (void)
   tcase_add_test (tc_chain, video_test_buffer_injector);
   tcase_add_test (tc_chain, buffer_injector_drop_buffers);
   tcase_add_test (tc_chain, renegotiate_input);
+  tcase_add_test (tc_chain, gap_buffers_share_memory);
   return s;
 }
 
@@ -121,6 +121,238 @@ GST_START_TEST (connect_sinks)
   g_object_unref (pipe);
 }
 
+GST_END_TEST
+GST_START_TEST (shared_encoding_caps)
+{
+  GstBin *pipe = (GstBin *) gst_pipeline_new ("shared_encoding_caps");
+  GstElement *hubport = gst_element_factory_make ("hubport", NULL);
+  GstElement *capsfilter = gst_element_factory_make ("capsfilter", NULL);
+  GstElement *fakesink = gst_element_factory_make ("fakesink", NULL);
+  GstCaps *raw = gst_caps_from_string ("video/x-raw");
+  GstCaps *vp8 = gst_caps_from_string ("video/x-vp8");
+  GstCaps *prefers_vp8 = gst_caps_from_string ("video/x-vp8;video/x-raw");
+  GstCaps *prefers_raw = gst_caps_from_string ("video/x-raw;video/x-vp8");
+  gchar *video_pad_name;
+  GstCaps *caps;
+  GstPad *sink;
+
+  /* Like real sinks, the consumer also accepts raw media */
+  g_object_set (capsfilter, "caps", prefers_vp8, NULL);
+  gst_bin_add_many (pipe, hubport, capsfilter, fakesink, NULL);
+  fail_unless (gst_element_link (capsfilter, fakesink));
+
+  sink = gst_element_get_request_pad (hubport, HUB_VIDEO_SINK);
+  fail_unless (sink != NULL);
+
+  g_signal_emit_by_name (hubport, "request-new-pad",
+      KMS_ELEMENT_PAD_TYPE_VIDEO, NULL, GST_PAD_SRC, &video_pad_name);
+  fail_if (video_pad_name == NULL);
+  fail_unless (gst_element_link_pads (hubport, video_pad_name, capsfilter,
+          "sink"));
+
+  /* Not shared: the hub is free to send raw media */
+  caps = gst_pad_query_caps (sink, NULL);
+  fail_unless (gst_caps_can_intersect (caps, raw));
+  gst_caps_unref (caps);
+
+  /* Shared: the hub is asked for what the consumer wants */
+  g_object_set (hubport, "shared-video-encoding", TRUE, NULL);
+
+  caps = gst_pad_query_caps (sink, NULL);
+  fail_unless (gst_caps_is_always_compatible (caps, vp8));
+  gst_caps_unref (caps);
+  fail_if (gst_pad_query_accept_caps (sink, raw));
+  fail_unless (gst_pad_query_accept_caps (sink, vp8));
+
+  /* A consumer that prefers raw media gets it */
+  g_object_set (capsfilter, "caps", prefers_raw, NULL);
+
+  caps = gst_pad_query_caps (sink, NULL);
+  fail_unless (gst_caps_can_intersect (caps, raw));
+  gst_caps_unref (caps);
+
+  g_object_set (capsfilter, "caps", prefers_vp8, NULL);
+
+  /* Own bitrate limits need an own encoder */
+  g_object_set (hubport, "max-output-bitrate", 500000, NULL);
+
+  caps = gst_pad_query_caps (sink, NULL);
+  fail_unless (gst_caps_can_intersect (caps, raw));
+  gst_caps_unref (caps);
+
+  g_free (video_pad_name);
+  g_object_unref (sink);
+  gst_caps_unref (raw);
+  gst_caps_unref (vp8);
+  gst_caps_unref (prefers_vp8);
+  gst_caps_unref (prefers_raw);
+  g_object_unref (pipe);
+}
+
+GST_END_TEST
+#define SHARING_PORTS 2
+#define SHARING_BUFFERS 10
+
+static GMainLoop *loop;
+static gint receiving_ports;
+
+static gboolean
+quit_main_loop_idle (gpointer data)
+{
+  g_main_loop_quit (data);
+  return FALSE;
+}
+
+static void
+sharing_hand_off (GstElement * fakesink, GstBuffer * buf, GstPad * pad,
+    gpointer user_data)
+{
+  gint received;
+
+  received = GPOINTER_TO_INT (g_object_get_data (G_OBJECT (fakesink),
+          "received"));
+  g_object_set_data (G_OBJECT (fakesink), "received",
+      GINT_TO_POINTER (++received));
+
+  if (received == SHARING_BUFFERS
+      && g_atomic_int_dec_and_test (&receiving_ports)) {
+    g_idle_add (quit_main_loop_idle, loop);
+  }
+}
+
+static guint
+count_elements (GstElement * bin, const gchar * factory_name)
+{
+  GValue item = G_VALUE_INIT;
+  gboolean done = FALSE;
+  GstIterator *it;
+  guint count = 0;
+
+  it = gst_bin_iterate_recurse (GST_BIN (bin));
+
+  while (!done) {
+    switch (gst_iterator_next (it, &item)) {
+      case GST_ITERATOR_OK:{
+        GstElement *element = g_value_get_object (&item);
+        GstElementFactory *factory = gst_element_get_factory (element);
+
+        if (factory != NULL
+            && g_strcmp0 (GST_OBJECT_NAME (factory), factory_name) == 0) {
+          count++;
+        }
+
+        g_value_reset (&item);
+        break;
+      }
+      case GST_ITERATOR_RESYNC:
+        gst_iterator_resync (it);
+        count = 0;
+        break;
+      case GST_ITERATOR_ERROR:
+      case GST_ITERATOR_DONE:
+        done = TRUE;
+        break;
+    }
+  }
+
+  g_value_unset (&item);
+  gst_iterator_free (it);
+
+  return count;
+}
+
+GST_START_TEST (shared_encoding_single_encoder)
+{
+  GstElement *pipeline = gst_pipeline_new (__FUNCTION__);
+  GstElement *videosrc = gst_element_factory_make ("videotestsrc", NULL);
+  GstElement *agnostic = gst_element_factory_make ("agnosticbin", NULL);
+  GstElement *hubports[SHARING_PORTS];
+  gint i;
+
+  loop = g_main_loop_new (NULL, FALSE);
+  g_atomic_int_set (&receiving_ports, SHARING_PORTS);
+
+  g_object_set (videosrc, "is-live", TRUE, NULL);
+  gst_bin_add_many (GST_BIN (pipeline), videosrc, agnostic, NULL);
+  fail_unless (gst_element_link (videosrc, agnostic));
+
+  /* The hub agnosticbin feeds every port, as BaseHub does */
+  for (i = 0; i < SHARING_PORTS; i++) {
+    GstElement *capsfilter = gst_element_factory_make ("capsfilter", NULL);
+    GstElement *fakesink = gst_element_factory_make ("fakesink", NULL);
+    GstCaps *caps = gst_caps_from_string ("video/x-vp8;video/x-raw");
+    gchar *pad_name;
+
+    hubports[i] = gst_element_factory_make ("hubport", NULL);
+    g_object_set (hubports[i], "shared-video-encoding", TRUE, NULL);
+    g_object_set (capsfilter, "caps", caps, NULL);
+    gst_caps_unref (caps);
+    g_object_set (fakesink, "async", FALSE, "sync", FALSE,
+        "signal-handoffs", TRUE, NULL);
+    g_signal_connect (fakesink, "handoff", G_CALLBACK (sharing_hand_off),
+        NULL);
+
+    gst_bin_add_many (GST_BIN (pipeline), hubports[i], capsfilter, fakesink,
+        NULL);
+    fail_unless (gst_element_link (capsfilter, fakesink));
+
+    g_signal_emit_by_name (hubports[i], "request-new-pad",
+        KMS_ELEMENT_PAD_TYPE_VIDEO, NULL, GST_PAD_SRC, &pad_name);
+    fail_if (pad_name == NULL);
+    fail_unless (gst_element_link_pads (hubports[i], pad_name, capsfilter,
+            "sink"));
+    g_free (pad_name);
+
+    fail_unless (gst_element_link_pads (agnostic, "src_%u", hubports[i],
+            HUB_VIDEO_SINK));
+  }
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  mark_point ();
+  g_main_loop_run (loop);
+  mark_point ();
+
+  /* Both ports get the output of one encoder and do not encode again */
+  fail_unless (count_elements (agnostic, "vp8enc") == 1);
+  for (i = 0; i < SHARING_PORTS; i++) {
+    fail_unless (count_elements (hubports[i], "vp8enc") == 0);
+  }
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  g_object_unref (pipeline);
+  g_main_loop_unref (loop);
+}
+
+GST_END_TEST
+GST_START_TEST (hub_input_src)
+{
+  GstElement *hubport = gst_element_factory_make ("hubport", NULL);
+  gchar *pad_name = NULL;
+  GstPad *pad;
+
+  gst_object_ref_sink (hubport);
+
+  g_signal_emit_by_name (hubport, "request-new-pad",
+      KMS_ELEMENT_PAD_TYPE_VIDEO, HUB_INPUT_DESCRIPTION, GST_PAD_SRC,
+      &pad_name);
+  fail_if (pad_name == NULL);
+
+  /* The hub input is available as soon as it is requested */
+  pad = gst_element_get_static_pad (hubport, pad_name);
+  fail_if (pad == NULL);
+  g_object_unref (pad);
+  g_free (pad_name);
+
+  pad_name = NULL;
+  g_signal_emit_by_name (hubport, "request-new-pad",
+      KMS_ELEMENT_PAD_TYPE_DATA, HUB_INPUT_DESCRIPTION, GST_PAD_SRC,
+      &pad_name);
+  fail_unless (pad_name == NULL);
+
+  g_object_unref (hubport);
+}
+
 GST_END_TEST
 GST_START_TEST (create_element)
 {
@@ -144,6 +376,9 @@ hubport_suite (void)
   tcase_add_test (tc_chain, create_element);
   tcase_add_test (tc_chain, connect_sinks);
   tcase_add_test (tc_chain, connect_srcs);
+  tcase_add_test (tc_chain, shared_encoding_caps);
+  tcase_add_test (tc_chain, shared_encoding_single_encoder);
+  tcase_add_test (tc_chain, hub_input_src);
 
   return s;
 }
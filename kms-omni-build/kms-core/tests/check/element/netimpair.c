@@ -0,0 +1,245 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/gst.h>
+
+#define PACKETS 200
+
+static GstHarness *
+create_harness (void)
+{
+  GstHarness *h = gst_harness_new ("netimpair");
+
+  gst_harness_set_src_caps_str (h, "application/x-rtp");
+
+  return h;
+}
+
+static guint64
+get_stat (GstHarness * h, const gchar * name)
+{
+  GstStructure *stats;
+  guint64 value = 0;
+
+  g_object_get (h->element, "stats", &stats, NULL);
+  gst_structure_get_uint64 (stats, name, &value);
+  gst_structure_free (stats);
+
+  return value;
+}
+
+static GstClockTime
+get_time (GstHarness * h)
+{
+  GstTestClock *clock = gst_harness_get_testclock (h);
+  GstClockTime now = gst_clock_get_time (GST_CLOCK (clock));
+
+  gst_object_unref (clock);
+
+  return now;
+}
+
+static void
+push_numbered (GstHarness * h, guint64 count)
+{
+  guint64 i;
+
+  for (i = 0; i < count; i++) {
+    GstBuffer *buf = gst_buffer_new_allocate (NULL, 100, NULL);
+
+    GST_BUFFER_OFFSET (buf) = i;
+    fail_unless_equals_int (gst_harness_push (h, buf), GST_FLOW_OK);
+  }
+}
+
+/* Offsets of the packets that went through, in output order */
+static GArray *
+pull_numbered (GstHarness * h, guint64 count)
+{
+  GArray *offsets = g_array_new (FALSE, FALSE, sizeof (guint64));
+  guint64 i;
+
+  for (i = 0; i < count; i++) {
+    GstBuffer *buf = gst_harness_pull (h);
+
+    fail_unless (buf != NULL);
+    g_array_append_val (offsets, GST_BUFFER_OFFSET (buf));
+    gst_buffer_unref (buf);
+  }
+
+  return offsets;
+}
+
+static GArray *
+run_bursty_loss (guint seed)
+{
+  GstHarness *h = create_harness ();
+  GArray *offsets;
+  guint64 lost;
+
+  g_object_set (h->element, "seed", seed, "loss-good", 0.05, "loss-bad", 0.8,
+      "good-to-bad", 0.05, "bad-to-good", 0.3, NULL);
+
+  push_numbered (h, PACKETS);
+  lost = get_stat (h, "lost");
+  fail_unless (lost > 0 && lost < PACKETS);
+
+  offsets = pull_numbered (h, PACKETS - lost);
+  fail_unless (gst_harness_try_pull (h) == NULL);
+
+  gst_harness_teardown (h);
+
+  return offsets;
+}
+
+GST_START_TEST (reproducible_loss)
+{
+  GArray *first, *second, *other;
+
+  first = run_bursty_loss (42);
+  second = run_bursty_loss (42);
+  other = run_bursty_loss (7);
+
+  fail_unless_equals_int (first->len, second->len);
+  fail_unless (memcmp (first->data, second->data,
+          first->len * sizeof (guint64)) == 0);
+
+  fail_unless (first->len != other->len
+      || memcmp (first->data, other->data,
+          first->len * sizeof (guint64)) != 0);
+
+  g_array_unref (first);
+  g_array_unref (second);
+  g_array_unref (other);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (delay_and_duplication)
+{
+  GstHarness *h = create_harness ();
+  GstBuffer *buf;
+
+  g_object_set (h->element, "delay", 50, "duplicate-probability", 1.0, NULL);
+
+  push_numbered (h, 1);
+  fail_unless (gst_harness_try_pull (h) == NULL);
+
+  fail_unless (gst_harness_crank_single_clock_wait (h));
+  fail_unless_equals_uint64 (get_time (h), 50 * GST_MSECOND);
+
+  buf = gst_harness_pull (h);
+  fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buf), 0);
+  gst_buffer_unref (buf);
+
+  buf = gst_harness_pull (h);
+  fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buf), 0);
+  gst_buffer_unref (buf);
+
+  fail_unless_equals_uint64 (get_stat (h, "duplicated"), 1);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (bandwidth_queue)
+{
+  GstHarness *h = create_harness ();
+  GstBuffer *buf;
+
+  /* 100 bytes take 100 ms at 8 kbps, only two packets fit in the queue */
+  g_object_set (h->element, "bandwidth", 8000, "queue-size", 250, NULL);
+
+  push_numbered (h, 3);
+  fail_unless_equals_uint64 (get_stat (h, "queue-dropped"), 1);
+
+  fail_unless (gst_harness_crank_single_clock_wait (h));
+  buf = gst_harness_pull (h);
+  fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buf), 0);
+  fail_unless_equals_uint64 (get_time (h), 100 * GST_MSECOND);
+  gst_buffer_unref (buf);
+
+  fail_unless (gst_harness_crank_single_clock_wait (h));
+  buf = gst_harness_pull (h);
+  fail_unless_equals_uint64 (GST_BUFFER_OFFSET (buf), 1);
+  fail_unless_equals_uint64 (get_time (h), 200 * GST_MSECOND);
+  gst_buffer_unref (buf);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (reordering)
+{
+  GstHarness *h = create_harness ();
+  GArray *offsets;
+  guint64 reordered, i, late = 0;
+
+  g_object_set (h->element, "seed", 3, "reorder-probability", 0.3,
+      "reorder-delay", 10, NULL);
+
+  push_numbered (h, 20);
+  reordered = get_stat (h, "reordered");
+  fail_unless (reordered > 0);
+
+  /* Packets on time go first, the held back ones after the clock moves */
+  offsets = pull_numbered (h, 20 - reordered);
+  fail_unless (gst_harness_crank_single_clock_wait (h));
+  g_array_unref (offsets);
+  offsets = pull_numbered (h, reordered);
+
+  for (i = 1; i < offsets->len; i++) {
+    if (g_array_index (offsets, guint64, i) <
+        g_array_index (offsets, guint64, i - 1)) {
+      late++;
+    }
+  }
+
+  /* Within each group packets keep their order */
+  fail_unless_equals_uint64 (late, 0);
+  fail_unless_equals_uint64 (get_time (h), 10 * GST_MSECOND);
+
+  g_array_unref (offsets);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+static Suite *
+netimpair_suite (void)
+{
+  Suite *s = suite_create ("netimpair");
+  TCase *tc_chain = tcase_create ("element");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, reproducible_loss);
+  tcase_add_test (tc_chain, delay_and_duplication);
+  tcase_add_test (tc_chain, bandwidth_queue);
+  tcase_add_test (tc_chain, reordering);
+
+  return s;
+}
+
+GST_CHECK_MAIN (netimpair);
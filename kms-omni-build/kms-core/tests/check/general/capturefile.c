@@ -0,0 +1,271 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <gst/check/gstcheck.h>
+#include <gst/gst.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <unistd.h>
+
+#include "kmscapturefile.h"
+
+#define FRAMES 10
+#define FRAME_DURATION (40 * GST_MSECOND)
+
+static GstBuffer *
+create_frame (guint n)
+{
+  GstBuffer *buffer;
+  guint8 *data;
+  gsize size = 100 + n * 7, i;
+
+  data = g_malloc (size);
+  for (i = 0; i < size; i++) {
+    data[i] = (guint8) (n * 31 + i);
+  }
+
+  buffer = gst_buffer_new_wrapped (data, size);
+  GST_BUFFER_PTS (buffer) = n * FRAME_DURATION;
+  GST_BUFFER_DTS (buffer) = n * FRAME_DURATION;
+  GST_BUFFER_DURATION (buffer) = FRAME_DURATION;
+
+  /* One key frame every 4 */
+  if (n % 4 != 0) {
+    GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT);
+  }
+
+  return buffer;
+}
+
+static void
+append (GByteArray * array, GstBuffer * buffer)
+{
+  GstMapInfo info;
+
+  fail_unless (gst_buffer_map (buffer, &info, GST_MAP_READ));
+  g_byte_array_append (array, info.data, info.size);
+  gst_buffer_unmap (buffer, &info);
+  gst_buffer_unref (buffer);
+}
+
+/* Writes a capture with one video track and returns its path */
+static gchar *
+write_capture (gboolean finish, gsize cut)
+{
+  KmsCaptureWriter *writer;
+  GByteArray *array;
+  GstCaps *caps;
+  gchar *path;
+  gint fd;
+  guint i;
+
+  fd = g_file_open_tmp ("kmscapture-XXXXXX", &path, NULL);
+  fail_unless (fd >= 0);
+  close (fd);
+
+  writer = kms_capture_writer_new (KMS_RECORDING_PROFILE_WEBM);
+  array = g_byte_array_new ();
+  caps = gst_caps_from_string ("video/x-vp8,width=320,height=240");
+
+  append (array, kms_capture_writer_header (writer));
+  append (array, kms_capture_writer_track (writer, 0, KMS_MEDIA_TYPE_VIDEO,
+          caps));
+
+  for (i = 0; i < FRAMES; i++) {
+    GstBuffer *frame = create_frame (i);
+
+    append (array, kms_capture_writer_buffer (writer, 0, frame,
+            i * GST_MSECOND));
+    gst_buffer_unref (frame);
+  }
+
+  if (finish) {
+    append (array, kms_capture_writer_finish (writer));
+  }
+
+  fail_unless (cut < array->len);
+  fail_unless (g_file_set_contents (path, (const gchar *) array->data,
+          array->len - cut, NULL));
+
+  kms_capture_writer_free (writer);
+  g_byte_array_unref (array);
+  gst_caps_unref (caps);
+
+  return path;
+}
+
+static void
+check_frame (GstBuffer * buffer, guint n)
+{
+  GstBuffer *expected = create_frame (n);
+  GstMapInfo a, b;
+
+  fail_unless (GST_BUFFER_PTS (buffer) == GST_BUFFER_PTS (expected));
+  fail_unless (GST_BUFFER_DTS (buffer) == GST_BUFFER_DTS (expected));
+  fail_unless (GST_BUFFER_DURATION (buffer) ==
+      GST_BUFFER_DURATION (expected));
+  fail_unless (GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT) ==
+      GST_BUFFER_FLAG_IS_SET (expected, GST_BUFFER_FLAG_DELTA_UNIT));
+
+  fail_unless (gst_buffer_map (buffer, &a, GST_MAP_READ));
+  fail_unless (gst_buffer_map (expected, &b, GST_MAP_READ));
+  fail_unless (a.size == b.size);
+  fail_unless (memcmp (a.data, b.data, a.size) == 0);
+  gst_buffer_unmap (buffer, &a);
+  gst_buffer_unmap (expected, &b);
+
+  gst_buffer_unref (expected);
+}
+
+static void
+check_track (KmsCaptureReader * reader)
+{
+  KmsCaptureRecord record;
+  GstCaps *caps = NULL, *expected;
+  GstBuffer *buffer = NULL;
+  GstClockTime arrival;
+  KmsMediaType type;
+  guint track;
+
+  record = kms_capture_reader_next (reader, &track, &type, &caps, &buffer,
+      &arrival);
+  fail_unless (record == KMS_CAPTURE_RECORD_TRACK);
+  fail_unless (track == 0);
+  fail_unless (type == KMS_MEDIA_TYPE_VIDEO);
+
+  expected = gst_caps_from_string ("video/x-vp8,width=320,height=240");
+  fail_unless (gst_caps_is_equal (caps, expected));
+  gst_caps_unref (expected);
+  gst_caps_unref (caps);
+}
+
+/* Returns the number of frames read, checking each one */
+static guint
+read_frames (KmsCaptureReader * reader, guint first, KmsCaptureRecord * last)
+{
+  KmsCaptureRecord record;
+  GstClockTime arrival;
+  GstBuffer *buffer;
+  KmsMediaType type;
+  GstCaps *caps;
+  guint track, n = first;
+
+  for (;;) {
+    buffer = NULL;
+    caps = NULL;
+    record = kms_capture_reader_next (reader, &track, &type, &caps, &buffer,
+        &arrival);
+
+    if (record != KMS_CAPTURE_RECORD_BUFFER) {
+      break;
+    }
+
+    fail_unless (track == 0);
+    fail_unless (arrival == n * GST_MSECOND);
+    check_frame (buffer, n);
+    gst_buffer_unref (buffer);
+    n++;
+  }
+
+  *last = record;
+
+  return n - first;
+}
+
+GST_START_TEST (round_trip)
+{
+  KmsCaptureReader *reader;
+  KmsCaptureRecord last;
+  gchar *path;
+
+  path = write_capture (TRUE, 0);
+  reader = kms_capture_reader_new (path, NULL);
+  fail_unless (reader != NULL);
+
+  fail_unless (kms_capture_reader_get_profile (reader) ==
+      KMS_RECORDING_PROFILE_WEBM);
+  fail_unless (kms_capture_reader_is_indexed (reader));
+
+  check_track (reader);
+  fail_unless (read_frames (reader, 0, &last) == FRAMES);
+  fail_unless (last == KMS_CAPTURE_RECORD_END);
+
+  kms_capture_reader_free (reader);
+  g_unlink (path);
+  g_free (path);
+}
+
+GST_END_TEST
+GST_START_TEST (truncated)
+{
+  KmsCaptureReader *reader;
+  KmsCaptureRecord last;
+  gchar *path;
+
+  /* Server died in the middle of the last frame */
+  path = write_capture (FALSE, 10);
+  reader = kms_capture_reader_new (path, NULL);
+  fail_unless (reader != NULL);
+  fail_if (kms_capture_reader_is_indexed (reader));
+
+  check_track (reader);
+  fail_unless (read_frames (reader, 0, &last) == FRAMES - 1);
+  fail_unless (last == KMS_CAPTURE_RECORD_ERROR);
+
+  kms_capture_reader_free (reader);
+  g_unlink (path);
+  g_free (path);
+}
+
+GST_END_TEST
+GST_START_TEST (seek)
+{
+  KmsCaptureReader *reader;
+  KmsCaptureRecord last;
+  gchar *path;
+
+  path = write_capture (TRUE, 0);
+  reader = kms_capture_reader_new (path, NULL);
+  fail_unless (reader != NULL);
+
+  /* Frame 6 is a delta, reading restarts at key frame 4 */
+  fail_unless (kms_capture_reader_seek (reader, 6 * FRAME_DURATION));
+  check_track (reader);
+  fail_unless (read_frames (reader, 4, &last) == FRAMES - 4);
+  fail_unless (last == KMS_CAPTURE_RECORD_END);
+
+  kms_capture_reader_free (reader);
+  g_unlink (path);
+  g_free (path);
+}
+
+GST_END_TEST
+/* Suite initialization */
+static Suite *
+capturefile_suite (void)
+{
+  Suite *s = suite_create ("capturefile");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, round_trip);
+  tcase_add_test (tc_chain, truncated);
+  tcase_add_test (tc_chain, seek);
+
+  return s;
+}
+
+GST_CHECK_MAIN (capturefile);
@@ -0,0 +1,332 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <gst/check/gstcheck.h>
+#include <gst/gst.h>
+#include <glib.h>
+
+#include "kmslatencyprofile.h"
+
+static void
+set_profile (GstElement * pipeline, KmsLatencyProfile profile)
+{
+  GstContext *context = kms_latency_profile_context_new (profile);
+
+  gst_element_set_context (pipeline, context);
+  gst_context_unref (context);
+}
+
+GST_START_TEST (context_propagation)
+{
+  GstElement *pipeline = gst_pipeline_new (__FUNCTION__);
+  GstElement *bin = gst_bin_new (NULL);
+  GstElement *before = gst_element_factory_make ("identity", NULL);
+  GstElement *after = gst_element_factory_make ("identity", NULL);
+
+  gst_bin_add (GST_BIN (bin), before);
+  gst_bin_add (GST_BIN (pipeline), bin);
+
+  fail_unless (kms_latency_profile_get_element_targets (before) ==
+      kms_latency_profile_get_targets (KMS_LATENCY_PROFILE_DEFAULT));
+
+  set_profile (pipeline, KMS_LATENCY_PROFILE_INTERACTIVE);
+
+  /* Existing and new elements, at any depth, see the profile */
+  gst_bin_add (GST_BIN (bin), after);
+
+  fail_unless (kms_latency_profile_get_element_targets (before) ==
+      kms_latency_profile_get_targets (KMS_LATENCY_PROFILE_INTERACTIVE));
+  fail_unless (kms_latency_profile_get_element_targets (after) ==
+      kms_latency_profile_get_targets (KMS_LATENCY_PROFILE_INTERACTIVE));
+
+  set_profile (pipeline, KMS_LATENCY_PROFILE_RECORDING);
+
+  fail_unless (kms_latency_profile_get_element_targets (after) ==
+      kms_latency_profile_get_targets (KMS_LATENCY_PROFILE_RECORDING));
+
+  g_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+static GMainLoop *loop;
+
+static void
+fakesink_hand_off (GstElement * fakesink, GstBuffer * buf, GstPad * pad,
+    gpointer data)
+{
+  g_signal_handlers_disconnect_by_data (fakesink, data);
+  g_main_loop_quit (loop);
+}
+
+static void
+check_queue_time (const GValue * item, gpointer user_data)
+{
+  GstElement *element = g_value_get_object (item);
+  GstClockTime *expected = user_data;
+  GstClockTime max_time;
+  gint leaky;
+
+  if (g_strcmp0 (G_OBJECT_TYPE_NAME (element), "GstQueue") != 0) {
+    return;
+  }
+
+  g_object_get (element, "leaky", &leaky, "max-size-time", &max_time, NULL);
+
+  if (leaky == 2) {
+    fail_unless (max_time == *expected);
+    *expected = GST_CLOCK_TIME_NONE;
+  }
+}
+
+static void
+assert_queue_time (GstElement * agnosticbin, GstClockTime expected)
+{
+  GstIterator *it = gst_bin_iterate_elements (GST_BIN (agnosticbin));
+
+  gst_iterator_foreach (it, check_queue_time, &expected);
+  gst_iterator_free (it);
+
+  /* A leaky queue was found and checked */
+  fail_unless (expected == GST_CLOCK_TIME_NONE);
+}
+
+GST_START_TEST (agnosticbin_queues)
+{
+  GstElement *pipeline = gst_pipeline_new (__FUNCTION__);
+  GstElement *videosrc = gst_element_factory_make ("videotestsrc", NULL);
+  GstElement *agnosticbin = gst_element_factory_make ("agnosticbin", NULL);
+  GstElement *fakesink = gst_element_factory_make ("fakesink", NULL);
+
+  loop = g_main_loop_new (NULL, TRUE);
+
+  g_object_set (videosrc, "is-live", TRUE, NULL);
+  g_object_set (fakesink, "sync", FALSE, "signal-handoffs", TRUE, "async",
+      FALSE, NULL);
+  g_signal_connect (fakesink, "handoff", G_CALLBACK (fakesink_hand_off), loop);
+
+  set_profile (pipeline, KMS_LATENCY_PROFILE_INTERACTIVE);
+
+  gst_bin_add_many (GST_BIN (pipeline), videosrc, agnosticbin, fakesink, NULL);
+  gst_element_link_many (videosrc, agnosticbin, fakesink, NULL);
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  mark_point ();
+  g_main_loop_run (loop);
+  mark_point ();
+
+  /* Raw output, so there is a leaky queue built with the profile */
+  assert_queue_time (agnosticbin,
+      kms_latency_profile_get_targets
+      (KMS_LATENCY_PROFILE_INTERACTIVE)->queue_time);
+
+  set_profile (pipeline, KMS_LATENCY_PROFILE_BROADCAST);
+
+  assert_queue_time (agnosticbin,
+      kms_latency_profile_get_targets
+      (KMS_LATENCY_PROFILE_BROADCAST)->queue_time);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  g_object_unref (pipeline);
+  g_main_loop_unref (loop);
+}
+
+GST_END_TEST;
+
+static guint
+count_messages_from (GstBus * bus, GstMessageType types, GstElement * src)
+{
+  GstMessage *msg;
+  guint count = 0;
+
+  while ((msg = gst_bus_pop_filtered (bus, types)) != NULL) {
+    if (GST_MESSAGE_SRC (msg) == GST_OBJECT (src)) {
+      count++;
+    }
+    gst_message_unref (msg);
+  }
+
+  return count;
+}
+
+GST_START_TEST (latency_domain)
+{
+  GstElement *pipeline = gst_pipeline_new (__FUNCTION__);
+  GstElement *element = gst_element_factory_make ("dummysrc", NULL);
+  GstElement *child = gst_element_factory_make ("identity", NULL);
+  GstBus *bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
+  GstMessage *msg;
+
+  gst_bin_add (GST_BIN (element), child);
+  gst_bin_add (GST_BIN (pipeline), element);
+
+  gst_element_post_message (child, gst_message_new_latency (GST_OBJECT
+          (child)));
+  fail_unless_equals_int (count_messages_from (bus, GST_MESSAGE_LATENCY,
+          child), 1);
+
+  g_object_set (element, "latency-domain", TRUE, NULL);
+
+  /* A burst of changes from children becomes one message from the element */
+  gst_element_post_message (child, gst_message_new_latency (GST_OBJECT
+          (child)));
+  gst_element_post_message (child, gst_message_new_latency (GST_OBJECT
+          (child)));
+  fail_unless_equals_int (count_messages_from (bus, GST_MESSAGE_LATENCY,
+          child), 0);
+
+  msg = gst_bus_timed_pop_filtered (bus, GST_SECOND, GST_MESSAGE_LATENCY);
+  fail_if (msg == NULL);
+  fail_unless (GST_MESSAGE_SRC (msg) == GST_OBJECT (element));
+  gst_message_unref (msg);
+  g_usleep (100 * G_TIME_SPAN_MILLISECOND);
+  fail_unless_equals_int (count_messages_from (bus, GST_MESSAGE_LATENCY,
+          element), 0);
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  fail_unless_equals_int (count_messages_from (bus,
+          GST_MESSAGE_STATE_CHANGED, child), 0);
+  fail_unless (count_messages_from (bus, GST_MESSAGE_STATE_CHANGED,
+          element) > 0);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  g_object_unref (bus);
+  g_object_unref (pipeline);
+}
+
+GST_END_TEST;
+
+typedef struct _SinkLatency
+{
+  GMutex mutex;
+  GCond cond;
+  GstClockTime latency;
+} SinkLatency;
+
+static GstPadProbeReturn
+sink_latency_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  GstEvent *event = gst_pad_probe_info_get_event (info);
+  SinkLatency *data = user_data;
+
+  if (GST_EVENT_TYPE (event) == GST_EVENT_LATENCY) {
+    g_mutex_lock (&data->mutex);
+    gst_event_parse_latency (event, &data->latency);
+    GST_DEBUG_OBJECT (pad, "Configured latency %" GST_TIME_FORMAT,
+        GST_TIME_ARGS (data->latency));
+    g_cond_broadcast (&data->cond);
+    g_mutex_unlock (&data->mutex);
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+static gboolean
+wait_sink_latency (SinkLatency * data, GstClockTime min_latency)
+{
+  gint64 end_time = g_get_monotonic_time () + 5 * G_TIME_SPAN_SECOND;
+  gboolean ret = TRUE;
+
+  g_mutex_lock (&data->mutex);
+  while (ret && (!GST_CLOCK_TIME_IS_VALID (data->latency)
+          || data->latency < min_latency)) {
+    ret = g_cond_wait_until (&data->cond, &data->mutex, end_time);
+  }
+  g_mutex_unlock (&data->mutex);
+
+  return ret;
+}
+
+static void
+add_ghost_pad (GstElement * element, GstElement * child, const gchar * name,
+    GstPad * target)
+{
+  gst_bin_add (GST_BIN (element), child);
+  gst_element_add_pad (element, gst_ghost_pad_new (name, target));
+}
+
+GST_START_TEST (latency_domain_downstream)
+{
+  GstElement *pipeline = gst_pipeline_new (__FUNCTION__);
+  GstElement *producer = gst_element_factory_make ("dummysrc", NULL);
+  GstElement *consumer = gst_element_factory_make ("dummysrc", NULL);
+  GstElement *fakesink = gst_element_factory_make ("fakesink", NULL);
+  GstElement *jitterbuffer, *source;
+  SinkLatency data;
+  GstPad *pad;
+
+  g_mutex_init (&data.mutex);
+  g_cond_init (&data.cond);
+  data.latency = GST_CLOCK_TIME_NONE;
+
+  g_object_set (producer, "latency-domain", TRUE, NULL);
+  g_object_set (consumer, "latency-domain", TRUE, NULL);
+  gst_bin_add_many (GST_BIN (pipeline), producer, consumer, NULL);
+
+  /* Jitterbuffer in one element, sink in another */
+  source = gst_parse_bin_from_description ("audiotestsrc is-live=true"
+      " ! rtpL16pay ! rtpjitterbuffer name=jb latency=50", TRUE, NULL);
+  fail_if (source == NULL);
+  jitterbuffer = gst_bin_get_by_name (GST_BIN (source), "jb");
+  pad = gst_element_get_static_pad (source, "src");
+  add_ghost_pad (producer, source, "relay_src", pad);
+  g_object_unref (pad);
+
+  g_object_set (fakesink, "sync", TRUE, NULL);
+  pad = gst_element_get_static_pad (fakesink, "sink");
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_EVENT_UPSTREAM,
+      sink_latency_probe, &data, NULL);
+  add_ghost_pad (consumer, fakesink, "relay_sink", pad);
+  g_object_unref (pad);
+
+  fail_unless (gst_element_link_pads (producer, "relay_src", consumer,
+          "relay_sink"));
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  fail_unless (wait_sink_latency (&data, 50 * GST_MSECOND));
+
+  /* The change is posted inside the producer and must reach the sink */
+  g_object_set (jitterbuffer, "latency", 500, NULL);
+  fail_unless (wait_sink_latency (&data, 500 * GST_MSECOND),
+      "Sink latency is %" GST_TIME_FORMAT, GST_TIME_ARGS (data.latency));
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  g_object_unref (jitterbuffer);
+  g_object_unref (pipeline);
+  g_mutex_clear (&data.mutex);
+  g_cond_clear (&data.cond);
+}
+
+GST_END_TEST;
+
+/* Suite initialization */
+static Suite *
+latencyprofile_suite (void)
+{
+  Suite *s = suite_create ("latencyprofile");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, context_propagation);
+  tcase_add_test (tc_chain, agnosticbin_queues);
+  tcase_add_test (tc_chain, latency_domain);
+  tcase_add_test (tc_chain, latency_domain_downstream);
+
+  return s;
+}
+
+GST_CHECK_MAIN (latencyprofile);
@@ -16,6 +16,7 @@
  */
 
 #include "kmsutils.h"
+#include "kmsbitratetiers.h"
 
 #include <gst/check/gstcheck.h>
 #include <glib.h>
@@ -130,6 +131,60 @@ GST_START_TEST (check_take_into_account_after_clear_time)
 
 GST_END_TEST;
 
+GST_START_TEST (check_tiers_group_estimates)
+{
+  guint estimates[] = { 2000000, 300000, 1800000, 250000, 900000, 1000000 };
+  guint bitrates[KMS_BITRATE_TIERS_MAX];
+  guint membership[G_N_ELEMENTS (estimates)];
+  guint n_tiers;
+
+  n_tiers = kms_bitrate_tiers_compute (estimates, G_N_ELEMENTS (estimates), 4,
+      KMS_BITRATE_TIERS_DEFAULT_SPACING, bitrates, membership);
+
+  /* A poor link only drags down the consumers with a similar one */
+  fail_unless (n_tiers == 3);
+  fail_unless (bitrates[0] == 1800000);
+  fail_unless (bitrates[1] == 900000);
+  fail_unless (bitrates[2] == 250000);
+
+  fail_unless (membership[0] == 0 && membership[2] == 0);
+  fail_unless (membership[4] == 1 && membership[5] == 1);
+  fail_unless (membership[1] == 2 && membership[3] == 2);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (check_tiers_bounded)
+{
+  guint estimates[] = { 2000000, 300000, 1800000, 250000, 900000, 1000000 };
+  guint bitrates[KMS_BITRATE_TIERS_MAX];
+  guint membership[G_N_ELEMENTS (estimates)];
+  guint n_tiers;
+
+  /* The two closest tiers are merged */
+  n_tiers = kms_bitrate_tiers_compute (estimates, G_N_ELEMENTS (estimates), 2,
+      KMS_BITRATE_TIERS_DEFAULT_SPACING, bitrates, membership);
+
+  fail_unless (n_tiers == 2);
+  fail_unless (bitrates[0] == 900000);
+  fail_unless (bitrates[1] == 250000);
+  fail_unless (membership[0] == 0 && membership[4] == 0);
+  fail_unless (membership[1] == 1 && membership[3] == 1);
+
+  /* A single tier behaves like the minimum of all the estimates */
+  n_tiers = kms_bitrate_tiers_compute (estimates, G_N_ELEMENTS (estimates), 1,
+      KMS_BITRATE_TIERS_DEFAULT_SPACING, bitrates, membership);
+
+  fail_unless (n_tiers == 1);
+  fail_unless (bitrates[0] == 250000);
+
+  n_tiers = kms_bitrate_tiers_compute (estimates, 0, 4,
+      KMS_BITRATE_TIERS_DEFAULT_SPACING, bitrates, membership);
+  fail_unless (n_tiers == 0);
+}
+
+GST_END_TEST;
+
 /* Suite initialization */
 static Suite *
 rembmanager_suite (void)
@@ -140,6 +195,8 @@ rembmanager_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, check_min_br_update);
   tcase_add_test (tc_chain, check_take_into_account_after_clear_time);
+  tcase_add_test (tc_chain, check_tiers_group_estimates);
+  tcase_add_test (tc_chain, check_tiers_bounded);
 
   return s;
 }
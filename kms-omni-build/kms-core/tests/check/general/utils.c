@@ -15,6 +15,7 @@
  *
  */
 #include "kmsutils.h"
+#include "kmsgopcache.h"
 #include "sdp_utils.h"
 
 #include <gst/check/gstcheck.h>
@@ -380,6 +381,83 @@ GST_START_TEST (check_kms_utils_drop_until_keyframe_bufferlist)
 
 GST_END_TEST;
 
+static GstBuffer *
+new_frame (gsize size, gboolean keyframe)
+{
+  GstBuffer *buf = gst_buffer_new_allocate (NULL, size, NULL);
+
+  if (!keyframe) {
+    GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_DELTA_UNIT);
+  }
+
+  return buf;
+}
+
+static void
+push_frame (KmsGopCache * cache, gsize size, gboolean keyframe)
+{
+  GstBuffer *buf = new_frame (size, keyframe);
+
+  kms_gop_cache_push (cache, buf);
+  gst_buffer_unref (buf);
+}
+
+GST_START_TEST (check_kms_gop_cache)
+{
+  KmsGopCache *cache = kms_gop_cache_new (1000, G_USEC_PER_SEC);
+  GstBufferList *list;
+  GstBuffer *key;
+
+  GST_DEBUG ("Nothing cached before the first keyframe");
+  push_frame (cache, 100, FALSE);
+  fail_unless (kms_gop_cache_get (cache) == NULL);
+
+  key = new_frame (300, TRUE);
+  kms_gop_cache_push (cache, key);
+  push_frame (cache, 100, FALSE);
+  push_frame (cache, 100, FALSE);
+
+  list = kms_gop_cache_get (cache);
+  fail_unless (list != NULL);
+  fail_unless (gst_buffer_list_length (list) == 3);
+  fail_unless (gst_buffer_list_get (list, 0) == key);
+  gst_buffer_list_unref (list);
+  gst_buffer_unref (key);
+
+  GST_DEBUG ("A new keyframe starts a new GOP");
+  push_frame (cache, 200, TRUE);
+  list = kms_gop_cache_get (cache);
+  fail_unless (gst_buffer_list_length (list) == 1);
+  gst_buffer_list_unref (list);
+
+  GST_DEBUG ("A GOP over the limit is dropped until the next keyframe");
+  push_frame (cache, 500, FALSE);
+  push_frame (cache, 500, FALSE);
+  fail_unless (kms_gop_cache_get (cache) == NULL);
+  push_frame (cache, 100, FALSE);
+  fail_unless (kms_gop_cache_get (cache) == NULL);
+  push_frame (cache, 100, TRUE);
+  list = kms_gop_cache_get (cache);
+  fail_unless (gst_buffer_list_length (list) == 1);
+  gst_buffer_list_unref (list);
+
+  GST_DEBUG ("Size 0 disables it");
+  kms_gop_cache_set_max_size (cache, 0);
+  push_frame (cache, 100, TRUE);
+  fail_unless (kms_gop_cache_get (cache) == NULL);
+
+  kms_gop_cache_free (cache);
+
+  GST_DEBUG ("Old keyframes are stale");
+  cache = kms_gop_cache_new (1000, 1000);
+  push_frame (cache, 100, TRUE);
+  g_usleep (2000);
+  fail_unless (kms_gop_cache_get (cache) == NULL);
+  kms_gop_cache_free (cache);
+}
+
+GST_END_TEST;
+
 /* Suite initialization */
 static Suite *
 utils_suite (void)
@@ -397,6 +475,7 @@ utils_suite (void)
 
   tcase_add_test (tc_chain, check_kms_utils_drop_until_keyframe_buffer);
   tcase_add_test (tc_chain, check_kms_utils_drop_until_keyframe_bufferlist);
+  tcase_add_test (tc_chain, check_kms_gop_cache);
 
   return s;
 }
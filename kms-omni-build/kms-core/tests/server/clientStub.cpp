@@ -0,0 +1,235 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE ClientStub
+#include <boost/test/unit_test.hpp>
+#include <ModuleManager.hpp>
+#include <KurentoException.hpp>
+#include <MediaSet.hpp>
+#include <ClientSession.hpp>
+#include <DeferredResponse.hpp>
+#include <MediaPipelineClient.hpp>
+#include <PassThroughClient.hpp>
+#include <ElementConnected.hpp>
+#include <MediaElement.hpp>
+#include <Stats.hpp>
+#include <gst/gst.h>
+#include <json/json.h>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+#include <config.h>
+
+using namespace kurento;
+
+#define N_CALLS 10000
+
+std::shared_ptr <ModuleManager> moduleManager;
+
+struct InitTests {
+  InitTests();
+  ~InitTests();
+};
+
+BOOST_GLOBAL_FIXTURE (InitTests);
+
+InitTests::InitTests()
+{
+  gst_init (nullptr, nullptr);
+
+  moduleManager = std::make_shared<ModuleManager>();
+  moduleManager->loadModule ("../../src/server/libkmscoremodule.so");
+}
+
+InitTests::~InitTests()
+{
+  moduleManager.reset();
+  MediaSet::deleteMediaSet();
+}
+
+BOOST_AUTO_TEST_CASE (typed_calls)
+{
+  auto session = std::make_shared<ClientSession> (
+                   boost::property_tree::ptree () );
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::string connectedSink;
+
+  auto pipeline = MediaPipelineClient::create (session);
+  auto source = PassThroughClient::create (session, pipeline->getObject () );
+  auto sink = PassThroughClient::create (session, pipeline->getObject () );
+
+  // Objects are visible to the session as if created by a remote client
+  auto found = PassThroughClient::get (session, source->getId () );
+  BOOST_CHECK (found->getObject () == source->getObject () );
+
+  try {
+    MediaPipelineClient::get (session, source->getId () );
+    BOOST_FAIL ("This code should not be reached");
+  } catch (const KurentoException &e) {
+    BOOST_CHECK (e.getCode() == MEDIA_OBJECT_NOT_FOUND);
+  }
+
+  source->setName ("source");
+  BOOST_CHECK_EQUAL (source->getName (), "source");
+
+  source->connectElementConnected ([&] (const ElementConnected &event) {
+    std::unique_lock<std::mutex> lock (mtx);
+
+    connectedSink = event.getSink ()->getId ();
+    cv.notify_one ();
+  });
+
+  source->connect (sink->getObject () );
+
+  std::unique_lock<std::mutex> lock (mtx);
+
+  if (!cv.wait_for (lock, std::chrono::seconds (5), [&] () {
+  return !connectedSink.empty ();
+  }) ) {
+    BOOST_FAIL ("Timeout waiting for ElementConnected event");
+  }
+
+  BOOST_CHECK_EQUAL (connectedSink, sink->getId () );
+  lock.unlock ();
+
+  // Released objects are rejected, as with remote requests
+  sink->release ();
+
+  try {
+    source->connect (sink->getObject () );
+    BOOST_FAIL ("This code should not be reached");
+  } catch (const KurentoException &e) {
+    BOOST_CHECK (e.getCode() == MEDIA_OBJECT_NOT_FOUND);
+  }
+
+  try {
+    sink->getName ();
+    BOOST_FAIL ("This code should not be reached");
+  } catch (const KurentoException &e) {
+    BOOST_CHECK (e.getCode() == MEDIA_OBJECT_NOT_FOUND);
+  }
+
+  pipeline->release ();
+}
+
+/* A module method serving a request calls a method that defers when it can */
+BOOST_AUTO_TEST_CASE (sync_calls_inside_deferrable_request)
+{
+  auto session = std::make_shared<ClientSession> (
+                   boost::property_tree::ptree () );
+  auto pipeline = MediaPipelineClient::create (session);
+  std::map <std::string, std::shared_ptr<Stats>> stats;
+
+  pipeline->setLatencyStats (true);
+
+  auto element = PassThroughClient::create (session, pipeline->getObject () );
+
+  {
+    DeferredResponse::Scope scope;
+
+    stats = element->getStats ();
+
+    // The outer request keeps its own response
+    BOOST_CHECK (!scope.getDeferred () );
+    BOOST_CHECK (!DeferredResponse::isDeferred () );
+  }
+
+  BOOST_REQUIRE (stats.find (element->getId () ) != stats.end () );
+  BOOST_CHECK_EQUAL (stats[element->getId ()]->getId (), element->getId () );
+
+  pipeline->release ();
+}
+
+/* What a server-side module pays today to call another object: build the
+ * request, write it, parse it, dispatch it and do the same for the response */
+static std::string
+json_loopback_get_name (const std::string &sessionId,
+                        const std::string &objectId)
+{
+  Json::StreamWriterBuilder writer;
+  Json::CharReaderBuilder readerBuilder;
+  std::unique_ptr<Json::CharReader> reader (readerBuilder.newCharReader () );
+  Json::Value request, params, response, result;
+  std::string text, errors;
+
+  request["jsonrpc"] = "2.0";
+  request["id"] = 1;
+  request["method"] = "invoke";
+  request["params"]["object"] = objectId;
+  request["params"]["operation"] = "getName";
+  request["params"]["sessionId"] = sessionId;
+
+  text = Json::writeString (writer, request);
+  reader->parse (text.data (), text.data () + text.size (), &params, &errors);
+
+  auto obj = MediaSet::getMediaSet ()->getMediaObject (
+               params["params"]["sessionId"].asString (),
+               params["params"]["object"].asString () );
+  obj->invoke (obj, params["params"]["operation"].asString (),
+               params["params"]["operationParams"], result);
+
+  response["jsonrpc"] = "2.0";
+  response["id"] = params["id"];
+  response["result"]["value"] = result;
+  response["result"]["sessionId"] = sessionId;
+
+  text = Json::writeString (writer, response);
+  reader->parse (text.data (), text.data () + text.size (), &result, &errors);
+
+  return result["result"]["value"].asString ();
+}
+
+BOOST_AUTO_TEST_CASE (compare_with_json_loopback)
+{
+  auto session = std::make_shared<ClientSession> (
+                   boost::property_tree::ptree () );
+  auto pipeline = MediaPipelineClient::create (session);
+  auto element = PassThroughClient::create (session, pipeline->getObject () );
+  std::chrono::steady_clock::time_point start;
+  std::chrono::microseconds typed, json;
+
+  element->setName ("benchmark");
+
+  start = std::chrono::steady_clock::now ();
+
+  for (int i = 0; i < N_CALLS; i++) {
+    BOOST_REQUIRE (element->getName () == "benchmark");
+  }
+
+  typed = std::chrono::duration_cast<std::chrono::microseconds>
+          (std::chrono::steady_clock::now () - start);
+
+  start = std::chrono::steady_clock::now ();
+
+  for (int i = 0; i < N_CALLS; i++) {
+    BOOST_REQUIRE (json_loopback_get_name (session->getId (),
+                   element->getId () ) == "benchmark");
+  }
+
+  json = std::chrono::duration_cast<std::chrono::microseconds>
+         (std::chrono::steady_clock::now () - start);
+
+  BOOST_TEST_MESSAGE ("getName x" << N_CALLS << ": typed client "
+                      << typed.count () << " us, JSON loopback "
+                      << json.count () << " us");
+
+  pipeline->release ();
+}
@@ -0,0 +1,158 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE ConfigSnapshot
+#include <boost/test/unit_test.hpp>
+#include <ConfigSnapshot.hpp>
+#include <BaseRtpEndpointConfig.hpp>
+#include <SdpEndpointConfig.hpp>
+#include <CodecConfiguration.hpp>
+
+#include <boost/property_tree/json_parser.hpp>
+#include <sstream>
+
+using namespace kurento;
+
+static boost::property_tree::ptree
+parseConfig (const std::string &json)
+{
+  boost::property_tree::ptree config;
+  std::stringstream ss (json);
+
+  boost::property_tree::read_json (ss, config);
+
+  return config;
+}
+
+/* Reference conversion, as done before snapshots existed */
+static Json::Value
+viaWriteJson (const boost::property_tree::ptree &config, const std::string &key)
+{
+  boost::property_tree::ptree array;
+  std::stringstream ss;
+  Json::Reader reader;
+  Json::Value val;
+
+  array.push_back (std::make_pair ("val", config.get_child (key) ) );
+  boost::property_tree::write_json (ss, array, false);
+  reader.parse (ss.str (), val);
+
+  return val["val"];
+}
+
+BOOST_AUTO_TEST_CASE (same_as_write_json)
+{
+  boost::property_tree::ptree config = parseConfig (
+      "{\"modules\": {\"kurento\": {\"WebRtcEndpoint\": {"
+      "\"stunServerPort\": 3478, \"externalIPv4\": \"10.0.0.1\","
+      "\"codecs\": [\"VP8\", \"H264\"], \"nested\": {\"enabled\": true}"
+      "}}}}");
+  ConfigSnapshot snapshot (config);
+
+  for (const std::string key : {
+         "modules", "modules.kurento.WebRtcEndpoint",
+         "modules.kurento.WebRtcEndpoint.stunServerPort",
+         "modules.kurento.WebRtcEndpoint.externalIPv4",
+         "modules.kurento.WebRtcEndpoint.codecs",
+         "modules.kurento.WebRtcEndpoint.nested.enabled"
+       }) {
+    const Json::Value *found = snapshot.find (key);
+
+    BOOST_REQUIRE_MESSAGE (found != nullptr, key);
+    BOOST_CHECK_MESSAGE (*found == viaWriteJson (config, key), key);
+  }
+
+  BOOST_CHECK (snapshot.find ("modules.kurento.WebRtcEndpoint.missing") ==
+               nullptr);
+  BOOST_CHECK (snapshot.find ("modules.kurento.RtpEndpoint") == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE (publish_and_swap)
+{
+  boost::property_tree::ptree config = parseConfig ("{\"a\": {\"b\": 1}}");
+  boost::property_tree::ptree other;
+
+  BOOST_CHECK (!ConfigSnapshot::get (config) );
+
+  ConfigSnapshot::publish (config, std::make_shared<ConfigSnapshot> (config) );
+  std::shared_ptr<const ConfigSnapshot> first = ConfigSnapshot::get (config);
+
+  BOOST_REQUIRE (first);
+  BOOST_CHECK (!ConfigSnapshot::get (other) );
+  BOOST_CHECK_EQUAL (first->find ("a.b")->asString (), "1");
+
+  ConfigSnapshot::publish (config, std::make_shared<ConfigSnapshot> (
+                             parseConfig ("{\"a\": {\"b\": 2}}") ) );
+
+  /* Readers holding the previous snapshot are not affected */
+  BOOST_CHECK_EQUAL (first->find ("a.b")->asString (), "1");
+  BOOST_CHECK_EQUAL (ConfigSnapshot::get (config)->find ("a.b")->asString (),
+                     "2");
+
+  ConfigSnapshot::publish (config, nullptr);
+  BOOST_CHECK (!ConfigSnapshot::get (config) );
+}
+
+BOOST_AUTO_TEST_CASE (typed_sections)
+{
+  boost::property_tree::ptree config = parseConfig (
+      "{\"modules\": {\"kurento\": {"
+      "\"BaseRtpEndpoint\": {\"minPort\": 5000, \"mtu\": 1400},"
+      "\"SdpEndpoint\": {\"numVideoMedias\": 2,"
+      "\"videoCodecs\": [{\"name\": \"VP8/90000\"}, {\"name\": \"H264/90000\"}]}"
+      "}}}");
+
+  ConfigSnapshot::publish (config, std::make_shared<ConfigSnapshot> (config) );
+
+  std::shared_ptr<const BaseRtpEndpointConfig> rtp =
+    BaseRtpEndpointConfig::get (config);
+
+  BOOST_CHECK (rtp->__isSetMinPort);
+  BOOST_CHECK_EQUAL (rtp->minPort, 5000);
+  BOOST_CHECK (!rtp->__isSetMaxPort);
+  BOOST_CHECK (rtp->__isSetMtu);
+  BOOST_CHECK_EQUAL (rtp->mtu, 1400);
+
+  /* Built once, every reader of the same snapshot shares it */
+  BOOST_CHECK (BaseRtpEndpointConfig::get (config) == rtp);
+
+  std::shared_ptr<const SdpEndpointConfig> sdp =
+    SdpEndpointConfig::get (config);
+
+  /* Missing keys take the default declared in the kmd */
+  BOOST_CHECK (!sdp->__isSetNumAudioMedias);
+  BOOST_CHECK_EQUAL (sdp->numAudioMedias, 1);
+  BOOST_CHECK_EQUAL (sdp->numVideoMedias, 2);
+  BOOST_CHECK (sdp->audioCodecs.empty () );
+  BOOST_REQUIRE_EQUAL (sdp->videoCodecs.size (), 2);
+  BOOST_CHECK_EQUAL (sdp->videoCodecs[1]->getName (), "H264/90000");
+
+  /* A reload gives new sections, old readers keep theirs */
+  ConfigSnapshot::publish (config, std::make_shared<ConfigSnapshot> (
+                             parseConfig ("{\"modules\": {\"kurento\": {"
+                                 "\"BaseRtpEndpoint\": {\"mtu\": 1000}}}}") ) );
+
+  BOOST_CHECK_EQUAL (rtp->mtu, 1400);
+  BOOST_CHECK_EQUAL (BaseRtpEndpointConfig::get (config)->mtu, 1000);
+  BOOST_CHECK (!BaseRtpEndpointConfig::get (config)->__isSetMinPort);
+
+  ConfigSnapshot::publish (config, nullptr);
+
+  /* Unpublished trees are read directly */
+  BOOST_CHECK_EQUAL (BaseRtpEndpointConfig::get (config)->mtu, 1400);
+}
@@ -0,0 +1,131 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE DeferredResponse
+#include <boost/test/unit_test.hpp>
+#include <DeferredResponse.hpp>
+#include <KurentoException.hpp>
+
+#include <condition_variable>
+#include <mutex>
+
+using namespace kurento;
+
+BOOST_AUTO_TEST_CASE (no_scope)
+{
+  BOOST_CHECK (!DeferredResponse::defer () );
+  BOOST_CHECK (!DeferredResponse::isDeferred () );
+}
+
+BOOST_AUTO_TEST_CASE (disabled_scope)
+{
+  DeferredResponse::Scope scope;
+
+  {
+    DeferredResponse::Scope syncScope (false);
+
+    BOOST_CHECK (!DeferredResponse::defer () );
+  }
+
+  BOOST_CHECK (DeferredResponse::defer () );
+  BOOST_CHECK (DeferredResponse::isDeferred () );
+
+  /* Only the first call can claim the response */
+  BOOST_CHECK (!DeferredResponse::defer () );
+
+  scope.getDeferred ()->cancel ();
+}
+
+BOOST_AUTO_TEST_CASE (complete_before_arm)
+{
+  std::shared_ptr<DeferredResponse> deferred;
+  Json::Value result;
+  bool called = false;
+
+  {
+    DeferredResponse::Scope scope;
+
+    DeferredResponse::defer ()->complete<int> (42);
+    deferred = scope.getDeferred ();
+  }
+
+  BOOST_REQUIRE (deferred);
+
+  deferred->arm ([&] (const Json::Value & value, std::exception_ptr error) {
+    BOOST_CHECK (!error);
+    result = value;
+    called = true;
+  });
+
+  BOOST_CHECK (called);
+  BOOST_CHECK_EQUAL (result.asInt (), 42);
+}
+
+BOOST_AUTO_TEST_CASE (complete_from_other_thread)
+{
+  std::mutex mutex;
+  std::condition_variable cond;
+  Json::Value result;
+  bool called = false;
+  std::shared_ptr<DeferredResponse> deferred;
+
+  {
+    DeferredResponse::Scope scope;
+    std::shared_ptr<DeferredResponse> handle = DeferredResponse::defer ();
+
+    DeferredResponse::postAfter (std::chrono::milliseconds (50), [handle] () {
+      handle->complete<std::string> ("done");
+    });
+
+    deferred = scope.getDeferred ();
+  }
+
+  deferred->arm ([&] (const Json::Value & value, std::exception_ptr error) {
+    std::unique_lock<std::mutex> lock (mutex);
+
+    result = value;
+    called = true;
+    cond.notify_all ();
+  });
+  deferred.reset ();
+
+  std::unique_lock<std::mutex> lock (mutex);
+  BOOST_REQUIRE (cond.wait_for (lock, std::chrono::seconds (5),
+  [&] () {
+    return called;
+  }) );
+  BOOST_CHECK_EQUAL (result.asString (), "done");
+}
+
+BOOST_AUTO_TEST_CASE (abandoned)
+{
+  std::exception_ptr result;
+
+  {
+    DeferredResponse::Scope scope;
+
+    DeferredResponse::defer ();
+    scope.getDeferred ()->arm ([&] (const Json::Value & value,
+    std::exception_ptr error) {
+      result = error;
+    });
+  }
+
+  BOOST_REQUIRE (result);
+  BOOST_CHECK_THROW (std::rethrow_exception (result), KurentoException);
+}
@@ -0,0 +1,175 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE EventFilter
+#include <boost/test/unit_test.hpp>
+#include <EventFilter.hpp>
+#include <KurentoException.hpp>
+
+#include <vector>
+
+using namespace kurento;
+using std::chrono::milliseconds;
+
+struct ScheduledTask {
+  EventFilter::Clock::duration delay;
+  std::function<void () > task;
+};
+
+/* Records tasks instead of running them, so time is under test control */
+class FakeScheduler
+{
+public:
+  EventFilter::Scheduler get ()
+  {
+    return [this] (EventFilter::Clock::duration delay,
+    std::function<void () > task) {
+      tasks.push_back ({delay, task});
+    };
+  }
+
+  void runAll ()
+  {
+    std::vector<ScheduledTask> current;
+
+    current.swap (tasks);
+
+    for (auto &t : current) {
+      t.task ();
+    }
+  }
+
+  std::vector<ScheduledTask> tasks;
+};
+
+static Json::Value
+parse (const std::string &str)
+{
+  Json::Value value;
+  Json::Reader reader;
+
+  BOOST_REQUIRE (reader.parse (str, value) );
+
+  return value;
+}
+
+BOOST_AUTO_TEST_CASE (field_predicates)
+{
+  EventFilter filter (parse (
+                        R"({"fields": {"mediaType": "VIDEO", "state": "FLOWING"}})") );
+  std::map<std::string, Json::Value> event;
+
+  auto getField = [&event] (const std::string & field, Json::Value & value) {
+    auto it = event.find (field);
+
+    if (it == event.end () ) {
+      return false;
+    }
+
+    value = it->second;
+    return true;
+  };
+
+  event["mediaType"] = "VIDEO";
+  BOOST_CHECK (!filter.matches (getField) );
+
+  event["state"] = "NOT_FLOWING";
+  BOOST_CHECK (!filter.matches (getField) );
+
+  event["state"] = "FLOWING";
+  BOOST_CHECK (filter.matches (getField) );
+
+  event["mediaType"] = "AUDIO";
+  BOOST_CHECK (!filter.matches (getField) );
+}
+
+BOOST_AUTO_TEST_CASE (invalid_filters)
+{
+  BOOST_CHECK_THROW (EventFilter (parse ("[]") ), KurentoException);
+  BOOST_CHECK_THROW (EventFilter (parse (R"({"maxRate": 0})") ),
+                     KurentoException);
+  BOOST_CHECK_THROW (EventFilter (parse (R"({"latestOnly": 1})") ),
+                     KurentoException);
+  BOOST_CHECK_THROW (EventFilter (parse (R"({"fields": 3})") ),
+                     KurentoException);
+  BOOST_CHECK_THROW (EventFilter (parse (R"({"other": true})") ),
+                     KurentoException);
+}
+
+BOOST_AUTO_TEST_CASE (same_key)
+{
+  EventFilter a (parse (R"({"maxRate": 2, "fields": {"state": "FLOWING"}})") );
+  EventFilter b (parse (R"({"fields": {"state": "FLOWING"}, "maxRate": 2})") );
+
+  BOOST_CHECK_EQUAL (a.getKey (), b.getKey () );
+}
+
+BOOST_AUTO_TEST_CASE (max_rate_drops)
+{
+  auto filter = std::make_shared<EventFilter> (parse (R"({"maxRate": 10})") );
+  FakeScheduler scheduler;
+  EventFilter::Clock::time_point start = EventFilter::Clock::now ();
+  int sent = 0;
+  auto send = [&sent] () {
+    sent++;
+  };
+
+  /* 10 events/s: one every 100ms gets through */
+  for (int i = 0; i < 50; i++) {
+    filter->submit (send, scheduler.get (), start + milliseconds (i * 10) );
+  }
+
+  scheduler.runAll ();
+
+  BOOST_CHECK_EQUAL (sent, 5);
+  BOOST_CHECK_EQUAL (filter->getDropped (), 45);
+}
+
+BOOST_AUTO_TEST_CASE (latest_only)
+{
+  auto filter = std::make_shared<EventFilter> (parse (
+                  R"({"maxRate": 10, "latestOnly": true})") );
+  FakeScheduler scheduler;
+  EventFilter::Clock::time_point start = EventFilter::Clock::now ();
+  std::vector<int> sent;
+
+  auto submit = [&] (int n, int ms) {
+    filter->submit ([&sent, n] () {
+      sent.push_back (n);
+    }, scheduler.get (), start + milliseconds (ms) );
+  };
+
+  /* First one goes right away */
+  submit (0, 0);
+  BOOST_REQUIRE_EQUAL (scheduler.tasks.size (), 1);
+  BOOST_CHECK (scheduler.tasks[0].delay == EventFilter::Clock::duration::zero () );
+  scheduler.runAll ();
+
+  /* The rest of the interval is coalesced into the last event */
+  submit (1, 20);
+  submit (2, 50);
+  submit (3, 70);
+  BOOST_REQUIRE_EQUAL (scheduler.tasks.size (), 1);
+  BOOST_CHECK (scheduler.tasks[0].delay == milliseconds (80) );
+  scheduler.runAll ();
+
+  BOOST_REQUIRE_EQUAL (sent.size (), 2);
+  BOOST_CHECK_EQUAL (sent[0], 0);
+  BOOST_CHECK_EQUAL (sent[1], 3);
+  BOOST_CHECK_EQUAL (filter->getDropped (), 2);
+}
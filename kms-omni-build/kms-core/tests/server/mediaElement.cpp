@@ -27,6 +27,9 @@
 #include <MediaSet.hpp>
 #include <ModuleManager.hpp>
 
+#include <chrono>
+#include <vector>
+
 using namespace kurento;
 
 ModuleManager moduleManager;
@@ -299,3 +302,60 @@ BOOST_AUTO_TEST_CASE (dot_test)
   src.reset();
   pipe.reset();
 }
+
+/* Mean time to add one element and dispatch what it posts on the bus */
+static double
+measureJoinMillis (const std::string &mediaPipelineId, int joins,
+                   std::vector<std::string> &ids)
+{
+  auto begin = std::chrono::steady_clock::now ();
+
+  for (int i = 0; i < joins; i++) {
+    std::shared_ptr <MediaElementImpl> element = createDummyElement ("dummysrc",
+        mediaPipelineId);
+
+    g_object_set (element->getGstreamerElement(), "audio", TRUE, "video", TRUE,
+                  NULL);
+
+    while (g_main_context_iteration (nullptr, FALSE) ) {
+    }
+
+    ids.push_back (element->getId () );
+  }
+
+  std::chrono::duration<double, std::milli> elapsed =
+    std::chrono::steady_clock::now () - begin;
+
+  return elapsed.count () / joins;
+}
+
+BOOST_AUTO_TEST_CASE (join_latency_scaling)
+{
+  const int small = 20, large = 400, joins = 20;
+  std::vector<std::string> ids;
+  double smallMillis, largeMillis;
+
+  std::string mediaPipelineId =
+    moduleManager.getFactory ("MediaPipeline")->createObject (
+      config, "",
+      Json::Value() )->getId();
+
+  measureJoinMillis (mediaPipelineId, small, ids);
+  smallMillis = measureJoinMillis (mediaPipelineId, joins, ids);
+
+  measureJoinMillis (mediaPipelineId, large - (int) ids.size (), ids);
+  largeMillis = measureJoinMillis (mediaPipelineId, joins, ids);
+
+  BOOST_TEST_MESSAGE ("Join time with " << small << " elements: " <<
+                      smallMillis << " ms, with " << large << " elements: " <<
+                      largeMillis << " ms");
+
+  /* Bus messages of a new element used to reach a handler per element */
+  BOOST_CHECK_LT (largeMillis, smallMillis * 5 + 1);
+
+  for (auto id : ids) {
+    releaseMediaObject (id);
+  }
+
+  releaseMediaObject (mediaPipelineId);
+}
@@ -23,12 +23,14 @@
 #include <gst/gst.h>
 #include <MediaSet.hpp>
 #include <ServerManagerImpl.hpp>
+#include <MediaPipelineImpl.hpp>
 #include <ServerInfo.hpp>
 #include <ModuleInfo.hpp>
 #include <ServerType.hpp>
 #include <ObjectCreated.hpp>
 #include <ObjectDestroyed.hpp>
 #include <memory>
+#include <atomic>
 
 #include <config.h>
 
@@ -243,3 +245,120 @@ BOOST_FIXTURE_TEST_CASE (get_pipelines, F)
 
   pipes.clear();
 }
+
+static GstState
+get_state (std::shared_ptr<MediaPipelineImpl> pipeline)
+{
+  GstState state;
+
+  gst_element_get_state (pipeline->getPipeline (), &state, nullptr,
+                         GST_SECOND);
+
+  return state;
+}
+
+BOOST_FIXTURE_TEST_CASE (reclaim_idle_sessions, F)
+{
+  auto mediaSet = MediaSet::getMediaSet();
+  auto start = std::chrono::steady_clock::now ();
+  auto elapsed = std::make_shared<std::atomic<int>> (0);
+  std::shared_ptr<kurento::Factory> mediaPipelineFactory;
+  std::shared_ptr<MediaPipelineImpl> pipeline, shared;
+  MediaSet::ReclaimStats stats;
+
+  MediaSet::setCollectorInterval (std::chrono::seconds (240) );
+  MediaSet::setIdleTimeouts (std::chrono::seconds (30),
+                             std::chrono::seconds (120) );
+  MediaSet::setClock ([start, elapsed] () {
+    return start + std::chrono::seconds (elapsed->load () );
+  });
+
+  mediaPipelineFactory = moduleManager->getFactory ("MediaPipeline");
+
+  pipeline = std::dynamic_pointer_cast <MediaPipelineImpl>
+             (mediaPipelineFactory->createObject (boost::property_tree::ptree(),
+                 "session1", Json::Value() ) );
+  shared = std::dynamic_pointer_cast <MediaPipelineImpl>
+           (mediaPipelineFactory->createObject (boost::property_tree::ptree(),
+               "session1", Json::Value() ) );
+  mediaSet->ref ("session2", shared);
+
+  BOOST_CHECK (get_state (pipeline) == GST_STATE_PLAYING);
+
+  // Only session2 keeps alive, session1 pipelines pause
+  *elapsed = 31;
+  mediaSet->keepAliveSession ("session2");
+  mediaSet->doGarbageCollection ();
+
+  BOOST_CHECK (mediaSet->getSessionStage ("session1") ==
+               MediaSet::SessionStage::PAUSED);
+  BOOST_CHECK (mediaSet->getSessionStage ("session2") ==
+               MediaSet::SessionStage::ACTIVE);
+  BOOST_CHECK (get_state (pipeline) == GST_STATE_READY);
+  BOOST_CHECK (get_state (shared) == GST_STATE_PLAYING);
+
+  stats = mediaSet->getReclaimStats ();
+  BOOST_CHECK_EQUAL (stats.activeSessions, 1);
+  BOOST_CHECK_EQUAL (stats.pausedSessions, 1);
+  BOOST_CHECK_EQUAL (stats.pausedPipelines, 1);
+  BOOST_CHECK_EQUAL (stats.trimmedPipelines, 0);
+
+  *elapsed = 121;
+  mediaSet->keepAliveSession ("session2");
+  mediaSet->doGarbageCollection ();
+
+  BOOST_CHECK (mediaSet->getSessionStage ("session1") ==
+               MediaSet::SessionStage::TRIMMED);
+  BOOST_CHECK (get_state (pipeline) == GST_STATE_NULL);
+  BOOST_CHECK (get_state (shared) == GST_STATE_PLAYING);
+
+  stats = mediaSet->getReclaimStats ();
+  BOOST_CHECK_EQUAL (stats.trimmedSessions, 1);
+  BOOST_CHECK_EQUAL (stats.pausedPipelines, 0);
+  BOOST_CHECK_EQUAL (stats.trimmedPipelines, 1);
+
+  // The client comes back before the session is collected
+  mediaSet->keepAliveSession ("session1");
+  mediaSet->doGarbageCollection ();
+
+  BOOST_CHECK (mediaSet->getSessionStage ("session1") ==
+               MediaSet::SessionStage::ACTIVE);
+  BOOST_CHECK (get_state (pipeline) == GST_STATE_PLAYING);
+
+  stats = mediaSet->getReclaimStats ();
+  BOOST_CHECK_EQUAL (stats.activeSessions, 2);
+  BOOST_CHECK_EQUAL (stats.trimmedPipelines, 0);
+  BOOST_CHECK_EQUAL (stats.resumedSessions, 1);
+
+  // And leaves again for good
+  *elapsed = 121 + 241;
+  mediaSet->keepAliveSession ("session2");
+  mediaSet->doGarbageCollection ();
+
+  try {
+    mediaSet->getSessionStage ("session1");
+    BOOST_FAIL ("This code should not be reached");
+  } catch (const KurentoException &e) {
+    BOOST_CHECK (e.getCode() == INVALID_SESSION);
+  }
+
+  try {
+    mediaSet->ref ("session3", pipeline->getId () );
+    BOOST_FAIL ("This code should not be reached");
+  } catch (const KurentoException &e) {
+    BOOST_CHECK (e.getCode() == MEDIA_OBJECT_NOT_FOUND);
+  }
+
+  // Still used by session2
+  BOOST_CHECK (get_state (shared) == GST_STATE_PLAYING);
+
+  stats = mediaSet->getReclaimStats ();
+  BOOST_CHECK_EQUAL (stats.activeSessions, 1);
+  BOOST_CHECK_EQUAL (stats.collectedSessions, 1);
+
+  MediaSet::setClock (MediaSet::Clock () );
+
+  mediaSet->release (shared);
+  pipeline.reset ();
+  shared.reset ();
+}
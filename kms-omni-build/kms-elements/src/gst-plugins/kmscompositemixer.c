@@ -23,9 +23,9 @@
 #include <commons/kmshubport.h>
 #include <commons/kmsloop.h>
 #include <commons/kmsrefstruct.h>
+#include <commons/kmslatencyprofile.h>
 #include <math.h>
 
-#define LATENCY 600             //ms
 
 #define PLUGIN_NAME "compositemixer"
 
@@ -300,15 +300,26 @@ cb_EOS_received (GstPad * pad, GstPadProbeInfo * info, gpointer data)
 static GstPadProbeReturn
 cb_latency (GstPad * pad, GstPadProbeInfo * info, gpointer data)
 {
+  GstElement *videomixer;
+  GstClockTime latency;
+
   if (GST_QUERY_TYPE (GST_PAD_PROBE_INFO_QUERY (info)) != GST_QUERY_LATENCY) {
     return GST_PAD_PROBE_OK;
   }
 
+  videomixer = gst_pad_get_parent_element (pad);
+  if (videomixer == NULL) {
+    return GST_PAD_PROBE_OK;
+  }
+
+  latency =
+      kms_latency_profile_get_element_targets (videomixer)->video_mixer_latency;
+  g_object_unref (videomixer);
+
   GST_LOG_OBJECT (pad, "Modifing latency query. New latency %" G_GUINT64_FORMAT,
-      (guint64) (LATENCY * GST_MSECOND));
+      latency);
 
-  gst_query_set_latency (GST_PAD_PROBE_INFO_QUERY (info),
-      TRUE, 0, LATENCY * GST_MSECOND);
+  gst_query_set_latency (GST_PAD_PROBE_INFO_QUERY (info), TRUE, 0, latency);
 
   return GST_PAD_PROBE_HANDLED;
 }
@@ -665,7 +676,8 @@ kms_composite_mixer_handle_port (KmsBaseHub * mixer,
     self->priv->videomixer = gst_element_factory_make ("compositor", NULL);
     g_object_set (G_OBJECT (self->priv->videomixer), "background",
         1 /*black */ , "start-time-selection", 1 /*first */ ,
-        "latency", LATENCY * GST_MSECOND, NULL);
+        "latency", kms_latency_profile_get_element_targets (GST_ELEMENT
+            (self))->video_mixer_latency, NULL);
     self->priv->mixer_video_agnostic =
         gst_element_factory_make ("agnosticbin", NULL);
 
@@ -795,6 +807,28 @@ kms_composite_mixer_finalize (GObject * object)
   G_OBJECT_CLASS (kms_composite_mixer_parent_class)->finalize (object);
 }
 
+static void
+kms_composite_mixer_set_context (GstElement * element, GstContext * context)
+{
+  KmsCompositeMixer *self = KMS_COMPOSITE_MIXER (element);
+  KmsLatencyProfile profile;
+
+  if (kms_latency_profile_parse_context (context, &profile)) {
+    KMS_COMPOSITE_MIXER_LOCK (self);
+
+    if (self->priv->videomixer != NULL) {
+      g_object_set (self->priv->videomixer, "latency",
+          kms_latency_profile_get_targets (profile)->video_mixer_latency,
+          NULL);
+    }
+
+    KMS_COMPOSITE_MIXER_UNLOCK (self);
+  }
+
+  GST_ELEMENT_CLASS (kms_composite_mixer_parent_class)->set_context (element,
+      context);
+}
+
 static void
 kms_composite_mixer_class_init (KmsCompositeMixerClass * klass)
 {
@@ -809,6 +843,9 @@ kms_composite_mixer_class_init (KmsCompositeMixerClass * klass)
   gobject_class->dispose = GST_DEBUG_FUNCPTR (kms_composite_mixer_dispose);
   gobject_class->finalize = GST_DEBUG_FUNCPTR (kms_composite_mixer_finalize);
 
+  gstelement_class->set_context =
+      GST_DEBUG_FUNCPTR (kms_composite_mixer_set_context);
+
   base_hub_class->handle_port =
       GST_DEBUG_FUNCPTR (kms_composite_mixer_handle_port);
   base_hub_class->unhandle_port =
@@ -25,6 +25,7 @@
 #include "kmsselectablemixer.h"
 #include "kmscompositemixer.h"
 #include "kmsalphablending.h"
+#include "kmsrelayendpoint.h"
 
 static gboolean
 kurento_init (GstPlugin * kurento)
@@ -60,6 +61,10 @@ kurento_init (GstPlugin * kurento)
   if (!kms_alpha_blending_plugin_init (kurento))
     return FALSE;
 
+  if (!kms_relay_endpoint_plugin_init (kurento)) {
+    return FALSE;
+  }
+
   return TRUE;
 }
 
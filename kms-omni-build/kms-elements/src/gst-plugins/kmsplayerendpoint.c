@@ -44,6 +44,12 @@ G_DEFINE_QUARK (APPSINK_KEY, appsink);
 #define PTS_KEY "pts-key"
 G_DEFINE_QUARK (PTS_KEY, pts);
 
+#define ITEM_KEY "item-key"
+G_DEFINE_QUARK (ITEM_KEY, item);
+
+#define USERS_KEY "users-key"
+G_DEFINE_QUARK (USERS_KEY, users);
+
 #define NETWORK_CACHE_DEFAULT 2000
 #define PORT_RANGE_DEFAULT "0-0"
 #define IS_PREROLL TRUE
@@ -82,6 +88,16 @@ struct _KmsPlayerEndpointPrivate
   GstElement *pipeline;
   GstElement *uridecodebin;
   KmsLoop *loop;
+
+  /* Playlist, protected by the element lock */
+  GQueue *playlist;             /* URIs still to be played, oldest first */
+  GstElement *next_pipeline;    /* Pre-rolls the head of the playlist */
+  GstElement *next_uridecodebin;
+  gboolean next_failed;
+  GstElement *appsrcs[KMS_MEDIA_TYPE_DATA];     /* Shared by all items */
+  gint items;                   /* Last id given to an item */
+  gint item;                    /* Id of the item being played */
+
   gboolean use_encoded_media;
   gint network_cache;
   gchar *port_range;
@@ -103,6 +119,7 @@ enum
   PROP_NETWORK_CACHE,
   PROP_PORT_RANGE,
   PROP_PIPELINE,
+  PROP_PLAYLIST,
   N_PROPERTIES
 };
 
@@ -112,6 +129,7 @@ enum
   SIGNAL_INVALID_URI,
   SIGNAL_INVALID_MEDIA,
   SIGNAL_SET_POSITION,
+  SIGNAL_ITEM_STARTED,
   LAST_SIGNAL
 };
 
@@ -135,12 +153,52 @@ typedef struct _KmsPtsData
   GstClockTime last_pts;
   GstClockTime last_pts_orig;
   gboolean pts_handled;
+
+  /* Playlist item the timestamps come from */
+  gint item;
+
+  /* Timestamps of the buffers queued in the appsrc, see process_sample() */
+  GMutex retimes_mutex;
+  GQueue retimes;
 } KmsPtsData;
 
+/* Timestamps of a buffer pushed to the appsrc, they are applied when the
+ * buffer leaves it (see appsrc_retime_probe()) */
+typedef struct _KmsRetime
+{
+  /* Only compared, the entry does not hold a reference */
+  GstBuffer *buffer;
+  gboolean retime;
+
+  GstClockTime pts;
+  GstClockTime dts;
+  GstClockTime duration;
+} KmsRetime;
+
+static void
+kms_retime_destroy (gpointer data)
+{
+  g_slice_free (KmsRetime, data);
+}
+
+static void
+kms_pts_data_clear_retimes (KmsPtsData * data)
+{
+  g_mutex_lock (&data->retimes_mutex);
+  g_queue_foreach (&data->retimes, (GFunc) kms_retime_destroy, NULL);
+  g_queue_clear (&data->retimes);
+  g_mutex_unlock (&data->retimes_mutex);
+}
+
 static void
 kms_pts_data_destroy (gpointer data)
 {
-  g_slice_free (KmsPtsData, data);
+  KmsPtsData *pts_data = data;
+
+  kms_pts_data_clear_retimes (pts_data);
+  g_mutex_clear (&pts_data->retimes_mutex);
+
+  g_slice_free (KmsPtsData, pts_data);
 }
 
 static KmsPtsData *
@@ -156,6 +214,9 @@ kms_pts_data_new ()
   data->last_pts_orig = GST_CLOCK_TIME_NONE;
   data->pts_handled = FALSE;
 
+  g_mutex_init (&data->retimes_mutex);
+  g_queue_init (&data->retimes);
+
   return data;
 }
 
@@ -166,8 +227,14 @@ kms_pts_data_reset (KmsPtsData * data)
   data->last_pts_orig = GST_CLOCK_TIME_NONE;
 }
 
+static void kms_player_endpoint_set_playlist (KmsPlayerEndpoint * self,
+    gchar ** uris);
+static gchar **kms_player_endpoint_get_playlist (KmsPlayerEndpoint * self);
+static void kms_player_endpoint_preroll_next_item (KmsPlayerEndpoint * self);
+static void kms_player_endpoint_drop_next_item (KmsPlayerEndpoint * self);
+
 static void
-kms_player_endpoint_disable_decoding (KmsPlayerEndpoint * self)
+kms_player_endpoint_disable_decoding (GstElement * uridecodebin)
 {
   /* By setting the caps of the uridecodebin element, with all formats
    * except 'application/x-rtp', what we achieve is that all incoming formats
@@ -179,10 +246,37 @@ kms_player_endpoint_disable_decoding (KmsPlayerEndpoint * self)
   GstCaps *deco_caps;
 
   deco_caps = gst_caps_from_string (KMS_AGNOSTIC_NO_RTP_CAPS);
-  g_object_set (G_OBJECT (self->priv->uridecodebin), "caps", deco_caps, NULL);
+  g_object_set (G_OBJECT (uridecodebin), "caps", deco_caps, NULL);
   gst_caps_unref (deco_caps);
 }
 
+/*
+ * The pipeline and its uridecodebin are replaced from the loop thread when
+ * the next item of the playlist starts, and the old ones are destroyed. Take
+ * a reference to them to use them out of the element lock.
+ */
+static GstElement *
+kms_player_endpoint_ref_pipeline (KmsPlayerEndpoint * self,
+    GstElement ** uridecodebin)
+{
+  GstElement *pipeline = NULL;
+
+  KMS_ELEMENT_LOCK (self);
+
+  if (self->priv->pipeline != NULL) {
+    pipeline = gst_object_ref (self->priv->pipeline);
+  }
+
+  if (uridecodebin != NULL) {
+    *uridecodebin = (self->priv->uridecodebin != NULL) ?
+        gst_object_ref (self->priv->uridecodebin) : NULL;
+  }
+
+  KMS_ELEMENT_UNLOCK (self);
+
+  return pipeline;
+}
+
 void
 kms_player_endpoint_set_property (GObject * object, guint property_id,
     const GValue * value, GParamSpec * pspec)
@@ -191,10 +285,13 @@ kms_player_endpoint_set_property (GObject * object, guint property_id,
 
   switch (property_id) {
     case PROP_USE_ENCODED_MEDIA:{
+      KMS_ELEMENT_LOCK (playerendpoint);
       playerendpoint->priv->use_encoded_media = g_value_get_boolean (value);
       if (playerendpoint->priv->use_encoded_media) {
-        kms_player_endpoint_disable_decoding (playerendpoint);
+        kms_player_endpoint_disable_decoding (playerendpoint->
+            priv->uridecodebin);
       }
+      KMS_ELEMENT_UNLOCK (playerendpoint);
       break;
     }
     case PROP_NETWORK_CACHE:
@@ -204,6 +301,10 @@ kms_player_endpoint_set_property (GObject * object, guint property_id,
       g_free (playerendpoint->priv->port_range);
       playerendpoint->priv->port_range = g_value_dup_string (value);
       break;
+    case PROP_PLAYLIST:
+      kms_player_endpoint_set_playlist (playerendpoint,
+          g_value_get_boxed (value));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -228,8 +329,10 @@ kms_player_endpoint_get_property (GObject * object, guint property_id,
       GstFormat format;
       GstStructure *video_data = NULL;
       GstQuery *query = gst_query_new_seeking (GST_FORMAT_TIME);
+      GstElement *pipeline =
+          kms_player_endpoint_ref_pipeline (playerendpoint, NULL);
 
-      if (gst_element_query (playerendpoint->priv->pipeline, query)) {
+      if (gst_element_query (pipeline, query)) {
         gst_query_parse_seeking (query,
             &format, &seekable, &segment_start, &segment_end);
       } else {
@@ -239,12 +342,13 @@ kms_player_endpoint_get_property (GObject * object, guint property_id,
 
       gst_query_unref (query);
 
-      if (!gst_element_query_duration (playerendpoint->priv->pipeline,
-              GST_FORMAT_TIME, &duration)) {
+      if (!gst_element_query_duration (pipeline, GST_FORMAT_TIME, &duration)) {
         GST_WARNING_OBJECT (playerendpoint,
             "Impossible to get the file duration");
       }
 
+      gst_object_unref (pipeline);
+
       video_data = gst_structure_new ("video_data",
           "isSeekable", G_TYPE_BOOLEAN, seekable,
           "seekableInit", G_TYPE_INT64, segment_start,
@@ -257,10 +361,13 @@ kms_player_endpoint_get_property (GObject * object, guint property_id,
     case PROP_POSITION:{
       gint64 position = -1;
       gboolean ret = FALSE;
+      GstElement *pipeline =
+          kms_player_endpoint_ref_pipeline (playerendpoint, NULL);
 
-      if (playerendpoint->priv->pipeline != NULL) {
-        ret = gst_element_query_position (playerendpoint->priv->pipeline,
-            GST_FORMAT_TIME, &position);
+      if (pipeline != NULL) {
+        ret = gst_element_query_position (pipeline, GST_FORMAT_TIME,
+            &position);
+        gst_object_unref (pipeline);
       }
 
       if (!ret) {
@@ -272,7 +379,8 @@ kms_player_endpoint_get_property (GObject * object, guint property_id,
       break;
     }
     case PROP_PIPELINE:
-      g_value_set_object (value, playerendpoint->priv->pipeline);
+      g_value_take_object (value,
+          kms_player_endpoint_ref_pipeline (playerendpoint, NULL));
       break;
     case PROP_NETWORK_CACHE:
       g_value_set_int (value, playerendpoint->priv->network_cache);
@@ -280,6 +388,10 @@ kms_player_endpoint_get_property (GObject * object, guint property_id,
     case PROP_PORT_RANGE:
       g_value_set_string (value, playerendpoint->priv->port_range);
       break;
+    case PROP_PLAYLIST:
+      g_value_take_boxed (value,
+          kms_player_endpoint_get_playlist (playerendpoint));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -337,24 +449,42 @@ kms_player_endpoint_enable_latency_probe (KmsPlayerEndpoint * self)
   g_object_unref (pad);
 }
 
+static void
+kms_player_endpoint_destroy_pipeline (GstElement * pipeline)
+{
+  GstBus *bus;
+
+  bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
+  gst_bus_set_sync_handler (bus, NULL, NULL, NULL);
+  gst_bus_remove_watch(bus);
+  g_object_unref (bus);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (GST_OBJECT (pipeline));
+}
+
 static void
 kms_player_endpoint_dispose (GObject * object)
 {
   KmsPlayerEndpoint *self = KMS_PLAYER_ENDPOINT (object);
+  GstElement *pipeline;
 
   g_clear_object (&self->priv->loop);
 
-  if (self->priv->pipeline != NULL) {
-    GstBus *bus;
+  if (self->priv->next_pipeline != NULL) {
+    kms_player_endpoint_destroy_pipeline (self->priv->next_pipeline);
+    self->priv->next_pipeline = NULL;
+    self->priv->next_uridecodebin = NULL;
+  }
 
-    bus = gst_pipeline_get_bus (GST_PIPELINE (self->priv->pipeline));
-    gst_bus_set_sync_handler (bus, NULL, NULL, NULL);
-    gst_bus_remove_watch(bus);
-    g_object_unref (bus);
+  KMS_ELEMENT_LOCK (self);
+  pipeline = self->priv->pipeline;
+  self->priv->pipeline = NULL;
+  self->priv->uridecodebin = NULL;
+  KMS_ELEMENT_UNLOCK (self);
 
-    gst_element_set_state (self->priv->pipeline, GST_STATE_NULL);
-    gst_object_unref (GST_OBJECT (self->priv->pipeline));
-    self->priv->pipeline = NULL;
+  if (pipeline != NULL) {
+    kms_player_endpoint_destroy_pipeline (pipeline);
   }
 
   /* clean up as possible. May be called multiple times */
@@ -376,6 +506,8 @@ kms_player_endpoint_finalize (GObject * object)
   g_free (self->priv->port_range);
   self->priv->port_range = NULL;
 
+  g_queue_free_full (self->priv->playlist, g_free);
+
   G_OBJECT_CLASS (kms_player_endpoint_parent_class)->finalize (object);
 }
 
@@ -442,28 +574,65 @@ static GstStateChangeReturn
 kms_player_endpoint_mark_reset_base_time_and_set_state (KmsPlayerEndpoint *
     self, GstState state)
 {
+  GstElement *pipeline = kms_player_endpoint_ref_pipeline (self, NULL);
+  GstStateChangeReturn ret;
+
+  if (pipeline == NULL) {
+    return GST_STATE_CHANGE_FAILURE;
+  }
+
   kms_player_endpoint_mark_reset_base_time (self);
 
-  return gst_element_set_state (self->priv->pipeline, state);
+  ret = gst_element_set_state (pipeline, state);
+  gst_object_unref (pipeline);
+
+  return ret;
+}
+
+#define kms_player_endpoint_get_item(object) \
+  GPOINTER_TO_INT (g_object_get_qdata (G_OBJECT (object), item_quark ()))
+
+/* Whether @appsink belongs to the item being played, and not to a finished
+ * one or to the next one of the playlist, which is only pre-rolled */
+static gboolean
+kms_player_endpoint_is_playing (KmsPlayerEndpoint * self, GstElement * appsink)
+{
+  return kms_player_endpoint_get_item (appsink) ==
+      g_atomic_int_get (&self->priv->item);
 }
 
+/* Buffers are not retimed here: the appsink and the sample still hold them,
+ * so making them writable would copy every frame. Their timestamps are
+ * queued along with them and applied by appsrc_retime_probe() in the main
+ * pipeline, where the appsrc is their only owner. */
 static GstFlowReturn
 process_sample (GstAppSink * appsink, GstAppSrc * appsrc, GstSample * sample,
     gboolean is_preroll)
 {
   KmsPlayerEndpoint *self = KMS_PLAYER_ENDPOINT (GST_ELEMENT_PARENT (appsrc));
   KmsPtsData *pts_data;
+  KmsRetime *retime;
   GstBuffer *buffer = NULL;
   GstPad *src, *sink;
+  GstClockTime pts, dts, duration;
   GstClockTime pts_orig, base_time, offset_time;
   GstFlowReturn ret = GST_FLOW_OK;
+  gboolean retimed = FALSE;
   gint64 diff;
+  gint item;
 
   if (sample == NULL) {
     GST_ERROR_OBJECT (appsink, "Cannot get sample");
     return GST_FLOW_OK;
   }
 
+  if (!kms_player_endpoint_is_playing (self, GST_ELEMENT (appsink))) {
+    /* The first frame of the next item stays prerolled in the appsink, it is
+     * rendered again when the item starts */
+    GST_LOG_OBJECT (appsink, "Item not playing, is preroll: %d", is_preroll);
+    goto end;
+  }
+
   if (gst_sample_get_buffer_list (sample) != NULL) {
     GST_ERROR_OBJECT (appsink, "BufferList not supported");
     g_warning ("BufferList not supported");
@@ -475,13 +644,23 @@ process_sample (GstAppSink * appsink, GstAppSrc * appsrc, GstSample * sample,
     goto end;
   }
 
-  gst_buffer_ref (buffer);
-  buffer = gst_buffer_make_writable (buffer);
-
   pts_data =
-      (KmsPtsData *) g_object_get_qdata (G_OBJECT (appsink), pts_quark ());
+      (KmsPtsData *) g_object_get_qdata (G_OBJECT (appsrc), pts_quark ());
 
-  if (!GST_BUFFER_PTS_IS_VALID (buffer) && !GST_BUFFER_DTS_IS_VALID (buffer)) {
+  item = kms_player_endpoint_get_item (appsink);
+  if (pts_data->item != item) {
+    /* A new item goes on with the stream: it gets a new base time, which
+     * is kept above the last PTS pushed by the previous one */
+    GST_DEBUG_OBJECT (appsrc, "Stream fed by item %d", item);
+    kms_pts_data_reset (pts_data);
+    pts_data->item = item;
+  }
+
+  pts = GST_BUFFER_PTS (buffer);
+  dts = GST_BUFFER_DTS (buffer);
+  duration = GST_BUFFER_DURATION (buffer);
+
+  if (!GST_CLOCK_TIME_IS_VALID (pts) && !GST_CLOCK_TIME_IS_VALID (dts)) {
     if (pts_data->pts_handled) {
       GST_ERROR_OBJECT (appsink,
           "PTS and DTS are not valid and a previous buffer was handled.");
@@ -490,14 +669,14 @@ process_sample (GstAppSink * appsink, GstAppSrc * appsrc, GstSample * sample,
     }
 
     goto push;
-  } else if (!GST_BUFFER_PTS_IS_VALID (buffer)) {
-    GST_BUFFER_PTS (buffer) = GST_BUFFER_DTS (buffer);
-  } else if (!GST_BUFFER_DTS_IS_VALID (buffer)) {
-    GST_BUFFER_DTS (buffer) = GST_BUFFER_PTS (buffer);
+  } else if (!GST_CLOCK_TIME_IS_VALID (pts)) {
+    pts = dts;
+  } else if (!GST_CLOCK_TIME_IS_VALID (dts)) {
+    dts = pts;
   }
 
   pts_data->pts_handled = TRUE;
-  pts_orig = GST_BUFFER_PTS (buffer);
+  pts_orig = pts;
 
   if (is_preroll) {
     GST_DEBUG_OBJECT (appsink, "Preroll: reset base time");
@@ -513,7 +692,7 @@ process_sample (GstAppSink * appsink, GstAppSrc * appsrc, GstSample * sample,
       base_time = MAX (base_time, pts_data->last_pts + GST_MSECOND);
     }
 
-    offset_time = GST_BUFFER_PTS (buffer);
+    offset_time = pts;
   } else {
     base_time = pts_data->base_time;
     offset_time = pts_data->offset_time;
@@ -529,7 +708,7 @@ process_sample (GstAppSink * appsink, GstAppSrc * appsrc, GstSample * sample,
       }
 
       pts_data->base_time = base_time;
-      pts_data->offset_time = offset_time = GST_BUFFER_PTS (buffer);
+      pts_data->offset_time = offset_time = pts;
     }
   }
 
@@ -552,31 +731,32 @@ process_sample (GstAppSink * appsink, GstAppSrc * appsrc, GstSample * sample,
   }
 
   diff = base_time - offset_time;
-  GST_BUFFER_DTS (buffer) += diff;
-  GST_BUFFER_PTS (buffer) += diff;
+  dts += diff;
+  pts += diff;
 
   // HACK: Change duration 1 to -1 to avoid segmentation fault
   //problems in seeks with some formats
-  if (GST_BUFFER_DURATION (buffer) == 1) {
-    GST_BUFFER_DURATION (buffer) = GST_CLOCK_TIME_NONE;
+  if (duration == 1) {
+    duration = GST_CLOCK_TIME_NONE;
   }
 
   GST_LOG_OBJECT (appsink,
-      "Is preroll: %d, buffer: %" GST_PTR_FORMAT ", original pts %"
-      GST_TIME_FORMAT, is_preroll, buffer, GST_TIME_ARGS (pts_orig));
+      "Is preroll: %d, buffer: %" GST_PTR_FORMAT ", pts %" GST_TIME_FORMAT
+      ", original pts %" GST_TIME_FORMAT, is_preroll, buffer,
+      GST_TIME_ARGS (pts), GST_TIME_ARGS (pts_orig));
 
-  if (pts_data->last_pts != GST_CLOCK_TIME_NONE &&
-      GST_BUFFER_PTS (buffer) <= pts_data->last_pts) {
+  if (pts_data->last_pts != GST_CLOCK_TIME_NONE && pts <= pts_data->last_pts) {
     GST_ERROR_OBJECT (appsink,
         "Non incremental PTS assignment (last PTS: %"
         GST_TIME_FORMAT ", PTS: %" GST_TIME_FORMAT
         ", is preroll: %d). Not pushing", GST_TIME_ARGS (pts_data->last_pts),
-        GST_TIME_ARGS (GST_BUFFER_PTS (buffer)), is_preroll);
+        GST_TIME_ARGS (pts), is_preroll);
     goto end;
   }
 
-  pts_data->last_pts = GST_BUFFER_PTS (buffer);
+  pts_data->last_pts = pts;
   pts_data->last_pts_orig = pts_orig;
+  retimed = TRUE;
 
 push:
   src = gst_element_get_static_pad (GST_ELEMENT (appsrc), "src");
@@ -592,19 +772,38 @@ push:
     g_object_unref (sink);
   }
 
+  retime = g_slice_new (KmsRetime);
+  retime->buffer = buffer;
+  retime->retime = retimed;
+  retime->pts = pts;
+  retime->dts = dts;
+  retime->duration = duration;
+
+  /* Drop the sample first, so that the appsrc queue is the only owner of
+   * the buffer once the appsink returns */
+  gst_buffer_ref (buffer);
+  gst_sample_unref (sample);
+  sample = NULL;
+
+  g_mutex_lock (&pts_data->retimes_mutex);
+  g_queue_push_tail (&pts_data->retimes, retime);
+  g_mutex_unlock (&pts_data->retimes_mutex);
+
   ret = gst_app_src_push_buffer (appsrc, buffer);
-  buffer = NULL;
   if (ret != GST_FLOW_OK) {
     GST_ERROR_OBJECT (appsink,
         "Could not send buffer to '%s'. Cause: %s",
         GST_ELEMENT_NAME (appsrc), gst_flow_get_name (ret));
-  }
 
-end:
-  if (buffer != NULL) {
-    gst_buffer_unref (buffer);
+    /* Not queued, unless a flush already cleared it */
+    g_mutex_lock (&pts_data->retimes_mutex);
+    if (g_queue_remove (&pts_data->retimes, retime)) {
+      kms_retime_destroy (retime);
+    }
+    g_mutex_unlock (&pts_data->retimes_mutex);
   }
 
+end:
   if (sample != NULL) {
     gst_sample_unref (sample);
   }
@@ -636,9 +835,26 @@ static void
 appsink_eos_cb (GstAppSink * appsink, gpointer user_data)
 {
   GstAppSrc *appsrc = GST_APP_SRC (user_data);
+  KmsPlayerEndpoint *self = KMS_PLAYER_ENDPOINT (GST_ELEMENT_PARENT (appsrc));
+  gboolean next_item;
   GstFlowReturn ret;
   GstPad *pad;
 
+  if (!kms_player_endpoint_is_playing (self, GST_ELEMENT (appsink))) {
+    GST_DEBUG_OBJECT (appsink, "Item not playing, ignoring EOS");
+    return;
+  }
+
+  KMS_ELEMENT_LOCK (self);
+  next_item = self->priv->next_pipeline != NULL && !self->priv->next_failed;
+  KMS_ELEMENT_UNLOCK (self);
+
+  if (next_item) {
+    GST_DEBUG_OBJECT (appsink, "Next item goes on with %s",
+        GST_ELEMENT_NAME (appsrc));
+    return;
+  }
+
   GST_DEBUG_OBJECT (appsink, "Send EOS event to main pipeline (via %s)",
       GST_ELEMENT_NAME (appsrc));
   ret = gst_app_src_end_of_stream (appsrc);
@@ -655,20 +871,109 @@ appsink_eos_cb (GstAppSink * appsink, gpointer user_data)
   }
 }
 
+/* The appsink that feeds @appsrc changes with each item of the playlist */
+static void
+kms_player_endpoint_set_appsink (GstElement * appsrc, GstElement * appsink)
+{
+  GST_OBJECT_LOCK (appsrc);
+  g_object_set_qdata_full (G_OBJECT (appsrc), appsink_quark (),
+      g_object_ref (appsink), g_object_unref);
+  GST_OBJECT_UNLOCK (appsrc);
+}
+
+static GstElement *
+kms_player_endpoint_get_appsink (GstElement * appsrc)
+{
+  GstElement *appsink;
+
+  GST_OBJECT_LOCK (appsrc);
+  appsink = g_object_get_qdata (G_OBJECT (appsrc), appsink_quark ());
+  if (appsink != NULL) {
+    g_object_ref (appsink);
+  }
+  GST_OBJECT_UNLOCK (appsrc);
+
+  return appsink;
+}
+
 static GstPadProbeReturn
 appsrc_query_probe (GstPad * pad, GstPadProbeInfo * info, gpointer element)
 {
   GstQuery *query = gst_pad_probe_info_get_query (info);
   GstQueryType type = GST_QUERY_TYPE (query);
-  GstElement *appsink = GST_ELEMENT (element);
+  GstElement *appsink;
 
-  if (type == GST_QUERY_CAPS || type == GST_QUERY_ACCEPT_CAPS) {
-    query = gst_query_make_writable (query);
-    // Send query upstream to the uridecodebin
-    gst_element_query (appsink, query);
-    GST_PAD_PROBE_INFO_DATA (info) = query;
+  if (type != GST_QUERY_CAPS && type != GST_QUERY_ACCEPT_CAPS) {
+    return GST_PAD_PROBE_OK;
+  }
+
+  appsink = kms_player_endpoint_get_appsink (GST_ELEMENT (element));
+  if (appsink == NULL) {
+    return GST_PAD_PROBE_OK;
   }
 
+  query = gst_query_make_writable (query);
+  // Send query upstream to the uridecodebin
+  gst_element_query (appsink, query);
+  GST_PAD_PROBE_INFO_DATA (info) = query;
+
+  g_object_unref (appsink);
+
+  return GST_PAD_PROBE_OK;
+}
+
+/* Applies the timestamps computed by process_sample() to the buffers leaving
+ * @element, in the order they were pushed to it */
+static GstPadProbeReturn
+appsrc_retime_probe (GstPad * pad, GstPadProbeInfo * info, gpointer element)
+{
+  KmsPtsData *pts_data;
+  KmsRetime *retime;
+  GstBuffer *buffer;
+
+  pts_data = (KmsPtsData *) g_object_get_qdata (G_OBJECT (element),
+      pts_quark ());
+
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_EVENT_BOTH) {
+    if (GST_EVENT_TYPE (GST_PAD_PROBE_INFO_EVENT (info)) ==
+        GST_EVENT_FLUSH_STOP) {
+      /* The appsrc queue has been flushed along with its buffers */
+      kms_pts_data_clear_retimes (pts_data);
+    }
+
+    return GST_PAD_PROBE_OK;
+  }
+
+  buffer = GST_PAD_PROBE_INFO_BUFFER (info);
+
+  g_mutex_lock (&pts_data->retimes_mutex);
+  while ((retime = g_queue_pop_head (&pts_data->retimes)) != NULL) {
+    if (retime->buffer == buffer) {
+      break;
+    }
+
+    GST_WARNING_OBJECT (pad, "Buffer dropped before leaving the appsrc");
+    kms_retime_destroy (retime);
+  }
+  g_mutex_unlock (&pts_data->retimes_mutex);
+
+  if (retime == NULL) {
+    GST_WARNING_OBJECT (pad, "No timestamps for %" GST_PTR_FORMAT, buffer);
+    return GST_PAD_PROBE_OK;
+  }
+
+  if (retime->retime) {
+    /* A preroll buffer is still shared with its appsink and gets a copy of
+     * its metadata, any other one is normally written in place */
+    buffer = gst_buffer_make_writable (buffer);
+    GST_BUFFER_PTS (buffer) = retime->pts;
+    GST_BUFFER_DTS (buffer) = retime->dts;
+    GST_BUFFER_DURATION (buffer) = retime->duration;
+    GST_PAD_PROBE_INFO_DATA (info) = buffer;
+  }
+
+  kms_retime_destroy (retime);
+
   return GST_PAD_PROBE_OK;
 }
 
@@ -687,9 +992,16 @@ kms_player_end_point_add_appsrc (KmsPlayerEndpoint * self,
       G_GUINT64_CONSTANT (0), "format", GST_FORMAT_TIME,
       "emit-signals", FALSE, NULL);
 
+  g_object_set_qdata_full (G_OBJECT (appsrc), pts_quark (),
+      kms_pts_data_new (), kms_pts_data_destroy);
+  kms_player_endpoint_set_appsink (appsrc, appsink);
+
   srcpad = gst_element_get_static_pad (appsrc, "src");
   gst_pad_add_probe (srcpad, GST_PAD_PROBE_TYPE_QUERY_UPSTREAM,
-      appsrc_query_probe, appsink, NULL);
+      appsrc_query_probe, appsrc, NULL);
+  gst_pad_add_probe (srcpad, GST_PAD_PROBE_TYPE_BUFFER |
+      GST_PAD_PROBE_TYPE_EVENT_BOTH | GST_PAD_PROBE_TYPE_EVENT_FLUSH,
+      appsrc_retime_probe, appsrc, NULL);
   g_object_unref (srcpad);
 
   gst_bin_add (GST_BIN (self), appsrc);
@@ -735,7 +1047,7 @@ kms_player_end_point_remove_stat_probe (KmsPlayerEndpoint * self, GstPad * pad)
 
 static GstElement *
 kms_player_end_point_get_agnostic_for_pad (KmsPlayerEndpoint * self,
-    GstPad * pad)
+    GstPad * pad, KmsMediaType * type)
 {
   GstCaps *caps;
   GstElement *agnosticbin = NULL;
@@ -752,10 +1064,12 @@ kms_player_end_point_get_agnostic_for_pad (KmsPlayerEndpoint * self,
     GST_DEBUG_OBJECT (pad, "Detected audio caps");
     agnosticbin = kms_element_get_audio_agnosticbin (KMS_ELEMENT (self));
     kms_player_end_point_add_stat_probe (self, pad, KMS_MEDIA_TYPE_AUDIO);
+    *type = KMS_MEDIA_TYPE_AUDIO;
   } else if (kms_utils_caps_is_video (caps)) {
     GST_DEBUG_OBJECT (pad, "Detected video caps");
     agnosticbin = kms_element_get_video_agnosticbin (KMS_ELEMENT (self));
     kms_player_end_point_add_stat_probe (self, pad, KMS_MEDIA_TYPE_VIDEO);
+    *type = KMS_MEDIA_TYPE_VIDEO;
   }
 
   gst_caps_unref (caps);
@@ -769,12 +1083,19 @@ appsink_probe_set_appsrc_caps (GstPad * pad, GstPadProbeInfo * info,
 {
   GstEvent *event = gst_pad_probe_info_get_event (info);
   GstElement *appsrc = GST_ELEMENT (element);
+  KmsPlayerEndpoint *self = KMS_PLAYER_ENDPOINT (GST_ELEMENT_PARENT (appsrc));
   GstCaps *caps;
 
   if (GST_EVENT_TYPE (event) != GST_EVENT_CAPS) {
     return GST_PAD_PROBE_OK;
   }
 
+  if (!kms_player_endpoint_is_playing (self, GST_PAD_PARENT (pad))) {
+    /* The current item is still using the appsrc, the caps of the next
+     * one are set when it starts */
+    return GST_PAD_PROBE_OK;
+  }
+
   gst_event_parse_caps (event, &caps);
   if (caps == NULL) {
     GST_ERROR_OBJECT (pad, "Invalid caps received");
@@ -821,25 +1142,99 @@ appsink_event_query_probe (GstPad * pad, GstPadProbeInfo * info, gpointer elemen
   return GST_PAD_PROBE_OK;
 }
 
+/*
+ * Returns the appsrc that @appsink has to feed. The streams of the item being
+ * played are taken over by the next item of the playlist, so that viewers do
+ * not see them end, and new ones are only added for the streams that the
+ * previous item does not have.
+ */
+static GstElement *
+kms_player_endpoint_get_appsrc (KmsPlayerEndpoint * self, KmsMediaType type,
+    GstElement * agnosticbin, GstElement * appsink)
+{
+  gint item = kms_player_endpoint_get_item (appsink);
+  GstElement *appsrc;
+  guint users;
+
+  KMS_ELEMENT_LOCK (self);
+
+  appsrc = self->priv->appsrcs[type];
+  if (appsrc != NULL && kms_player_endpoint_get_item (appsrc) == item) {
+    /* Already fed by another stream of the same item */
+    appsrc = NULL;
+  }
+
+  KMS_ELEMENT_UNLOCK (self);
+
+  if (appsrc == NULL) {
+    appsrc = kms_player_end_point_add_appsrc (self, agnosticbin, appsink);
+  }
+
+  KMS_ELEMENT_LOCK (self);
+
+  if (self->priv->appsrcs[type] == NULL) {
+    self->priv->appsrcs[type] = appsrc;
+  }
+
+  g_object_set_qdata (G_OBJECT (appsrc), item_quark (), GINT_TO_POINTER (item));
+  users = GPOINTER_TO_UINT (g_object_get_qdata (G_OBJECT (appsrc),
+          users_quark ()));
+  g_object_set_qdata (G_OBJECT (appsrc), users_quark (),
+      GUINT_TO_POINTER (users + 1));
+
+  KMS_ELEMENT_UNLOCK (self);
+
+  return appsrc;
+}
+
+static void
+kms_player_endpoint_release_appsrc (KmsPlayerEndpoint * self,
+    GstElement * appsrc)
+{
+  guint users, i;
+
+  KMS_ELEMENT_LOCK (self);
+
+  users = GPOINTER_TO_UINT (g_object_get_qdata (G_OBJECT (appsrc),
+          users_quark ())) - 1;
+  g_object_set_qdata (G_OBJECT (appsrc), users_quark (),
+      GUINT_TO_POINTER (users));
+
+  for (i = 0; users == 0 && i < G_N_ELEMENTS (self->priv->appsrcs); i++) {
+    if (self->priv->appsrcs[i] == appsrc) {
+      self->priv->appsrcs[i] = NULL;
+    }
+  }
+
+  KMS_ELEMENT_UNLOCK (self);
+
+  if (users == 0) {
+    kms_utils_bin_remove (GST_BIN (self), appsrc);
+  }
+}
+
 static void
 kms_player_endpoint_uridecodebin_pad_added (GstElement * element, GstPad * pad,
     KmsPlayerEndpoint * self)
 {
   GstElement *appsink, *appsrc;
   GstElement *agnosticbin;
+  KmsMediaType type;
   GstPad *sinkpad;
   GstPadLinkReturn link_ret;
 
   GST_DEBUG_OBJECT (pad, "Pad added");
 
-  agnosticbin = kms_player_end_point_get_agnostic_for_pad (self, pad);
+  agnosticbin = kms_player_end_point_get_agnostic_for_pad (self, pad, &type);
 
   if (agnosticbin != NULL) {
     GstAppSinkCallbacks callbacks;
 
     /* Create appsink */
     appsink = gst_element_factory_make ("appsink", NULL);
-    appsrc = kms_player_end_point_add_appsrc (self, agnosticbin, appsink);
+    g_object_set_qdata (G_OBJECT (appsink), item_quark (),
+        g_object_get_qdata (G_OBJECT (element), item_quark ()));
+    appsrc = kms_player_endpoint_get_appsrc (self, type, agnosticbin, appsink);
 
     g_object_set (appsink, "enable-last-sample", FALSE, "emit-signals", FALSE,
         "qos", FALSE, "max-buffers", 1, NULL);
@@ -850,8 +1245,7 @@ kms_player_endpoint_uridecodebin_pad_added (GstElement * element, GstPad * pad,
     gst_app_sink_set_callbacks (GST_APP_SINK (appsink), &callbacks, appsrc,
         NULL);
 
-    g_object_set_qdata_full (G_OBJECT (appsink), pts_quark (),
-        kms_pts_data_new (), kms_pts_data_destroy);
+    g_object_set_qdata (G_OBJECT (appsink), appsrc_quark (), appsrc);
 
     g_object_set_qdata (G_OBJECT (pad), appsink_quark (), appsink);
     g_object_set_qdata (G_OBJECT (pad), appsrc_quark (), appsrc);
@@ -871,7 +1265,8 @@ kms_player_endpoint_uridecodebin_pad_added (GstElement * element, GstPad * pad,
         appsrc, NULL);
   }
 
-  gst_bin_add (GST_BIN (self->priv->pipeline), appsink);
+  /* Either the pipeline being played or the one pre-rolling the next item */
+  gst_bin_add (GST_BIN (GST_ELEMENT_PARENT (element)), appsink);
 
   link_ret = gst_pad_link (pad, sinkpad);
 
@@ -903,14 +1298,12 @@ kms_player_endpoint_uridecodebin_pad_removed (GstElement * element,
   appsink = g_object_steal_qdata (G_OBJECT (pad), appsink_quark ());
   appsrc = g_object_steal_qdata (G_OBJECT (pad), appsrc_quark ());
 
-  // remove appsrc before appsink to avoid segment fault
-  // caused by invalid appsink in appsrc_query_probe
   if (appsrc != NULL) {
-    kms_utils_bin_remove (GST_BIN (self), appsrc);
+    kms_player_endpoint_release_appsrc (self, appsrc);
   }
 
   if (appsink != NULL) {
-    kms_utils_bin_remove (GST_BIN (self->priv->pipeline), appsink);
+    kms_utils_bin_remove (GST_BIN (GST_ELEMENT_PARENT (element)), appsink);
   }
 }
 
@@ -921,6 +1314,8 @@ kms_player_endpoint_stopped (KmsUriEndpoint * obj, GError ** error)
 
   GST_DEBUG_OBJECT (self, "Pipeline stopped");
 
+  kms_player_endpoint_drop_next_item (self);
+
   // Set internal pipeline to NULL state
   kms_player_endpoint_mark_reset_base_time_and_set_state (self, GST_STATE_NULL);
 
@@ -934,15 +1329,23 @@ static gboolean
 kms_player_endpoint_started (KmsUriEndpoint * obj, GError ** error)
 {
   KmsPlayerEndpoint *self = KMS_PLAYER_ENDPOINT (obj);
+  GstElement *pipeline, *uridecodebin;
 
   GST_DEBUG_OBJECT (self, "Pipeline started");
 
+  pipeline = kms_player_endpoint_ref_pipeline (self, &uridecodebin);
+
   /* Set uri property in uridecodebin */
-  g_object_set (G_OBJECT (self->priv->uridecodebin), "uri",
+  g_object_set (G_OBJECT (uridecodebin), "uri",
       KMS_URI_ENDPOINT (self)->uri, NULL);
 
   /* Set internal pipeline to playing */
-  gst_element_set_state (self->priv->pipeline, GST_STATE_PLAYING);
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  gst_object_unref (uridecodebin);
+  gst_object_unref (pipeline);
+
+  kms_player_endpoint_preroll_next_item (self);
 
   KMS_URI_ENDPOINT_GET_CLASS (self)->change_state (KMS_URI_ENDPOINT (self),
       KMS_URI_ENDPOINT_STATE_START);
@@ -953,14 +1356,18 @@ kms_player_endpoint_started (KmsUriEndpoint * obj, GError ** error)
 static gboolean
 kms_player_endpoint_set_position (KmsPlayerEndpoint * self, gint64 position)
 {
+  GstElement *pipeline;
   GstQuery *query;
   GstEvent *seek;
-  gboolean seekable = FALSE;
+  gboolean seekable = FALSE, ret = TRUE;
+
+  pipeline = kms_player_endpoint_ref_pipeline (self, NULL);
 
   query = gst_query_new_seeking (GST_FORMAT_TIME);
-  if (!gst_element_query (self->priv->pipeline, query)) {
+  if (!gst_element_query (pipeline, query)) {
     GST_WARNING_OBJECT (self, "File not seekable in format time");
     gst_query_unref (query);
+    gst_object_unref (pipeline);
     return FALSE;
   }
 
@@ -969,6 +1376,7 @@ kms_player_endpoint_set_position (KmsPlayerEndpoint * self, gint64 position)
 
   if (!seekable) {
     GST_WARNING_OBJECT (self, "File not seekable");
+    gst_object_unref (pipeline);
     return FALSE;
   }
 
@@ -979,12 +1387,14 @@ kms_player_endpoint_set_position (KmsPlayerEndpoint * self, gint64 position)
 
   kms_player_endpoint_mark_reset_base_time (self);
 
-  if (!gst_element_send_event (self->priv->pipeline, seek)) {
+  if (!gst_element_send_event (pipeline, seek)) {
     GST_WARNING_OBJECT (self, "Seek failed");
-    return FALSE;
+    ret = FALSE;
   }
 
-  return TRUE;
+  gst_object_unref (pipeline);
+
+  return ret;
 }
 
 static gboolean
@@ -1005,10 +1415,11 @@ kms_player_endpoint_paused (KmsUriEndpoint * obj, GError ** error)
   //the first time that paused is called.
 
   if (ret == GST_STATE_CHANGE_SUCCESS) {
+    GstElement *pipeline = kms_player_endpoint_ref_pipeline (self, NULL);
     gint64 position = -1;
 
-    gst_element_query_position (self->priv->pipeline,
-        GST_FORMAT_TIME, &position);
+    gst_element_query_position (pipeline, GST_FORMAT_TIME, &position);
+    gst_object_unref (pipeline);
     kms_player_endpoint_set_position (self, position);
     kms_player_endpoint_mark_reset_base_time_and_set_state (self,
         GST_STATE_PAUSED);
@@ -1119,6 +1530,13 @@ kms_player_endpoint_class_init (KmsPlayerEndpointClass * klass)
           "PlayerEndpoint's private pipeline",
           GST_TYPE_ELEMENT, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 
+  g_object_class_install_property (gobject_class, PROP_PLAYLIST,
+      g_param_spec_boxed ("playlist", "Playlist",
+          "URIs to play after the current one, without gaps. The next one is "
+          "pre-rolled while the current one plays, and each one is removed "
+          "from the list when it starts",
+          G_TYPE_STRV, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   kms_player_endpoint_signals[SIGNAL_EOS] =
       g_signal_new ("eos",
       G_TYPE_FROM_CLASS (klass),
@@ -1147,13 +1565,26 @@ kms_player_endpoint_class_init (KmsPlayerEndpointClass * klass)
       G_STRUCT_OFFSET (KmsPlayerEndpointClass, set_position), NULL, NULL,
       __kms_elements_marshal_BOOLEAN__INT64, G_TYPE_BOOLEAN, 1, G_TYPE_INT64);
 
+  kms_player_endpoint_signals[SIGNAL_ITEM_STARTED] =
+      g_signal_new ("item-started",
+      G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST,
+      G_STRUCT_OFFSET (KmsPlayerEndpointClass, item_started_signal), NULL,
+      NULL, g_cclosure_marshal_VOID__STRING, G_TYPE_NONE, 1, G_TYPE_STRING);
+
   /* Registers a private structure for the instantiatable type */
   // g_type_class_add_private (klass, sizeof (KmsPlayerEndpointPrivate));
 }
 
+static gboolean kms_player_endpoint_play_next_item (KmsPlayerEndpoint * self);
+
 static gboolean
 kms_player_endpoint_emit_EOS_signal (gpointer data)
 {
+  if (kms_player_endpoint_play_next_item (KMS_PLAYER_ENDPOINT (data))) {
+    return G_SOURCE_REMOVE;
+  }
+
   GST_DEBUG ("Emit 'EOS' signal and stop endpoint");
   kms_player_endpoint_stopped (KMS_URI_ENDPOINT (data), NULL);
   g_signal_emit (G_OBJECT (data), kms_player_endpoint_signals[SIGNAL_EOS], 0);
@@ -1232,6 +1663,68 @@ kms_player_endpoint_post_media_error (gpointer d)
   return G_SOURCE_REMOVE;
 }
 
+/* This function must be called holding the element mutex */
+static GstElement *
+kms_player_endpoint_steal_next_item (KmsPlayerEndpoint * self)
+{
+  GstElement *next = self->priv->next_pipeline;
+
+  self->priv->next_pipeline = NULL;
+  self->priv->next_uridecodebin = NULL;
+  self->priv->next_failed = FALSE;
+
+  return next;
+}
+
+/* Errors of the next item are reported as usual, and it is skipped */
+static gboolean
+kms_player_endpoint_next_item_failed (KmsPlayerEndpoint * self,
+    GstMessage * msg)
+{
+  gboolean failed = FALSE;
+
+  KMS_ELEMENT_LOCK (self);
+
+  if (self->priv->next_pipeline != NULL && !self->priv->next_failed
+      && gst_object_has_as_ancestor (GST_MESSAGE_SRC (msg),
+          GST_OBJECT (self->priv->next_pipeline))) {
+    self->priv->next_failed = failed = TRUE;
+  }
+
+  KMS_ELEMENT_UNLOCK (self);
+
+  return failed;
+}
+
+static gboolean
+kms_player_endpoint_skip_next_item (gpointer data)
+{
+  KmsPlayerEndpoint *self = KMS_PLAYER_ENDPOINT (data);
+  GstElement *next = NULL;
+  gchar *uri = NULL;
+
+  KMS_ELEMENT_LOCK (self);
+
+  if (self->priv->next_failed) {
+    next = kms_player_endpoint_steal_next_item (self);
+    uri = g_queue_pop_head (self->priv->playlist);
+  }
+
+  KMS_ELEMENT_UNLOCK (self);
+
+  if (next == NULL) {
+    return G_SOURCE_REMOVE;
+  }
+
+  GST_WARNING_OBJECT (self, "Skipping playlist item: %s", uri);
+  kms_player_endpoint_destroy_pipeline (next);
+  g_free (uri);
+
+  kms_player_endpoint_preroll_next_item (self);
+
+  return G_SOURCE_REMOVE;
+}
+
 static GstBusSyncReply
 bus_sync_signal_handler (GstBus * bus, GstMessage * msg, gpointer data)
 {
@@ -1242,6 +1735,12 @@ bus_sync_signal_handler (GstBus * bus, GstMessage * msg, gpointer data)
         kms_player_endpoint_emit_EOS_signal, g_object_ref (self),
         g_object_unref);
   } else if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR) {
+    if (kms_player_endpoint_next_item_failed (self, msg)) {
+      kms_loop_idle_add_full (self->priv->loop, G_PRIORITY_HIGH_IDLE,
+          kms_player_endpoint_skip_next_item, g_object_ref (self),
+          g_object_unref);
+    }
+
     if (g_str_has_prefix (GST_OBJECT_NAME (msg->src), "decodebin")) {
       kms_loop_idle_add_full (self->priv->loop, G_PRIORITY_HIGH_IDLE,
           kms_player_endpoint_emit_invalid_media_signal, g_object_ref (self),
@@ -1326,7 +1825,7 @@ process_bus_message (GstBus * bus, GstMessage * msg, KmsPlayerEndpoint * self)
       break;
   }
 
-  GstElement *parent = self->priv->pipeline;
+  GstElement *parent = kms_player_endpoint_ref_pipeline (self, NULL);
   gint err_code = 0;
   gchar *err_msg = NULL;
 
@@ -1349,54 +1848,249 @@ process_bus_message (GstBus * bus, GstMessage * msg, KmsPlayerEndpoint * self)
       dot_name);
   g_free (dot_name);
 
+  gst_object_unref (parent);
   g_error_free (err);
   g_free (dbg_info);
 
   return TRUE;
 }
 
-static void
-kms_player_endpoint_init (KmsPlayerEndpoint * self)
+/* Each item of the playlist is played by its own pipeline */
+static GstElement *
+kms_player_endpoint_create_pipeline (KmsPlayerEndpoint * self,
+    GstElement ** uridecodebin)
 {
+  GstElement *pipeline;
   GstBus *bus;
 
-  // self->priv = KMS_PLAYER_ENDPOINT_GET_PRIVATE (self);
-   self->priv = kms_player_endpoint_get_instance_private (self);
-
-  g_mutex_init (&self->priv->base_time_mutex);
-  self->priv->base_time = GST_CLOCK_TIME_NONE;
-  self->priv->base_time_preroll = GST_CLOCK_TIME_NONE;
-
-  self->priv->loop = kms_loop_new ();
-  self->priv->pipeline = gst_pipeline_new ("internalpipeline");
-  self->priv->uridecodebin =
-      gst_element_factory_make ("uridecodebin", NULL);
-  self->priv->network_cache = NETWORK_CACHE_DEFAULT;
-  self->priv->port_range = g_strdup (PORT_RANGE_DEFAULT);
-
-  self->priv->stats.probes = kms_list_new_full (g_direct_equal, g_object_unref,
-      (GDestroyNotify) kms_stats_probe_destroy);
+  pipeline = gst_pipeline_new ("internalpipeline");
+  *uridecodebin = gst_element_factory_make ("uridecodebin", NULL);
+  g_object_set_qdata (G_OBJECT (*uridecodebin), item_quark (),
+      GINT_TO_POINTER (++self->priv->items));
 
   /* Connect to signals */
-  g_signal_connect (self->priv->uridecodebin, "pad-added",
+  g_signal_connect (*uridecodebin, "pad-added",
       G_CALLBACK (kms_player_endpoint_uridecodebin_pad_added), self);
-  g_signal_connect (self->priv->uridecodebin, "pad-removed",
+  g_signal_connect (*uridecodebin, "pad-removed",
       G_CALLBACK (kms_player_endpoint_uridecodebin_pad_removed), self);
-  g_signal_connect (self->priv->uridecodebin, "source-setup",
+  g_signal_connect (*uridecodebin, "source-setup",
       G_CALLBACK (kms_player_endpoint_uridecodebin_source_setup), self);
-  g_signal_connect (self->priv->uridecodebin, "element-added",
+  g_signal_connect (*uridecodebin, "element-added",
       G_CALLBACK (kms_player_endpoint_uridecodebin_element_added), self);
 
   /* Eat all async messages such as buffering messages */
-  bus = gst_pipeline_get_bus (GST_PIPELINE (self->priv->pipeline));
+  bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
   gst_bus_add_watch (bus, (GstBusFunc) process_bus_message, self);
 
-  g_object_set (self->priv->uridecodebin, "download", TRUE, NULL);
+  if (self->priv->use_encoded_media) {
+    kms_player_endpoint_disable_decoding (*uridecodebin);
+  }
+
+  g_object_set (*uridecodebin, "download", TRUE, NULL);
 
-  gst_bin_add (GST_BIN (self->priv->pipeline), self->priv->uridecodebin);
+  gst_bin_add (GST_BIN (pipeline), *uridecodebin);
 
   gst_bus_set_sync_handler (bus, bus_sync_signal_handler, self, NULL);
   g_object_unref (bus);
+
+  return pipeline;
+}
+
+static void
+kms_player_endpoint_preroll_next_item (KmsPlayerEndpoint * self)
+{
+  GstElement *next = NULL;
+  const gchar *uri;
+
+  KMS_ELEMENT_LOCK (self);
+
+  uri = g_queue_peek_head (self->priv->playlist);
+
+  if (uri != NULL && self->priv->next_pipeline == NULL
+      && GST_STATE_TARGET (self->priv->pipeline) >= GST_STATE_PAUSED) {
+    GST_DEBUG_OBJECT (self, "Pre-rolling next item: %s", uri);
+
+    self->priv->next_pipeline = kms_player_endpoint_create_pipeline (self,
+        &self->priv->next_uridecodebin);
+    g_object_set (G_OBJECT (self->priv->next_uridecodebin), "uri", uri,
+        NULL);
+    next = gst_object_ref (self->priv->next_pipeline);
+  }
+
+  KMS_ELEMENT_UNLOCK (self);
+
+  if (next != NULL) {
+    gst_element_set_state (next, GST_STATE_PAUSED);
+    gst_object_unref (next);
+  }
+}
+
+static void
+kms_player_endpoint_drop_next_item (KmsPlayerEndpoint * self)
+{
+  GstElement *next;
+
+  KMS_ELEMENT_LOCK (self);
+  next = kms_player_endpoint_steal_next_item (self);
+  KMS_ELEMENT_UNLOCK (self);
+
+  if (next != NULL) {
+    kms_player_endpoint_destroy_pipeline (next);
+  }
+}
+
+static void
+kms_player_endpoint_take_over_appsrc (const GValue * value, gpointer data)
+{
+  GstElement *appsink = g_value_get_object (value);
+  GstElement *appsrc;
+  GstCaps *caps;
+  GstPad *pad;
+
+  appsrc = g_object_get_qdata (G_OBJECT (appsink), appsrc_quark ());
+  if (appsrc == NULL) {
+    /* Fakesink of a not supported stream */
+    return;
+  }
+
+  kms_player_endpoint_set_appsink (appsrc, appsink);
+
+  pad = gst_element_get_static_pad (appsink, "sink");
+  caps = gst_pad_get_current_caps (pad);
+  g_object_unref (pad);
+
+  if (caps != NULL) {
+    GST_DEBUG_OBJECT (appsrc, "Set new caps: %" GST_PTR_FORMAT, caps);
+    g_object_set (G_OBJECT (appsrc), "caps", caps, NULL);
+    gst_caps_unref (caps);
+  }
+}
+
+/*
+ * Called when the item being played reaches its end. The pre-rolled pipeline
+ * of the next item replaces it, and its appsinks take over the appsrcs, so
+ * that the streams of the element go on without being renegotiated.
+ * Timestamps carry on from the last ones pushed, see process_sample().
+ */
+static gboolean
+kms_player_endpoint_play_next_item (KmsPlayerEndpoint * self)
+{
+  GstElement *pipeline, *next;
+  GstIterator *it;
+  gchar *uri;
+
+  KMS_ELEMENT_LOCK (self);
+
+  if (self->priv->next_pipeline == NULL || self->priv->next_failed) {
+    KMS_ELEMENT_UNLOCK (self);
+    return FALSE;
+  }
+
+  pipeline = self->priv->pipeline;
+  self->priv->uridecodebin = self->priv->next_uridecodebin;
+  self->priv->pipeline = next = kms_player_endpoint_steal_next_item (self);
+  uri = g_queue_pop_head (self->priv->playlist);
+
+  it = gst_bin_iterate_sinks (GST_BIN (next));
+  gst_iterator_foreach (it, kms_player_endpoint_take_over_appsrc, NULL);
+  gst_iterator_free (it);
+
+  BASE_TIME_LOCK (self);
+  self->priv->base_time = GST_CLOCK_TIME_NONE;
+  self->priv->base_time_preroll = GST_CLOCK_TIME_NONE;
+  self->priv->reset = FALSE;
+  BASE_TIME_UNLOCK (self);
+
+  g_atomic_int_set (&self->priv->item,
+      kms_player_endpoint_get_item (self->priv->uridecodebin));
+
+  KMS_ELEMENT_UNLOCK (self);
+
+  GST_DEBUG_OBJECT (self, "Playing next item: %s", uri);
+
+  gst_element_set_state (next, GST_STATE_PLAYING);
+  kms_player_endpoint_destroy_pipeline (pipeline);
+
+  kms_player_endpoint_preroll_next_item (self);
+
+  g_signal_emit (G_OBJECT (self),
+      kms_player_endpoint_signals[SIGNAL_ITEM_STARTED], 0, uri);
+  g_free (uri);
+
+  return TRUE;
+}
+
+static void
+kms_player_endpoint_set_playlist (KmsPlayerEndpoint * self, gchar ** uris)
+{
+  GstElement *next = NULL;
+  const gchar *head = (uris != NULL) ? uris[0] : NULL;
+  guint i;
+
+  KMS_ELEMENT_LOCK (self);
+
+  /* Keep the pre-rolled item if it is still the next one */
+  if (self->priv->next_failed
+      || g_strcmp0 (head, g_queue_peek_head (self->priv->playlist)) != 0) {
+    next = kms_player_endpoint_steal_next_item (self);
+  }
+
+  g_queue_free_full (self->priv->playlist, g_free);
+  self->priv->playlist = g_queue_new ();
+
+  for (i = 0; uris != NULL && uris[i] != NULL; i++) {
+    g_queue_push_tail (self->priv->playlist, g_strdup (uris[i]));
+  }
+
+  KMS_ELEMENT_UNLOCK (self);
+
+  if (next != NULL) {
+    kms_player_endpoint_destroy_pipeline (next);
+  }
+
+  kms_player_endpoint_preroll_next_item (self);
+}
+
+static gchar **
+kms_player_endpoint_get_playlist (KmsPlayerEndpoint * self)
+{
+  gchar **uris;
+  GList *l;
+  guint i = 0;
+
+  KMS_ELEMENT_LOCK (self);
+
+  uris = g_new0 (gchar *, g_queue_get_length (self->priv->playlist) + 1);
+  for (l = self->priv->playlist->head; l != NULL; l = l->next) {
+    uris[i++] = g_strdup (l->data);
+  }
+
+  KMS_ELEMENT_UNLOCK (self);
+
+  return uris;
+}
+
+static void
+kms_player_endpoint_init (KmsPlayerEndpoint * self)
+{
+  // self->priv = KMS_PLAYER_ENDPOINT_GET_PRIVATE (self);
+   self->priv = kms_player_endpoint_get_instance_private (self);
+
+  g_mutex_init (&self->priv->base_time_mutex);
+  self->priv->base_time = GST_CLOCK_TIME_NONE;
+  self->priv->base_time_preroll = GST_CLOCK_TIME_NONE;
+
+  self->priv->loop = kms_loop_new ();
+  self->priv->network_cache = NETWORK_CACHE_DEFAULT;
+  self->priv->port_range = g_strdup (PORT_RANGE_DEFAULT);
+  self->priv->playlist = g_queue_new ();
+
+  self->priv->stats.probes = kms_list_new_full (g_direct_equal, g_object_unref,
+      (GDestroyNotify) kms_stats_probe_destroy);
+
+  self->priv->pipeline = kms_player_endpoint_create_pipeline (self,
+      &self->priv->uridecodebin);
+  self->priv->item = kms_player_endpoint_get_item (self->priv->uridecodebin);
 }
 
 gboolean
@@ -59,6 +59,7 @@ struct _KmsPlayerEndpointClass
   void (*eos_signal) (KmsPlayerEndpoint * self);
   void (*invalid_uri_signal) (KmsPlayerEndpoint * self);
   void (*invalid_media_signal) (KmsPlayerEndpoint * self);
+  void (*item_started_signal) (KmsPlayerEndpoint * self, const gchar * uri);
 };
 
 GType kms_player_endpoint_get_type (void);
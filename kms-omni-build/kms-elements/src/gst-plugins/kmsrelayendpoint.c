@@ -0,0 +1,1259 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <gio/gio.h>
+#include <gst/gst.h>
+#include <gst/net/gstnetaddressmeta.h>
+#include <gst/video/video.h>
+#include <commons/kmselement.h>
+#include <commons/kmsutils.h>
+#include <commons/kms-core-enumtypes.h>
+#include "kmsrelayendpoint.h"
+#include <kms-elements-marshal.h>
+
+#define PLUGIN_NAME "relayendpoint"
+
+GST_DEBUG_CATEGORY_STATIC (kms_relay_endpoint_debug_category);
+#define GST_CAT_DEFAULT kms_relay_endpoint_debug_category
+
+#define KMS_RELAY_ENDPOINT_LOCK(self) \
+  (g_mutex_lock (&(self)->priv->mutex))
+
+#define KMS_RELAY_ENDPOINT_UNLOCK(self) \
+  (g_mutex_unlock (&(self)->priv->mutex))
+
+/* Description KmsElement gives to pads requested without one */
+#define DEFAULT_DESCRIPTION "default"
+
+/* Encoded formats relayed, the first one is used when upstream is raw */
+#define RELAY_AUDIO_CAPS "audio/x-opus;audio/x-alaw;audio/x-mulaw;"
+#define RELAY_VIDEO_CAPS "video/x-vp8;video/x-h264;"
+
+#define RELAY_RTP_CAPS "application/x-rtp,media=(string)application," \
+  "clock-rate=(int)90000,encoding-name=(string)X-GST"
+
+/* Seconds between the caps sent in-band for late receivers */
+#define CONFIG_INTERVAL 1
+#define ANNOUNCE_INTERVAL GST_SECOND
+#define RECV_BUFFER_SIZE (4 * 1024 * 1024)
+#define MAX_DATAGRAM_SIZE 65507
+
+/* Minimum time between keyframe requests for lost video packets */
+#define LOSS_KEY_REQUEST_INTERVAL (G_USEC_PER_SEC / 2)
+
+/*
+ * Control messages share the socket with RTP. They are text datagrams whose
+ * first byte, 'K', can never start an RTP version 2 packet:
+ *
+ *   KMSR <session> <version>\n<ssrc> <audio|video> <description>\n...
+ *     Table of every stream sent, repeated each ANNOUNCE_INTERVAL. The
+ *     version grows on each change, so stale or repeated tables are ignored.
+ *   KMSK <ssrc>\n
+ *     Keyframe request for a stream received. Also sent when packets of a
+ *     video stream are lost, at most once each LOSS_KEY_REQUEST_INTERVAL.
+ *
+ * Datagrams not sent from the configured remote address are dropped.
+ */
+#define CONTROL_TABLE "KMSR"
+#define CONTROL_KEY_REQUEST "KMSK"
+#define CONTROL_PREFIX_LEN 4
+
+#define is_rtp_packet(data) (((data)[0] & 0xc0) == 0x80)
+
+#define SSRC_KEY "kms-relay-ssrc"
+G_DEFINE_QUARK (SSRC_KEY, ssrc);
+
+typedef struct _KmsRelayStream
+{
+  guint32 ssrc;
+  KmsElementPadType type;
+  gchar *description;
+
+  /* Sending side */
+  GstElement *capsfilter;
+  GstElement *payloader;
+  GstPad *funnel_pad;
+
+  /* Receiving side */
+  GstElement *depayloader;
+  gboolean have_seq;
+  guint16 last_seq;
+  gint64 last_key_request;
+} KmsRelayStream;
+
+struct _KmsRelayEndpointPrivate
+{
+  /* Protects the stream tables and the remote address */
+  GMutex mutex;
+
+  GSocket *socket;
+  guint port;
+  gchar *remote_address;
+  guint remote_port;
+  GSocketAddress *remote;
+
+  GstElement *funnel;
+  GstElement *udpsink;
+  GstElement *udpsrc;
+  GstElement *ssrcdemux;
+
+  GstClockID announce_id;
+
+  /* KmsRelayStream sent, by sink pad name */
+  GHashTable *local_streams;
+  guint32 session;
+  guint32 version;
+
+  /* KmsRelayStream announced by the peer, by SSRC */
+  GHashTable *remote_streams;
+  gboolean remote_table;
+  guint32 remote_session;
+  guint32 remote_version;
+};
+
+enum
+{
+  PROP_0,
+  PROP_PORT,
+  PROP_REMOTE_ADDRESS,
+  PROP_REMOTE_PORT,
+  N_PROPERTIES
+};
+
+static GParamSpec *obj_properties[N_PROPERTIES] = { NULL, };
+
+enum
+{
+  SIGNAL_STREAM_ADDED,
+  SIGNAL_STREAM_REMOVED,
+  LAST_SIGNAL
+};
+
+static guint kms_relay_endpoint_signals[LAST_SIGNAL] = { 0 };
+
+G_DEFINE_TYPE_WITH_PRIVATE (KmsRelayEndpoint, kms_relay_endpoint,
+    KMS_TYPE_ELEMENT);
+
+static KmsRelayStream *
+kms_relay_stream_new (guint32 ssrc, KmsElementPadType type,
+    const gchar * description)
+{
+  KmsRelayStream *stream = g_slice_new0 (KmsRelayStream);
+
+  stream->ssrc = ssrc;
+  stream->type = type;
+  stream->description = g_strdup (description);
+
+  return stream;
+}
+
+static void
+kms_relay_stream_destroy (KmsRelayStream * stream)
+{
+  g_free (stream->description);
+  g_slice_free (KmsRelayStream, stream);
+}
+
+static gboolean
+kms_relay_endpoint_open_socket (KmsRelayEndpoint * self)
+{
+  GSocketAddress *addr, *local;
+  GInetAddress *any;
+  GSocket *socket;
+  GError *err = NULL;
+  gboolean ret = TRUE;
+
+  KMS_RELAY_ENDPOINT_LOCK (self);
+
+  if (self->priv->socket != NULL) {
+    goto end;
+  }
+
+  socket = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+      G_SOCKET_PROTOCOL_UDP, &err);
+
+  if (socket == NULL) {
+    GST_ERROR_OBJECT (self, "Can not create socket: %s", err->message);
+    g_error_free (err);
+    ret = FALSE;
+    goto end;
+  }
+
+  any = g_inet_address_new_any (G_SOCKET_FAMILY_IPV4);
+  addr = g_inet_socket_address_new (any, self->priv->port);
+  g_object_unref (any);
+
+  if (!g_socket_bind (socket, addr, FALSE, &err)) {
+    GST_ERROR_OBJECT (self, "Can not bind port %u: %s", self->priv->port,
+        err->message);
+    g_error_free (err);
+    g_object_unref (socket);
+    g_object_unref (addr);
+    ret = FALSE;
+    goto end;
+  }
+
+  g_object_unref (addr);
+
+  local = g_socket_get_local_address (socket, NULL);
+  if (local != NULL) {
+    self->priv->port =
+        g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (local));
+    g_object_unref (local);
+  }
+
+  self->priv->socket = socket;
+  g_object_set (self->priv->udpsrc, "socket", socket, NULL);
+  g_object_set (self->priv->udpsink, "socket", socket, NULL);
+
+  GST_INFO_OBJECT (self, "Relaying on port %u", self->priv->port);
+
+end:
+  KMS_RELAY_ENDPOINT_UNLOCK (self);
+
+  return ret;
+}
+
+/* Takes ownership of @msg */
+static void
+kms_relay_endpoint_send_control (KmsRelayEndpoint * self, GString * msg)
+{
+  GSocketAddress *remote = NULL;
+  GSocket *socket = NULL;
+  GError *err = NULL;
+
+  KMS_RELAY_ENDPOINT_LOCK (self);
+
+  if (self->priv->socket != NULL && self->priv->remote != NULL) {
+    socket = g_object_ref (self->priv->socket);
+    remote = g_object_ref (self->priv->remote);
+  }
+
+  KMS_RELAY_ENDPOINT_UNLOCK (self);
+
+  if (socket == NULL) {
+    goto end;
+  }
+
+  if (msg->len > MAX_DATAGRAM_SIZE) {
+    GST_ERROR_OBJECT (self, "Control message of %" G_GSIZE_FORMAT
+        " bytes does not fit in a datagram", msg->len);
+  } else if (g_socket_send_to (socket, remote, msg->str, msg->len, NULL,
+          &err) < 0) {
+    GST_WARNING_OBJECT (self, "Can not send control message: %s",
+        err->message);
+    g_error_free (err);
+  }
+
+  g_object_unref (socket);
+  g_object_unref (remote);
+
+end:
+  g_string_free (msg, TRUE);
+}
+
+static void
+kms_relay_endpoint_announce (KmsRelayEndpoint * self)
+{
+  GHashTableIter iter;
+  gpointer value;
+  GString *msg;
+
+  msg = g_string_new (NULL);
+
+  KMS_RELAY_ENDPOINT_LOCK (self);
+
+  g_string_append_printf (msg, CONTROL_TABLE " %u %u\n", self->priv->session,
+      self->priv->version);
+
+  g_hash_table_iter_init (&iter, self->priv->local_streams);
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    KmsRelayStream *stream = value;
+
+    g_string_append_printf (msg, "%u %s %s\n", stream->ssrc,
+        kms_element_pad_type_str (stream->type), stream->description);
+  }
+
+  KMS_RELAY_ENDPOINT_UNLOCK (self);
+
+  kms_relay_endpoint_send_control (self, msg);
+}
+
+static gboolean
+kms_relay_endpoint_announce_cb (GstClock * clock, GstClockTime time,
+    GstClockID id, gpointer user_data)
+{
+  kms_relay_endpoint_announce (KMS_RELAY_ENDPOINT (user_data));
+
+  return TRUE;
+}
+
+static void
+kms_relay_endpoint_start_announcing (KmsRelayEndpoint * self)
+{
+  GstClock *clock;
+
+  KMS_RELAY_ENDPOINT_LOCK (self);
+
+  if (self->priv->announce_id != NULL) {
+    goto end;
+  }
+
+  clock = gst_system_clock_obtain ();
+  self->priv->announce_id = gst_clock_new_periodic_id (clock,
+      gst_clock_get_time (clock) + ANNOUNCE_INTERVAL, ANNOUNCE_INTERVAL);
+  gst_object_unref (clock);
+
+  gst_clock_id_wait_async (self->priv->announce_id,
+      kms_relay_endpoint_announce_cb, gst_object_ref (self), gst_object_unref);
+
+end:
+  KMS_RELAY_ENDPOINT_UNLOCK (self);
+}
+
+static void
+kms_relay_endpoint_stop_announcing (KmsRelayEndpoint * self)
+{
+  GstClockID id;
+
+  KMS_RELAY_ENDPOINT_LOCK (self);
+  id = self->priv->announce_id;
+  self->priv->announce_id = NULL;
+  KMS_RELAY_ENDPOINT_UNLOCK (self);
+
+  if (id != NULL) {
+    gst_clock_id_unschedule (id);
+    gst_clock_id_unref (id);
+  }
+}
+
+/* Called with the relay lock held */
+static KmsRelayStream *
+kms_relay_endpoint_find_local_stream (KmsRelayEndpoint * self, guint32 ssrc)
+{
+  GHashTableIter iter;
+  gpointer value;
+
+  g_hash_table_iter_init (&iter, self->priv->local_streams);
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    KmsRelayStream *stream = value;
+
+    if (stream->ssrc == ssrc) {
+      return stream;
+    }
+  }
+
+  return NULL;
+}
+
+/* Called with the relay lock held */
+static guint32
+kms_relay_endpoint_new_ssrc (KmsRelayEndpoint * self)
+{
+  guint32 ssrc;
+
+  /* G_MAXUINT32 would make the payloader pick a random one */
+  do {
+    ssrc = g_random_int ();
+  } while (ssrc == 0 || ssrc == G_MAXUINT32
+      || kms_relay_endpoint_find_local_stream (self, ssrc) != NULL);
+
+  return ssrc;
+}
+
+static gboolean
+kms_relay_endpoint_add_local_stream (KmsRelayEndpoint * self,
+    KmsElementPadType type, const gchar * description, const gchar * name)
+{
+  GstElement *capsfilter, *payloader;
+  GstPad *srcpad, *sinkpad, *funnel_pad;
+  KmsRelayStream *stream;
+  GstCaps *caps;
+
+  if (type != KMS_ELEMENT_PAD_TYPE_AUDIO && type != KMS_ELEMENT_PAD_TYPE_VIDEO) {
+    GST_WARNING_OBJECT (self, "Unsupported pad type: %u", type);
+    return FALSE;
+  }
+
+  if (strchr (description, '\n') != NULL) {
+    GST_WARNING_OBJECT (self, "Invalid description '%s'", description);
+    return FALSE;
+  }
+
+  KMS_RELAY_ENDPOINT_LOCK (self);
+
+  if (g_hash_table_contains (self->priv->local_streams, name)) {
+    KMS_RELAY_ENDPOINT_UNLOCK (self);
+    GST_WARNING_OBJECT (self, "Stream '%s' already added", name);
+    return FALSE;
+  }
+
+  KMS_RELAY_ENDPOINT_UNLOCK (self);
+
+  capsfilter = gst_element_factory_make ("capsfilter", NULL);
+  payloader = gst_element_factory_make ("rtpgstpay", NULL);
+
+  caps = gst_caps_from_string (type == KMS_ELEMENT_PAD_TYPE_AUDIO ?
+      RELAY_AUDIO_CAPS : RELAY_VIDEO_CAPS);
+  g_object_set (capsfilter, "caps", caps, NULL);
+  gst_caps_unref (caps);
+
+  g_object_set (payloader, "config-interval", CONFIG_INTERVAL, NULL);
+
+  gst_bin_add_many (GST_BIN (self), capsfilter, payloader, NULL);
+  gst_element_link (capsfilter, payloader);
+
+  funnel_pad = gst_element_get_request_pad (self->priv->funnel, "sink_%u");
+  srcpad = gst_element_get_static_pad (payloader, "src");
+  gst_pad_link (srcpad, funnel_pad);
+  g_object_unref (srcpad);
+
+  gst_element_sync_state_with_parent (payloader);
+  gst_element_sync_state_with_parent (capsfilter);
+
+  KMS_RELAY_ENDPOINT_LOCK (self);
+
+  stream = kms_relay_stream_new (kms_relay_endpoint_new_ssrc (self), type,
+      description);
+  stream->capsfilter = capsfilter;
+  stream->payloader = payloader;
+  stream->funnel_pad = funnel_pad;
+  g_hash_table_insert (self->priv->local_streams, g_strdup (name), stream);
+  self->priv->version++;
+
+  /* No media reaches the payloader until the sink pad is connected */
+  g_object_set (payloader, "ssrc", stream->ssrc, NULL);
+
+  KMS_RELAY_ENDPOINT_UNLOCK (self);
+
+  GST_DEBUG_OBJECT (self, "Sending %s stream '%s' with SSRC %u",
+      kms_element_pad_type_str (type), description, stream->ssrc);
+
+  sinkpad = gst_element_get_static_pad (capsfilter, "sink");
+  kms_element_connect_sink_target_full (KMS_ELEMENT (self), sinkpad, type,
+      description, NULL, NULL);
+  g_object_unref (sinkpad);
+
+  kms_relay_endpoint_announce (self);
+
+  return TRUE;
+}
+
+static gboolean
+kms_relay_endpoint_remove_local_stream (KmsRelayEndpoint * self,
+    const gchar * name)
+{
+  KmsRelayStream *stream = NULL;
+  gpointer key;
+  GstPad *srcpad;
+
+  KMS_RELAY_ENDPOINT_LOCK (self);
+
+  if (g_hash_table_lookup_extended (self->priv->local_streams, name, &key,
+          (gpointer *) & stream)) {
+    if (g_strcmp0 (stream->description, DEFAULT_DESCRIPTION) == 0) {
+      /* Default pads are not requested, so they are never released */
+      stream = NULL;
+    } else {
+      g_hash_table_steal (self->priv->local_streams, name);
+      g_free (key);
+      self->priv->version++;
+    }
+  }
+
+  KMS_RELAY_ENDPOINT_UNLOCK (self);
+
+  if (stream == NULL) {
+    GST_WARNING_OBJECT (self, "Can not release pad %s", name);
+    return FALSE;
+  }
+
+  GST_DEBUG_OBJECT (self, "Stop sending %s stream '%s' with SSRC %u",
+      kms_element_pad_type_str (stream->type), stream->description,
+      stream->ssrc);
+
+  kms_element_remove_sink_by_type_full (KMS_ELEMENT (self), stream->type,
+      stream->description);
+
+  srcpad = gst_element_get_static_pad (stream->payloader, "src");
+  gst_pad_unlink (srcpad, stream->funnel_pad);
+  g_object_unref (srcpad);
+
+  gst_element_release_request_pad (self->priv->funnel, stream->funnel_pad);
+  g_object_unref (stream->funnel_pad);
+
+  gst_element_set_state (stream->capsfilter, GST_STATE_NULL);
+  gst_element_set_state (stream->payloader, GST_STATE_NULL);
+  gst_bin_remove_many (GST_BIN (self), stream->capsfilter, stream->payloader,
+      NULL);
+
+  kms_relay_stream_destroy (stream);
+
+  kms_relay_endpoint_announce (self);
+
+  return TRUE;
+}
+
+static void
+kms_relay_endpoint_force_key_unit (KmsRelayEndpoint * self, guint32 ssrc)
+{
+  KmsRelayStream *stream;
+  GstPad *sinkpad = NULL;
+
+  KMS_RELAY_ENDPOINT_LOCK (self);
+
+  stream = kms_relay_endpoint_find_local_stream (self, ssrc);
+  if (stream != NULL && stream->type == KMS_ELEMENT_PAD_TYPE_VIDEO) {
+    sinkpad = gst_element_get_static_pad (stream->capsfilter, "sink");
+  }
+
+  KMS_RELAY_ENDPOINT_UNLOCK (self);
+
+  if (sinkpad == NULL) {
+    return;
+  }
+
+  GST_DEBUG_OBJECT (self, "Peer requested a keyframe for SSRC %u", ssrc);
+
+  gst_pad_push_event (sinkpad,
+      gst_video_event_new_upstream_force_key_unit (GST_CLOCK_TIME_NONE, TRUE,
+          0));
+  g_object_unref (sinkpad);
+}
+
+static void
+kms_relay_endpoint_request_key_frame (KmsRelayEndpoint * self, guint ssrc)
+{
+  GString *msg = g_string_new (NULL);
+
+  GST_DEBUG_OBJECT (self, "Requesting a keyframe for SSRC %u", ssrc);
+
+  g_string_printf (msg, CONTROL_KEY_REQUEST " %u\n", ssrc);
+  kms_relay_endpoint_send_control (self, msg);
+}
+
+static GstPadProbeReturn
+kms_relay_endpoint_key_request_probe (GstPad * pad, GstPadProbeInfo * info,
+    gpointer user_data)
+{
+  KmsRelayEndpoint *self = KMS_RELAY_ENDPOINT (user_data);
+  GstEvent *event = gst_pad_probe_info_get_event (info);
+  guint ssrc;
+
+  if (!gst_video_event_is_force_key_unit (event)) {
+    return GST_PAD_PROBE_OK;
+  }
+
+  ssrc = GPOINTER_TO_UINT (g_object_get_qdata (G_OBJECT (pad),
+          ssrc_quark ()));
+
+  kms_relay_endpoint_request_key_frame (self, ssrc);
+
+  /* Nothing upstream of the depayloader can generate it */
+  return GST_PAD_PROBE_DROP;
+}
+
+static void
+kms_relay_endpoint_new_ssrc_pad (GstElement * ssrcdemux, guint ssrc,
+    GstPad * pad, KmsRelayEndpoint * self)
+{
+  GstElement *depayloader, *output;
+  KmsElementPadType type = KMS_ELEMENT_PAD_TYPE_DATA;
+  GstPad *srcpad, *sinkpad;
+  KmsRelayStream *stream;
+  gchar *description = NULL;
+
+  KMS_RELAY_ENDPOINT_LOCK (self);
+
+  stream = g_hash_table_lookup (self->priv->remote_streams,
+      GUINT_TO_POINTER (ssrc));
+  if (stream != NULL) {
+    type = stream->type;
+    description = g_strdup (stream->description);
+  }
+
+  KMS_RELAY_ENDPOINT_UNLOCK (self);
+
+  if (description == NULL) {
+    /* Not expected, unknown SSRCs are dropped before the demuxer */
+    GST_WARNING_OBJECT (self, "Unknown SSRC %u", ssrc);
+    return;
+  }
+
+  GST_DEBUG_OBJECT (self, "Receiving %s stream '%s' with SSRC %u",
+      kms_element_pad_type_str (type), description, ssrc);
+
+  depayloader = gst_element_factory_make ("rtpgstdepay", NULL);
+  gst_bin_add (GST_BIN (self), depayloader);
+
+  output = kms_element_get_output_element (KMS_ELEMENT (self), type,
+      description);
+  gst_element_link (depayloader, output);
+
+  srcpad = gst_element_get_static_pad (depayloader, "src");
+  kms_utils_control_key_frames_request_duplicates (srcpad);
+  g_object_unref (srcpad);
+
+  sinkpad = gst_element_get_static_pad (depayloader, "sink");
+  if (type == KMS_ELEMENT_PAD_TYPE_VIDEO) {
+    g_object_set_qdata (G_OBJECT (sinkpad), ssrc_quark (),
+        GUINT_TO_POINTER (ssrc));
+    gst_pad_add_probe (sinkpad, GST_PAD_PROBE_TYPE_EVENT_UPSTREAM,
+        kms_relay_endpoint_key_request_probe, self, NULL);
+  }
+
+  gst_element_sync_state_with_parent (depayloader);
+  gst_pad_link (pad, sinkpad);
+  g_object_unref (sinkpad);
+
+  KMS_RELAY_ENDPOINT_LOCK (self);
+
+  stream = g_hash_table_lookup (self->priv->remote_streams,
+      GUINT_TO_POINTER (ssrc));
+  if (stream != NULL) {
+    stream->depayloader = depayloader;
+  }
+
+  KMS_RELAY_ENDPOINT_UNLOCK (self);
+
+  g_free (description);
+}
+
+static void
+kms_relay_endpoint_drop_remote_stream (KmsRelayEndpoint * self,
+    KmsRelayStream * stream)
+{
+  GST_DEBUG_OBJECT (self, "Stop receiving %s stream '%s' with SSRC %u",
+      kms_element_pad_type_str (stream->type), stream->description,
+      stream->ssrc);
+
+  g_signal_emit_by_name (self->priv->ssrcdemux, "clear-ssrc", stream->ssrc);
+
+  if (stream->depayloader == NULL) {
+    return;
+  }
+
+  /* The output element is kept, a new stream with the same description
+   * will feed it again */
+  gst_element_set_state (stream->depayloader, GST_STATE_NULL);
+  gst_bin_remove (GST_BIN (self), stream->depayloader);
+  stream->depayloader = NULL;
+}
+
+static GHashTable *
+kms_relay_endpoint_parse_table (KmsRelayEndpoint * self, const gchar * data,
+    gsize size, guint * session, guint * version)
+{
+  GHashTable *table = NULL;
+  gchar *text, **lines;
+  guint i;
+
+  text = g_strndup (data, size);
+  lines = g_strsplit (text, "\n", -1);
+  g_free (text);
+
+  if (lines[0] == NULL
+      || sscanf (lines[0], CONTROL_TABLE " %u %u", session, version) != 2) {
+    GST_WARNING_OBJECT (self, "Malformed stream table");
+    goto end;
+  }
+
+  table = g_hash_table_new_full (NULL, NULL, NULL,
+      (GDestroyNotify) kms_relay_stream_destroy);
+
+  for (i = 1; lines[i] != NULL; i++) {
+    KmsElementPadType type;
+    gchar media[6];
+    gint offset = 0;
+    guint ssrc;
+
+    if (*lines[i] == '\0') {
+      continue;
+    }
+
+    if (sscanf (lines[i], "%u %5s %n", &ssrc, media, &offset) != 2
+        || offset == 0 || lines[i][offset] == '\0') {
+      GST_WARNING_OBJECT (self, "Malformed stream '%s'", lines[i]);
+      continue;
+    }
+
+    if (g_strcmp0 (media, kms_element_pad_type_str
+            (KMS_ELEMENT_PAD_TYPE_AUDIO)) == 0) {
+      type = KMS_ELEMENT_PAD_TYPE_AUDIO;
+    } else if (g_strcmp0 (media, kms_element_pad_type_str
+            (KMS_ELEMENT_PAD_TYPE_VIDEO)) == 0) {
+      type = KMS_ELEMENT_PAD_TYPE_VIDEO;
+    } else {
+      GST_WARNING_OBJECT (self, "Unsupported media '%s'", media);
+      continue;
+    }
+
+    g_hash_table_insert (table, GUINT_TO_POINTER (ssrc),
+        kms_relay_stream_new (ssrc, type, lines[i] + offset));
+  }
+
+end:
+  g_strfreev (lines);
+
+  return table;
+}
+
+static void
+kms_relay_endpoint_update_remote_streams (KmsRelayEndpoint * self,
+    guint session, guint version, GHashTable * table)
+{
+  GSList *added = NULL, *removed = NULL, *l;
+  GHashTableIter iter;
+  gpointer key, value;
+
+  KMS_RELAY_ENDPOINT_LOCK (self);
+
+  if (self->priv->remote_table && self->priv->remote_session == session
+      && self->priv->remote_version >= version) {
+    /* Periodic refresh, or a late table */
+    KMS_RELAY_ENDPOINT_UNLOCK (self);
+    g_hash_table_unref (table);
+    return;
+  }
+
+  self->priv->remote_table = TRUE;
+  self->priv->remote_session = session;
+  self->priv->remote_version = version;
+
+  g_hash_table_iter_init (&iter, self->priv->remote_streams);
+  while (g_hash_table_iter_next (&iter, &key, &value)) {
+    KmsRelayStream *stream = value;
+    KmsRelayStream *announced = g_hash_table_lookup (table, key);
+
+    if (announced == NULL || announced->type != stream->type
+        || g_strcmp0 (announced->description, stream->description) != 0) {
+      g_hash_table_iter_steal (&iter);
+      removed = g_slist_prepend (removed, stream);
+    }
+  }
+
+  g_hash_table_iter_init (&iter, table);
+  while (g_hash_table_iter_next (&iter, &key, &value)) {
+    KmsRelayStream *stream = value;
+
+    if (g_hash_table_contains (self->priv->remote_streams, key)) {
+      continue;
+    }
+
+    g_hash_table_iter_steal (&iter);
+    g_hash_table_insert (self->priv->remote_streams, key, stream);
+    added = g_slist_prepend (added, kms_relay_stream_new (stream->ssrc,
+            stream->type, stream->description));
+  }
+
+  KMS_RELAY_ENDPOINT_UNLOCK (self);
+
+  g_hash_table_unref (table);
+
+  for (l = removed; l != NULL; l = l->next) {
+    KmsRelayStream *stream = l->data;
+
+    kms_relay_endpoint_drop_remote_stream (self, stream);
+    g_signal_emit (self, kms_relay_endpoint_signals[SIGNAL_STREAM_REMOVED], 0,
+        stream->type, stream->description);
+  }
+
+  for (l = added; l != NULL; l = l->next) {
+    KmsRelayStream *stream = l->data;
+
+    GST_DEBUG_OBJECT (self, "Peer announced %s stream '%s' with SSRC %u",
+        kms_element_pad_type_str (stream->type), stream->description,
+        stream->ssrc);
+    g_signal_emit (self, kms_relay_endpoint_signals[SIGNAL_STREAM_ADDED], 0,
+        stream->type, stream->description);
+  }
+
+  g_slist_free_full (removed, (GDestroyNotify) kms_relay_stream_destroy);
+  g_slist_free_full (added, (GDestroyNotify) kms_relay_stream_destroy);
+}
+
+static void
+kms_relay_endpoint_handle_control (KmsRelayEndpoint * self,
+    const gchar * data, gsize size)
+{
+  if (size < CONTROL_PREFIX_LEN) {
+    GST_DEBUG_OBJECT (self, "Dropping short packet");
+  } else if (strncmp (data, CONTROL_TABLE, CONTROL_PREFIX_LEN) == 0) {
+    guint session, version;
+    GHashTable *table;
+
+    table = kms_relay_endpoint_parse_table (self, data, size, &session,
+        &version);
+    if (table != NULL) {
+      kms_relay_endpoint_update_remote_streams (self, session, version, table);
+    }
+  } else if (strncmp (data, CONTROL_KEY_REQUEST, CONTROL_PREFIX_LEN) == 0) {
+    gchar *text = g_strndup (data, size);
+    guint ssrc;
+
+    if (sscanf (text, CONTROL_KEY_REQUEST " %u", &ssrc) == 1) {
+      kms_relay_endpoint_force_key_unit (self, ssrc);
+    }
+
+    g_free (text);
+  } else {
+    GST_DEBUG_OBJECT (self, "Dropping unknown packet");
+  }
+}
+
+/* Called with the relay lock held */
+static gboolean
+kms_relay_endpoint_is_from_remote (KmsRelayEndpoint * self, GstBuffer * buffer)
+{
+  GInetSocketAddress *remote, *sender;
+  GstNetAddressMeta *meta;
+
+  if (self->priv->remote == NULL) {
+    return FALSE;
+  }
+
+  meta = gst_buffer_get_net_address_meta (buffer);
+  if (meta == NULL || !G_IS_INET_SOCKET_ADDRESS (meta->addr)) {
+    return FALSE;
+  }
+
+  remote = G_INET_SOCKET_ADDRESS (self->priv->remote);
+  sender = G_INET_SOCKET_ADDRESS (meta->addr);
+
+  return g_inet_socket_address_get_port (sender) ==
+      g_inet_socket_address_get_port (remote)
+      && g_inet_address_equal (g_inet_socket_address_get_address (sender),
+      g_inet_socket_address_get_address (remote));
+}
+
+/*
+ * Called with the relay lock held. Returns TRUE when packets were lost on a
+ * video stream and its peer has to be asked for a keyframe.
+ */
+static gboolean
+kms_relay_endpoint_check_loss (KmsRelayEndpoint * self,
+    KmsRelayStream * stream, guint16 seq)
+{
+  gint16 diff;
+  gint64 now;
+
+  if (!stream->have_seq) {
+    stream->have_seq = TRUE;
+    stream->last_seq = seq;
+    return FALSE;
+  }
+
+  diff = (gint16) (seq - stream->last_seq);
+  if (diff <= 0) {
+    /* Duplicated or reordered, already accounted */
+    return FALSE;
+  }
+
+  stream->last_seq = seq;
+
+  if (diff == 1 || stream->type != KMS_ELEMENT_PAD_TYPE_VIDEO) {
+    return FALSE;
+  }
+
+  GST_DEBUG_OBJECT (self, "Lost %d packets of SSRC %u", diff - 1,
+      stream->ssrc);
+
+  now = g_get_monotonic_time ();
+  if (now - stream->last_key_request < LOSS_KEY_REQUEST_INTERVAL) {
+    return FALSE;
+  }
+
+  stream->last_key_request = now;
+
+  return TRUE;
+}
+
+static GstPadProbeReturn
+kms_relay_endpoint_recv_probe (GstPad * pad, GstPadProbeInfo * info,
+    gpointer user_data)
+{
+  KmsRelayEndpoint *self = KMS_RELAY_ENDPOINT (user_data);
+  GstBuffer *buffer = gst_pad_probe_info_get_buffer (info);
+  GstPadProbeReturn ret = GST_PAD_PROBE_DROP;
+  gboolean from_remote, request_key = FALSE;
+  KmsRelayStream *stream;
+  GstMapInfo map;
+  guint32 ssrc;
+
+  /* Only the configured peer can feed or control this relay */
+  KMS_RELAY_ENDPOINT_LOCK (self);
+  from_remote = kms_relay_endpoint_is_from_remote (self, buffer);
+  KMS_RELAY_ENDPOINT_UNLOCK (self);
+
+  if (!from_remote) {
+    GST_LOG_OBJECT (self, "Dropping packet not sent by the peer");
+    return GST_PAD_PROBE_DROP;
+  }
+
+  if (!gst_buffer_map (buffer, &map, GST_MAP_READ)) {
+    return GST_PAD_PROBE_DROP;
+  }
+
+  if (map.size == 0) {
+    goto end;
+  }
+
+  if (!is_rtp_packet (map.data)) {
+    kms_relay_endpoint_handle_control (self, (const gchar *) map.data,
+        map.size);
+    goto end;
+  }
+
+  if (map.size < 12) {
+    goto end;
+  }
+
+  ssrc = GST_READ_UINT32_BE (map.data + 8);
+
+  /* Media of streams not announced yet, or already removed, is dropped */
+  KMS_RELAY_ENDPOINT_LOCK (self);
+  stream = g_hash_table_lookup (self->priv->remote_streams,
+      GUINT_TO_POINTER (ssrc));
+  if (stream != NULL) {
+    request_key = kms_relay_endpoint_check_loss (self, stream,
+        GST_READ_UINT16_BE (map.data + 2));
+    ret = GST_PAD_PROBE_OK;
+  }
+  KMS_RELAY_ENDPOINT_UNLOCK (self);
+
+  if (request_key) {
+    kms_relay_endpoint_request_key_frame (self, ssrc);
+  }
+
+end:
+  gst_buffer_unmap (buffer, &map);
+
+  return ret;
+}
+
+static void
+kms_relay_endpoint_update_remote (KmsRelayEndpoint * self)
+{
+  GSocketAddress *remote = NULL;
+  gchar *address;
+  guint port;
+
+  KMS_RELAY_ENDPOINT_LOCK (self);
+
+  address = g_strdup (self->priv->remote_address);
+  port = self->priv->remote_port;
+
+  g_clear_object (&self->priv->remote);
+
+  if (address != NULL && port != 0) {
+    remote = g_inet_socket_address_new_from_string (address, port);
+    if (remote == NULL) {
+      GST_ERROR_OBJECT (self, "Invalid remote address %s", address);
+    }
+    self->priv->remote = remote;
+  }
+
+  KMS_RELAY_ENDPOINT_UNLOCK (self);
+
+  g_signal_emit_by_name (self->priv->udpsink, "clear");
+
+  if (remote != NULL) {
+    GST_INFO_OBJECT (self, "Relaying to %s:%u", address, port);
+    g_signal_emit_by_name (self->priv->udpsink, "add", address, port);
+    kms_relay_endpoint_announce (self);
+  }
+
+  g_free (address);
+}
+
+static gboolean
+kms_relay_endpoint_request_new_sink_pad (KmsElement * obj,
+    KmsElementPadType type, const gchar * description, const gchar * name)
+{
+  return kms_relay_endpoint_add_local_stream (KMS_RELAY_ENDPOINT (obj), type,
+      description, name);
+}
+
+static gboolean
+kms_relay_endpoint_release_requested_sink_pad (KmsElement * obj, GstPad * pad)
+{
+  gchar *name = gst_pad_get_name (pad);
+  gboolean ret;
+
+  ret = kms_relay_endpoint_remove_local_stream (KMS_RELAY_ENDPOINT (obj),
+      name);
+  g_free (name);
+
+  return ret;
+}
+
+static GstStateChangeReturn
+kms_relay_endpoint_change_state (GstElement * element,
+    GstStateChange transition)
+{
+  KmsRelayEndpoint *self = KMS_RELAY_ENDPOINT (element);
+  GstStateChangeReturn ret;
+
+  if (transition == GST_STATE_CHANGE_NULL_TO_READY) {
+    if (!kms_relay_endpoint_open_socket (self)) {
+      return GST_STATE_CHANGE_FAILURE;
+    }
+
+    kms_relay_endpoint_start_announcing (self);
+  }
+
+  ret = GST_ELEMENT_CLASS (kms_relay_endpoint_parent_class)->change_state
+      (element, transition);
+
+  if (transition == GST_STATE_CHANGE_READY_TO_NULL) {
+    kms_relay_endpoint_stop_announcing (self);
+  }
+
+  return ret;
+}
+
+static void
+kms_relay_endpoint_set_property (GObject * object, guint property_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  KmsRelayEndpoint *self = KMS_RELAY_ENDPOINT (object);
+
+  switch (property_id) {
+    case PROP_PORT:
+      KMS_RELAY_ENDPOINT_LOCK (self);
+      if (self->priv->socket != NULL) {
+        GST_WARNING_OBJECT (self, "Port can not change once it is bound");
+      } else {
+        self->priv->port = g_value_get_uint (value);
+      }
+      KMS_RELAY_ENDPOINT_UNLOCK (self);
+      break;
+    case PROP_REMOTE_ADDRESS:
+      KMS_RELAY_ENDPOINT_LOCK (self);
+      g_free (self->priv->remote_address);
+      self->priv->remote_address = g_value_dup_string (value);
+      KMS_RELAY_ENDPOINT_UNLOCK (self);
+      kms_relay_endpoint_update_remote (self);
+      break;
+    case PROP_REMOTE_PORT:
+      KMS_RELAY_ENDPOINT_LOCK (self);
+      self->priv->remote_port = g_value_get_uint (value);
+      KMS_RELAY_ENDPOINT_UNLOCK (self);
+      kms_relay_endpoint_update_remote (self);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      break;
+  }
+}
+
+static void
+kms_relay_endpoint_get_property (GObject * object, guint property_id,
+    GValue * value, GParamSpec * pspec)
+{
+  KmsRelayEndpoint *self = KMS_RELAY_ENDPOINT (object);
+
+  switch (property_id) {
+    case PROP_PORT:
+      /* The peer needs the port before media flows */
+      kms_relay_endpoint_open_socket (self);
+      KMS_RELAY_ENDPOINT_LOCK (self);
+      g_value_set_uint (value, self->priv->port);
+      KMS_RELAY_ENDPOINT_UNLOCK (self);
+      break;
+    case PROP_REMOTE_ADDRESS:
+      KMS_RELAY_ENDPOINT_LOCK (self);
+      g_value_set_string (value, self->priv->remote_address);
+      KMS_RELAY_ENDPOINT_UNLOCK (self);
+      break;
+    case PROP_REMOTE_PORT:
+      KMS_RELAY_ENDPOINT_LOCK (self);
+      g_value_set_uint (value, self->priv->remote_port);
+      KMS_RELAY_ENDPOINT_UNLOCK (self);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+      break;
+  }
+}
+
+static void
+kms_relay_endpoint_dispose (GObject * object)
+{
+  KmsRelayEndpoint *self = KMS_RELAY_ENDPOINT (object);
+
+  GST_DEBUG_OBJECT (self, "dispose");
+
+  kms_relay_endpoint_stop_announcing (self);
+
+  KMS_RELAY_ENDPOINT_LOCK (self);
+  g_clear_object (&self->priv->remote);
+  g_clear_object (&self->priv->socket);
+  KMS_RELAY_ENDPOINT_UNLOCK (self);
+
+  G_OBJECT_CLASS (kms_relay_endpoint_parent_class)->dispose (object);
+}
+
+static void
+kms_relay_endpoint_finalize (GObject * object)
+{
+  KmsRelayEndpoint *self = KMS_RELAY_ENDPOINT (object);
+
+  GST_DEBUG_OBJECT (self, "finalize");
+
+  g_hash_table_unref (self->priv->local_streams);
+  g_hash_table_unref (self->priv->remote_streams);
+  g_free (self->priv->remote_address);
+  g_mutex_clear (&self->priv->mutex);
+
+  G_OBJECT_CLASS (kms_relay_endpoint_parent_class)->finalize (object);
+}
+
+static void
+kms_relay_endpoint_class_init (KmsRelayEndpointClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstElementClass *gstelement_class = GST_ELEMENT_CLASS (klass);
+  KmsElementClass *kms_element_class = KMS_ELEMENT_CLASS (klass);
+
+  GST_DEBUG_CATEGORY_INIT (GST_CAT_DEFAULT, PLUGIN_NAME, 0, PLUGIN_NAME);
+
+  gst_element_class_set_static_metadata (gstelement_class,
+      "RelayEndpoint", "Generic",
+      "Relays many encoded streams to another media server over one transport",
+      "Kurento <kurento@googlegroups.com>");
+
+  gobject_class->set_property = kms_relay_endpoint_set_property;
+  gobject_class->get_property = kms_relay_endpoint_get_property;
+  gobject_class->dispose = kms_relay_endpoint_dispose;
+  gobject_class->finalize = kms_relay_endpoint_finalize;
+
+  gstelement_class->change_state =
+      GST_DEBUG_FUNCPTR (kms_relay_endpoint_change_state);
+
+  kms_element_class->request_new_sink_pad =
+      GST_DEBUG_FUNCPTR (kms_relay_endpoint_request_new_sink_pad);
+  kms_element_class->release_requested_sink_pad =
+      GST_DEBUG_FUNCPTR (kms_relay_endpoint_release_requested_sink_pad);
+
+  obj_properties[PROP_PORT] = g_param_spec_uint ("port",
+      "Local port",
+      "UDP port where the peer sends to (0 = any free port). "
+      "Bound when first read or when the element starts",
+      0, G_MAXUINT16, 0, G_PARAM_READWRITE);
+
+  obj_properties[PROP_REMOTE_ADDRESS] = g_param_spec_string ("remote-address",
+      "Remote address", "IPv4 address of the peer relay", NULL,
+      G_PARAM_READWRITE);
+
+  obj_properties[PROP_REMOTE_PORT] = g_param_spec_uint ("remote-port",
+      "Remote port", "UDP port of the peer relay",
+      0, G_MAXUINT16, 0, G_PARAM_READWRITE);
+
+  g_object_class_install_properties (gobject_class,
+      N_PROPERTIES, obj_properties);
+
+  kms_relay_endpoint_signals[SIGNAL_STREAM_ADDED] =
+      g_signal_new ("stream-added",
+      G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST,
+      G_STRUCT_OFFSET (KmsRelayEndpointClass, stream_added_signal), NULL,
+      NULL, __kms_elements_marshal_VOID__ENUM_STRING, G_TYPE_NONE, 2,
+      KMS_TYPE_ELEMENT_PAD_TYPE, G_TYPE_STRING);
+
+  kms_relay_endpoint_signals[SIGNAL_STREAM_REMOVED] =
+      g_signal_new ("stream-removed",
+      G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST,
+      G_STRUCT_OFFSET (KmsRelayEndpointClass, stream_removed_signal), NULL,
+      NULL, __kms_elements_marshal_VOID__ENUM_STRING, G_TYPE_NONE, 2,
+      KMS_TYPE_ELEMENT_PAD_TYPE, G_TYPE_STRING);
+}
+
+static void
+kms_relay_endpoint_add_default_stream (KmsRelayEndpoint * self,
+    KmsElementPadType type)
+{
+  gchar *name;
+
+  name = g_strdup_printf ("sink_%s_%s", kms_element_pad_type_str (type),
+      DEFAULT_DESCRIPTION);
+  kms_relay_endpoint_add_local_stream (self, type, DEFAULT_DESCRIPTION, name);
+  g_free (name);
+}
+
+static void
+kms_relay_endpoint_init (KmsRelayEndpoint * self)
+{
+  GstCaps *caps;
+  GstPad *srcpad;
+
+  self->priv = kms_relay_endpoint_get_instance_private (self);
+
+  g_mutex_init (&self->priv->mutex);
+
+  self->priv->local_streams = g_hash_table_new_full (g_str_hash, g_str_equal,
+      g_free, (GDestroyNotify) kms_relay_stream_destroy);
+  self->priv->remote_streams = g_hash_table_new_full (NULL, NULL, NULL,
+      (GDestroyNotify) kms_relay_stream_destroy);
+  self->priv->session = g_random_int ();
+
+  self->priv->funnel = gst_element_factory_make ("funnel", NULL);
+  self->priv->udpsink = gst_element_factory_make ("multiudpsink", NULL);
+  self->priv->udpsrc = gst_element_factory_make ("udpsrc", NULL);
+  self->priv->ssrcdemux = gst_element_factory_make ("rtpssrcdemux", NULL);
+
+  /* Streams are interleaved packet by packet, do not renegotiate each time */
+  g_object_set (self->priv->funnel, "forward-sticky-events-mode",
+      0 /* never */ , NULL);
+  g_object_set (self->priv->udpsink, "close-socket", FALSE, "sync", FALSE,
+      "async", FALSE, NULL);
+
+  caps = gst_caps_from_string (RELAY_RTP_CAPS);
+  g_object_set (self->priv->udpsrc, "close-socket", FALSE, "auto-multicast",
+      FALSE, "buffer-size", RECV_BUFFER_SIZE, "caps", caps, NULL);
+  gst_caps_unref (caps);
+
+  g_signal_connect (self->priv->ssrcdemux, "new-ssrc-pad",
+      G_CALLBACK (kms_relay_endpoint_new_ssrc_pad), self);
+
+  gst_bin_add_many (GST_BIN (self), self->priv->funnel, self->priv->udpsink,
+      self->priv->udpsrc, self->priv->ssrcdemux, NULL);
+  gst_element_link (self->priv->funnel, self->priv->udpsink);
+  gst_element_link_pads (self->priv->udpsrc, "src", self->priv->ssrcdemux,
+      "sink");
+
+  srcpad = gst_element_get_static_pad (self->priv->udpsrc, "src");
+  gst_pad_add_probe (srcpad, GST_PAD_PROBE_TYPE_BUFFER,
+      kms_relay_endpoint_recv_probe, self, NULL);
+  g_object_unref (srcpad);
+
+  kms_relay_endpoint_add_default_stream (self, KMS_ELEMENT_PAD_TYPE_AUDIO);
+  kms_relay_endpoint_add_default_stream (self, KMS_ELEMENT_PAD_TYPE_VIDEO);
+}
+
+gboolean
+kms_relay_endpoint_plugin_init (GstPlugin * plugin)
+{
+  return gst_element_register (plugin, PLUGIN_NAME, GST_RANK_NONE,
+      KMS_TYPE_RELAY_ENDPOINT);
+}
@@ -0,0 +1,74 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef _KMS_RELAY_ENDPOINT_H_
+#define _KMS_RELAY_ENDPOINT_H_
+
+#include <commons/kmselement.h>
+
+G_BEGIN_DECLS
+#define KMS_TYPE_RELAY_ENDPOINT               \
+  (kms_relay_endpoint_get_type())
+#define KMS_RELAY_ENDPOINT(obj)               \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),          \
+  KMS_TYPE_RELAY_ENDPOINT,KmsRelayEndpoint))
+#define KMS_RELAY_ENDPOINT_CLASS(klass)       \
+  (G_TYPE_CHECK_CLASS_CAST((klass),           \
+  KMS_TYPE_RELAY_ENDPOINT,                    \
+  KmsRelayEndpointClass))
+#define KMS_IS_RELAY_ENDPOINT(obj)            \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),          \
+  KMS_TYPE_RELAY_ENDPOINT))
+#define KMS_IS_RELAY_ENDPOINT_CLASS(klass)    \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),           \
+  KMS_TYPE_RELAY_ENDPOINT))
+
+typedef struct _KmsRelayEndpoint KmsRelayEndpoint;
+typedef struct _KmsRelayEndpointClass KmsRelayEndpointClass;
+typedef struct _KmsRelayEndpointPrivate KmsRelayEndpointPrivate;
+
+/*
+ * Carries any number of encoded streams to another relayendpoint over a
+ * single UDP socket. Each stream is identified by its media type and pad
+ * description, and is sent as RTP with an SSRC of its own. The peer learns
+ * which SSRC belongs to which stream from a table sent in-band on the same
+ * socket, so no per-stream negotiation is needed.
+ */
+struct _KmsRelayEndpoint
+{
+  KmsElement parent;
+
+  /*< private > */
+  KmsRelayEndpointPrivate *priv;
+};
+
+struct _KmsRelayEndpointClass
+{
+  KmsElementClass parent_class;
+
+  /* Signals */
+  void (*stream_added_signal) (KmsRelayEndpoint * self,
+      KmsElementPadType type, const gchar * description);
+  void (*stream_removed_signal) (KmsRelayEndpoint * self,
+      KmsElementPadType type, const gchar * description);
+};
+
+GType kms_relay_endpoint_get_type (void);
+
+gboolean kms_relay_endpoint_plugin_init (GstPlugin * plugin);
+
+G_END_DECLS
+#endif /* _KMS_RELAY_ENDPOINT_H_ */
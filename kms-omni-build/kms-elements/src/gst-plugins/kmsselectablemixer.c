@@ -53,10 +53,13 @@ typedef struct _KmsSelectableMixerPortData KmsSelectableMixerPortData;
 struct _KmsSelectableMixerPortData
 {
   KmsSelectableMixer *mixer;
+  /* Only created while more than one audio source is selected */
   GstElement *audiomixer;
   gint id;
   GstElement *audio_agnostic;
   GstElement *video_agnostic;
+  /* Ids of the ports whose audio is sent to this one */
+  GSList *audio_sources;
 };
 
 /* class initialization */
@@ -200,6 +203,135 @@ disconnect_elements (GstElement * agnosticbin, GstElement * audiomixer)
   return disconnected;
 }
 
+static void
+kms_selectable_mixer_remove_audiomixer (KmsSelectableMixer * self,
+    KmsSelectableMixerPortData * port_data)
+{
+  GstElement *audiomixer = port_data->audiomixer;
+
+  if (audiomixer == NULL) {
+    return;
+  }
+
+  GST_DEBUG_OBJECT (self, "Removing audio mixer of port %d", port_data->id);
+
+  port_data->audiomixer = NULL;
+
+  release_sink_pads (audiomixer);
+  gst_element_set_locked_state (audiomixer, TRUE);
+  gst_element_set_state (audiomixer, GST_STATE_NULL);
+  gst_bin_remove (GST_BIN (self), audiomixer);
+  g_object_unref (audiomixer);
+}
+
+/*
+ * Make the audio output of a port match its selection: nothing for no
+ * source, the source's agnosticbin for a single one (no decoding nor
+ * mixing), and an audiomixerbin only when there is something to mix.
+ *
+ * Moving between the last two changes what the port receives from encoded
+ * (the hub port asks the agnosticbin for its consumers' format, see
+ * "shared-audio-encoding") to raw mixed audio and back. The port's own
+ * agnosticbin rebuilds its input bin on such raw/encoded changes.
+ */
+static gboolean
+kms_selectable_mixer_update_audio (KmsSelectableMixer * self,
+    KmsSelectableMixerPortData * port_data)
+{
+  KmsSelectableMixerPortData *source_port;
+  guint n_sources = g_slist_length (port_data->audio_sources);
+  gboolean ret = TRUE;
+  GSList *l;
+
+  if (n_sources == 0) {
+    GST_DEBUG_OBJECT (self, "No audio sources for port %d", port_data->id);
+    kms_base_hub_unlink_audio_src (KMS_BASE_HUB (self), port_data->id);
+    kms_selectable_mixer_remove_audiomixer (self, port_data);
+    return TRUE;
+  }
+
+  if (n_sources == 1) {
+    gint source = GPOINTER_TO_INT (port_data->audio_sources->data);
+
+    source_port = g_hash_table_lookup (self->priv->ports, &source);
+    if (source_port == NULL) {
+      GST_ERROR_OBJECT (self, "No source port %d found", source);
+      return FALSE;
+    }
+
+    GST_DEBUG_OBJECT (self, "Passthrough audio from port %d to port %d",
+        source, port_data->id);
+
+    /* Replaces the mixer as target before it goes away */
+    ret = kms_base_hub_link_audio_src (KMS_BASE_HUB (self), port_data->id,
+        source_port->audio_agnostic, "src_%u", TRUE);
+    kms_selectable_mixer_remove_audiomixer (self, port_data);
+
+    return ret;
+  }
+
+  if (port_data->audiomixer != NULL) {
+    return TRUE;
+  }
+
+  GST_DEBUG_OBJECT (self, "Mixing %u audio sources for port %d", n_sources,
+      port_data->id);
+
+  port_data->audiomixer = gst_element_factory_make ("audiomixerbin", NULL);
+  gst_bin_add (GST_BIN (self), g_object_ref (port_data->audiomixer));
+  gst_element_sync_state_with_parent (port_data->audiomixer);
+
+  for (l = port_data->audio_sources; l != NULL; l = l->next) {
+    gint source = GPOINTER_TO_INT (l->data);
+
+    source_port = g_hash_table_lookup (self->priv->ports, &source);
+    if (source_port == NULL
+        || !gst_element_link (source_port->audio_agnostic,
+            port_data->audiomixer)) {
+      GST_ERROR_OBJECT (self, "Can not mix audio from port %d", source);
+      ret = FALSE;
+    }
+  }
+
+  /* Replaces the passthrough target, releasing its agnosticbin pad */
+  if (!kms_base_hub_link_audio_src (KMS_BASE_HUB (self), port_data->id,
+          port_data->audiomixer, "src", FALSE)) {
+    ret = FALSE;
+  }
+
+  return ret;
+}
+
+static gboolean
+kms_selectable_mixer_remove_audio_source (KmsSelectableMixer * self,
+    KmsSelectableMixerPortData * port_data, gint source)
+{
+  GSList *l = g_slist_find (port_data->audio_sources, GINT_TO_POINTER (source));
+
+  if (l == NULL) {
+    return FALSE;
+  }
+
+  port_data->audio_sources = g_slist_delete_link (port_data->audio_sources, l);
+
+  if (port_data->audiomixer != NULL && port_data->audio_sources != NULL
+      && port_data->audio_sources->next != NULL) {
+    KmsSelectableMixerPortData *source_port;
+
+    /* Still mixing, only this input goes away */
+    source_port = g_hash_table_lookup (self->priv->ports, &source);
+    if (source_port != NULL) {
+      disconnect_elements (source_port->audio_agnostic, port_data->audiomixer);
+    }
+
+    return TRUE;
+  }
+
+  kms_selectable_mixer_update_audio (self, port_data);
+
+  return TRUE;
+}
+
 static void
 kms_selectable_mixer_port_data_destroy (gpointer data)
 {
@@ -208,18 +340,17 @@ kms_selectable_mixer_port_data_destroy (gpointer data)
 
   KMS_SELECTABLE_MIXER_LOCK (self);
 
-  release_sink_pads (port_data->audiomixer);
+  kms_selectable_mixer_remove_audiomixer (self, port_data);
+  g_slist_free (port_data->audio_sources);
 
   gst_bin_remove_many (GST_BIN (self), port_data->audio_agnostic,
-      port_data->video_agnostic, port_data->audiomixer, NULL);
+      port_data->video_agnostic, NULL);
 
-  KMS_SELECTABLE_MIXER_LOCK (self);
+  KMS_SELECTABLE_MIXER_UNLOCK (self);
 
-  gst_element_set_state (port_data->audiomixer, GST_STATE_NULL);
   gst_element_set_state (port_data->audio_agnostic, GST_STATE_NULL);
   gst_element_set_state (port_data->video_agnostic, GST_STATE_NULL);
 
-  g_clear_object (&port_data->audiomixer);
   g_clear_object (&port_data->video_agnostic);
   g_clear_object (&port_data->audio_agnostic);
 
@@ -232,24 +363,20 @@ kms_selectable_mixer_port_data_create (KmsSelectableMixer * self, gint id)
   KmsSelectableMixerPortData *data = g_slice_new0 (KmsSelectableMixerPortData);
 
   data->mixer = self;
-  data->audiomixer = gst_element_factory_make ("audiomixerbin", NULL);
   data->audio_agnostic = gst_element_factory_make ("agnosticbin", NULL);
   data->video_agnostic = gst_element_factory_make ("agnosticbin", NULL);
   data->id = id;
 
   gst_bin_add_many (GST_BIN (self), g_object_ref (data->audio_agnostic),
-      g_object_ref (data->video_agnostic), data->audiomixer, NULL);
+      g_object_ref (data->video_agnostic), NULL);
 
   gst_element_sync_state_with_parent (data->audio_agnostic);
   gst_element_sync_state_with_parent (data->video_agnostic);
-  gst_element_sync_state_with_parent (data->audiomixer);
 
   kms_base_hub_link_video_sink (KMS_BASE_HUB (self), id, data->video_agnostic,
       "sink", FALSE);
   kms_base_hub_link_audio_sink (KMS_BASE_HUB (self), id, data->audio_agnostic,
       "sink", FALSE);
-  kms_base_hub_link_audio_src (KMS_BASE_HUB (self), id, data->audiomixer,
-      "src", FALSE);
 
   return data;
 }
@@ -290,12 +417,24 @@ static void
 kms_selectable_mixer_unhandle_port (KmsBaseHub * hub, gint id)
 {
   KmsSelectableMixer *self = KMS_SELECTABLE_MIXER (hub);
+  GHashTableIter iter;
+  gpointer value;
 
   KMS_SELECTABLE_MIXER_LOCK (self);
 
+  /* Stop sending this port's audio to the others before it disappears */
+  g_hash_table_iter_init (&iter, self->priv->ports);
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    KmsSelectableMixerPortData *port_data = value;
+
+    if (port_data->id != id) {
+      kms_selectable_mixer_remove_audio_source (self, port_data, id);
+    }
+  }
+
   g_hash_table_remove (self->priv->ports, &id);
 
-  KMS_SELECTABLE_MIXER_LOCK (self);
+  KMS_SELECTABLE_MIXER_UNLOCK (self);
 
   KMS_BASE_HUB_CLASS (kms_selectable_mixer_parent_class)->unhandle_port (hub,
       id);
@@ -375,11 +514,44 @@ kms_selectable_mixer_connect_audio (KmsSelectableMixer * self, guint source,
   }
 
   sink_port = g_hash_table_lookup (self->priv->ports, &sink);
-  if (sink_port != NULL) {
+  if (sink_port == NULL) {
+    GST_ERROR_OBJECT (self, "No sink port %u found", source);
+    goto end;
+  }
+
+  if (g_slist_find (sink_port->audio_sources, GINT_TO_POINTER (source))) {
+    GST_DEBUG_OBJECT (self, "Audio from port %u already sent to port %u",
+        source, sink);
+    connected = TRUE;
+    goto end;
+  }
+
+  sink_port->audio_sources =
+      g_slist_append (sink_port->audio_sources, GINT_TO_POINTER (source));
+
+  if (sink_port->audiomixer != NULL) {
+    /* Already mixing, just add one more input */
     connected =
         gst_element_link (source_port->audio_agnostic, sink_port->audiomixer);
-  } else {
-    GST_ERROR_OBJECT (self, "No sink port %u found", source);
+
+    if (!connected) {
+      GST_ERROR_OBJECT (self, "Can not connect audio port");
+      sink_port->audio_sources =
+          g_slist_remove (sink_port->audio_sources, GINT_TO_POINTER (source));
+    }
+
+    goto end;
+  }
+
+  connected = kms_selectable_mixer_update_audio (self, sink_port);
+
+  if (!connected) {
+    GST_ERROR_OBJECT (self, "Can not connect audio port");
+    sink_port->audio_sources =
+        g_slist_remove (sink_port->audio_sources, GINT_TO_POINTER (source));
+
+    /* Back to the previous output, which drops a half built mixer */
+    kms_selectable_mixer_update_audio (self, sink_port);
   }
 
 end:
@@ -406,8 +578,8 @@ kms_selectable_mixer_disconnect_audio (KmsSelectableMixer * self, guint source,
 
   sink_port = g_hash_table_lookup (self->priv->ports, &sink);
   if (sink_port != NULL) {
-    disconnected = disconnect_elements (source_port->audio_agnostic,
-        sink_port->audiomixer);
+    disconnected =
+        kms_selectable_mixer_remove_audio_source (self, sink_port, source);
   } else {
     GST_ERROR_OBJECT (self, "No sink port %u found", source);
   }
@@ -0,0 +1,485 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/gst.h>
+#include <gst/app/gstappsink.h>
+#include <gst/app/gstappsrc.h>
+#include <commons/kmscapturefile.h>
+
+#include "kmscapturemuxer.h"
+#include "kmsavmuxer.h"
+
+#define OBJECT_NAME "capturemuxer"
+
+#define parent_class kms_capture_muxer_parent_class
+
+GST_DEBUG_CATEGORY_STATIC (kms_capture_muxer_debug_category);
+#define GST_CAT_DEFAULT kms_capture_muxer_debug_category
+
+struct _KmsCaptureMuxerPrivate
+{
+  GstElement *videosrc;
+  GstElement *audiosrc;
+  GstElement *outputsrc;
+  GstElement *sink;
+  gboolean sink_signaled;
+
+  /* Serializes records coming from both tracks */
+  GMutex mutex;
+  KmsCaptureWriter *writer;
+  gboolean header_sent;
+  gint64 start_time;
+  guint tracks;
+  guint eos_tracks;
+};
+
+typedef struct _KmsCaptureTrack
+{
+  KmsCaptureMuxer *self;
+  guint id;
+  KmsMediaType type;
+  GstCaps *caps;
+} KmsCaptureTrack;
+
+G_DEFINE_TYPE_WITH_CODE (KmsCaptureMuxer, kms_capture_muxer,
+    KMS_TYPE_BASE_MEDIA_MUXER,
+    G_ADD_PRIVATE (KmsCaptureMuxer)
+    GST_DEBUG_CATEGORY_INIT (kms_capture_muxer_debug_category, OBJECT_NAME,
+        0, "debug category for raw capture muxer"));
+
+static void
+kms_capture_track_destroy (gpointer data)
+{
+  KmsCaptureTrack *track = data;
+
+  gst_caps_replace (&track->caps, NULL);
+  g_slice_free (KmsCaptureTrack, track);
+}
+
+/* Called with the mutex held */
+static GstFlowReturn
+kms_capture_muxer_push (KmsCaptureMuxer * self, GstBuffer * record)
+{
+  if (!self->priv->header_sent) {
+    GstBuffer *header = kms_capture_writer_header (self->priv->writer);
+
+    gst_app_src_push_buffer (GST_APP_SRC (self->priv->outputsrc), header);
+    self->priv->header_sent = TRUE;
+    self->priv->start_time = g_get_monotonic_time ();
+  }
+
+  return gst_app_src_push_buffer (GST_APP_SRC (self->priv->outputsrc), record);
+}
+
+static GstFlowReturn
+kms_capture_muxer_new_sample (GstAppSink * appsink, gpointer user_data)
+{
+  KmsCaptureTrack *track = user_data;
+  KmsCaptureMuxer *self = track->self;
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstSample *sample;
+  GstBuffer *buffer;
+  GstCaps *caps;
+
+  sample = gst_app_sink_pull_sample (appsink);
+  if (sample == NULL) {
+    return GST_FLOW_OK;
+  }
+
+  buffer = gst_sample_get_buffer (sample);
+  caps = gst_sample_get_caps (sample);
+
+  g_mutex_lock (&self->priv->mutex);
+
+  if (caps != NULL && (track->caps == NULL
+          || !gst_caps_is_equal (caps, track->caps))) {
+    GST_DEBUG_OBJECT (self, "Track %u caps: %" GST_PTR_FORMAT, track->id,
+        caps);
+    gst_caps_replace (&track->caps, caps);
+    ret = kms_capture_muxer_push (self,
+        kms_capture_writer_track (self->priv->writer, track->id, track->type,
+            caps));
+  }
+
+  if (buffer != NULL && ret == GST_FLOW_OK) {
+    GstClockTime arrival;
+
+    /* Header goes with the first record, so start_time is set after it */
+    if (!self->priv->header_sent) {
+      arrival = 0;
+    } else {
+      arrival = (g_get_monotonic_time () - self->priv->start_time) * GST_USECOND;
+    }
+
+    ret = kms_capture_muxer_push (self,
+        kms_capture_writer_buffer (self->priv->writer, track->id, buffer,
+            arrival));
+  }
+
+  g_mutex_unlock (&self->priv->mutex);
+
+  gst_sample_unref (sample);
+
+  return ret;
+}
+
+static void
+kms_capture_muxer_eos (GstAppSink * appsink, gpointer user_data)
+{
+  KmsCaptureTrack *track = user_data;
+  KmsCaptureMuxer *self = track->self;
+
+  g_mutex_lock (&self->priv->mutex);
+
+  GST_DEBUG_OBJECT (self, "EOS on track %u", track->id);
+
+  if (++self->priv->eos_tracks == self->priv->tracks) {
+    kms_capture_muxer_push (self,
+        kms_capture_writer_finish (self->priv->writer));
+    gst_app_src_end_of_stream (GST_APP_SRC (self->priv->outputsrc));
+  }
+
+  g_mutex_unlock (&self->priv->mutex);
+}
+
+static GstElement *
+kms_capture_muxer_create_track (KmsCaptureMuxer * self, KmsMediaType type)
+{
+  GstAppSinkCallbacks callbacks = { 0 };
+  GstElement *appsrc, *appsink;
+  KmsCaptureTrack *track;
+
+  track = g_slice_new0 (KmsCaptureTrack);
+  track->self = self;
+  track->id = self->priv->tracks++;
+  track->type = type;
+
+  callbacks.eos = kms_capture_muxer_eos;
+  callbacks.new_sample = kms_capture_muxer_new_sample;
+
+  appsrc = gst_element_factory_make ("appsrc", NULL);
+  g_object_set (appsrc, "block", TRUE, "format", GST_FORMAT_TIME,
+      "max-bytes", 0, NULL);
+
+  appsink = gst_element_factory_make ("appsink", NULL);
+  g_object_set (appsink, "sync", FALSE, "async", FALSE, NULL);
+  gst_app_sink_set_callbacks (GST_APP_SINK (appsink), &callbacks, track,
+      kms_capture_track_destroy);
+
+  gst_bin_add_many (GST_BIN (KMS_BASE_MEDIA_MUXER_GET_PIPELINE (self)), appsrc,
+      appsink, NULL);
+  gst_element_link (appsrc, appsink);
+  gst_element_sync_state_with_parent (appsink);
+  gst_element_sync_state_with_parent (appsrc);
+
+  GST_DEBUG_OBJECT (self, "Track %u created", track->id);
+
+  return appsrc;
+}
+
+static GstElement *
+kms_capture_muxer_add_src (KmsBaseMediaMuxer * obj, KmsMediaType type,
+    const gchar * id)
+{
+  KmsCaptureMuxer *self = KMS_CAPTURE_MUXER (obj);
+  GstElement *sink = NULL, *appsrc = NULL;
+  GstElement **track_src;
+
+  KMS_BASE_MEDIA_MUXER_LOCK (self);
+
+  switch (type) {
+    case KMS_MEDIA_TYPE_AUDIO:
+      track_src = &self->priv->audiosrc;
+      break;
+    case KMS_MEDIA_TYPE_VIDEO:
+      track_src = &self->priv->videosrc;
+      break;
+    default:
+      GST_WARNING_OBJECT (obj, "Unsupported media type %u", type);
+      goto end;
+  }
+
+  /* Tracks are created on demand, so unused ones do not hold back EOS */
+  if (*track_src == NULL) {
+    g_mutex_lock (&self->priv->mutex);
+    *track_src = kms_capture_muxer_create_track (self, type);
+    g_mutex_unlock (&self->priv->mutex);
+  }
+
+  appsrc = *track_src;
+
+  if (!self->priv->sink_signaled) {
+    sink = g_object_ref (self->priv->sink);
+    self->priv->sink_signaled = TRUE;
+  }
+
+end:
+  KMS_BASE_MEDIA_MUXER_UNLOCK (self);
+
+  if (sink != NULL) {
+    KMS_BASE_MEDIA_MUXER_GET_CLASS (self)->emit_on_sink_added
+        (KMS_BASE_MEDIA_MUXER (self), sink);
+    g_object_unref (sink);
+  }
+
+  return appsrc;
+}
+
+static gboolean
+kms_capture_muxer_remove_src (KmsBaseMediaMuxer * obj, const gchar * id)
+{
+  /* Nothing to remove */
+  return FALSE;
+}
+
+static void
+kms_capture_muxer_finalize (GObject * object)
+{
+  KmsCaptureMuxer *self = KMS_CAPTURE_MUXER (object);
+
+  GST_DEBUG_OBJECT (self, "finalize");
+
+  if (self->priv->writer != NULL) {
+    kms_capture_writer_free (self->priv->writer);
+  }
+
+  g_mutex_clear (&self->priv->mutex);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static void
+kms_capture_muxer_class_init (KmsCaptureMuxerClass * klass)
+{
+  KmsBaseMediaMuxerClass *basemediamuxerclass;
+  GObjectClass *objclass;
+
+  objclass = G_OBJECT_CLASS (klass);
+  objclass->finalize = kms_capture_muxer_finalize;
+
+  basemediamuxerclass = KMS_BASE_MEDIA_MUXER_CLASS (klass);
+  basemediamuxerclass->add_src = kms_capture_muxer_add_src;
+  basemediamuxerclass->remove_src = kms_capture_muxer_remove_src;
+}
+
+static void
+kms_capture_muxer_init (KmsCaptureMuxer * self)
+{
+  self->priv = kms_capture_muxer_get_instance_private (self);
+
+  g_mutex_init (&self->priv->mutex);
+}
+
+static void
+kms_capture_muxer_prepare_pipeline (KmsCaptureMuxer * self)
+{
+  self->priv->writer =
+      kms_capture_writer_new (KMS_BASE_MEDIA_MUXER_GET_PROFILE (self));
+
+  self->priv->outputsrc = gst_element_factory_make ("appsrc", "captureSrc");
+  g_object_set (self->priv->outputsrc, "block", TRUE, "format",
+      GST_FORMAT_BYTES, NULL);
+
+  self->priv->sink =
+      KMS_BASE_MEDIA_MUXER_GET_CLASS (self)->create_sink (KMS_BASE_MEDIA_MUXER
+      (self), KMS_BASE_MEDIA_MUXER_GET_URI (self));
+
+  gst_bin_add_many (GST_BIN (KMS_BASE_MEDIA_MUXER_GET_PIPELINE (self)),
+      self->priv->outputsrc, self->priv->sink, NULL);
+
+  if (!gst_element_link (self->priv->outputsrc, self->priv->sink)) {
+    GST_ERROR_OBJECT (self, "Could not link elements: %"
+        GST_PTR_FORMAT ", %" GST_PTR_FORMAT, self->priv->outputsrc,
+        self->priv->sink);
+  }
+}
+
+KmsCaptureMuxer *
+kms_capture_muxer_new (const char *optname1, ...)
+{
+  KmsCaptureMuxer *obj;
+
+  va_list ap;
+
+  va_start (ap, optname1);
+  obj = KMS_CAPTURE_MUXER (g_object_new_valist (KMS_TYPE_CAPTURE_MUXER,
+          optname1, ap));
+  va_end (ap);
+
+  kms_capture_muxer_prepare_pipeline (obj);
+
+  return obj;
+}
+
+typedef struct _KmsCaptureReplay
+{
+  KmsBaseMediaMuxer *mux;
+  /* Track id in the capture -> appsrc */
+  GHashTable *srcs;
+} KmsCaptureReplay;
+
+static GstElement *
+kms_capture_replay_get_src (KmsCaptureReplay * replay, guint track,
+    KmsMediaType type)
+{
+  GstElement *appsrc;
+  gchar *id;
+
+  appsrc = g_hash_table_lookup (replay->srcs, GUINT_TO_POINTER (track));
+  if (appsrc != NULL) {
+    return appsrc;
+  }
+
+  id = g_strdup_printf ("track_%u", track);
+  appsrc = kms_base_media_muxer_add_src (replay->mux, type, id);
+  g_free (id);
+
+  if (appsrc == NULL) {
+    GST_WARNING ("Track %u is not supported by the profile, skipping it",
+        track);
+    return NULL;
+  }
+
+  g_hash_table_insert (replay->srcs, GUINT_TO_POINTER (track), appsrc);
+
+  return appsrc;
+}
+
+static gboolean
+kms_capture_replay_run (KmsCaptureReplay * replay, KmsCaptureReader * reader,
+    GError ** error)
+{
+  GHashTableIter iter;
+  gpointer appsrc;
+
+  for (;;) {
+    KmsCaptureRecord record;
+    GstClockTime arrival;
+    GstBuffer *buffer = NULL;
+    GstCaps *caps = NULL;
+    KmsMediaType type;
+    guint track;
+
+    record = kms_capture_reader_next (reader, &track, &type, &caps, &buffer,
+        &arrival);
+
+    if (record == KMS_CAPTURE_RECORD_END) {
+      break;
+    } else if (record == KMS_CAPTURE_RECORD_ERROR) {
+      /* Data up to here is still valid, close the file with it */
+      GST_WARNING ("Capture is truncated, muxing the readable part");
+      break;
+    } else if (record == KMS_CAPTURE_RECORD_TRACK) {
+      appsrc = kms_capture_replay_get_src (replay, track, type);
+
+      if (appsrc != NULL) {
+        g_object_set (appsrc, "caps", caps, NULL);
+      }
+
+      gst_caps_unref (caps);
+    } else {
+      appsrc = g_hash_table_lookup (replay->srcs, GUINT_TO_POINTER (track));
+
+      if (appsrc == NULL) {
+        gst_buffer_unref (buffer);
+        continue;
+      }
+
+      if (gst_app_src_push_buffer (appsrc, buffer) != GST_FLOW_OK) {
+        g_set_error (error, GST_STREAM_ERROR, GST_STREAM_ERROR_MUX,
+            "Muxer refused data on track %u", track);
+        return FALSE;
+      }
+    }
+  }
+
+  g_hash_table_iter_init (&iter, replay->srcs);
+  while (g_hash_table_iter_next (&iter, NULL, &appsrc)) {
+    gst_app_src_end_of_stream (appsrc);
+  }
+
+  return TRUE;
+}
+
+static gboolean
+kms_capture_replay_wait (KmsCaptureReplay * replay, GError ** error)
+{
+  GstBus *bus = kms_base_media_muxer_get_bus (replay->mux);
+  gboolean ret = TRUE;
+  GstMessage *msg;
+
+  msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+
+  if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR) {
+    gst_message_parse_error (msg, error, NULL);
+    ret = FALSE;
+  }
+
+  gst_message_unref (msg);
+  g_object_unref (bus);
+
+  return ret;
+}
+
+gboolean
+kms_capture_muxer_mux_file (const gchar * capture,
+    KmsRecordingProfile profile, const gchar * uri, GError ** error)
+{
+  KmsCaptureReplay replay;
+  KmsCaptureReader *reader;
+  gboolean ret;
+
+  reader = kms_capture_reader_new (capture, error);
+  if (reader == NULL) {
+    return FALSE;
+  }
+
+  if (profile == KMS_RECORDING_PROFILE_NONE) {
+    profile = kms_capture_reader_get_profile (reader);
+  }
+
+  if (profile == KMS_RECORDING_PROFILE_NONE
+      || profile == KMS_RECORDING_PROFILE_KSR) {
+    g_set_error (error, GST_STREAM_ERROR, GST_STREAM_ERROR_FORMAT,
+        "A container profile is needed to mux this capture");
+    kms_capture_reader_free (reader);
+    return FALSE;
+  }
+
+  replay.mux = KMS_BASE_MEDIA_MUXER (kms_av_muxer_new
+      (KMS_BASE_MEDIA_MUXER_PROFILE, profile, KMS_BASE_MEDIA_MUXER_URI, uri,
+          NULL));
+  replay.srcs = g_hash_table_new (NULL, NULL);
+
+  kms_base_media_muxer_set_state (replay.mux, GST_STATE_PLAYING);
+
+  ret = kms_capture_replay_run (&replay, reader, error)
+      && kms_capture_replay_wait (&replay, error);
+
+  kms_base_media_muxer_set_state (replay.mux, GST_STATE_NULL);
+
+  g_hash_table_unref (replay.srcs);
+  g_object_unref (replay.mux);
+  kms_capture_reader_free (reader);
+
+  return ret;
+}
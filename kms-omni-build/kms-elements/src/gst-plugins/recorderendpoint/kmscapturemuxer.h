@@ -0,0 +1,84 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef _KMS_CAPTURE_MUXER_H_
+#define _KMS_CAPTURE_MUXER_H_
+
+#include <gst/gst.h>
+#include "kmsbasemediamuxer.h"
+
+G_BEGIN_DECLS
+#define KMS_TYPE_CAPTURE_MUXER               \
+  (kms_capture_muxer_get_type())
+#define KMS_CAPTURE_MUXER_CAST(obj)          \
+  ((KmsCaptureMuxer *)(obj))
+#define KMS_CAPTURE_MUXER(obj)               \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),    \
+  KMS_TYPE_CAPTURE_MUXER,KmsCaptureMuxer))
+#define KMS_CAPTURE_MUXER_CLASS(klass)        \
+  (G_TYPE_CHECK_CLASS_CAST((klass),      \
+  KMS_TYPE_CAPTURE_MUXER,                     \
+  KmsCaptureMuxerClass))
+#define KMS_IS_CAPTURE_MUXER(obj)             \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),     \
+  KMS_TYPE_CAPTURE_MUXER))
+#define KMS_IS_CAPTURE_MUXER_CLASS(klass)     \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),      \
+  KMS_TYPE_CAPTURE_MUXER))
+
+typedef struct _KmsCaptureMuxer KmsCaptureMuxer;
+typedef struct _KmsCaptureMuxerClass KmsCaptureMuxerClass;
+typedef struct _KmsCaptureMuxerPrivate KmsCaptureMuxerPrivate;
+
+/*
+ * Writes the encoded frames given to the recorder to a capture file (see
+ * commons/kmscapturefile.h) instead of a container, so that muxing can be
+ * done later with kms_capture_muxer_mux_file() or the kms-capture-mux tool.
+ *
+ * Frames are stored as they reach the muxer, after depayloading, rather than
+ * as RTP/RTCP packets: the recorder is fed elementary streams by the
+ * pipeline and never sees RTP, and the depayloaders are shared with every
+ * other consumer of the endpoint, so they cost nothing extra. What is saved
+ * on the media host is the container muxing.
+ */
+struct _KmsCaptureMuxer
+{
+  KmsBaseMediaMuxer parent;
+
+  /*< private > */
+  KmsCaptureMuxerPrivate *priv;
+};
+
+struct _KmsCaptureMuxerClass
+{
+  KmsBaseMediaMuxerClass parent_class;
+};
+
+GType kms_capture_muxer_get_type ();
+
+KmsCaptureMuxer * kms_capture_muxer_new (const char *optname1, ...);
+
+/*
+ * Muxes @capture into @uri with the same muxer used for live recordings,
+ * blocking until the output is complete. KMS_RECORDING_PROFILE_NONE uses the
+ * profile stored in the capture. A truncated capture is muxed up to its last
+ * complete frame.
+ */
+gboolean kms_capture_muxer_mux_file (const gchar * capture,
+    KmsRecordingProfile profile, const gchar * uri, GError ** error);
+
+G_END_DECLS
+#endif
@@ -76,6 +76,23 @@ kms_ksr_muxer_finalize (GObject * obj)
   G_OBJECT_CLASS (parent_class)->finalize (obj);
 }
 
+/* Tracks can join at any time, so keep in the index who they belong to and
+ * when they started, to allow splitting them out of the container offline */
+static void
+kms_ksr_muxer_tag_track (GstElement * appsrc, const gchar * id)
+{
+  GstDateTime *now = gst_date_time_new_now_utc ();
+  GstTagList *tags;
+
+  tags = gst_tag_list_new (GST_TAG_TITLE, id, GST_TAG_DATE_TIME, now, NULL);
+  gst_tag_list_set_scope (tags, GST_TAG_SCOPE_STREAM);
+  gst_date_time_unref (now);
+
+  if (!gst_element_send_event (appsrc, gst_event_new_tag (tags))) {
+    GST_WARNING_OBJECT (appsrc, "Cannot tag track %s", id);
+  }
+}
+
 static GstElement *
 kms_ksr_muxer_add_src (KmsBaseMediaMuxer * obj, KmsMediaType type,
     const gchar * id)
@@ -112,6 +129,8 @@ kms_ksr_muxer_add_src (KmsBaseMediaMuxer * obj, KmsMediaType type,
   gst_element_link_pads (appsrc, "src", self->priv->mux, padname);
   gst_element_sync_state_with_parent (appsrc);
 
+  kms_ksr_muxer_tag_track (appsrc, id);
+
 end:
   KMS_BASE_MEDIA_MUXER_UNLOCK (self);
 
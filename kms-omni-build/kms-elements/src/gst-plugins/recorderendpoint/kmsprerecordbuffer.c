@@ -0,0 +1,188 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "kmsprerecordbuffer.h"
+
+#define GST_DEFAULT_NAME "kmsprerecordbuffer"
+#define GST_CAT_DEFAULT kms_pre_record_buffer_debug
+GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
+
+#define buffer_is_keyframe(buffer) \
+    (!GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_DELTA_UNIT))
+
+#define buffer_time(buffer) \
+    (GST_BUFFER_DTS_IS_VALID (buffer) ? GST_BUFFER_DTS (buffer) : \
+        GST_BUFFER_PTS (buffer))
+
+struct _KmsPreRecordBuffer
+{
+  GstClockTime duration;
+
+  /* GstBuffer, the head is always a keyframe */
+  GQueue buffers;
+  /* Links of 'buffers' holding a keyframe, oldest first */
+  GQueue keyframes;
+  gsize size;
+
+  GstClockTime last_time;
+};
+
+static void
+kms_pre_record_buffer_reset (KmsPreRecordBuffer * self)
+{
+  g_queue_free_full (&self->buffers, (GDestroyNotify) gst_buffer_unref);
+  g_queue_init (&self->buffers);
+  g_queue_clear (&self->keyframes);
+  self->size = 0;
+  self->last_time = GST_CLOCK_TIME_NONE;
+}
+
+KmsPreRecordBuffer *
+kms_pre_record_buffer_new (GstClockTime duration)
+{
+  KmsPreRecordBuffer *self = g_slice_new0 (KmsPreRecordBuffer);
+
+  g_queue_init (&self->buffers);
+  g_queue_init (&self->keyframes);
+  self->duration = duration;
+  self->last_time = GST_CLOCK_TIME_NONE;
+
+  return self;
+}
+
+void
+kms_pre_record_buffer_free (KmsPreRecordBuffer * self)
+{
+  kms_pre_record_buffer_reset (self);
+  g_slice_free (KmsPreRecordBuffer, self);
+}
+
+void
+kms_pre_record_buffer_set_duration (KmsPreRecordBuffer * self,
+    GstClockTime duration)
+{
+  self->duration = duration;
+}
+
+/* Drops the oldest GOP while the newer ones are enough */
+static void
+kms_pre_record_buffer_trim (KmsPreRecordBuffer * self)
+{
+  while (g_queue_get_length (&self->keyframes) > 1) {
+    GList *next = g_queue_peek_nth (&self->keyframes, 1);
+    GstClockTime next_time = buffer_time (GST_BUFFER (next->data));
+
+    if (self->size <= KMS_PRE_RECORD_BUFFER_MAX_SIZE
+        && (!GST_CLOCK_TIME_IS_VALID (next_time)
+            || self->last_time < next_time + self->duration)) {
+      break;
+    }
+
+    while (self->buffers.head != next) {
+      GstBuffer *buffer = g_queue_pop_head (&self->buffers);
+
+      self->size -= gst_buffer_get_size (buffer);
+      gst_buffer_unref (buffer);
+    }
+
+    g_queue_pop_head (&self->keyframes);
+  }
+
+  if (self->size > KMS_PRE_RECORD_BUFFER_MAX_SIZE) {
+    GST_WARNING ("GOP over %d bytes, dropped until the next keyframe",
+        KMS_PRE_RECORD_BUFFER_MAX_SIZE);
+    kms_pre_record_buffer_reset (self);
+  }
+}
+
+void
+kms_pre_record_buffer_push (KmsPreRecordBuffer * self, GstBuffer * buffer)
+{
+  GstClockTime time = buffer_time (buffer);
+
+  if (GST_CLOCK_TIME_IS_VALID (time)) {
+    self->last_time = time;
+  } else if (!GST_CLOCK_TIME_IS_VALID (self->last_time)) {
+    GST_LOG ("Drop buffer without timestamp %" GST_PTR_FORMAT, buffer);
+    gst_buffer_unref (buffer);
+    return;
+  }
+
+  if (!buffer_is_keyframe (buffer) && g_queue_is_empty (&self->buffers)) {
+    GST_LOG ("Waiting for a keyframe, drop %" GST_PTR_FORMAT, buffer);
+    gst_buffer_unref (buffer);
+    return;
+  }
+
+  g_queue_push_tail (&self->buffers, buffer);
+  self->size += gst_buffer_get_size (buffer);
+
+  if (buffer_is_keyframe (buffer)) {
+    g_queue_push_tail (&self->keyframes, self->buffers.tail);
+  }
+
+  kms_pre_record_buffer_trim (self);
+}
+
+gboolean
+kms_pre_record_buffer_get_start (KmsPreRecordBuffer * self,
+    GstClockTime * pts, GstClockTime * dts)
+{
+  GstBuffer *first = g_queue_peek_head (&self->buffers);
+
+  if (first == NULL) {
+    return FALSE;
+  }
+
+  *pts = GST_BUFFER_PTS (first);
+  *dts = GST_BUFFER_DTS (first);
+
+  return TRUE;
+}
+
+GstBufferList *
+kms_pre_record_buffer_take (KmsPreRecordBuffer * self)
+{
+  GstBufferList *list;
+  GstBuffer *buffer;
+
+  if (g_queue_is_empty (&self->buffers)) {
+    return NULL;
+  }
+
+  list = gst_buffer_list_new_sized (g_queue_get_length (&self->buffers));
+
+  while ((buffer = g_queue_pop_head (&self->buffers)) != NULL) {
+    gst_buffer_list_add (list, buffer);
+  }
+
+  kms_pre_record_buffer_reset (self);
+
+  return list;
+}
+
+static void init_debug (void) __attribute__ ((constructor));
+
+static void
+init_debug (void)
+{
+  GST_DEBUG_CATEGORY_INIT (GST_CAT_DEFAULT, GST_DEFAULT_NAME, 0,
+      GST_DEFAULT_NAME);
+}
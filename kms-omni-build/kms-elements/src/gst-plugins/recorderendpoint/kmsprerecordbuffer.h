@@ -0,0 +1,57 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef __KMS_PRE_RECORD_BUFFER_H__
+#define __KMS_PRE_RECORD_BUFFER_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/* Hard limit, whatever the duration, for streams with very long GOPs */
+#define KMS_PRE_RECORD_BUFFER_MAX_SIZE (64 * 1024 * 1024)
+
+typedef struct _KmsPreRecordBuffer KmsPreRecordBuffer;
+
+/*
+ * Keeps the last encoded frames of a stream, so that they can be written
+ * before the live ones when a recording starts. The kept frames always start
+ * with a keyframe and span at least @duration when the stream is long enough:
+ * whole GOPs are only dropped from the front when the following ones already
+ * cover @duration.
+ *
+ * Buffers are compared by their DTS, or PTS when there is no DTS, so they are
+ * expected to carry running times. Not thread safe.
+ */
+KmsPreRecordBuffer * kms_pre_record_buffer_new (GstClockTime duration);
+void kms_pre_record_buffer_free (KmsPreRecordBuffer * self);
+
+void kms_pre_record_buffer_set_duration (KmsPreRecordBuffer * self,
+    GstClockTime duration);
+
+/* Takes ownership of @buffer */
+void kms_pre_record_buffer_push (KmsPreRecordBuffer * self,
+    GstBuffer * buffer);
+
+/* Timestamps of the first kept frame, FALSE if there is none */
+gboolean kms_pre_record_buffer_get_start (KmsPreRecordBuffer * self,
+    GstClockTime * pts, GstClockTime * dts);
+
+/* Returns the kept frames in order and empties the buffer, NULL if empty */
+GstBufferList * kms_pre_record_buffer_take (KmsPreRecordBuffer * self);
+
+G_END_DECLS
+#endif /* __KMS_PRE_RECORD_BUFFER_H__ */
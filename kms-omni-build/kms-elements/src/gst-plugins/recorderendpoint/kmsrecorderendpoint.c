@@ -40,6 +40,8 @@
 #include "kmsbasemediamuxer.h"
 #include "kmsavmuxer.h"
 #include "kmsksrmuxer.h"
+#include "kmscapturemuxer.h"
+#include "kmsprerecordbuffer.h"
 
 #include "kmsrecordergapsfixmethod.h"
 #include "kms-recorder-enumtypes.h"
@@ -50,6 +52,9 @@
 
 #define DEFAULT_RECORDING_PROFILE KMS_RECORDING_PROFILE_NONE
 #define DEFAULT_GAPS_FIX KMS_RECORDER_GAPS_FIX_NONE
+#define DEFAULT_RAW_CAPTURE FALSE
+#define DEFAULT_PRE_RECORD_TIME 0
+#define MAX_PRE_RECORD_TIME (300 * GST_SECOND)
 
 #define KMS_BASE_TIME_KEY "base-time-key"
 G_DEFINE_QUARK (KMS_BASE_TIME_KEY, base_time_key);
@@ -60,6 +65,9 @@ G_DEFINE_QUARK (KMS_PAD_ID_KEY, kms_pad_id_key);
 #define KMS_APPSRC_ID_KEY "kms-appsrc-id-key"
 G_DEFINE_QUARK (KMS_APPSRC_ID_KEY, kms_appsrc_id_key);
 
+#define KMS_PRE_RECORD_KEY "kms-pre-record-key"
+G_DEFINE_QUARK (KMS_PRE_RECORD_KEY, kms_pre_record_key);
+
 GST_DEBUG_CATEGORY_STATIC (kms_recorder_endpoint_debug_category);
 #define GST_CAT_DEFAULT kms_recorder_endpoint_debug_category
 
@@ -97,6 +105,8 @@ enum
   PROP_DVR,
   PROP_PROFILE,
   PROP_GAPS_FIX,
+  PROP_RAW_CAPTURE,
+  PROP_PRE_RECORD_TIME,
   N_PROPERTIES
 };
 
@@ -139,6 +149,8 @@ struct _KmsRecorderEndpointPrivate
 {
   KmsRecordingProfile profile;
   KmsRecorderGapsFixMethod gaps_fix;
+  gboolean raw_capture;
+  GstClockTime pre_record_time;
   GstClockTime paused_time;
   GstClockTime paused_start;
   gboolean use_dvr;
@@ -271,15 +283,220 @@ release_base_time_type (gpointer data)
   g_slice_free (BaseTimeType, data);
 }
 
+/* Call this function holding the base time lock */
+static BaseTimeType *
+kms_recorder_endpoint_get_base_time (KmsRecorderEndpoint * self)
+{
+  BaseTimeType *base_time;
+
+  // First time this runs, create a new BaseTime storage.
+  base_time = g_object_get_qdata (G_OBJECT (self), base_time_key_quark ());
+  if (base_time == NULL) {
+    base_time = g_slice_new0 (BaseTimeType);
+    base_time->pts = GST_CLOCK_TIME_NONE;
+    base_time->dts = GST_CLOCK_TIME_NONE;
+    base_time->audio_gaps = 0;
+
+    g_object_set_qdata_full (G_OBJECT (self), base_time_key_quark (),
+        base_time, release_base_time_type);
+  }
+
+  return base_time;
+}
+
 // Adjust timestamps to avoid gaps created by paused recordings.
+// Call this function holding the element lock.
+static void
+kms_recorder_endpoint_adjust_buffer (KmsRecorderEndpoint * self,
+    GstBuffer * buffer)
+{
+  BaseTimeType *base_time;
+
+  BASE_TIME_LOCK (self);
+
+  {
+    base_time = kms_recorder_endpoint_get_base_time (self);
+
+    if (!GST_CLOCK_TIME_IS_VALID (base_time->pts)
+        && GST_BUFFER_PTS_IS_VALID (buffer)) {
+      base_time->pts = GST_BUFFER_PTS (buffer);
+      GST_DEBUG_OBJECT (self, "Setting PTS base time to %" GST_TIME_FORMAT,
+          GST_TIME_ARGS (base_time->pts));
+    }
+
+    if (!GST_CLOCK_TIME_IS_VALID (base_time->dts)
+        && GST_BUFFER_DTS_IS_VALID (buffer)) {
+      base_time->dts = GST_BUFFER_DTS (buffer);
+      GST_DEBUG_OBJECT (self, "Setting DTS base time to %" GST_TIME_FORMAT,
+          GST_TIME_ARGS (base_time->dts));
+    }
+  }
+
+  // Adjust PTS/DTS of all buffers, so recordings are always created with an
+  // initial timestamp of 0 (0:00:00.000).
+  {
+    // FIXME: There is some skew introduced each time the recording is paused.
+    // The 'paused_time' doesn't account exactly for all the time, it is missing
+    // some milliseconds. Maybe due to latency in upstream elements?
+
+    GstClockTime common_offset = self->priv->paused_time;
+
+    if (self->priv->gaps_fix == KMS_RECORDER_GAPS_FIX_GENPTS) {
+      // In GenPTS mode, add the total time that has been lost in the form
+      // of gaps, typically caused by packet loss from an RTP source.
+      common_offset += base_time->audio_gaps;
+    }
+
+    if (GST_CLOCK_TIME_IS_VALID (base_time->pts)
+        && GST_BUFFER_PTS_IS_VALID (buffer)) {
+      const GstClockTime offset = common_offset + base_time->pts;
+
+      // PTS -= offset, but preventing underflows.
+      if (GST_BUFFER_PTS (buffer) > offset) {
+        GST_BUFFER_PTS (buffer) -= offset;
+      } else {
+        GST_BUFFER_PTS (buffer) = 0;
+      }
+    }
+
+    if (GST_CLOCK_TIME_IS_VALID (base_time->dts)
+        && GST_BUFFER_DTS_IS_VALID (buffer)) {
+      const GstClockTime offset = common_offset + base_time->dts;
+
+      // DTS -= offset, but preventing underflows.
+      if (GST_BUFFER_DTS (buffer) > offset) {
+        GST_BUFFER_DTS (buffer) -= offset;
+      } else {
+        GST_BUFFER_DTS (buffer) = 0;
+      }
+    }
+  }
+
+  BASE_TIME_UNLOCK (self);
+
+  // Set some flags to make sure the buffer is appropriately handled downstream.
+  GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_LIVE);
+  if (GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_HEADER)) {
+    GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_DISCONT);
+  }
+}
+
+/*
+ * Before the first record (), the last frames are kept when a pre-record time
+ * is set, instead of being dropped. Call this function holding the element
+ * lock.
+ */
+static gboolean
+kms_recorder_endpoint_is_armed (KmsRecorderEndpoint * self)
+{
+  return self->priv->pre_record_time > 0 && !self->priv->stopped &&
+      self->priv->transition == KMS_RECORDER_ENDPOINT_COMPLETED &&
+      kms_uri_endpoint_get_state (KMS_URI_ENDPOINT (self)) ==
+      KMS_URI_ENDPOINT_STATE_STOP;
+}
+
+/* Call this function holding the element lock */
+static void
+kms_recorder_endpoint_pre_record (KmsRecorderEndpoint * self,
+    GstAppSink * appsink, GstBuffer * buffer)
+{
+  KmsPreRecordBuffer *pre;
+
+  pre = g_object_get_qdata (G_OBJECT (appsink), kms_pre_record_key_quark ());
+
+  if (pre == NULL) {
+    pre = kms_pre_record_buffer_new (self->priv->pre_record_time);
+    g_object_set_qdata_full (G_OBJECT (appsink), kms_pre_record_key_quark (),
+        pre, (GDestroyNotify) kms_pre_record_buffer_free);
+  } else {
+    kms_pre_record_buffer_set_duration (pre, self->priv->pre_record_time);
+  }
+
+  kms_pre_record_buffer_push (pre, buffer);
+}
+
+/* Call this function holding the element lock */
+static GstBufferList *
+kms_recorder_endpoint_take_pre_recorded (KmsRecorderEndpoint * self,
+    GstAppSink * appsink)
+{
+  KmsPreRecordBuffer *pre;
+  GstBufferList *list;
+
+  pre = g_object_get_qdata (G_OBJECT (appsink), kms_pre_record_key_quark ());
+
+  if (pre == NULL) {
+    return NULL;
+  }
+
+  list = kms_pre_record_buffer_take (pre);
+  g_object_set_qdata (G_OBJECT (appsink), kms_pre_record_key_quark (), NULL);
+
+  if (list != NULL && self->priv->pre_record_time == 0) {
+    GST_DEBUG_OBJECT (appsink, "Pre-record disabled, discarding frames");
+    gst_buffer_list_unref (list);
+    list = NULL;
+  }
+
+  return list;
+}
+
+/* Frees the kept frames when pre-record is disabled while armed. Call this
+ * function holding the element lock */
+static void
+kms_recorder_endpoint_drop_pre_recorded (KmsRecorderEndpoint * self)
+{
+  GHashTableIter iter;
+  gpointer value;
+
+  g_hash_table_iter_init (&iter, self->priv->sink_pad_data);
+
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    KmsSinkPadData *data = value;
+    GstElement *appsink;
+
+    appsink = gst_pad_get_parent_element (data->sink_target);
+    if (appsink == NULL) {
+      continue;
+    }
+
+    if (g_object_get_qdata (G_OBJECT (appsink),
+            kms_pre_record_key_quark ()) != NULL) {
+      GST_DEBUG_OBJECT (appsink, "Pre-record disabled, discarding frames");
+      g_object_set_qdata (G_OBJECT (appsink), kms_pre_record_key_quark (),
+          NULL);
+    }
+
+    g_object_unref (appsink);
+  }
+}
+
+static GstFlowReturn
+kms_recorder_endpoint_push_buffer (KmsRecorderEndpoint * self,
+    GstAppSrc * appsrc, GstBuffer * buffer)
+{
+  GstFlowReturn ret;
+
+  ret = gst_app_src_push_buffer (appsrc, buffer);
+
+  if (ret != GST_FLOW_OK) {
+    GST_ERROR_OBJECT (self, "Could not send buffer to appsrc %s. Cause: %s",
+        GST_ELEMENT_NAME (appsrc), gst_flow_get_name (ret));
+    ret = GST_FLOW_CUSTOM_SUCCESS;
+  }
+
+  return ret;
+}
+
 static GstFlowReturn
 recv_sample (GstAppSink * appsink, gpointer user_data)
 {
   KmsRecorderEndpoint *self =
       KMS_RECORDER_ENDPOINT (GST_OBJECT_PARENT (appsink));
   KmsUriEndpointState state = KMS_URI_ENDPOINT_STATE_STOP;
-  BaseTimeType *base_time = NULL;
+  GstBufferList *pre_recorded = NULL;
   GstCaps *caps = NULL;
+  gboolean recording;
 
   gboolean unlock_element = FALSE;
   GstSample *sample = NULL;
@@ -317,9 +534,11 @@ recv_sample (GstAppSink * appsink, gpointer user_data)
 
   state = kms_uri_endpoint_get_state (KMS_URI_ENDPOINT (self));
 
-  if (!((state == KMS_URI_ENDPOINT_STATE_START &&
-              self->priv->transition == KMS_RECORDER_ENDPOINT_COMPLETED) ||
-          self->priv->transition == KMS_RECORDER_ENDPOINT_STARTING)) {
+  recording = (state == KMS_URI_ENDPOINT_STATE_START &&
+      self->priv->transition == KMS_RECORDER_ENDPOINT_COMPLETED) ||
+      self->priv->transition == KMS_RECORDER_ENDPOINT_STARTING;
+
+  if (!recording && !kms_recorder_endpoint_is_armed (self)) {
     GST_LOG_OBJECT (appsink,
         "Not recording, drop buffer %" GST_PTR_FORMAT, buffer);
     ret = GST_FLOW_OK;
@@ -344,83 +563,28 @@ recv_sample (GstAppSink * appsink, gpointer user_data)
     }
   }
 
-  BASE_TIME_LOCK (self);
-
-  // First time this runs, create a new BaseTime storage.
-  {
-    base_time = g_object_get_qdata (G_OBJECT (self), base_time_key_quark ());
-    if (base_time == NULL) {
-      base_time = g_slice_new0 (BaseTimeType);
-      base_time->pts = GST_CLOCK_TIME_NONE;
-      base_time->dts = GST_CLOCK_TIME_NONE;
-      base_time->audio_gaps = 0;
-
-      g_object_set_qdata_full (G_OBJECT (self), base_time_key_quark (),
-          base_time, release_base_time_type);
-    }
-
-    if (!GST_CLOCK_TIME_IS_VALID (base_time->pts)
-        && GST_BUFFER_PTS_IS_VALID (buffer)) {
-      base_time->pts = GST_BUFFER_PTS (buffer);
-      GST_DEBUG_OBJECT (self, "Setting PTS base time to %" GST_TIME_FORMAT,
-          GST_TIME_ARGS (base_time->pts));
-    }
-
-    if (!GST_CLOCK_TIME_IS_VALID (base_time->dts)
-        && GST_BUFFER_DTS_IS_VALID (buffer)) {
-      base_time->dts = GST_BUFFER_DTS (buffer);
-      GST_DEBUG_OBJECT (self, "Setting DTS base time to %" GST_TIME_FORMAT,
-          GST_TIME_ARGS (base_time->dts));
-    }
+  if (!recording) {
+    // Armed: keep it in memory until record () is called, with no muxing.
+    kms_recorder_endpoint_pre_record (self, appsink, buffer);
+    ret = GST_FLOW_OK;
+    goto end;
   }
 
-  // Adjust PTS/DTS of all buffers, so recordings are always created with an
-  // initial timestamp of 0 (0:00:00.000).
-  {
-    // FIXME: There is some skew introduced each time the recording is paused.
-    // The 'paused_time' doesn't account exactly for all the time, it is missing
-    // some milliseconds. Maybe due to latency in upstream elements?
-
-    GstClockTime common_offset = self->priv->paused_time;
-
-    if (self->priv->gaps_fix == KMS_RECORDER_GAPS_FIX_GENPTS) {
-      // In GenPTS mode, add the total time that has been lost in the form
-      // of gaps, typically caused by packet loss from an RTP source.
-      common_offset += base_time->audio_gaps;
-    }
-
-    if (GST_CLOCK_TIME_IS_VALID (base_time->pts)
-        && GST_BUFFER_PTS_IS_VALID (buffer)) {
-      const GstClockTime offset = common_offset + base_time->pts;
-
-      // PTS -= offset, but preventing underflows.
-      if (GST_BUFFER_PTS (buffer) > offset) {
-        GST_BUFFER_PTS (buffer) -= offset;
-      } else {
-        GST_BUFFER_PTS (buffer) = 0;
-      }
-    }
+  // The frames kept before record () go first.
+  pre_recorded = kms_recorder_endpoint_take_pre_recorded (self, appsink);
+  if (pre_recorded != NULL) {
+    guint i;
 
-    if (GST_CLOCK_TIME_IS_VALID (base_time->dts)
-        && GST_BUFFER_DTS_IS_VALID (buffer)) {
-      const GstClockTime offset = common_offset + base_time->dts;
+    GST_DEBUG_OBJECT (appsink, "Writing %u pre-recorded frames",
+        gst_buffer_list_length (pre_recorded));
 
-      // DTS -= offset, but preventing underflows.
-      if (GST_BUFFER_DTS (buffer) > offset) {
-        GST_BUFFER_DTS (buffer) -= offset;
-      } else {
-        GST_BUFFER_DTS (buffer) = 0;
-      }
+    for (i = 0; i < gst_buffer_list_length (pre_recorded); i++) {
+      kms_recorder_endpoint_adjust_buffer (self,
+          gst_buffer_list_get (pre_recorded, i));
     }
   }
 
-  BASE_TIME_UNLOCK (self);
-
-  // Set some flags to make sure the buffer is appropriately handled downstream.
-  GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_LIVE);
-  if (GST_BUFFER_FLAG_IS_SET (buffer, GST_BUFFER_FLAG_HEADER)) {
-    GST_BUFFER_FLAG_SET (buffer, GST_BUFFER_FLAG_DISCONT);
-  }
+  kms_recorder_endpoint_adjust_buffer (self, buffer);
 
   KMS_ELEMENT_UNLOCK (self);
   unlock_element = FALSE;
@@ -431,14 +595,20 @@ recv_sample (GstAppSink * appsink, gpointer user_data)
   } else {
     gst_caps_unref (caps);
   }
-  ret = gst_app_src_push_buffer (appsrc, buffer);
 
-  if (ret != GST_FLOW_OK) {
-    GST_ERROR_OBJECT (self, "Could not send buffer to appsrc %s. Cause: %s",
-        GST_ELEMENT_NAME (appsrc), gst_flow_get_name (ret));
-    ret = GST_FLOW_CUSTOM_SUCCESS;
+  if (pre_recorded != NULL) {
+    guint i;
+
+    for (i = 0; i < gst_buffer_list_length (pre_recorded); i++) {
+      kms_recorder_endpoint_push_buffer (self, appsrc,
+          gst_buffer_ref (gst_buffer_list_get (pre_recorded, i)));
+    }
+
+    gst_buffer_list_unref (pre_recorded);
   }
 
+  ret = kms_recorder_endpoint_push_buffer (self, appsrc, buffer);
+
 end:
   if (unlock_element) {
     KMS_ELEMENT_UNLOCK (self);
@@ -762,6 +932,74 @@ kms_recorder_endpoint_remove_pads (KmsRecorderEndpoint * self)
   self->priv->generate_pads = TRUE;
 }
 
+/* Starts receiving media before record (), for the pre-record buffers */
+static void
+kms_recorder_endpoint_arm (KmsRecorderEndpoint * self)
+{
+  if (self->priv->mux == NULL || !kms_recorder_endpoint_is_armed (self)) {
+    return;
+  }
+
+  GST_DEBUG_OBJECT (self, "Keeping the last %" GST_TIME_FORMAT
+      " before recording", GST_TIME_ARGS (self->priv->pre_record_time));
+
+  kms_recorder_generate_pads (self);
+}
+
+/*
+ * Recording starts at the oldest pre-recorded frame of all streams, so that
+ * none of them gets its first timestamps clamped to 0.
+ */
+static void
+kms_recorder_endpoint_set_pre_record_base_time (KmsRecorderEndpoint * self)
+{
+  GstClockTime pts = GST_CLOCK_TIME_NONE, dts = GST_CLOCK_TIME_NONE;
+  BaseTimeType *base_time;
+  GHashTableIter iter;
+  gpointer value;
+
+  g_hash_table_iter_init (&iter, self->priv->sink_pad_data);
+
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    KmsSinkPadData *data = value;
+    KmsPreRecordBuffer *pre;
+    GstElement *appsink;
+    GstClockTime p, d;
+
+    appsink = gst_pad_get_parent_element (data->sink_target);
+    if (appsink == NULL) {
+      continue;
+    }
+
+    pre = g_object_get_qdata (G_OBJECT (appsink), kms_pre_record_key_quark ());
+
+    if (pre != NULL && kms_pre_record_buffer_get_start (pre, &p, &d)) {
+      if (GST_CLOCK_TIME_IS_VALID (p)
+          && (!GST_CLOCK_TIME_IS_VALID (pts) || p < pts)) {
+        pts = p;
+      }
+
+      if (GST_CLOCK_TIME_IS_VALID (d)
+          && (!GST_CLOCK_TIME_IS_VALID (dts) || d < dts)) {
+        dts = d;
+      }
+    }
+
+    g_object_unref (appsink);
+  }
+
+  BASE_TIME_LOCK (self);
+
+  base_time = kms_recorder_endpoint_get_base_time (self);
+  base_time->pts = pts;
+  base_time->dts = dts;
+
+  BASE_TIME_UNLOCK (self);
+
+  GST_DEBUG_OBJECT (self, "Pre-recorded frames start at PTS %" GST_TIME_FORMAT
+      ", DTS %" GST_TIME_FORMAT, GST_TIME_ARGS (pts), GST_TIME_ARGS (dts));
+}
+
 static void
 kms_recorder_endpoint_create_parent_directories (KmsRecorderEndpoint * self)
 {
@@ -885,6 +1123,9 @@ kms_recorder_endpoint_started (KmsUriEndpoint * obj, GError ** error)
   if (was_paused) {
     kms_element_for_each_sink_pad (GST_ELEMENT (self),
         drop_until_key_frame_cb, NULL);
+  } else if (kms_recorder_endpoint_is_armed (self)) {
+    /* Pre-recorded frames start with a keyframe, no need to ask for one */
+    kms_recorder_endpoint_set_pre_record_base_time (self);
   }
 
   kms_recorder_endpoint_change_state (self, KMS_RECORDER_ENDPOINT_STARTING);
@@ -1394,6 +1635,10 @@ kms_recorder_endpoint_create_base_media_muxer (KmsRecorderEndpoint * self)
     mux = KMS_BASE_MEDIA_MUXER (kms_ksr_muxer_new
         (KMS_BASE_MEDIA_MUXER_PROFILE, self->priv->profile,
             KMS_BASE_MEDIA_MUXER_URI, KMS_URI_ENDPOINT (self)->uri, NULL));
+  } else if (self->priv->raw_capture) {
+    mux = KMS_BASE_MEDIA_MUXER (kms_capture_muxer_new
+        (KMS_BASE_MEDIA_MUXER_PROFILE, self->priv->profile,
+            KMS_BASE_MEDIA_MUXER_URI, KMS_URI_ENDPOINT (self)->uri, NULL));
   } else {
     mux = KMS_BASE_MEDIA_MUXER (kms_av_muxer_new
         (KMS_BASE_MEDIA_MUXER_PROFILE, self->priv->profile,
@@ -1448,6 +1693,7 @@ kms_recorder_endpoint_set_property (GObject * object, guint property_id,
 
         if (self->priv->profile != KMS_RECORDING_PROFILE_NONE) {
           kms_recorder_endpoint_new_media_muxer (self);
+          kms_recorder_endpoint_arm (self);
         }
       } else {
         GST_ERROR_OBJECT (self, "Profile can only be configured once");
@@ -1458,6 +1704,21 @@ kms_recorder_endpoint_set_property (GObject * object, guint property_id,
     case PROP_GAPS_FIX:
       self->priv->gaps_fix = g_value_get_enum (value);
       break;
+    case PROP_RAW_CAPTURE:
+      if (self->priv->mux == NULL) {
+        self->priv->raw_capture = g_value_get_boolean (value);
+      } else {
+        GST_ERROR_OBJECT (self, "Raw capture must be set before the profile");
+      }
+      break;
+    case PROP_PRE_RECORD_TIME:
+      self->priv->pre_record_time = g_value_get_uint64 (value);
+      if (self->priv->pre_record_time == 0) {
+        kms_recorder_endpoint_drop_pre_recorded (self);
+      } else {
+        kms_recorder_endpoint_arm (self);
+      }
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -1484,6 +1745,12 @@ kms_recorder_endpoint_get_property (GObject * object, guint property_id,
       g_value_set_enum (value, self->priv->gaps_fix);
       break;
     }
+    case PROP_RAW_CAPTURE:
+      g_value_set_boolean (value, self->priv->raw_capture);
+      break;
+    case PROP_PRE_RECORD_TIME:
+      g_value_set_uint64 (value, self->priv->pre_record_time);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
       break;
@@ -1876,7 +2143,8 @@ kms_recorder_endpoint_request_new_sink_pad (KmsElement * obj,
   kms_recorder_endpoint_add_appsink (self, type, description, name, TRUE);
   state = kms_uri_endpoint_get_state (KMS_URI_ENDPOINT (self));
 
-  if (state != KMS_URI_ENDPOINT_STATE_START) {
+  if (state != KMS_URI_ENDPOINT_STATE_START
+      && !kms_recorder_endpoint_is_armed (self)) {
     goto end;
   }
 
@@ -1984,6 +2252,17 @@ kms_recorder_endpoint_class_init (KmsRecorderEndpointClass * klass)
       "Gaps fix method", "The method used to fix gaps in the stream",
       KMS_TYPE_RECORDER_GAPS_FIX_METHOD, DEFAULT_GAPS_FIX, G_PARAM_READWRITE);
 
+  obj_properties[PROP_RAW_CAPTURE] = g_param_spec_boolean ("raw-capture",
+      "Raw capture",
+      "Store received frames in a capture file to be muxed offline",
+      DEFAULT_RAW_CAPTURE, G_PARAM_READWRITE);
+
+  obj_properties[PROP_PRE_RECORD_TIME] = g_param_spec_uint64 ("pre-record-time",
+      "Pre-record time",
+      "Media kept in memory before recording starts and written first when "
+      "it does, in nanoseconds (0 = disabled)",
+      0, MAX_PRE_RECORD_TIME, DEFAULT_PRE_RECORD_TIME, G_PARAM_READWRITE);
+
   g_object_class_install_properties (gobject_class,
       N_PROPERTIES, obj_properties);
 
@@ -2118,6 +2397,8 @@ kms_recorder_endpoint_init (KmsRecorderEndpoint * self)
 
   self->priv->profile = DEFAULT_RECORDING_PROFILE;
   self->priv->gaps_fix = DEFAULT_GAPS_FIX;
+  self->priv->raw_capture = DEFAULT_RAW_CAPTURE;
+  self->priv->pre_record_time = DEFAULT_PRE_RECORD_TIME;
 
   self->priv->paused_time = G_GUINT64_CONSTANT (0);
   self->priv->paused_start = GST_CLOCK_TIME_NONE;
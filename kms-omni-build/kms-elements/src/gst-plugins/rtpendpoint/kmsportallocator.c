@@ -0,0 +1,300 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "kmsportallocator.h"
+#include "kmssocketutils.h"
+
+#define GST_DEFAULT_NAME "kmsportallocator"
+#define GST_CAT_DEFAULT kms_port_allocator_debug
+GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
+
+/* Pair N holds ports 2N (RTP) and 2N + 1 (RTCP) */
+#define PAIRS_COUNT (G_MAXUINT16 / 2 + 1)
+#define WORD_BITS 64
+#define WORDS_COUNT (PAIRS_COUNT / WORD_BITS)
+
+#define PAIR_BIT(pair) (G_GUINT64_CONSTANT (1) << ((pair) % WORD_BITS))
+
+typedef struct _KmsQuarantinedPair
+{
+  guint pair;
+  gint64 until;
+} KmsQuarantinedPair;
+
+typedef struct _KmsPortAllocator
+{
+  GMutex mutex;
+
+  /* In use by an endpoint */
+  guint64 used[WORDS_COUNT];
+  /* Released recently, or found busy by some other socket owner */
+  guint64 blocked[WORDS_COUNT];
+  /* KmsQuarantinedPair, ordered by release time */
+  GQueue quarantine;
+  gint64 quarantine_us;
+
+  /* Where the next search starts, to spread pairs across the range */
+  guint cursor;
+
+  guint in_use;
+  guint64 acquired;
+  guint64 released;
+  guint64 bind_failures;
+  guint64 exhausted;
+} KmsPortAllocator;
+
+static KmsPortAllocator *
+kms_port_allocator_get (void)
+{
+  static gsize init = 0;
+  static KmsPortAllocator allocator;
+
+  if (g_once_init_enter (&init)) {
+    g_mutex_init (&allocator.mutex);
+    g_queue_init (&allocator.quarantine);
+    allocator.quarantine_us = KMS_PORT_ALLOCATOR_DEFAULT_QUARANTINE;
+    allocator.cursor = g_random_int_range (0, PAIRS_COUNT);
+
+    g_once_init_leave (&init, 1);
+  }
+
+  return &allocator;
+}
+
+static void
+kms_port_allocator_block_pair (KmsPortAllocator * self, guint pair)
+{
+  KmsQuarantinedPair *q;
+
+  q = g_slice_new (KmsQuarantinedPair);
+  q->pair = pair;
+  q->until = g_get_monotonic_time () + self->quarantine_us;
+
+  self->blocked[pair / WORD_BITS] |= PAIR_BIT (pair);
+  g_queue_push_tail (&self->quarantine, q);
+}
+
+static void
+kms_port_allocator_expire_quarantine (KmsPortAllocator * self)
+{
+  gint64 now = g_get_monotonic_time ();
+  KmsQuarantinedPair *q;
+
+  while ((q = g_queue_peek_head (&self->quarantine)) != NULL) {
+    if (q->until > now) {
+      break;
+    }
+
+    g_queue_pop_head (&self->quarantine);
+    self->blocked[q->pair / WORD_BITS] &= ~PAIR_BIT (q->pair);
+    g_slice_free (KmsQuarantinedPair, q);
+  }
+}
+
+/* First free pair in [first, last], or -1 */
+static gint
+kms_port_allocator_scan (KmsPortAllocator * self, guint first, guint last)
+{
+  guint w, first_word = first / WORD_BITS, last_word = last / WORD_BITS;
+
+  for (w = first_word; w <= last_word; w++) {
+    guint64 free_bits = ~(self->used[w] | self->blocked[w]);
+
+    if (w == first_word) {
+      free_bits &= ~(PAIR_BIT (first) - 1);
+    }
+
+    if (w == last_word && (last % WORD_BITS) != WORD_BITS - 1) {
+      free_bits &= (PAIR_BIT (last) << 1) - 1;
+    }
+
+    if (free_bits != 0) {
+      return w * WORD_BITS + __builtin_ctzll (free_bits);
+    }
+  }
+
+  return -1;
+}
+
+static gint
+kms_port_allocator_find_free (KmsPortAllocator * self, guint first, guint last)
+{
+  guint start = self->cursor;
+  gint pair;
+
+  if (start < first || start > last) {
+    start = first;
+  }
+
+  pair = kms_port_allocator_scan (self, start, last);
+
+  if (pair < 0 && start > first) {
+    pair = kms_port_allocator_scan (self, first, start - 1);
+  }
+
+  return pair;
+}
+
+gboolean
+kms_port_allocator_acquire_pair (guint16 min_port, guint16 max_port,
+    GSocketFamily socket_family, GSocket ** rtp, GSocket ** rtcp)
+{
+  KmsPortAllocator *self = kms_port_allocator_get ();
+  guint first, last;
+  gboolean ret = FALSE;
+
+  if (rtp == NULL || rtcp == NULL) {
+    return FALSE;
+  }
+
+  /* Pairs whose both ports fall in the range; port 0 is never used */
+  first = MAX (1, (min_port + 1) / 2);
+  if (max_port < 1) {
+    return FALSE;
+  }
+  last = (max_port - 1) / 2;
+
+  if (first > last) {
+    GST_WARNING ("No port pair fits in range [%u, %u]", min_port, max_port);
+    return FALSE;
+  }
+
+  g_mutex_lock (&self->mutex);
+
+  kms_port_allocator_expire_quarantine (self);
+
+  while (!ret) {
+    GSocket *s1, *s2 = NULL;
+    gint pair;
+
+    pair = kms_port_allocator_find_free (self, first, last);
+
+    if (pair < 0) {
+      GST_WARNING ("No free port pair in range [%u, %u]", min_port, max_port);
+      self->exhausted++;
+      break;
+    }
+
+    self->used[pair / WORD_BITS] |= PAIR_BIT (pair);
+    self->cursor = pair + 1;
+
+    /* Do not hold the lock while binding */
+    g_mutex_unlock (&self->mutex);
+
+    s1 = kms_socket_open (pair * 2, socket_family);
+    if (s1 != NULL) {
+      s2 = kms_socket_open (pair * 2 + 1, socket_family);
+
+      if (s2 == NULL) {
+        /* Not kms_socket_finalize(), the pair is not released to quarantine */
+        g_socket_close (s1, NULL);
+        g_clear_object (&s1);
+      }
+    }
+
+    g_mutex_lock (&self->mutex);
+
+    if (s1 != NULL) {
+      *rtp = s1;
+      *rtcp = s2;
+      self->in_use++;
+      self->acquired++;
+      ret = TRUE;
+
+      GST_DEBUG ("Acquired ports %u-%u", pair * 2, pair * 2 + 1);
+      break;
+    }
+
+    /* Taken by someone outside this allocator, try again later */
+    GST_DEBUG ("Ports %u-%u busy, blocking them", pair * 2, pair * 2 + 1);
+    self->used[pair / WORD_BITS] &= ~PAIR_BIT (pair);
+    kms_port_allocator_block_pair (self, pair);
+    self->bind_failures++;
+  }
+
+  g_mutex_unlock (&self->mutex);
+
+  return ret;
+}
+
+void
+kms_port_allocator_release_port (guint16 port)
+{
+  KmsPortAllocator *self = kms_port_allocator_get ();
+  guint pair = port / 2;
+
+  if (port == 0) {
+    return;
+  }
+
+  g_mutex_lock (&self->mutex);
+
+  /* Both sockets of a pair release it, only the first one counts */
+  if (self->used[pair / WORD_BITS] & PAIR_BIT (pair)) {
+    self->used[pair / WORD_BITS] &= ~PAIR_BIT (pair);
+    kms_port_allocator_block_pair (self, pair);
+    self->in_use--;
+    self->released++;
+
+    GST_DEBUG ("Released ports %u-%u", pair * 2, pair * 2 + 1);
+  }
+
+  g_mutex_unlock (&self->mutex);
+}
+
+void
+kms_port_allocator_set_quarantine (gint64 quarantine_us)
+{
+  KmsPortAllocator *self = kms_port_allocator_get ();
+
+  g_mutex_lock (&self->mutex);
+  self->quarantine_us = MAX (0, quarantine_us);
+  g_mutex_unlock (&self->mutex);
+}
+
+GstStructure *
+kms_port_allocator_get_stats (void)
+{
+  KmsPortAllocator *self = kms_port_allocator_get ();
+  GstStructure *stats;
+
+  g_mutex_lock (&self->mutex);
+
+  kms_port_allocator_expire_quarantine (self);
+
+  stats = gst_structure_new ("port-allocator",
+      "pairs-in-use", G_TYPE_UINT, self->in_use,
+      "pairs-quarantined", G_TYPE_UINT,
+      g_queue_get_length (&self->quarantine),
+      "acquired", G_TYPE_UINT64, self->acquired,
+      "released", G_TYPE_UINT64, self->released,
+      "bind-failures", G_TYPE_UINT64, self->bind_failures,
+      "exhausted", G_TYPE_UINT64, self->exhausted, NULL);
+
+  g_mutex_unlock (&self->mutex);
+
+  return stats;
+}
+
+static void init_debug (void) __attribute__ ((constructor));
+
+static void
+init_debug (void)
+{
+  GST_DEBUG_CATEGORY_INIT (GST_CAT_DEFAULT, GST_DEFAULT_NAME, 0,
+      GST_DEFAULT_NAME);
+}
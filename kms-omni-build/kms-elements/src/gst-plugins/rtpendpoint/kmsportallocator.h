@@ -0,0 +1,46 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __KMS_PORT_ALLOCATOR_H__
+#define __KMS_PORT_ALLOCATOR_H__
+
+#include <gio/gio.h>
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/* Time a released pair is kept out of use, so late packets from the previous
+ * session never reach a new one */
+#define KMS_PORT_ALLOCATOR_DEFAULT_QUARANTINE (5 * G_USEC_PER_SEC)
+
+/*
+ * Process-wide allocator of RTP/RTCP port pairs (even port for RTP, next odd
+ * port for RTCP). Pair state is kept in a bitmap so that finding a free pair
+ * does not require probing the kernel with bind() calls.
+ */
+gboolean kms_port_allocator_acquire_pair (guint16 min_port, guint16 max_port,
+    GSocketFamily socket_family, GSocket ** rtp, GSocket ** rtcp);
+void kms_port_allocator_release_port (guint16 port);
+
+void kms_port_allocator_set_quarantine (gint64 quarantine_us);
+
+/* Returns a new "port-allocator" structure with current usage counters */
+GstStructure *kms_port_allocator_get_stats (void);
+
+G_END_DECLS
+
+#endif /* __KMS_PORT_ALLOCATOR_H__ */
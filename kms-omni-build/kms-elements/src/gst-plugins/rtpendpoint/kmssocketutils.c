@@ -16,6 +16,7 @@
  */
 
 #include "kmssocketutils.h"
+#include "kmsportallocator.h"
 
 void
 kms_socket_finalize (GSocket ** socket)
@@ -24,11 +25,13 @@ kms_socket_finalize (GSocket ** socket)
     return;
   }
 
+  kms_port_allocator_release_port (kms_socket_get_port (*socket));
+
   g_socket_close (*socket, NULL);
   g_clear_object (socket);
 }
 
-static GSocket *
+GSocket *
 kms_socket_open (guint16 port, GSocketFamily family)
 {
   GSocket *socket;
@@ -71,85 +74,10 @@ kms_socket_get_port (GSocket * socket)
   return port;
 }
 
-static inline guint16
-inc_port (guint16 current, guint16 min, guint16 max, guint16 start,
-    gboolean * max_reached, gboolean * all_checked)
-{
-  guint16 next = current + 2;
-
-  if (next > max) {
-    *max_reached = TRUE;
-    next = min;
-  }
-
-  if (*max_reached && (next + 1 >= start)) {
-    *all_checked = TRUE;
-  }
-
-  return next;
-}
-
-static inline gboolean
-in_range (guint16 current, guint16 min, guint16 max)
-{
-  return current >= min && current <= max;
-}
-
 gboolean
 kms_rtp_connection_get_rtp_rtcp_sockets (GSocket ** rtp, GSocket ** rtcp,
     guint16 min_port, guint16 max_port, GSocketFamily socket_family)
 {
-  guint16 port1, port2;
-  guint16 start_port;
-  gboolean all_checked = FALSE, max_reached = FALSE;
-
-  if (rtp == NULL || rtcp == NULL) {
-    return FALSE;
-  }
-
-  start_port = (guint16) g_random_int_range (min_port, max_port + 1);
-
-  for (port1 = start_port; !all_checked;
-       port1 = inc_port (
-           port1, min_port, max_port, start_port, &max_reached, &all_checked)) {
-    GSocket *s1, *s2;
-
-    s1 = kms_socket_open (port1, socket_family);
-
-    if (s1 == NULL) {
-      continue;
-    }
-
-    port1 = kms_socket_get_port (s1);
-
-    if (port1 & 0x01) {
-      port2 = port1 - 1;
-    } else {
-      port2 = port1 + 1;
-    }
-
-    if (!in_range (port2, min_port, max_port)) {
-      kms_socket_finalize (&s1);
-      continue;
-    }
-
-    s2 = kms_socket_open (port2, socket_family);
-
-    if (s2 == NULL) {
-      kms_socket_finalize (&s1);
-      continue;
-    }
-
-    if (port1 < port2) {
-      *rtp = s1;
-      *rtcp = s2;
-    } else {
-      *rtp = s2;
-      *rtcp = s1;
-    }
-
-    return TRUE;
-  }
-
-  return FALSE;
+  return kms_port_allocator_acquire_pair (min_port, max_port, socket_family,
+      rtp, rtcp);
 }
@@ -20,6 +20,7 @@
 
 #include <gio/gio.h>
 
+GSocket * kms_socket_open (guint16 port, GSocketFamily family);
 void kms_socket_finalize (GSocket ** socket);
 guint16 kms_socket_get_port (GSocket * socket);
 gboolean kms_rtp_connection_get_rtp_rtcp_sockets (GSocket ** rtp,
@@ -0,0 +1,241 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "kmsdtlscertificate.h"
+
+#include <string.h>
+#include <openssl/pem.h>
+
+#define GST_DEFAULT_NAME "kmsdtlscertificate"
+#define GST_CAT_DEFAULT kms_dtls_certificate_debug
+GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
+
+struct _KmsDtlsCertificate
+{
+  gint ref_count;
+
+  gchar *pem;
+  gchar *fingerprint;
+  X509 *x509;
+  EVP_PKEY *private_key;
+};
+
+/* PEM text -> KmsDtlsCertificate, entries are removed on their last unref */
+static GHashTable *registry;
+G_LOCK_DEFINE_STATIC (registry);
+
+static gchar *
+kms_dtls_certificate_compute_fingerprint (X509 * x509)
+{
+  guchar digest[EVP_MAX_MD_SIZE];
+  guint digest_length, i;
+  GString *fingerprint;
+
+  if (!X509_digest (x509, EVP_sha256 (), digest, &digest_length)) {
+    return NULL;
+  }
+
+  fingerprint = g_string_sized_new (digest_length * 3);
+  for (i = 0; i < digest_length; i++) {
+    if (i) {
+      g_string_append_c (fingerprint, ':');
+    }
+    g_string_append_printf (fingerprint, "%02X", digest[i]);
+  }
+
+  return g_string_free (fingerprint, FALSE);
+}
+
+static void
+kms_dtls_certificate_free (KmsDtlsCertificate * self)
+{
+  X509_free (self->x509);
+  EVP_PKEY_free (self->private_key);
+  g_free (self->fingerprint);
+  g_free (self->pem);
+
+  g_slice_free (KmsDtlsCertificate, self);
+}
+
+static KmsDtlsCertificate *
+kms_dtls_certificate_new (const gchar * pem)
+{
+  KmsDtlsCertificate *self;
+  BIO *bio;
+
+  bio = BIO_new_mem_buf (pem, -1);
+  if (bio == NULL) {
+    return NULL;
+  }
+
+  self = g_slice_new0 (KmsDtlsCertificate);
+  self->ref_count = 1;
+  self->pem = g_strdup (pem);
+
+  /* Key and certificate may come in any order, each read skips other blocks */
+  self->x509 = PEM_read_bio_X509 (bio, NULL, NULL, NULL);
+  (void) BIO_reset (bio);
+  self->private_key = PEM_read_bio_PrivateKey (bio, NULL, NULL, NULL);
+  BIO_free (bio);
+
+  if (self->x509 != NULL) {
+    self->fingerprint = kms_dtls_certificate_compute_fingerprint (self->x509);
+  }
+
+  if (self->fingerprint == NULL) {
+    GST_ERROR ("Cannot parse DTLS certificate");
+    kms_dtls_certificate_free (self);
+    return NULL;
+  }
+
+  if (self->private_key == NULL) {
+    GST_WARNING ("DTLS certificate %s has no private key", self->fingerprint);
+  }
+
+  return self;
+}
+
+KmsDtlsCertificate *
+kms_dtls_certificate_get (const gchar * pem)
+{
+  KmsDtlsCertificate *self, *other;
+
+  if (pem == NULL) {
+    return NULL;
+  }
+
+  G_LOCK (registry);
+
+  if (registry == NULL) {
+    registry = g_hash_table_new (g_str_hash, g_str_equal);
+  }
+
+  self = g_hash_table_lookup (registry, pem);
+  if (self != NULL) {
+    g_atomic_int_inc (&self->ref_count);
+  }
+
+  G_UNLOCK (registry);
+
+  if (self != NULL) {
+    return self;
+  }
+
+  /* Parse out of the lock, this is the slow path */
+  self = kms_dtls_certificate_new (pem);
+  if (self == NULL) {
+    return NULL;
+  }
+
+  G_LOCK (registry);
+
+  other = g_hash_table_lookup (registry, pem);
+  if (other != NULL) {
+    /* Someone else parsed the same PEM meanwhile */
+    g_atomic_int_inc (&other->ref_count);
+  } else {
+    g_hash_table_insert (registry, self->pem, self);
+    GST_DEBUG ("Cached DTLS certificate %s", self->fingerprint);
+  }
+
+  G_UNLOCK (registry);
+
+  if (other != NULL) {
+    kms_dtls_certificate_free (self);
+    self = other;
+  }
+
+  return self;
+}
+
+KmsDtlsCertificate *
+kms_dtls_certificate_ref (KmsDtlsCertificate * self)
+{
+  g_return_val_if_fail (self != NULL, NULL);
+
+  g_atomic_int_inc (&self->ref_count);
+
+  return self;
+}
+
+void
+kms_dtls_certificate_unref (KmsDtlsCertificate * self)
+{
+  gboolean last;
+
+  g_return_if_fail (self != NULL);
+
+  /* Under the registry lock, so that a lookup cannot revive it */
+  G_LOCK (registry);
+
+  last = g_atomic_int_dec_and_test (&self->ref_count);
+  if (last) {
+    g_hash_table_remove (registry, self->pem);
+  }
+
+  G_UNLOCK (registry);
+
+  if (last) {
+    GST_DEBUG ("Dropped DTLS certificate %s", self->fingerprint);
+    kms_dtls_certificate_free (self);
+  }
+}
+
+const gchar *
+kms_dtls_certificate_get_pem (KmsDtlsCertificate * self)
+{
+  return self->pem;
+}
+
+const gchar *
+kms_dtls_certificate_get_fingerprint (KmsDtlsCertificate * self)
+{
+  return self->fingerprint;
+}
+
+X509 *
+kms_dtls_certificate_get_x509 (KmsDtlsCertificate * self)
+{
+  return self->x509;
+}
+
+EVP_PKEY *
+kms_dtls_certificate_get_private_key (KmsDtlsCertificate * self)
+{
+  return self->private_key;
+}
+
+guint
+kms_dtls_certificate_get_cached_count (void)
+{
+  guint count;
+
+  G_LOCK (registry);
+  count = registry != NULL ? g_hash_table_size (registry) : 0;
+  G_UNLOCK (registry);
+
+  return count;
+}
+
+static void init_debug (void) __attribute__ ((constructor));
+
+static void
+init_debug (void)
+{
+  GST_DEBUG_CATEGORY_INIT (GST_CAT_DEFAULT, GST_DEFAULT_NAME, 0,
+      GST_DEFAULT_NAME);
+}
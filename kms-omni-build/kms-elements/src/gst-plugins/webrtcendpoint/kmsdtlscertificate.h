@@ -0,0 +1,55 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __KMS_DTLS_CERTIFICATE_H__
+#define __KMS_DTLS_CERTIFICATE_H__
+
+#include <gst/gst.h>
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+
+G_BEGIN_DECLS
+
+typedef struct _KmsDtlsCertificate KmsDtlsCertificate;
+
+/*
+ * Process-wide registry of DTLS certificates. Every distinct PEM is parsed
+ * and fingerprinted once, and the result is shared by all the endpoints and
+ * connections that use it for as long as any of them holds a reference.
+ *
+ * Returns a new reference, or NULL if the PEM has no valid certificate.
+ */
+KmsDtlsCertificate * kms_dtls_certificate_get (const gchar * pem);
+
+KmsDtlsCertificate * kms_dtls_certificate_ref (KmsDtlsCertificate * self);
+void kms_dtls_certificate_unref (KmsDtlsCertificate * self);
+
+const gchar * kms_dtls_certificate_get_pem (KmsDtlsCertificate * self);
+
+/* SHA-256 of the DER certificate, as "XX:XX:...", ready for SDP */
+const gchar * kms_dtls_certificate_get_fingerprint (KmsDtlsCertificate * self);
+
+/* Owned by the certificate, NULL if the PEM carries no private key */
+X509 * kms_dtls_certificate_get_x509 (KmsDtlsCertificate * self);
+EVP_PKEY * kms_dtls_certificate_get_private_key (KmsDtlsCertificate * self);
+
+/* Number of distinct certificates currently in the registry */
+guint kms_dtls_certificate_get_cached_count (void);
+
+G_END_DECLS
+
+#endif /* __KMS_DTLS_CERTIFICATE_H__ */
@@ -978,28 +978,51 @@ kms_webrtc_session_set_ice_candidates (KmsWebrtcSession * self,
   return TRUE;
 }
 
+static KmsDtlsCertificate *
+kms_webrtc_session_get_certificate (KmsWebrtcSession * self,
+    KmsSdpMediaHandler * handler)
+{
+  KmsDtlsCertificate *certificate = NULL;
+
+  KMS_SDP_SESSION_LOCK (self);
+
+  if (self->certificate == NULL) {
+    /* No certificate configured, DTLS elements generated their own one */
+    KmsWebRtcBaseConnection *conn =
+        kms_webrtc_session_get_connection (self, handler);
+    gchar *pem = kms_webrtc_base_connection_get_certificate_pem (conn);
+
+    self->certificate = kms_dtls_certificate_get (pem);
+    g_free (pem);
+  }
+
+  if (self->certificate != NULL) {
+    certificate = kms_dtls_certificate_ref (self->certificate);
+  }
+
+  KMS_SDP_SESSION_UNLOCK (self);
+
+  return certificate;
+}
+
 static gchar *
 kms_webrtc_session_generate_fingerprint_sdp_attr (KmsWebrtcSession * self,
     KmsSdpMediaHandler * handler)
 {
-  gchar *fp, *ret;
-
-  KmsWebRtcBaseConnection *conn =
-      kms_webrtc_session_get_connection (self, handler);
-  gchar *pem = kms_webrtc_base_connection_get_certificate_pem (conn);
+  KmsDtlsCertificate *certificate;
+  gchar *ret;
 
-  fp = kms_utils_generate_fingerprint_from_pem (pem);
-  g_free (pem);
+  certificate = kms_webrtc_session_get_certificate (self, handler);
 
-  if (fp == NULL) {
+  if (certificate == NULL) {
     GST_ELEMENT_ERROR (self, RESOURCE, FAILED,
         (("Fingerprint not generated.")), (NULL));
     return NULL;
   }
 
-  /* TODO: store fingerprint to reuse it for each media */
-  ret = g_strconcat ("sha-256 ", fp, NULL);
-  g_free (fp);
+  ret = g_strconcat ("sha-256 ",
+      kms_dtls_certificate_get_fingerprint (certificate), NULL);
+  kms_dtls_certificate_unref (certificate);
 
   return ret;
 }
@@ -1765,6 +1788,8 @@ kms_webrtc_session_set_property (GObject * object, guint prop_id,
     case PROP_PEM_CERTIFICATE:
       g_free (self->pem_certificate);
       self->pem_certificate = g_value_dup_string (value);
+      g_clear_pointer (&self->certificate, kms_dtls_certificate_unref);
+      self->certificate = kms_dtls_certificate_get (self->pem_certificate);
       break;
     case PROP_NETWORK_INTERFACES:
       g_free (self->network_interfaces);
@@ -1857,6 +1882,7 @@ kms_webrtc_session_finalize (GObject * object)
   g_free (self->turn_password);
   g_free (self->turn_address);
   g_free (self->pem_certificate);
+  g_clear_pointer (&self->certificate, kms_dtls_certificate_unref);
   g_free (self->network_interfaces);
   g_free (self->external_address);
   g_free (self->external_ipv4);
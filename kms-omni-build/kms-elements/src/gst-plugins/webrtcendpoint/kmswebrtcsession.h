@@ -23,6 +23,7 @@
 #include "kmsicecandidate.h"
 #include "kmsicebaseagent.h"
 #include "kmswebrtcconnection.h"
+#include "kmsdtlscertificate.h"
 
 G_BEGIN_DECLS
 
@@ -70,6 +71,8 @@ struct _KmsWebrtcSession
   guint turn_port;
   TurnProtocol turn_transport;
   gchar *pem_certificate;
+  /* Parsed once for every session using the same PEM */
+  KmsDtlsCertificate *certificate;
   gchar *network_interfaces;
   gchar *external_address;
   gchar *external_ipv4;
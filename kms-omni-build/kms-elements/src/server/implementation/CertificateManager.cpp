@@ -17,6 +17,7 @@
 
 #include "CertificateManager.hpp"
 #include <gst/gst.h>
+#include <webrtcendpoint/kmsdtlscertificate.h>
 #include <openssl/bn.h>
 #include <openssl/err.h>
 #include <openssl/rsa.h>
@@ -306,38 +307,31 @@ CertificateManager::generateECDSACertificate ()
 bool
 CertificateManager::isCertificateValid (std::string certificate)
 {
-  std::shared_ptr <BIO> bio;
-  std::shared_ptr <X509> x509;
-  std::shared_ptr <EVP_PKEY> private_key;
+  std::shared_ptr <KmsDtlsCertificate> parsed = getCertificate (certificate);
 
-  bio = std::shared_ptr<BIO>
-        (BIO_new_mem_buf ( (gpointer) certificate.c_str (), -1),
-  [] (BIO * obj) {
-    BIO_free_all (obj);
-  });
-
-  if (!bio) {
-    return false;
-  }
+  return parsed
+         && kms_dtls_certificate_get_private_key (parsed.get () ) != nullptr;
+}
 
-  x509 = std::shared_ptr<X509>(
-      PEM_read_bio_X509(bio.get(), nullptr, nullptr, nullptr),
-      [](X509 *obj) { X509_free(obj); });
+std::shared_ptr<KmsDtlsCertificate>
+CertificateManager::getCertificate (const std::string &certificate)
+{
+  KmsDtlsCertificate *parsed;
 
-  if (!x509) {
-    return false;
+  if (certificate.empty () ) {
+    return nullptr;
   }
 
-  (void) BIO_reset (bio.get() );
-  private_key = std::shared_ptr<EVP_PKEY>(
-      PEM_read_bio_PrivateKey(bio.get(), nullptr, nullptr, nullptr),
-      [](EVP_PKEY *obj) { EVP_PKEY_free(obj); });
+  parsed = kms_dtls_certificate_get (certificate.c_str () );
 
-  if (!private_key) {
-    return false;
+  if (parsed == nullptr) {
+    return nullptr;
   }
 
-  return true;
+  return std::shared_ptr<KmsDtlsCertificate> (parsed,
+  [] (KmsDtlsCertificate * obj) {
+    kms_dtls_certificate_unref (obj);
+  });
 }
 
 CertificateManager::StaticConstructor CertificateManager::staticConstructor;
@@ -19,8 +19,11 @@
 #ifndef __CERTIFICATE_MANAGER_HPP__
 #define __CERTIFICATE_MANAGER_HPP__
 
+#include <memory>
 #include <string>
 
+typedef struct _KmsDtlsCertificate KmsDtlsCertificate;
+
 namespace kurento
 {
 class CertificateManager
@@ -30,6 +33,10 @@ public:
   static std::string generateECDSACertificate ();
   static bool isCertificateValid (std::string certificate);
 
+  /* Parsed certificate shared through the process-wide DTLS registry */
+  static std::shared_ptr<KmsDtlsCertificate> getCertificate (
+    const std::string &certificate);
+
 private:
   class StaticConstructor
   {
@@ -35,6 +35,7 @@ GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
 #define POSITION "position"
 #define PIPELINE "pipeline"
 #define SET_POSITION "set-position"
+#define PLAYLIST "playlist"
 #define NS_TO_MS 1000000
 #define RTSP_CLIENT_PORT_RANGE "rtspClientPortRange"
 
@@ -76,6 +77,19 @@ void PlayerEndpointImpl::invalidMedia ()
   }
 }
 
+void PlayerEndpointImpl::itemStarted (gchar *uri)
+{
+  try {
+    PlaylistItemStarted event (shared_from_this (),
+                               PlaylistItemStarted::getName (), uri);
+    sigcSignalEmit(signalPlaylistItemStarted, event);
+  } catch (const std::bad_weak_ptr &e) {
+    // shared_from_this()
+    GST_ERROR ("BUG creating %s: %s", PlaylistItemStarted::getName ().c_str (),
+        e.what ());
+  }
+}
+
 void PlayerEndpointImpl::postConstructor()
 {
   UriEndpointImpl::postConstructor ();
@@ -98,6 +112,14 @@ void PlayerEndpointImpl::postConstructor()
                        (std::bind (&PlayerEndpointImpl::invalidMedia, this) ),
                        std::dynamic_pointer_cast<PlayerEndpointImpl>
                        (shared_from_this() ) );
+
+  signalItemStarted = register_signal_handler (G_OBJECT (element),
+                      "item-started",
+                      std::function <void (GstElement *, gchar *) >
+                      (std::bind (&PlayerEndpointImpl::itemStarted, this,
+                                  std::placeholders::_2) ),
+                      std::dynamic_pointer_cast<PlayerEndpointImpl>
+                      (shared_from_this() ) );
 }
 
 
@@ -133,6 +155,10 @@ PlayerEndpointImpl::~PlayerEndpointImpl()
     unregister_signal_handler (element, signalInvalidURI);
   }
 
+  if (signalItemStarted > 0 ) {
+    unregister_signal_handler (element, signalItemStarted);
+  }
+
   stop();
 }
 
@@ -190,6 +216,35 @@ void PlayerEndpointImpl::setPosition (int64_t position)
   }
 }
 
+std::vector<std::string> PlayerEndpointImpl::getPlaylist ()
+{
+  std::vector<std::string> playlist;
+  gchar **uris = nullptr;
+
+  g_object_get (G_OBJECT (element), PLAYLIST, &uris, NULL);
+
+  for (guint i = 0; uris != nullptr && uris[i] != nullptr; i++) {
+    playlist.push_back (uris[i]);
+  }
+
+  g_strfreev (uris);
+
+  return playlist;
+}
+
+void PlayerEndpointImpl::setPlaylist (const std::vector<std::string> &playlist)
+{
+  std::vector<const gchar *> uris;
+
+  for (const std::string &uri : playlist) {
+    uris.push_back (uri.c_str () );
+  }
+
+  uris.push_back (nullptr);
+
+  g_object_set (G_OBJECT (element), PLAYLIST, uris.data (), NULL);
+}
+
 void PlayerEndpointImpl::play ()
 {
   start();
@@ -52,12 +52,16 @@ public:
 
   virtual std::string getElementGstreamerDot() override;
 
+  virtual std::vector<std::string> getPlaylist () override;
+  virtual void setPlaylist (const std::vector<std::string> &playlist) override;
+
   /* Next methods are automatically implemented by code generator */
   using UriEndpointImpl::connect;
   virtual bool connect (const std::string &eventType,
                         std::shared_ptr<EventHandler> handler) override;
 
   sigc::signal<void, EndOfStream> signalEndOfStream;
+  sigc::signal<void, PlaylistItemStarted> signalPlaylistItemStarted;
 
   virtual void invoke (std::shared_ptr<MediaObjectImpl> obj,
                        const std::string &methodName, const Json::Value &params,
@@ -73,10 +77,12 @@ private:
   gulong signalEOS = 0;
   gulong signalInvalidURI = 0;
   gulong signalInvalidMedia = 0;
+  gulong signalItemStarted = 0;
 
   void eosHandler ();
   void invalidUri ();
   void invalidMedia ();
+  void itemStarted (gchar *uri);
 
   class StaticConstructor
   {
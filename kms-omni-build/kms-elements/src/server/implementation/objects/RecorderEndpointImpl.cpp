@@ -32,7 +32,12 @@
 #include <commons/kmsstats.h>
 
 #include <SignalHandler.hpp>
+#include <DeferredResponse.hpp>
+#include <HubImpl.hpp>
+#include <HubPortImpl.hpp>
+#include <commons/kmshubport.h>
 #include <functional>
+#include <algorithm>
 
 #define GST_CAT_DEFAULT kurento_recorder_endpoint_impl
 GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
@@ -43,8 +48,17 @@ GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
 #define PARAM_GAPS_FIX "gapsFix"
 #define PROP_GAPS_FIX "gaps-fix"
 
+#define PARAM_RAW_CAPTURE "rawCapture"
+#define PROP_RAW_CAPTURE "raw-capture"
+
+#define PROP_PRE_RECORD_TIME "pre-record-time"
+#define MAX_PRE_RECORD_TIME 300000 /* ms */
+
 #define TIMEOUT 4 /* seconds */
 
+#define KMS_DEFAULT_MEDIA_DESCRIPTION "default"
+#define HUB_TRACK_PREFIX "hubport"
+
 namespace kurento
 {
 
@@ -81,6 +95,14 @@ RecorderEndpointImpl::RecorderEndpointImpl (const boost::property_tree::ptree
   g_object_set (G_OBJECT (getGstreamerElement() ), "accept-eos",
                 stopOnEndOfStream, NULL);
 
+  // The muxer is built when the profile is set, so this goes first
+  bool rawCapture;
+  if (getConfigValue<bool, RecorderEndpoint> (&rawCapture,
+      PARAM_RAW_CAPTURE) && rawCapture) {
+    GST_INFO ("Set RecorderEndpoint raw capture mode");
+    g_object_set (getGstreamerElement (), PROP_RAW_CAPTURE, TRUE, NULL);
+  }
+
   switch (mediaProfile->getValue() ) {
   case MediaProfileSpecType::WEBM:
     g_object_set ( G_OBJECT (element), "profile", KMS_RECORDING_PROFILE_WEBM, NULL);
@@ -147,6 +169,7 @@ RecorderEndpointImpl::RecorderEndpointImpl (const boost::property_tree::ptree
 
     g_object_set ( G_OBJECT (element), "profile", KMS_RECORDING_PROFILE_KSR, NULL);
     GST_INFO ("Set KSR profile");
+    ksr = true;
     break;
     
   case MediaProfileSpecType::FLV:
@@ -222,12 +245,23 @@ RecorderEndpointImpl::onStateChanged (gint newState)
   }
   }
 
+  std::vector<std::shared_ptr<DeferredResponse>> waiters;
   std::unique_lock<std::mutex> lck (mtx);
 
   GST_TRACE_OBJECT (element, "State changed to %d", newState);
 
   state = newState;
   cv.notify_one();
+
+  if (newState == KMS_URI_END_POINT_STATE_STOP) {
+    waiters.swap (stopWaiters);
+  }
+
+  lck.unlock ();
+
+  for (auto &waiter : waiters) {
+    waiter->complete ();
+  }
 }
 
 void RecorderEndpointImpl::waitForStateChange (gint expectedState)
@@ -251,12 +285,180 @@ RecorderEndpointImpl::release ()
     goto end;
   }
 
-  stopAndWait();
+  stop();
+  waitForStateChange (KMS_URI_END_POINT_STATE_STOP);
 
 end:
+  std::unique_lock<std::mutex> lck (hubMutex);
+
+  for (auto &conn : hubConnections) {
+    conn.disconnect ();
+  }
+
+  hubConnections.clear ();
+  lck.unlock ();
+
   UriEndpointImpl::release();
 }
 
+void
+RecorderEndpointImpl::prepareSinkConnection (std::shared_ptr<MediaElement>
+    src, std::shared_ptr<MediaType> mediaType,
+    const std::string &sourceMediaDescription,
+    const std::string &sinkMediaDescription)
+{
+  KmsElementPadType type;
+  std::string padName;
+  GstPad *pad;
+  gchar *name = nullptr;
+
+  /* KSR tracks other than the default ones are requested on demand */
+  if (!ksr || sinkMediaDescription.empty ()
+      || sinkMediaDescription == KMS_DEFAULT_MEDIA_DESCRIPTION) {
+    return;
+  }
+
+  switch (mediaType->getValue () ) {
+  case MediaType::AUDIO:
+    type = KMS_ELEMENT_PAD_TYPE_AUDIO;
+    padName = "sink_audio_" + sinkMediaDescription;
+    break;
+
+  case MediaType::VIDEO:
+    type = KMS_ELEMENT_PAD_TYPE_VIDEO;
+    padName = "sink_video_" + sinkMediaDescription;
+    break;
+
+  default:
+    return;
+  }
+
+  pad = gst_element_get_static_pad (element, padName.c_str () );
+
+  if (pad != nullptr) {
+    g_object_unref (pad);
+    return;
+  }
+
+  g_signal_emit_by_name (element, "request-new-pad", type,
+                         sinkMediaDescription.c_str (), GST_PAD_SINK, &name, NULL);
+
+  if (name == nullptr) {
+    throw KurentoException (CONNECT_ERROR, "Recorder '" + getName () +
+                            "' cannot add a track for " +
+                            mediaType->getString () + "-" +
+                            sinkMediaDescription);
+  }
+
+  GST_DEBUG_OBJECT (element, "Added track %s", name);
+  g_free (name);
+}
+
+void
+RecorderEndpointImpl::recordHubPort (std::shared_ptr<HubPortImpl> port)
+{
+  std::shared_ptr<MediaElement> self =
+    std::dynamic_pointer_cast<MediaElement> (shared_from_this () );
+  std::string desc = HUB_TRACK_PREFIX +
+                     std::to_string (port->getHandlerId () );
+  std::weak_ptr<RecorderEndpointImpl> wself =
+    std::dynamic_pointer_cast<RecorderEndpointImpl> (shared_from_this () );
+
+  if (!getSourceConnections (std::make_shared<MediaType> (MediaType::VIDEO),
+                             desc).empty () ) {
+    /* Already recorded */
+    return;
+  }
+
+  std::unique_lock<std::mutex> lck (hubMutex);
+  hubConnections.push_back (port->signalElementDisconnected.connect ([wself] (
+  ElementDisconnected event) {
+    std::shared_ptr<RecorderEndpointImpl> recorder = wself.lock ();
+
+    if (recorder) {
+      recorder->onHubPortDisconnected (event);
+    }
+  }) );
+  lck.unlock ();
+
+  GST_INFO_OBJECT (element, "Recording %s as track %s",
+                   port->getName ().c_str (), desc.c_str () );
+
+  port->connect (self, std::make_shared<MediaType> (MediaType::AUDIO),
+                 HUB_INPUT_DESCRIPTION, desc);
+  port->connect (self, std::make_shared<MediaType> (MediaType::VIDEO),
+                 HUB_INPUT_DESCRIPTION, desc);
+}
+
+void
+RecorderEndpointImpl::onHubPortDisconnected (ElementDisconnected event)
+{
+  std::string padName;
+  GstPad *pad;
+  gboolean ret;
+
+  if (event.getSink () != std::dynamic_pointer_cast<MediaElement>
+      (shared_from_this () ) ) {
+    return;
+  }
+
+  switch (event.getMediaType ()->getValue () ) {
+  case MediaType::AUDIO:
+    padName = "sink_audio_" + event.getSinkMediaDescription ();
+    break;
+
+  case MediaType::VIDEO:
+    padName = "sink_video_" + event.getSinkMediaDescription ();
+    break;
+
+  default:
+    return;
+  }
+
+  pad = gst_element_get_static_pad (element, padName.c_str () );
+
+  if (pad == nullptr) {
+    return;
+  }
+
+  GST_DEBUG_OBJECT (element, "Closing track %" GST_PTR_FORMAT, pad);
+  g_signal_emit_by_name (element, "release-requested-pad", pad, &ret, NULL);
+  g_object_unref (pad);
+}
+
+void RecorderEndpointImpl::recordHub (std::shared_ptr<Hub> hub)
+{
+  std::shared_ptr<HubImpl> hubImpl = std::dynamic_pointer_cast<HubImpl> (hub);
+  std::weak_ptr<RecorderEndpointImpl> wself =
+    std::dynamic_pointer_cast<RecorderEndpointImpl> (shared_from_this () );
+
+  if (!ksr) {
+    throw KurentoException (MEDIA_OBJECT_ILLEGAL_PARAM_ERROR,
+                            "Recording a hub requires the "
+                            "KURENTO_SPLIT_RECORDER profile");
+  }
+
+  if (hubImpl->getMediaPipeline ()->getId () != getMediaPipeline ()->getId () ) {
+    throw KurentoException (CONNECT_ERROR,
+                            "Recorder and hub do not share pipeline");
+  }
+
+  std::unique_lock<std::mutex> lck (hubMutex);
+  hubConnections.push_back (hubImpl->signalPortAdded.connect ([wself] (
+  std::shared_ptr<HubPortImpl> port) {
+    std::shared_ptr<RecorderEndpointImpl> recorder = wself.lock ();
+
+    if (recorder) {
+      recorder->recordHubPort (port);
+    }
+  }) );
+  lck.unlock ();
+
+  for (auto port : hubImpl->getPorts () ) {
+    recordHubPort (port);
+  }
+}
+
 RecorderEndpointImpl::~RecorderEndpointImpl()
 {
   gint state = -1;
@@ -277,10 +479,86 @@ void RecorderEndpointImpl::record ()
   start();
 }
 
+int RecorderEndpointImpl::getPreRecordTime ()
+{
+  guint64 time;
+
+  g_object_get (getGstreamerElement (), PROP_PRE_RECORD_TIME, &time, NULL);
+
+  return time / GST_MSECOND;
+}
+
+void RecorderEndpointImpl::setPreRecordTime (int preRecordTime)
+{
+  if (preRecordTime < 0 || preRecordTime > MAX_PRE_RECORD_TIME) {
+    throw KurentoException (MEDIA_OBJECT_ILLEGAL_PARAM_ERROR,
+                            "preRecordTime must be between 0 and "
+                            + std::to_string (MAX_PRE_RECORD_TIME) );
+  }
+
+  g_object_set (getGstreamerElement (), PROP_PRE_RECORD_TIME,
+                (guint64) preRecordTime * GST_MSECOND, NULL);
+}
+
 void RecorderEndpointImpl::stopAndWait ()
 {
+  std::shared_ptr<DeferredResponse> deferred = DeferredResponse::defer ();
+
+  if (!deferred) {
+    stop();
+    waitForStateChange (KMS_URI_END_POINT_STATE_STOP);
+    return;
+  }
+
+  // Answer when the recorder reports STOP, instead of parking this thread
+  std::unique_lock<std::mutex> lck (mtx);
+  stopWaiters.push_back (deferred);
+  lck.unlock ();
+
   stop();
-  waitForStateChange (KMS_URI_END_POINT_STATE_STOP);
+
+  lck.lock ();
+
+  if (state == KMS_URI_END_POINT_STATE_STOP) {
+    std::vector<std::shared_ptr<DeferredResponse>> waiters;
+
+    waiters.swap (stopWaiters);
+    lck.unlock ();
+
+    for (auto &waiter : waiters) {
+      waiter->complete ();
+    }
+
+    return;
+  }
+
+  lck.unlock ();
+
+  std::string name = getName ();
+  std::weak_ptr<RecorderEndpointImpl> wself =
+    std::dynamic_pointer_cast<RecorderEndpointImpl> (shared_from_this () );
+
+  DeferredResponse::postAfter (std::chrono::seconds (TIMEOUT),
+  [deferred, name, wself] () {
+    std::shared_ptr<RecorderEndpointImpl> self = wself.lock ();
+
+    if (self) {
+      std::unique_lock<std::mutex> lck (self->mtx);
+      auto it = std::find (self->stopWaiters.begin (), self->stopWaiters.end (),
+                           deferred);
+
+      if (it == self->stopWaiters.end () ) {
+        /* Already answered by onStateChanged */
+        return;
+      }
+
+      self->stopWaiters.erase (it);
+    }
+
+    GST_ERROR ("%s: STATE did not changed to %d in %d seconds", name.c_str (),
+               KMS_URI_END_POINT_STATE_STOP, TIMEOUT);
+    deferred->complete ();
+  });
 }
 
 static void
@@ -19,8 +19,10 @@
 
 #include "UriEndpointImpl.hpp"
 #include "RecorderEndpoint.hpp"
+#include "ElementDisconnected.hpp"
 #include <EventHandler.hpp>
 #include <condition_variable>
+#include <vector>
 
 namespace kurento
 {
@@ -28,6 +30,9 @@ namespace kurento
 class MediaPipeline;
 class MediaProfileSpecType;
 class RecorderEndpointImpl;
+class DeferredResponse;
+class Hub;
+class HubPortImpl;
 
 void Serialize (std::shared_ptr<RecorderEndpointImpl> &object,
                 JsonSerializer &serializer);
@@ -46,6 +51,10 @@ public:
 
   void record () override;
   virtual void stopAndWait () override;
+  virtual void recordHub (std::shared_ptr<Hub> hub) override;
+
+  virtual int getPreRecordTime () override;
+  virtual void setPreRecordTime (int preRecordTime) override;
 
   /* Next methods are automatically implemented by code generator */
   using UriEndpointImpl::connect;
@@ -70,14 +79,26 @@ protected:
   virtual void postConstructor () override;
 
   virtual void release () override;
+
+  virtual void prepareSinkConnection (std::shared_ptr<MediaElement> src,
+                                      std::shared_ptr<MediaType> mediaType,
+                                      const std::string &sourceMediaDescription,
+                                      const std::string &sinkMediaDescription) override;
 private:
   static bool support_ksr;
+  bool ksr = false;
   gulong handlerOnStateChanged = 0;
   std::mutex mtx;
   std::condition_variable cv;
   gint state{};
+  std::vector<std::shared_ptr<DeferredResponse>> stopWaiters;
+
+  std::mutex hubMutex;
+  std::vector<sigc::connection> hubConnections;
 
   void onStateChanged (gint state);
+  void recordHubPort (std::shared_ptr<HubPortImpl> port);
+  void onHubPortDisconnected (ElementDisconnected event);
   void waitForStateChange (gint state);
 
   void collectEndpointStats (std::map <std::string, std::shared_ptr<Stats>>
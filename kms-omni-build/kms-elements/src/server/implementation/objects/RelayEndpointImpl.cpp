@@ -0,0 +1,192 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#include <gst/gst.h>
+#include "MediaType.hpp"
+#include "MediaPipeline.hpp"
+#include <RelayEndpointImplFactory.hpp>
+#include "RelayEndpointImpl.hpp"
+#include <jsonrpc/JsonSerializer.hpp>
+#include <KurentoException.hpp>
+#include "SignalHandler.hpp"
+
+#define GST_CAT_DEFAULT kurento_relay_endpoint_impl
+GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
+#define GST_DEFAULT_NAME "KurentoRelayEndpointImpl"
+
+#define FACTORY_NAME "relayendpoint"
+#define PORT "port"
+#define REMOTE_ADDRESS "remote-address"
+#define REMOTE_PORT "remote-port"
+
+namespace kurento
+{
+
+static std::shared_ptr<MediaType>
+relayMediaType (KmsElementPadType type)
+{
+  if (type == KMS_ELEMENT_PAD_TYPE_AUDIO) {
+    return std::make_shared <MediaType> (MediaType::AUDIO);
+  }
+
+  return std::make_shared <MediaType> (MediaType::VIDEO);
+}
+
+void RelayEndpointImpl::streamAdded (KmsElementPadType type,
+                                     gchar *description)
+{
+  try {
+    RelayStreamAdded event (shared_from_this (), RelayStreamAdded::getName (),
+                            relayMediaType (type), description);
+    sigcSignalEmit(signalRelayStreamAdded, event);
+  } catch (const std::bad_weak_ptr &e) {
+    // shared_from_this()
+    GST_ERROR ("BUG creating %s: %s", RelayStreamAdded::getName ().c_str (),
+        e.what ());
+  }
+}
+
+void RelayEndpointImpl::streamRemoved (KmsElementPadType type,
+                                       gchar *description)
+{
+  try {
+    RelayStreamRemoved event (shared_from_this (),
+                              RelayStreamRemoved::getName (),
+                              relayMediaType (type), description);
+    sigcSignalEmit(signalRelayStreamRemoved, event);
+  } catch (const std::bad_weak_ptr &e) {
+    // shared_from_this()
+    GST_ERROR ("BUG creating %s: %s", RelayStreamRemoved::getName ().c_str (),
+        e.what ());
+  }
+}
+
+void RelayEndpointImpl::postConstructor ()
+{
+  EndpointImpl::postConstructor ();
+
+  signalStreamAdded = register_signal_handler (G_OBJECT (element),
+                      "stream-added",
+                      std::function <void (GstElement *, KmsElementPadType, gchar *) >
+                      (std::bind (&RelayEndpointImpl::streamAdded, this,
+                                  std::placeholders::_2, std::placeholders::_3) ),
+                      std::dynamic_pointer_cast<RelayEndpointImpl>
+                      (shared_from_this() ) );
+
+  signalStreamRemoved = register_signal_handler (G_OBJECT (element),
+                        "stream-removed",
+                        std::function <void (GstElement *, KmsElementPadType, gchar *) >
+                        (std::bind (&RelayEndpointImpl::streamRemoved, this,
+                                    std::placeholders::_2, std::placeholders::_3) ),
+                        std::dynamic_pointer_cast<RelayEndpointImpl>
+                        (shared_from_this() ) );
+}
+
+RelayEndpointImpl::RelayEndpointImpl (const boost::property_tree::ptree &conf,
+                                      std::shared_ptr<MediaPipeline>
+                                      mediaPipeline, int localPort) : EndpointImpl (conf,
+                                            std::dynamic_pointer_cast<MediaObjectImpl> (mediaPipeline), FACTORY_NAME)
+{
+  if (localPort < 0 || localPort > G_MAXUINT16) {
+    throw KurentoException (MEDIA_OBJECT_ILLEGAL_PARAM_ERROR,
+                            "Invalid local port " + std::to_string (localPort) );
+  }
+
+  g_object_set (G_OBJECT (element), PORT, (guint) localPort, NULL);
+}
+
+RelayEndpointImpl::~RelayEndpointImpl ()
+{
+  if (signalStreamAdded > 0) {
+    unregister_signal_handler (element, signalStreamAdded);
+  }
+
+  if (signalStreamRemoved > 0) {
+    unregister_signal_handler (element, signalStreamRemoved);
+  }
+}
+
+int
+RelayEndpointImpl::getLocalPort ()
+{
+  guint port;
+
+  g_object_get (G_OBJECT (element), PORT, &port, NULL);
+
+  return port;
+}
+
+std::string
+RelayEndpointImpl::getRemoteAddress ()
+{
+  std::string remoteAddress;
+  gchar *ret;
+
+  g_object_get (G_OBJECT (element), REMOTE_ADDRESS, &ret, NULL);
+
+  if (ret != nullptr) {
+    remoteAddress = std::string (ret);
+    g_free (ret);
+  }
+
+  return remoteAddress;
+}
+
+void
+RelayEndpointImpl::setRemoteAddress (const std::string &remoteAddress)
+{
+  g_object_set (G_OBJECT (element), REMOTE_ADDRESS, remoteAddress.c_str (),
+                NULL);
+}
+
+int
+RelayEndpointImpl::getRemotePort ()
+{
+  guint port;
+
+  g_object_get (G_OBJECT (element), REMOTE_PORT, &port, NULL);
+
+  return port;
+}
+
+void
+RelayEndpointImpl::setRemotePort (int remotePort)
+{
+  if (remotePort < 0 || remotePort > G_MAXUINT16) {
+    throw KurentoException (MEDIA_OBJECT_ILLEGAL_PARAM_ERROR,
+                            "Invalid remote port " + std::to_string (remotePort) );
+  }
+
+  g_object_set (G_OBJECT (element), REMOTE_PORT, (guint) remotePort, NULL);
+}
+
+MediaObjectImpl *
+RelayEndpointImplFactory::createObject (const boost::property_tree::ptree
+                                        &conf, std::shared_ptr<MediaPipeline> mediaPipeline,
+                                        int localPort) const
+{
+  return new RelayEndpointImpl (conf, mediaPipeline, localPort);
+}
+
+RelayEndpointImpl::StaticConstructor RelayEndpointImpl::staticConstructor;
+
+RelayEndpointImpl::StaticConstructor::StaticConstructor()
+{
+  GST_DEBUG_CATEGORY_INIT (GST_CAT_DEFAULT, GST_DEFAULT_NAME, 0,
+                           GST_DEFAULT_NAME);
+}
+
+} /* kurento */
@@ -0,0 +1,89 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifndef __RELAY_ENDPOINT_IMPL_HPP__
+#define __RELAY_ENDPOINT_IMPL_HPP__
+
+#include "EndpointImpl.hpp"
+#include "RelayEndpoint.hpp"
+#include <EventHandler.hpp>
+#include <functional>
+
+namespace kurento
+{
+
+class MediaPipeline;
+class RelayEndpointImpl;
+
+void Serialize (std::shared_ptr<RelayEndpointImpl> &object,
+                JsonSerializer &serializer);
+
+class RelayEndpointImpl : public EndpointImpl, public virtual RelayEndpoint
+{
+
+public:
+
+  RelayEndpointImpl (const boost::property_tree::ptree &conf,
+                     std::shared_ptr<MediaPipeline> mediaPipeline, int localPort);
+
+  virtual ~RelayEndpointImpl ();
+
+  virtual int getLocalPort () override;
+
+  virtual std::string getRemoteAddress () override;
+  virtual void setRemoteAddress (const std::string &remoteAddress) override;
+
+  virtual int getRemotePort () override;
+  virtual void setRemotePort (int remotePort) override;
+
+  /* Next methods are automatically implemented by code generator */
+  using EndpointImpl::connect;
+  virtual bool connect (const std::string &eventType,
+                        std::shared_ptr<EventHandler> handler) override;
+
+  sigc::signal<void, RelayStreamAdded> signalRelayStreamAdded;
+  sigc::signal<void, RelayStreamRemoved> signalRelayStreamRemoved;
+
+  virtual void invoke (std::shared_ptr<MediaObjectImpl> obj,
+                       const std::string &methodName, const Json::Value &params,
+                       Json::Value &response) override;
+
+  virtual void Serialize (JsonSerializer &serializer) override;
+
+protected:
+  virtual void postConstructor () override;
+
+private:
+
+  gulong signalStreamAdded = 0;
+  gulong signalStreamRemoved = 0;
+
+  void streamAdded (KmsElementPadType type, gchar *description);
+  void streamRemoved (KmsElementPadType type, gchar *description);
+
+  class StaticConstructor
+  {
+  public:
+    StaticConstructor();
+  };
+
+  static StaticConstructor staticConstructor;
+
+};
+
+} /* kurento */
+
+#endif /*  __RELAY_ENDPOINT_IMPL_HPP__ */
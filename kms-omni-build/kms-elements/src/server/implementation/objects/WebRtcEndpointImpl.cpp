@@ -18,6 +18,7 @@
 #include "MediaPipeline.hpp"
 #include <WebRtcEndpointImplFactory.hpp>
 #include "WebRtcEndpointImpl.hpp"
+#include "WebRtcEndpointConfig.hpp"
 #include <jsonrpc/JsonSerializer.hpp>
 #include <KurentoException.hpp>
 #include <boost/filesystem.hpp>
@@ -54,12 +55,6 @@ GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
 #define CONFIG_PATH "configPath"
 #define DEFAULT_PATH "/etc/kurento"
 
-#define PARAM_EXTERNAL_ADDRESS "externalAddress"
-#define PARAM_EXTERNAL_IPV4 "externalIPv4"
-#define PARAM_EXTERNAL_IPV6 "externalIPv6"
-#define PARAM_NETWORK_INTERFACES "networkInterfaces"
-#define PARAM_ICE_TCP "iceTcp"
-
 #define PROP_EXTERNAL_ADDRESS "external-address"
 #define PROP_EXTERNAL_IPV4 "external-ipv4"
 #define PROP_EXTERNAL_IPV6 "external-ipv6"
@@ -71,10 +66,11 @@ GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
 namespace kurento
 {
 
-static const uint DEFAULT_STUN_PORT = 3478;
-
 static std::once_flag check_openh264, certificates_flag;
 static std::string defaultCertificateRSA, defaultCertificateECDSA;
+/* Keep default certificates parsed even while no endpoint is using them */
+static std::shared_ptr<KmsDtlsCertificate> parsedCertificateRSA,
+       parsedCertificateECDSA;
 
 // "H264" gets added at runtime by check_support_for_h264()
 static std::vector<std::string> supported_codecs = { "VP8", "opus", "PCMU" };
@@ -154,30 +150,35 @@ WebRtcEndpointImpl::generateDefaultCertificates ()
   defaultCertificateECDSA = "";
   defaultCertificateRSA = "";
 
-  std::string pemUriRSA;
-  if (getConfigValue <std::string, WebRtcEndpoint> (&pemUriRSA,
-      "pemCertificateRSA")) {
-    defaultCertificateRSA = getCerficateFromFile (pemUriRSA);
+  std::shared_ptr<const WebRtcEndpointConfig> webRtcConfig =
+    WebRtcEndpointConfig::get (config);
+
+  if (webRtcConfig->__isSetPemCertificateRSA) {
+    defaultCertificateRSA = getCerficateFromFile (
+                              webRtcConfig->pemCertificateRSA);
   } else {
-    std::string pemUri;
-    if (getConfigValue <std::string, WebRtcEndpoint> (&pemUri,
-        "pemCertificate")) {
+    if (webRtcConfig->__isSetPemCertificate) {
       GST_WARNING ("pemCertificate is deprecated. Please use pemCertificateRSA instead");
-      defaultCertificateRSA = getCerficateFromFile (pemUri);
+      defaultCertificateRSA = getCerficateFromFile (
+                                webRtcConfig->pemCertificate);
     } else {
       GST_INFO ("Unable to load the RSA certificate from file. Using the default certificate.");
       defaultCertificateRSA = CertificateManager::generateRSACertificate ();
     }
   }
 
-  std::string pemUriECDSA;
-  if (getConfigValue <std::string, WebRtcEndpoint> (&pemUriECDSA,
-      "pemCertificateECDSA")) {
-    defaultCertificateECDSA = getCerficateFromFile (pemUriECDSA);
+  if (webRtcConfig->__isSetPemCertificateECDSA) {
+    defaultCertificateECDSA = getCerficateFromFile (
+                                webRtcConfig->pemCertificateECDSA);
   } else {
     GST_INFO ("Unable to load the ECDSA certificate from file. Using the default certificate.");
     defaultCertificateECDSA = CertificateManager::generateECDSACertificate ();
   }
+
+  parsedCertificateRSA = CertificateManager::getCertificate (
+                           defaultCertificateRSA);
+  parsedCertificateECDSA = CertificateManager::getCertificate (
+                             defaultCertificateECDSA);
 }
 
 void WebRtcEndpointImpl::checkUri (std::string &uri)
@@ -663,9 +664,11 @@ WebRtcEndpointImpl::WebRtcEndpointImpl (const boost::property_tree::ptree &conf,
 
   //set properties
 
-  std::string externalIPv4;
-  if (getConfigValue <std::string, WebRtcEndpoint> (&externalIPv4,
-      PARAM_EXTERNAL_IPV4)) {
+  std::shared_ptr<const WebRtcEndpointConfig> webRtcConfig =
+    WebRtcEndpointConfig::get (conf);
+
+  if (webRtcConfig->__isSetExternalIPv4) {
+    const std::string &externalIPv4 = webRtcConfig->externalIPv4;
     GST_INFO ("Predefined external IPv4 address: %s", externalIPv4.c_str());
     g_object_set (G_OBJECT (element), PROP_EXTERNAL_IPV4,
         externalIPv4.c_str(), NULL);
@@ -674,9 +677,8 @@ WebRtcEndpointImpl::WebRtcEndpointImpl (const boost::property_tree::ptree &conf,
                " you can set one or default to STUN automatic discovery");
   }
 
-  std::string externalIPv6;
-  if (getConfigValue <std::string, WebRtcEndpoint> (&externalIPv6,
-      PARAM_EXTERNAL_IPV6)) {
+  if (webRtcConfig->__isSetExternalIPv6) {
+    const std::string &externalIPv6 = webRtcConfig->externalIPv6;
     GST_INFO ("Predefined external IPv6 address: %s", externalIPv6.c_str());
     g_object_set (G_OBJECT (element), PROP_EXTERNAL_IPV6,
         externalIPv6.c_str(), NULL);
@@ -685,9 +687,8 @@ WebRtcEndpointImpl::WebRtcEndpointImpl (const boost::property_tree::ptree &conf,
                " you can set one or default to STUN automatic discovery");
   }
 
-  std::string externalAddress;
-  if (getConfigValue <std::string, WebRtcEndpoint> (&externalAddress,
-      PARAM_EXTERNAL_ADDRESS)) {
+  if (webRtcConfig->__isSetExternalAddress) {
+    const std::string &externalAddress = webRtcConfig->externalAddress;
     GST_INFO ("Predefined external IP address: %s", externalAddress.c_str());
     g_object_set (G_OBJECT (element), PROP_EXTERNAL_ADDRESS,
         externalAddress.c_str(), NULL);
@@ -696,9 +697,8 @@ WebRtcEndpointImpl::WebRtcEndpointImpl (const boost::property_tree::ptree &conf,
                " you can set one or default to STUN automatic discovery");
   }
 
-  std::string networkInterfaces;
-  if (getConfigValue <std::string, WebRtcEndpoint> (&networkInterfaces,
-      PARAM_NETWORK_INTERFACES)) {
+  if (webRtcConfig->__isSetNetworkInterfaces) {
+    const std::string &networkInterfaces = webRtcConfig->networkInterfaces;
     GST_INFO ("Predefined network interfaces: %s", networkInterfaces.c_str());
     g_object_set (G_OBJECT (element), PROP_NETWORK_INTERFACES,
         networkInterfaces.c_str(), NULL);
@@ -707,8 +707,8 @@ WebRtcEndpointImpl::WebRtcEndpointImpl (const boost::property_tree::ptree &conf,
                " you can set one or default to ICE automatic discovery");
   }
 
-  gboolean iceTcp;
-  if (getConfigValue<gboolean, WebRtcEndpoint> (&iceTcp, PARAM_ICE_TCP)) {
+  if (webRtcConfig->__isSetIceTcp) {
+    gboolean iceTcp = webRtcConfig->iceTcp;
     GST_INFO ("ICE-TCP candidate gathering is %s",
         iceTcp ? "ENABLED" : "DISABLED");
     g_object_set (G_OBJECT (element), PROP_ICE_TCP, iceTcp, NULL);
@@ -717,17 +717,15 @@ WebRtcEndpointImpl::WebRtcEndpointImpl (const boost::property_tree::ptree &conf,
                " you can set it or default to 1 (TRUE)");
   }
 
-  uint stunPort = 0;
-  if (!getConfigValue <uint, WebRtcEndpoint> (&stunPort, "stunServerPort",
-      DEFAULT_STUN_PORT) ) {
+  guint stunPort = webRtcConfig->stunServerPort;
+  if (!webRtcConfig->__isSetStunServerPort) {
     GST_DEBUG ("STUN port not found in config;"
-               " using default value: %d", DEFAULT_STUN_PORT);
+               " using default value: %u", stunPort);
   }
 
-  std::string stunAddress;
-  if (getConfigValue<std::string, WebRtcEndpoint> (&stunAddress,
-      "stunServerAddress")) {
-    GST_INFO ("Predefined STUN server: %s:%d", stunAddress.c_str (), stunPort);
+  if (webRtcConfig->__isSetStunServerAddress) {
+    const std::string &stunAddress = webRtcConfig->stunServerAddress;
+    GST_INFO ("Predefined STUN server: %s:%u", stunAddress.c_str (), stunPort);
 
     g_object_set (G_OBJECT (element), "stun-server-port", stunPort, NULL);
     g_object_set (G_OBJECT (element), "stun-server", stunAddress.c_str (),
@@ -736,8 +734,8 @@ WebRtcEndpointImpl::WebRtcEndpointImpl (const boost::property_tree::ptree &conf,
     GST_DEBUG ("STUN server not found in config");
   }
 
-  std::string turnURL;
-  if (getConfigValue <std::string, WebRtcEndpoint> (&turnURL, "turnURL")) {
+  if (webRtcConfig->__isSetTurnURL) {
+    const std::string &turnURL = webRtcConfig->turnURL;
     std::string safeURL = "<user:password>";
     size_t separatorPos = turnURL.find_last_of('@');
     if (separatorPos == std::string::npos) {
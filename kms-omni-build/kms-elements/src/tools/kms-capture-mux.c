@@ -0,0 +1,101 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/*
+ * Turns a raw capture written by a recorder with "raw-capture" enabled into
+ * the final container, using the same muxing code and profiles as a live
+ * recording. Capture files hold the depayloaded frames that reached the
+ * recorder, see kmscapturemuxer.h.
+ *
+ *   kms-capture-mux [--profile=webm|mp4|mkv|...] capture.kcap output-uri
+ */
+
+#include <gst/gst.h>
+#include <commons/kms-core-enumtypes.h>
+
+#include "kmscapturemuxer.h"
+
+#define GST_DEFAULT_NAME "kmscapturemux"
+#define GST_CAT_DEFAULT kms_capture_mux_debug
+GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
+
+static gchar *profile_name = NULL;
+
+static GOptionEntry entries[] = {
+  {"profile", 'p', 0, G_OPTION_ARG_STRING, &profile_name,
+      "Container profile, defaults to the one of the recording", "PROFILE"},
+  {NULL}
+};
+
+static gboolean
+parse_profile (const gchar * name, KmsRecordingProfile * profile)
+{
+  GEnumClass *klass = g_type_class_ref (KMS_TYPE_RECORDING_PROFILE);
+  GEnumValue *value = g_enum_get_value_by_nick (klass, name);
+
+  if (value != NULL) {
+    *profile = value->value;
+  }
+
+  g_type_class_unref (klass);
+
+  return value != NULL;
+}
+
+int
+main (int argc, char **argv)
+{
+  KmsRecordingProfile profile = KMS_RECORDING_PROFILE_NONE;
+  GOptionContext *context;
+  GError *error = NULL;
+
+  context = g_option_context_new ("CAPTURE OUTPUT-URI");
+  g_option_context_add_main_entries (context, entries, NULL);
+  g_option_context_add_group (context, gst_init_get_option_group ());
+
+  if (!g_option_context_parse (context, &argc, &argv, &error)) {
+    g_printerr ("%s\n", error->message);
+    g_error_free (error);
+    g_option_context_free (context);
+    return 1;
+  }
+
+  g_option_context_free (context);
+
+  if (argc != 3) {
+    g_printerr ("Usage: %s [--profile=PROFILE] CAPTURE OUTPUT-URI\n", argv[0]);
+    return 1;
+  }
+
+  GST_DEBUG_CATEGORY_INIT (GST_CAT_DEFAULT, GST_DEFAULT_NAME, 0,
+      GST_DEFAULT_NAME);
+
+  if (profile_name != NULL && !parse_profile (profile_name, &profile)) {
+    g_printerr ("Unknown profile '%s'\n", profile_name);
+    return 1;
+  }
+
+  g_free (profile_name);
+
+  if (!kms_capture_muxer_mux_file (argv[1], profile, argv[2], &error)) {
+    g_printerr ("Muxing failed: %s\n", error->message);
+    g_error_free (error);
+    return 1;
+  }
+
+  return 0;
+}
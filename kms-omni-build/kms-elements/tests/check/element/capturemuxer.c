@@ -0,0 +1,227 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <gst/gst.h>
+#include <gst/app/gstappsink.h>
+#include <gst/app/gstappsrc.h>
+#include <glib/gstdio.h>
+
+#include "kmsavmuxer.h"
+#include "kmscapturemuxer.h"
+
+#define FRAMES 60
+
+typedef struct _Frames
+{
+  guint count;
+  gsize bytes;
+} Frames;
+
+static GstCaps *
+encode_frames (GQueue * frames)
+{
+  GstElement *pipeline, *sink;
+  GstCaps *caps = NULL;
+  GstSample *sample;
+
+  pipeline =
+      gst_parse_launch ("videotestsrc num-buffers=" G_STRINGIFY (FRAMES)
+      " ! video/x-raw,width=320,height=240,framerate=30/1"
+      " ! vp8enc deadline=1 keyframe-max-dist=15"
+      " ! appsink name=sink sync=false", NULL);
+  fail_if (pipeline == NULL);
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  while ((sample = gst_app_sink_pull_sample (GST_APP_SINK (sink))) != NULL) {
+    if (caps == NULL) {
+      caps = gst_caps_ref (gst_sample_get_caps (sample));
+    }
+
+    g_queue_push_tail (frames, gst_buffer_ref (gst_sample_get_buffer
+            (sample)));
+    gst_sample_unref (sample);
+  }
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  g_object_unref (sink);
+  g_object_unref (pipeline);
+
+  return caps;
+}
+
+static void
+record (KmsBaseMediaMuxer * mux, GQueue * frames, GstCaps * caps)
+{
+  GstElement *appsrc;
+  GstMessage *msg;
+  GstBus *bus;
+  GList *l;
+
+  kms_base_media_muxer_set_state (mux, GST_STATE_PLAYING);
+
+  appsrc = kms_base_media_muxer_add_src (mux, KMS_MEDIA_TYPE_VIDEO, "video");
+  fail_if (appsrc == NULL);
+  g_object_set (appsrc, "caps", caps, NULL);
+
+  for (l = frames->head; l != NULL; l = l->next) {
+    fail_unless (gst_app_src_push_buffer (GST_APP_SRC (appsrc),
+            gst_buffer_ref (l->data)) == GST_FLOW_OK);
+  }
+
+  gst_app_src_end_of_stream (GST_APP_SRC (appsrc));
+
+  bus = kms_base_media_muxer_get_bus (mux);
+  msg = gst_bus_timed_pop_filtered (bus, 10 * GST_SECOND,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_if (msg == NULL);
+  fail_unless (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  g_object_unref (bus);
+
+  kms_base_media_muxer_set_state (mux, GST_STATE_NULL);
+  g_object_unref (mux);
+}
+
+static void
+demux_frames (const gchar * location, Frames * frames)
+{
+  GstElement *pipeline, *sink;
+  GstSample *sample;
+  gchar *desc;
+
+  desc = g_strdup_printf ("filesrc location=%s ! matroskademux"
+      " ! appsink name=sink sync=false", location);
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  fail_if (pipeline == NULL);
+
+  sink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  while ((sample = gst_app_sink_pull_sample (GST_APP_SINK (sink))) != NULL) {
+    frames->count++;
+    frames->bytes += gst_buffer_get_size (gst_sample_get_buffer (sample));
+    gst_sample_unref (sample);
+  }
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  g_object_unref (sink);
+  g_object_unref (pipeline);
+}
+
+GST_START_TEST (capture_round_trip)
+{
+  gchar *live_path, *capture_path, *muxed_path, *uri;
+  Frames live = { 0 }, muxed = { 0 };
+  GQueue frames = G_QUEUE_INIT;
+  GError *error = NULL;
+  gsize bytes = 0;
+  GstCaps *caps;
+  GList *l;
+
+  live_path = g_build_filename (g_get_tmp_dir (), "capturemuxer_live.webm",
+      NULL);
+  capture_path = g_build_filename (g_get_tmp_dir (), "capturemuxer.kcap",
+      NULL);
+  muxed_path = g_build_filename (g_get_tmp_dir (), "capturemuxer_muxed.webm",
+      NULL);
+
+  caps = encode_frames (&frames);
+  fail_if (caps == NULL);
+  fail_unless (frames.length == FRAMES);
+
+  for (l = frames.head; l != NULL; l = l->next) {
+    bytes += gst_buffer_get_size (l->data);
+  }
+
+  /* Same frames to a live recording and to a capture */
+  uri = gst_filename_to_uri (live_path, NULL);
+  record (KMS_BASE_MEDIA_MUXER (kms_av_muxer_new
+          (KMS_BASE_MEDIA_MUXER_PROFILE, KMS_RECORDING_PROFILE_WEBM_VIDEO_ONLY,
+              KMS_BASE_MEDIA_MUXER_URI, uri, NULL)), &frames, caps);
+  g_free (uri);
+
+  uri = gst_filename_to_uri (capture_path, NULL);
+  record (KMS_BASE_MEDIA_MUXER (kms_capture_muxer_new
+          (KMS_BASE_MEDIA_MUXER_PROFILE, KMS_RECORDING_PROFILE_WEBM_VIDEO_ONLY,
+              KMS_BASE_MEDIA_MUXER_URI, uri, NULL)), &frames, caps);
+  g_free (uri);
+
+  /* The profile comes from the capture */
+  uri = gst_filename_to_uri (muxed_path, NULL);
+  fail_unless (kms_capture_muxer_mux_file (capture_path,
+          KMS_RECORDING_PROFILE_NONE, uri, &error));
+  fail_unless (error == NULL);
+  g_free (uri);
+
+  demux_frames (live_path, &live);
+  demux_frames (muxed_path, &muxed);
+
+  GST_INFO ("Live: %u frames, %" G_GSIZE_FORMAT " bytes. Muxed offline: %u"
+      " frames, %" G_GSIZE_FORMAT " bytes", live.count, live.bytes,
+      muxed.count, muxed.bytes);
+
+  fail_unless (live.count == FRAMES);
+  fail_unless (live.bytes == bytes);
+  fail_unless (muxed.count == live.count);
+  fail_unless (muxed.bytes == live.bytes);
+
+  g_unlink (live_path);
+  g_unlink (capture_path);
+  g_unlink (muxed_path);
+  g_free (live_path);
+  g_free (capture_path);
+  g_free (muxed_path);
+  g_queue_clear_full (&frames, (GDestroyNotify) gst_buffer_unref);
+  gst_caps_unref (caps);
+}
+
+GST_END_TEST
+GST_START_TEST (capture_missing_file)
+{
+  GError *error = NULL;
+
+  fail_if (kms_capture_muxer_mux_file ("/nonexistent/capture.kcap",
+          KMS_RECORDING_PROFILE_NONE, "file:///tmp/never.webm", &error));
+  fail_if (error == NULL);
+  g_error_free (error);
+}
+
+GST_END_TEST
+/*
+ * End of test cases
+ */
+static Suite *
+capture_muxer_suite (void)
+{
+  Suite *s = suite_create ("capturemuxer");
+  TCase *tc_chain = tcase_create ("element");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, capture_round_trip);
+  tcase_add_test (tc_chain, capture_missing_file);
+
+  return s;
+}
+
+GST_CHECK_MAIN (capture_muxer);
@@ -20,6 +20,9 @@
 
 #include <gst/check/gstcheck.h>
 #include <gst/gst.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/resource.h>
 #include <commons/kmsuriendpointstate.h>
 
 #include <kmstestutils.h>
@@ -487,6 +490,470 @@ GST_START_TEST (check_eos)
 
 GST_END_TEST
 
+/* Playlist test */
+#define PLAYLIST_MAX_GAP (GST_SECOND / 2)
+
+typedef struct _PlaylistData
+{
+  GMutex mutex;
+  GMainLoop *loop;
+  guint items;
+  gboolean unknown_item;
+  guint buffers;
+  GstClockTime last_pts;
+  GstClockTime max_gap;
+  gboolean non_incremental;
+  guint video_pads;
+  gboolean switched;
+  guint keyframe_requests;
+} PlaylistData;
+
+static void
+playlist_handoff (GstElement * sink, GstBuffer * buffer, GstPad * pad,
+    PlaylistData * data)
+{
+  GstClockTime pts = GST_BUFFER_PTS (buffer);
+
+  g_mutex_lock (&data->mutex);
+
+  if (GST_CLOCK_TIME_IS_VALID (data->last_pts)) {
+    if (pts <= data->last_pts) {
+      data->non_incremental = TRUE;
+    } else {
+      data->max_gap = MAX (data->max_gap, pts - data->last_pts);
+    }
+  }
+
+  data->last_pts = pts;
+  data->buffers++;
+
+  g_mutex_unlock (&data->mutex);
+}
+
+static void
+playlist_connect_sink (GstElement * player, GstPad * new_pad,
+    PlaylistData * data)
+{
+  GstElement *sink;
+  GstPad *sinkpad;
+
+  if (!g_str_has_prefix (GST_OBJECT_NAME (new_pad), KMS_VIDEO_PREFIX)) {
+    return;
+  }
+
+  g_mutex_lock (&data->mutex);
+  data->video_pads++;
+  g_mutex_unlock (&data->mutex);
+
+  sink = gst_element_factory_make ("fakesink", NULL);
+  g_object_set (G_OBJECT (sink), "async", FALSE, "sync", FALSE,
+      "signal-handoffs", TRUE, NULL);
+  g_signal_connect (sink, "handoff", G_CALLBACK (playlist_handoff), data);
+
+  gst_bin_add (GST_BIN (GST_OBJECT_PARENT (player)), sink);
+
+  sinkpad = gst_element_get_static_pad (sink, "sink");
+  fail_if (gst_pad_link (new_pad, sinkpad) != GST_PAD_LINK_OK);
+  g_object_unref (sinkpad);
+
+  gst_element_sync_state_with_parent (sink);
+}
+
+static void
+playlist_item_started (GstElement * player, const gchar * uri,
+    PlaylistData * data)
+{
+  GST_DEBUG ("Item started: %s", uri);
+
+  g_mutex_lock (&data->mutex);
+  data->items++;
+  data->switched = TRUE;
+  data->unknown_item |= g_strcmp0 (uri, VIDEO_PATH3) != 0;
+  g_mutex_unlock (&data->mutex);
+}
+
+static GstPadProbeReturn
+playlist_keyframe_probe (GstPad * pad, GstPadProbeInfo * info,
+    PlaylistData * data)
+{
+  GstEvent *event = gst_pad_probe_info_get_event (info);
+
+  if (gst_event_has_name (event, "GstForceKeyUnit")) {
+    g_mutex_lock (&data->mutex);
+    if (data->switched) {
+      GST_DEBUG_OBJECT (pad, "Keyframe requested after switching items");
+      data->keyframe_requests++;
+    }
+    g_mutex_unlock (&data->mutex);
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+/* Keyframe requests reach the appsrcs that feed the player output */
+static void
+playlist_element_added (GstBin * player, GstBin * bin, GstElement * element,
+    PlaylistData * data)
+{
+  GstElementFactory *factory = gst_element_get_factory (element);
+  GstPad *pad;
+
+  if (factory == NULL
+      || g_strcmp0 (GST_OBJECT_NAME (factory), "appsrc") != 0) {
+    return;
+  }
+
+  pad = gst_element_get_static_pad (element, "src");
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_EVENT_UPSTREAM,
+      (GstPadProbeCallback) playlist_keyframe_probe, data, NULL);
+  g_object_unref (pad);
+}
+
+static void
+playlist_eos (GstElement * player, PlaylistData * data)
+{
+  GST_DEBUG ("Eos received");
+  g_idle_add (quit_main_loop_idle, data->loop);
+}
+
+GST_START_TEST (check_playlist)
+{
+  const gchar *playlist[] = { VIDEO_PATH3, VIDEO_PATH3, NULL };
+  PlaylistData data = { 0 };
+  gchar **remaining = NULL;
+  guint bus_watch_id;
+  gchar *padname;
+  GstBus *bus;
+
+  g_mutex_init (&data.mutex);
+  data.loop = g_main_loop_new (NULL, FALSE);
+  data.last_pts = GST_CLOCK_TIME_NONE;
+
+  pipeline = gst_pipeline_new (__FUNCTION__);
+  player = gst_element_factory_make ("playerendpoint", NULL);
+  bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
+
+  bus_watch_id = gst_bus_add_watch (bus, gst_bus_async_signal_func, NULL);
+  g_signal_connect (bus, "message", G_CALLBACK (bus_msg_cb), pipeline);
+  g_object_unref (bus);
+
+  g_object_set (G_OBJECT (player), "uri", VIDEO_PATH3, "playlist", playlist,
+      NULL);
+
+  g_signal_connect (player, "pad-added", G_CALLBACK (playlist_connect_sink),
+      &data);
+  g_signal_connect (player, "item-started",
+      G_CALLBACK (playlist_item_started), &data);
+  g_signal_connect (player, "eos", G_CALLBACK (playlist_eos), &data);
+
+  gst_bin_add (GST_BIN (pipeline), player);
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  g_signal_emit_by_name (player, "request-new-pad",
+      KMS_ELEMENT_PAD_TYPE_VIDEO, NULL, GST_PAD_SRC, &padname);
+  fail_if (padname == NULL);
+  g_free (padname);
+
+  g_object_set (G_OBJECT (player), "state", KMS_URI_ENDPOINT_STATE_START, NULL);
+
+  g_main_loop_run (data.loop);
+
+  GST_INFO ("%u items, %u buffers, max gap %" GST_TIME_FORMAT, data.items,
+      data.buffers, GST_TIME_ARGS (data.max_gap));
+
+  /* Both items played after the first one, as a single stream */
+  fail_unless (data.items == G_N_ELEMENTS (playlist) - 1);
+  fail_if (data.unknown_item);
+  fail_unless (data.buffers > 0);
+  fail_if (data.non_incremental, "PTS went backwards between items");
+  fail_unless (data.max_gap < PLAYLIST_MAX_GAP, "Gap of %" GST_TIME_FORMAT
+      " between items", GST_TIME_ARGS (data.max_gap));
+
+  g_object_get (G_OBJECT (player), "playlist", &remaining, NULL);
+  fail_unless (remaining != NULL && remaining[0] == NULL);
+  g_strfreev (remaining);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (GST_OBJECT (pipeline));
+  g_source_remove (bus_watch_id);
+  g_main_loop_unref (data.loop);
+  g_mutex_clear (&data.mutex);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (check_playlist_caps)
+{
+  /* Each item has a different resolution */
+  const gchar *playlist[] = { VIDEO_PATH2, VIDEO_PATH, NULL };
+  PlaylistData data = { 0 };
+  guint bus_watch_id;
+  gchar *padname;
+  GstBus *bus;
+
+  g_mutex_init (&data.mutex);
+  data.loop = g_main_loop_new (NULL, FALSE);
+  data.last_pts = GST_CLOCK_TIME_NONE;
+
+  pipeline = gst_pipeline_new (__FUNCTION__);
+  player = gst_element_factory_make ("playerendpoint", NULL);
+  bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
+
+  bus_watch_id = gst_bus_add_watch (bus, gst_bus_async_signal_func, NULL);
+  g_signal_connect (bus, "message", G_CALLBACK (bus_msg_cb), pipeline);
+  g_object_unref (bus);
+
+  g_object_set (G_OBJECT (player), "uri", VIDEO_PATH3, "playlist", playlist,
+      NULL);
+
+  g_signal_connect (player, "pad-added", G_CALLBACK (playlist_connect_sink),
+      &data);
+  g_signal_connect (player, "deep-element-added",
+      G_CALLBACK (playlist_element_added), &data);
+  g_signal_connect (player, "item-started",
+      G_CALLBACK (playlist_item_started), &data);
+  g_signal_connect (player, "eos", G_CALLBACK (playlist_eos), &data);
+
+  gst_bin_add (GST_BIN (pipeline), player);
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  g_signal_emit_by_name (player, "request-new-pad",
+      KMS_ELEMENT_PAD_TYPE_VIDEO, NULL, GST_PAD_SRC, &padname);
+  fail_if (padname == NULL);
+  g_free (padname);
+
+  g_object_set (G_OBJECT (player), "state", KMS_URI_ENDPOINT_STATE_START, NULL);
+
+  g_main_loop_run (data.loop);
+
+  GST_INFO ("%u items, %u buffers, %u video pads, %u keyframe requests",
+      data.items, data.buffers, data.video_pads, data.keyframe_requests);
+
+  /* The caps change on the same stream, nothing is renegotiated */
+  fail_unless (data.items == G_N_ELEMENTS (playlist) - 1);
+  fail_unless (data.buffers > 0);
+  fail_if (data.non_incremental, "PTS went backwards between items");
+  fail_unless (data.video_pads == 1, "%u video pads added", data.video_pads);
+  fail_unless (data.keyframe_requests == 0, "%u keyframes requested",
+      data.keyframe_requests);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (GST_OBJECT (pipeline));
+  g_source_remove (bus_watch_id);
+  g_main_loop_unref (data.loop);
+  g_mutex_clear (&data.mutex);
+}
+
+GST_END_TEST;
+
+/* Many players test */
+#define N_PLAYERS 8
+
+typedef struct _PlayersData
+{
+  GMutex mutex;
+  GMainLoop *loop;
+  /* Buffers that reached the internal appsinks, taken from decoder pools */
+  GHashTable *decoded;
+  guint buffers;
+  guint copies;
+  guint eos;
+} PlayersData;
+
+static glong
+get_rss_kb (void)
+{
+  gchar *contents = NULL;
+  glong size = 0, resident = 0;
+
+  if (g_file_get_contents ("/proc/self/statm", &contents, NULL, NULL)) {
+    sscanf (contents, "%ld %ld", &size, &resident);
+    g_free (contents);
+  }
+
+  return resident * (sysconf (_SC_PAGESIZE) / 1024);
+}
+
+static gint64
+get_cpu_time_us (void)
+{
+  struct rusage usage;
+
+  if (getrusage (RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+
+  return (gint64) (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) *
+      G_USEC_PER_SEC + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+static GstPadProbeReturn
+decoded_buffer_probe (GstPad * pad, GstPadProbeInfo * info, PlayersData * data)
+{
+  GstBuffer *buffer = gst_pad_probe_info_get_buffer (info);
+
+  g_mutex_lock (&data->mutex);
+  g_hash_table_add (data->decoded, buffer);
+  g_mutex_unlock (&data->mutex);
+
+  return GST_PAD_PROBE_OK;
+}
+
+static void
+internal_element_added (GstBin * bin, GstBin * sub_bin, GstElement * element,
+    PlayersData * data)
+{
+  GstElementFactory *factory = gst_element_get_factory (element);
+  GstPad *sinkpad;
+
+  if (factory == NULL
+      || g_strcmp0 (GST_OBJECT_NAME (factory), "appsink") != 0) {
+    return;
+  }
+
+  sinkpad = gst_element_get_static_pad (element, "sink");
+  gst_pad_add_probe (sinkpad, GST_PAD_PROBE_TYPE_BUFFER,
+      (GstPadProbeCallback) decoded_buffer_probe, data, NULL);
+  g_object_unref (sinkpad);
+}
+
+/* A buffer that was made writable while shared is a new GstBuffer */
+static void
+output_handoff (GstElement * sink, GstBuffer * buffer, GstPad * pad,
+    PlayersData * data)
+{
+  g_mutex_lock (&data->mutex);
+  data->buffers++;
+  if (!g_hash_table_contains (data->decoded, buffer)) {
+    data->copies++;
+  }
+  g_mutex_unlock (&data->mutex);
+}
+
+static void
+connect_output_sink (GstElement * player, GstPad * new_pad,
+    PlayersData * data)
+{
+  GstElement *sink;
+  GstPad *sinkpad;
+
+  if (!g_str_has_prefix (GST_OBJECT_NAME (new_pad), KMS_VIDEO_PREFIX)) {
+    return;
+  }
+
+  sink = gst_element_factory_make ("fakesink", NULL);
+  g_object_set (G_OBJECT (sink), "async", FALSE, "sync", FALSE,
+      "signal-handoffs", TRUE, NULL);
+  g_signal_connect (sink, "handoff", G_CALLBACK (output_handoff), data);
+
+  gst_bin_add (GST_BIN (GST_OBJECT_PARENT (player)), sink);
+
+  sinkpad = gst_element_get_static_pad (sink, "sink");
+  fail_if (gst_pad_link (new_pad, sinkpad) != GST_PAD_LINK_OK);
+  g_object_unref (sinkpad);
+
+  gst_element_sync_state_with_parent (sink);
+}
+
+static void
+many_players_eos (GstElement * player, PlayersData * data)
+{
+  gboolean done;
+
+  g_mutex_lock (&data->mutex);
+  done = (++data->eos == N_PLAYERS);
+  g_mutex_unlock (&data->mutex);
+
+  if (done) {
+    g_idle_add (quit_main_loop_idle, data->loop);
+  }
+}
+
+GST_START_TEST (check_many_players)
+{
+  GstElement *players[N_PLAYERS];
+  PlayersData data = { 0 };
+  guint bus_watch_id, i;
+  glong rss_start, rss_end;
+  gint64 start, elapsed, cpu_start, cpu;
+  GstBus *bus;
+
+  g_mutex_init (&data.mutex);
+  data.loop = g_main_loop_new (NULL, FALSE);
+  data.decoded = g_hash_table_new (NULL, NULL);
+
+  pipeline = gst_pipeline_new (__FUNCTION__);
+  bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
+
+  bus_watch_id = gst_bus_add_watch (bus, gst_bus_async_signal_func, NULL);
+  g_signal_connect (bus, "message", G_CALLBACK (bus_msg_cb), pipeline);
+  g_object_unref (bus);
+
+  for (i = 0; i < N_PLAYERS; i++) {
+    GstElement *internal;
+    gchar *padname;
+
+    players[i] = gst_element_factory_make ("playerendpoint", NULL);
+    g_object_set (G_OBJECT (players[i]), "uri", VIDEO_PATH3, NULL);
+
+    g_object_get (players[i], "pipeline", &internal, NULL);
+    g_signal_connect (internal, "deep-element-added",
+        G_CALLBACK (internal_element_added), &data);
+    g_object_unref (internal);
+
+    g_signal_connect (players[i], "pad-added",
+        G_CALLBACK (connect_output_sink), &data);
+    g_signal_connect (players[i], "eos", G_CALLBACK (many_players_eos),
+        &data);
+
+    gst_bin_add (GST_BIN (pipeline), players[i]);
+
+    g_signal_emit_by_name (players[i], "request-new-pad",
+        KMS_ELEMENT_PAD_TYPE_VIDEO, NULL, GST_PAD_SRC, &padname);
+    fail_if (padname == NULL);
+    g_free (padname);
+  }
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  rss_start = get_rss_kb ();
+  cpu_start = get_cpu_time_us ();
+  start = g_get_monotonic_time ();
+
+  for (i = 0; i < N_PLAYERS; i++) {
+    g_object_set (G_OBJECT (players[i]), "state",
+        KMS_URI_ENDPOINT_STATE_START, NULL);
+  }
+
+  g_main_loop_run (data.loop);
+
+  elapsed = g_get_monotonic_time () - start;
+  cpu = get_cpu_time_us () - cpu_start;
+  rss_end = get_rss_kb ();
+
+  GST_INFO ("%u players: %u frames in %" G_GINT64_FORMAT " ms (%.1f fps), "
+      "%.1f us of CPU per frame, %u copied, RSS %ld kB -> %ld kB", N_PLAYERS,
+      data.buffers, elapsed / 1000, data.buffers * 1e6 / MAX (elapsed, 1),
+      (gdouble) cpu / MAX (data.buffers, 1), data.copies, rss_start, rss_end);
+
+  fail_unless (data.eos == N_PLAYERS);
+  fail_unless (data.buffers > 0);
+  /* Retiming only writes the metadata of buffers owned by the pipeline: the
+   * preroll frame of each player, still held by its appsink, is the expected
+   * copy */
+  fail_unless (data.copies * 10 <= data.buffers, "%u of %u frames were copied",
+      data.copies, data.buffers);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (GST_OBJECT (pipeline));
+  g_source_remove (bus_watch_id);
+  g_main_loop_unref (data.loop);
+  g_hash_table_unref (data.decoded);
+  g_mutex_clear (&data.mutex);
+}
+
+GST_END_TEST;
+
 #ifdef ENABLE_EXPERIMENTAL_TESTS
 
 GST_START_TEST (check_set_encoded_media)
@@ -549,6 +1016,9 @@ playerendpoint_suite (void)
   tcase_add_test (tc_chain, check_states);
   tcase_add_test (tc_chain, check_live_stream);
   tcase_add_test (tc_chain, check_eos);
+  tcase_add_test (tc_chain, check_playlist);
+  tcase_add_test (tc_chain, check_playlist_caps);
+  tcase_add_test (tc_chain, check_many_players);
 #ifdef ENABLE_EXPERIMENTAL_TESTS
   tcase_add_test (tc_chain, check_set_encoded_media);
 #endif
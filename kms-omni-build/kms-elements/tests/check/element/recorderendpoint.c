@@ -602,6 +602,233 @@ GST_START_TEST (check_audio_only)
   g_main_loop_unref (loop);
 }
 
+GST_END_TEST;
+
+#define PRE_RECORD_TIME (2 * GST_SECOND)
+#define PRE_RECORD_GOP (GST_SECOND)
+
+static gint pre_record_counting;
+static gint pre_record_keyframe_requests;
+static GstClockTime pre_record_last_pts;
+static GstClockTime pre_record_start_pts;
+static GstClockTime pre_record_stop_pts;
+static GMutex pre_record_mutex;
+
+static GstPadProbeReturn
+track_encoded_pts (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  GstBuffer *buffer = gst_pad_probe_info_get_buffer (info);
+
+  g_mutex_lock (&pre_record_mutex);
+  pre_record_last_pts = GST_BUFFER_PTS (buffer);
+  g_mutex_unlock (&pre_record_mutex);
+
+  return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn
+count_keyframe_requests (GstPad * pad, GstPadProbeInfo * info,
+    gpointer user_data)
+{
+  GstEvent *event = gst_pad_probe_info_get_event (info);
+
+  if (gst_event_has_name (event, "GstForceKeyUnit")
+      && g_atomic_int_get (&pre_record_counting)) {
+    GST_DEBUG_OBJECT (pad, "Keyframe requested");
+    g_atomic_int_inc (&pre_record_keyframe_requests);
+  }
+
+  return GST_PAD_PROBE_OK;
+}
+
+static gboolean
+start_pre_recorded (gpointer data)
+{
+  GST_DEBUG ("Setting recorder to START");
+
+  g_mutex_lock (&pre_record_mutex);
+  pre_record_start_pts = pre_record_last_pts;
+  g_mutex_unlock (&pre_record_mutex);
+
+  g_atomic_int_set (&pre_record_counting, TRUE);
+  g_object_set (G_OBJECT (recorder), "state", KMS_URI_ENDPOINT_STATE_START,
+      NULL);
+
+  return FALSE;
+}
+
+static gboolean
+stop_pre_recorded (gpointer data)
+{
+  g_mutex_lock (&pre_record_mutex);
+  pre_record_stop_pts = pre_record_last_pts;
+  g_mutex_unlock (&pre_record_mutex);
+
+  return stop_recorder (data);
+}
+
+static void
+pre_record_state_changed (GstElement * recorder, KmsUriEndpointState newState,
+    gpointer loop)
+{
+  GST_DEBUG ("State changed %s.", state2string (newState));
+
+  if (newState == KMS_URI_ENDPOINT_STATE_START) {
+    g_timeout_add (3000, stop_pre_recorded, NULL);
+  } else if (newState == KMS_URI_ENDPOINT_STATE_STOP) {
+    g_idle_add (quit_main_loop_idle, loop);
+  }
+}
+
+static void
+recorded_handoff (GstElement * fakesink, GstBuffer * buffer, GstPad * pad,
+    gpointer user_data)
+{
+  GstClockTime *span = user_data;
+
+  if (!GST_BUFFER_PTS_IS_VALID (buffer)) {
+    return;
+  }
+
+  if (!GST_CLOCK_TIME_IS_VALID (span[0])) {
+    span[0] = GST_BUFFER_PTS (buffer);
+  }
+
+  span[1] = GST_BUFFER_PTS (buffer);
+}
+
+/* Time between the first and the last frame written to a file */
+static GstClockTime
+get_recorded_span (const gchar * location)
+{
+  GstClockTime span[2] = { GST_CLOCK_TIME_NONE, GST_CLOCK_TIME_NONE };
+  GstElement *pipeline, *fakesink;
+  GstMessage *msg;
+  GstBus *bus;
+  gchar *desc;
+
+  desc = g_strdup_printf ("filesrc location=%s ! matroskademux"
+      " ! fakesink name=sink sync=false signal-handoffs=true", location);
+  pipeline = gst_parse_launch (desc, NULL);
+  g_free (desc);
+  fail_if (pipeline == NULL);
+
+  fakesink = gst_bin_get_by_name (GST_BIN (pipeline), "sink");
+  g_signal_connect (fakesink, "handoff", G_CALLBACK (recorded_handoff), span);
+  g_object_unref (fakesink);
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
+  msg = gst_bus_timed_pop_filtered (bus, 10 * GST_SECOND,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_if (msg == NULL);
+  fail_unless (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  g_object_unref (bus);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  g_object_unref (pipeline);
+
+  fail_unless (GST_CLOCK_TIME_IS_VALID (span[0]));
+
+  return span[1] - span[0];
+}
+
+GST_START_TEST (check_pre_record)
+{
+  GstElement *pipeline, *videotestsrc, *vencoder;
+  GstClockTime recorded, live;
+  guint bus_watch_id;
+  GstPad *encoder_src, *sink;
+  GstBus *bus;
+
+  GMainLoop *loop = g_main_loop_new (NULL, FALSE);
+
+  expected_warnings = FALSE;
+  pre_record_counting = FALSE;
+  pre_record_keyframe_requests = 0;
+  pre_record_last_pts = GST_CLOCK_TIME_NONE;
+  pre_record_start_pts = GST_CLOCK_TIME_NONE;
+  pre_record_stop_pts = GST_CLOCK_TIME_NONE;
+
+  pipeline = gst_pipeline_new (__FUNCTION__);
+  videotestsrc = gst_element_factory_make ("videotestsrc", NULL);
+  vencoder = gst_element_factory_make ("vp8enc", NULL);
+  recorder = gst_element_factory_make ("recorderendpoint", NULL);
+
+  g_object_set (G_OBJECT (recorder), "uri", "file:///tmp/check_pre_record.webm",
+      "profile", KMS_RECORDING_PROFILE_WEBM_VIDEO_ONLY,
+      "pre-record-time", PRE_RECORD_TIME, NULL);
+
+  bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
+
+  bus_watch_id = gst_bus_add_watch (bus, gst_bus_async_signal_func, NULL);
+  g_signal_connect (bus, "message", G_CALLBACK (bus_msg), pipeline);
+  g_object_unref (bus);
+
+  gst_bin_add_many (GST_BIN (pipeline), videotestsrc, vencoder, recorder,
+      NULL);
+  gst_element_link (videotestsrc, vencoder);
+
+  /* Sink pads are available before recording to fill the pre-record buffer */
+  sink = gst_element_get_static_pad (recorder, SINK_VIDEO_STREAM);
+  fail_unless (sink != NULL);
+  g_object_unref (sink);
+
+  link_to_recorder (recorder, vencoder, pipeline, SINK_VIDEO_STREAM);
+
+  encoder_src = gst_element_get_static_pad (vencoder, "src");
+  gst_pad_add_probe (encoder_src, GST_PAD_PROBE_TYPE_EVENT_UPSTREAM,
+      count_keyframe_requests, NULL, NULL);
+  gst_pad_add_probe (encoder_src, GST_PAD_PROBE_TYPE_BUFFER,
+      track_encoded_pts, NULL, NULL);
+  g_object_unref (encoder_src);
+
+  g_signal_connect (recorder, "state-changed",
+      G_CALLBACK (pre_record_state_changed), loop);
+
+  g_object_set (G_OBJECT (videotestsrc), "is-live", TRUE, "do-timestamp", TRUE,
+      NULL);
+  g_object_set (G_OBJECT (vencoder), "deadline", G_GINT64_CONSTANT (1),
+      "keyframe-max-dist", 30, NULL);
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  /* Long enough to fill the pre-record buffer */
+  g_timeout_add (3000, start_pre_recorded, NULL);
+
+  g_main_loop_run (loop);
+  GST_DEBUG ("Stop executed");
+
+  fail_unless (g_atomic_int_get (&pre_record_keyframe_requests) == 0,
+      "%d keyframes requested on record", pre_record_keyframe_requests);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (GST_OBJECT (pipeline));
+  GST_DEBUG ("Pipe released");
+
+  /* The file starts the pre-record time before record (), rounded down to
+   * the previous keyframe */
+  fail_unless (GST_CLOCK_TIME_IS_VALID (pre_record_start_pts));
+  fail_unless (GST_CLOCK_TIME_IS_VALID (pre_record_stop_pts));
+  recorded = get_recorded_span ("/tmp/check_pre_record.webm");
+  live = pre_record_stop_pts - pre_record_start_pts;
+  GST_INFO ("Recorded %" GST_TIME_FORMAT ", %" GST_TIME_FORMAT
+      " after record ()", GST_TIME_ARGS (recorded), GST_TIME_ARGS (live));
+
+  fail_unless (recorded > live);
+  fail_unless (recorded - live >= PRE_RECORD_TIME - GST_SECOND / 2,
+      "Only %" GST_TIME_FORMAT " recorded before record ()",
+      GST_TIME_ARGS (recorded - live));
+  fail_unless (recorded - live <= PRE_RECORD_TIME + PRE_RECORD_GOP +
+      GST_SECOND / 2, "%" GST_TIME_FORMAT " recorded before record ()",
+      GST_TIME_ARGS (recorded - live));
+
+  g_source_remove (bus_watch_id);
+  g_main_loop_unref (loop);
+}
+
 GST_END_TEST static gboolean
 check_support_for_ksr ()
 {
@@ -740,6 +967,7 @@ recorderendpoint_suite (void)
   tcase_add_test (tc_chain, check_audio_only);
   tcase_add_test (tc_chain, check_states_pipeline);
   tcase_add_test (tc_chain, warning_pipeline);
+  tcase_add_test (tc_chain, check_pre_record);
 
   if (check_support_for_ksr ()) {
     tcase_add_test (tc_chain, check_ksm_sink_request);
@@ -0,0 +1,570 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gst/check/gstcheck.h>
+#include <gst/sdp/gstsdpmessage.h>
+#include <gst/gst.h>
+#include <glib.h>
+#include <sys/resource.h>
+
+#include <commons/kmselementpadtype.h>
+
+#define LOCALHOST "127.0.0.1"
+
+#define N_STREAMS 4
+#define N_BENCHMARK_STREAMS 8
+#define BUFFERS_PER_STREAM 10
+#define BENCHMARK_WINDOW 3
+
+#define RTP_SINK_VIDEO_STREAM "sink_video_default"
+
+typedef struct _RelayTest RelayTest;
+
+typedef struct _StreamData
+{
+  RelayTest *test;
+  gchar *description;
+  GstElement *agnosticbin;
+  GstElement *fakesink;
+  gchar *sink_pad;
+  gchar *src_pad;
+  gint linked;
+  gint buffers;
+} StreamData;
+
+struct _RelayTest
+{
+  GMainLoop *loop;
+  GstElement *sender;
+  GstElement *receiver;
+  StreamData streams[N_BENCHMARK_STREAMS];
+  guint n;
+  gint pending;
+  gint added;
+  const gchar *removed;
+};
+
+typedef struct _Measure
+{
+  gdouble fps;
+  gdouble cpu;
+  guint threads;
+} Measure;
+
+static gboolean
+quit_main_loop (gpointer data)
+{
+  g_main_loop_quit (data);
+  return FALSE;
+}
+
+static void
+bus_msg (GstBus * bus, GstMessage * msg, gpointer pipe)
+{
+  switch (msg->type) {
+    case GST_MESSAGE_ERROR:{
+      GST_ERROR ("Error: %" GST_PTR_FORMAT, msg);
+      GST_DEBUG_BIN_TO_DOT_FILE_WITH_TS (GST_BIN (pipe),
+          GST_DEBUG_GRAPH_SHOW_ALL, "error");
+      fail ("Error received on bus");
+      break;
+    }
+    case GST_MESSAGE_WARNING:{
+      GST_WARNING ("Warning: %" GST_PTR_FORMAT, msg);
+      GST_DEBUG_BIN_TO_DOT_FILE_WITH_TS (GST_BIN (pipe),
+          GST_DEBUG_GRAPH_SHOW_ALL, "warning");
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+static GstElement *
+create_pipeline (const gchar * name)
+{
+  GstElement *pipeline = gst_pipeline_new (name);
+  GstBus *bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
+
+  gst_bus_add_signal_watch (bus);
+  g_signal_connect (bus, "message", G_CALLBACK (bus_msg), pipeline);
+  g_object_unref (bus);
+
+  return pipeline;
+}
+
+static void
+destroy_pipeline (GstElement * pipeline)
+{
+  GstBus *bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
+
+  gst_bus_remove_signal_watch (bus);
+  g_object_unref (bus);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  g_object_unref (pipeline);
+}
+
+static void
+fakesink_hand_off (GstElement * fakesink, GstBuffer * buf, GstPad * pad,
+    gpointer data)
+{
+  StreamData *stream = data;
+
+  if (g_atomic_int_add (&stream->buffers, 1) + 1 != BUFFERS_PER_STREAM) {
+    return;
+  }
+
+  GST_DEBUG ("Stream '%s' is flowing", stream->description);
+
+  if (g_atomic_int_dec_and_test (&stream->test->pending)) {
+    g_idle_add (quit_main_loop, stream->test->loop);
+  }
+}
+
+static void
+try_link_sink_pad (GstElement * element, StreamData * stream)
+{
+  GstPad *pad = gst_element_get_static_pad (element, stream->sink_pad);
+
+  if (pad == NULL) {
+    return;
+  }
+
+  if (g_atomic_int_compare_and_exchange (&stream->linked, 0, 1)) {
+    GST_DEBUG_OBJECT (element, "Linking %s", stream->sink_pad);
+    fail_unless (gst_element_link_pads (stream->agnosticbin, NULL, element,
+            stream->sink_pad));
+  }
+
+  g_object_unref (pad);
+}
+
+static void
+sender_pad_added (GstElement * element, GstPad * pad, StreamData * stream)
+{
+  if (stream->sink_pad != NULL
+      && g_strcmp0 (GST_OBJECT_NAME (pad), stream->sink_pad) == 0) {
+    try_link_sink_pad (element, stream);
+  }
+}
+
+static void
+receiver_pad_added (GstElement * element, GstPad * pad, StreamData * stream)
+{
+  GstPad *sinkpad;
+
+  if (g_strcmp0 (GST_OBJECT_NAME (pad), stream->src_pad) != 0) {
+    return;
+  }
+
+  GST_DEBUG_OBJECT (element, "Receiving stream '%s' on %s",
+      stream->description, stream->src_pad);
+
+  sinkpad = gst_element_get_static_pad (stream->fakesink, "sink");
+  fail_unless (gst_pad_link (pad, sinkpad) == GST_PAD_LINK_OK);
+  g_object_unref (sinkpad);
+}
+
+static void
+relay_pad_added (GstElement * element, GstPad * pad, RelayTest * test)
+{
+  guint i;
+
+  for (i = 0; i < test->n; i++) {
+    receiver_pad_added (element, pad, &test->streams[i]);
+  }
+}
+
+static void
+stream_data_init (RelayTest * test, StreamData * stream, guint i)
+{
+  GstElement *videotestsrc;
+
+  stream->test = test;
+  stream->description = g_strdup_printf ("stream_%u", i);
+
+  videotestsrc = gst_element_factory_make ("videotestsrc", NULL);
+  stream->agnosticbin = gst_element_factory_make ("agnosticbin", NULL);
+  g_object_set (videotestsrc, "is-live", TRUE, "pattern", i % 20, NULL);
+
+  gst_bin_add_many (GST_BIN (test->sender), videotestsrc, stream->agnosticbin,
+      NULL);
+  gst_element_link (videotestsrc, stream->agnosticbin);
+
+  stream->fakesink = gst_element_factory_make ("fakesink", NULL);
+  g_object_set (stream->fakesink, "signal-handoffs", TRUE, "async", FALSE,
+      "sync", FALSE, NULL);
+  g_signal_connect (stream->fakesink, "handoff",
+      G_CALLBACK (fakesink_hand_off), stream);
+  gst_bin_add (GST_BIN (test->receiver), stream->fakesink);
+}
+
+static void
+stream_data_clear (StreamData * stream)
+{
+  g_free (stream->description);
+  g_free (stream->sink_pad);
+  g_free (stream->src_pad);
+}
+
+static void
+relay_test_init (RelayTest * test, guint n)
+{
+  guint i;
+
+  test->loop = g_main_loop_new (NULL, FALSE);
+  test->sender = create_pipeline ("sender");
+  test->receiver = create_pipeline ("receiver");
+  test->n = n;
+  test->pending = n;
+  test->added = 0;
+  test->removed = NULL;
+
+  for (i = 0; i < n; i++) {
+    stream_data_init (test, &test->streams[i], i);
+  }
+}
+
+static void
+relay_test_clear (RelayTest * test)
+{
+  guint i;
+
+  destroy_pipeline (test->sender);
+  destroy_pipeline (test->receiver);
+
+  for (i = 0; i < test->n; i++) {
+    stream_data_clear (&test->streams[i]);
+  }
+
+  g_main_loop_unref (test->loop);
+}
+
+static void
+stream_added (GstElement * relay, KmsElementPadType type,
+    const gchar * description, RelayTest * test)
+{
+  GST_DEBUG_OBJECT (relay, "Stream '%s' added", description);
+
+  if (g_str_has_prefix (description, "stream_")) {
+    fail_unless (type == KMS_ELEMENT_PAD_TYPE_VIDEO);
+    g_atomic_int_inc (&test->added);
+  }
+}
+
+static void
+stream_removed (GstElement * relay, KmsElementPadType type,
+    const gchar * description, RelayTest * test)
+{
+  GST_DEBUG_OBJECT (relay, "Stream '%s' removed", description);
+
+  if (g_strcmp0 (description, test->removed) == 0) {
+    g_idle_add (quit_main_loop, test->loop);
+  }
+}
+
+/* Connects every stream through a single pair of relays */
+static void
+relay_test_connect_relays (RelayTest * test, GstElement ** sender_relay,
+    GstElement ** receiver_relay)
+{
+  GstElement *relay_a, *relay_b;
+  guint port_a, port_b, i;
+
+  relay_a = gst_element_factory_make ("relayendpoint", NULL);
+  relay_b = gst_element_factory_make ("relayendpoint", NULL);
+
+  gst_bin_add (GST_BIN (test->sender), relay_a);
+  gst_bin_add (GST_BIN (test->receiver), relay_b);
+
+  g_object_get (relay_a, "port", &port_a, NULL);
+  g_object_get (relay_b, "port", &port_b, NULL);
+  fail_if (port_a == 0 || port_b == 0 || port_a == port_b);
+
+  g_object_set (relay_a, "remote-address", LOCALHOST, "remote-port", port_b,
+      NULL);
+  g_object_set (relay_b, "remote-address", LOCALHOST, "remote-port", port_a,
+      NULL);
+
+  g_signal_connect (relay_b, "pad-added", G_CALLBACK (relay_pad_added), test);
+
+  for (i = 0; i < test->n; i++) {
+    StreamData *stream = &test->streams[i];
+
+    g_signal_emit_by_name (relay_a, "request-new-pad",
+        KMS_ELEMENT_PAD_TYPE_VIDEO, stream->description, GST_PAD_SINK,
+        &stream->sink_pad);
+    fail_unless (stream->sink_pad != NULL);
+    try_link_sink_pad (relay_a, stream);
+
+    g_signal_emit_by_name (relay_b, "request-new-pad",
+        KMS_ELEMENT_PAD_TYPE_VIDEO, stream->description, GST_PAD_SRC,
+        &stream->src_pad);
+    fail_unless (stream->src_pad != NULL);
+  }
+
+  *sender_relay = relay_a;
+  *receiver_relay = relay_b;
+}
+
+static GArray *
+create_codecs_array (gchar * codecs[])
+{
+  GArray *a = g_array_new (FALSE, TRUE, sizeof (GValue));
+  int i;
+
+  for (i = 0; i < g_strv_length (codecs); i++) {
+    GValue v = G_VALUE_INIT;
+    GstStructure *s;
+
+    g_value_init (&v, GST_TYPE_STRUCTURE);
+    s = gst_structure_new (codecs[i], NULL, NULL);
+    gst_value_set_structure (&v, s);
+    gst_structure_free (s);
+    g_array_append_val (a, v);
+  }
+
+  return a;
+}
+
+/* Connects each stream through its own pair of negotiated rtpendpoints */
+static void
+relay_test_connect_rtpendpoints (RelayTest * test)
+{
+  gchar *video_codecs[] = { "VP8/90000", NULL };
+  GArray *video_codecs_array;
+  guint i;
+
+  video_codecs_array = create_codecs_array (video_codecs);
+
+  for (i = 0; i < test->n; i++) {
+    StreamData *stream = &test->streams[i];
+    gchar *sender_sess_id, *receiver_sess_id;
+    GstElement *sender, *receiver;
+    GstSDPMessage *offer, *answer;
+    gboolean answer_ok;
+
+    sender = gst_element_factory_make ("rtpendpoint", NULL);
+    receiver = gst_element_factory_make ("rtpendpoint", NULL);
+
+    g_object_set (sender, "num-video-medias", 1, "video-codecs",
+        g_array_ref (video_codecs_array), NULL);
+    g_object_set (receiver, "num-video-medias", 1, "video-codecs",
+        g_array_ref (video_codecs_array), NULL);
+
+    stream->sink_pad = g_strdup (RTP_SINK_VIDEO_STREAM);
+    g_signal_connect (sender, "pad-added", G_CALLBACK (sender_pad_added),
+        stream);
+    g_signal_connect (receiver, "pad-added", G_CALLBACK (receiver_pad_added),
+        stream);
+
+    g_signal_emit_by_name (receiver, "request-new-pad",
+        KMS_ELEMENT_PAD_TYPE_VIDEO, NULL, GST_PAD_SRC, &stream->src_pad);
+    fail_unless (stream->src_pad != NULL);
+
+    gst_bin_add (GST_BIN (test->sender), sender);
+    gst_bin_add (GST_BIN (test->receiver), receiver);
+
+    g_signal_emit_by_name (sender, "create-session", &sender_sess_id);
+    g_signal_emit_by_name (receiver, "create-session", &receiver_sess_id);
+
+    g_signal_emit_by_name (sender, "generate-offer", sender_sess_id, &offer);
+    fail_unless (offer != NULL);
+    g_signal_emit_by_name (receiver, "process-offer", receiver_sess_id, offer,
+        &answer);
+    fail_unless (answer != NULL);
+    g_signal_emit_by_name (sender, "process-answer", sender_sess_id, answer,
+        &answer_ok);
+    fail_unless (answer_ok);
+
+    gst_sdp_message_free (offer);
+    gst_sdp_message_free (answer);
+    g_free (sender_sess_id);
+    g_free (receiver_sess_id);
+
+    try_link_sink_pad (sender, stream);
+  }
+
+  g_array_unref (video_codecs_array);
+}
+
+GST_START_TEST (check_relay_streams)
+{
+  GstElement *relay_a, *relay_b;
+  RelayTest test;
+  GstPad *pad;
+  gboolean ret;
+
+  relay_test_init (&test, N_STREAMS);
+  relay_test_connect_relays (&test, &relay_a, &relay_b);
+
+  g_signal_connect (relay_b, "stream-added", G_CALLBACK (stream_added), &test);
+  g_signal_connect (relay_b, "stream-removed", G_CALLBACK (stream_removed),
+      &test);
+
+  gst_element_set_state (test.receiver, GST_STATE_PLAYING);
+  gst_element_set_state (test.sender, GST_STATE_PLAYING);
+
+  mark_point ();
+  g_main_loop_run (test.loop);
+  mark_point ();
+
+  GST_DEBUG_BIN_TO_DOT_FILE_WITH_TS (GST_BIN (test.receiver),
+      GST_DEBUG_GRAPH_SHOW_ALL, __FUNCTION__);
+
+  fail_unless (g_atomic_int_get (&test.added) == N_STREAMS);
+
+  /* Stop sending the first stream, the peer has to notice it */
+  test.removed = test.streams[0].description;
+  pad = gst_element_get_static_pad (relay_a, test.streams[0].sink_pad);
+  fail_unless (pad != NULL);
+  g_signal_emit_by_name (relay_a, "release-requested-pad", pad, &ret);
+  fail_unless (ret);
+  g_object_unref (pad);
+
+  mark_point ();
+  g_main_loop_run (test.loop);
+  mark_point ();
+
+  relay_test_clear (&test);
+}
+
+GST_END_TEST
+static guint
+count_threads (void)
+{
+  GDir *dir = g_dir_open ("/proc/self/task", 0, NULL);
+  guint threads = 0;
+
+  fail_unless (dir != NULL);
+
+  while (g_dir_read_name (dir) != NULL) {
+    threads++;
+  }
+
+  g_dir_close (dir);
+
+  return threads;
+}
+
+static gint64
+get_cpu_time (void)
+{
+  struct rusage usage;
+
+  fail_unless (getrusage (RUSAGE_SELF, &usage) == 0);
+
+  return (gint64) (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) *
+      G_USEC_PER_SEC + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+static gint
+count_buffers (RelayTest * test)
+{
+  gint buffers = 0;
+  guint i;
+
+  for (i = 0; i < test->n; i++) {
+    buffers += g_atomic_int_get (&test->streams[i].buffers);
+  }
+
+  return buffers;
+}
+
+/* Waits for every stream to flow, then measures BENCHMARK_WINDOW seconds */
+static void
+relay_test_measure (RelayTest * test, Measure * measure)
+{
+  gint64 start, cpu;
+  gint buffers;
+
+  mark_point ();
+  g_main_loop_run (test->loop);
+  mark_point ();
+
+  start = g_get_monotonic_time ();
+  cpu = get_cpu_time ();
+  buffers = count_buffers (test);
+
+  g_timeout_add_seconds (BENCHMARK_WINDOW, quit_main_loop, test->loop);
+  g_main_loop_run (test->loop);
+
+  measure->threads = count_threads ();
+  measure->cpu = (gdouble) (get_cpu_time () - cpu) /
+      (g_get_monotonic_time () - start);
+  measure->fps = (count_buffers (test) - buffers) *
+      (gdouble) G_USEC_PER_SEC / (g_get_monotonic_time () - start);
+}
+
+/*
+ * Same streams through one relay pair and through one rtpendpoint pair per
+ * stream. The relay has to deliver the same frame rate with fewer threads.
+ * CPU usage is only reported, it depends too much on the machine.
+ */
+GST_START_TEST (check_relay_vs_rtpendpoint)
+{
+  GstElement *relay_a, *relay_b;
+  Measure relay, rtp;
+  RelayTest test;
+
+  /* Measured first, so threads left over from it only penalize rtpendpoint */
+  relay_test_init (&test, N_BENCHMARK_STREAMS);
+  relay_test_connect_relays (&test, &relay_a, &relay_b);
+  gst_element_set_state (test.receiver, GST_STATE_PLAYING);
+  gst_element_set_state (test.sender, GST_STATE_PLAYING);
+  relay_test_measure (&test, &relay);
+  relay_test_clear (&test);
+
+  relay_test_init (&test, N_BENCHMARK_STREAMS);
+  gst_element_set_state (test.receiver, GST_STATE_PLAYING);
+  gst_element_set_state (test.sender, GST_STATE_PLAYING);
+  relay_test_connect_rtpendpoints (&test);
+  relay_test_measure (&test, &rtp);
+  relay_test_clear (&test);
+
+  GST_INFO ("%d streams with 1 relay pair: %.1f fps, %.0f%% CPU, %u threads",
+      N_BENCHMARK_STREAMS, relay.fps, relay.cpu * 100, relay.threads);
+  GST_INFO ("%d streams with %d rtpendpoint pairs: %.1f fps, %.0f%% CPU, %u "
+      "threads", N_BENCHMARK_STREAMS, N_BENCHMARK_STREAMS, rtp.fps,
+      rtp.cpu * 100, rtp.threads);
+
+  fail_unless (rtp.fps > 0);
+  fail_unless (relay.fps >= 0.9 * rtp.fps,
+      "Relay delivered %.1f fps, rtpendpoint %.1f fps", relay.fps, rtp.fps);
+  fail_unless (relay.threads < rtp.threads,
+      "Relay used %u threads, rtpendpoint %u", relay.threads, rtp.threads);
+}
+
+GST_END_TEST
+/*
+ * End of test cases
+ */
+static Suite *
+relayendpoint_suite (void)
+{
+  Suite *s = suite_create ("relayendpoint");
+  TCase *tc_chain = tcase_create ("element");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, check_relay_streams);
+  tcase_add_test (tc_chain, check_relay_vs_rtpendpoint);
+
+  return s;
+}
+
+GST_CHECK_MAIN (relayendpoint);
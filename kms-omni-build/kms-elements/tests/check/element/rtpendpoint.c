@@ -19,10 +19,14 @@
 #include <gst/sdp/gstsdpmessage.h>
 #include <gst/gst.h>
 #include <glib.h>
+#include <string.h>
 
 #include <kmstestutils.h>
 
 #include <commons/kmselementpadtype.h>
+#include <commons/kmslatencyprofile.h>
+#include <rtpendpoint/kmsportallocator.h>
+#include <rtpendpoint/kmssocketutils.h>
 
 #define KMS_VIDEO_PREFIX "video_src_"
 #define KMS_AUDIO_PREFIX "audio_src_"
@@ -38,6 +42,15 @@ G_DEFINE_QUARK (LOOP, loop);
 
 #define SINK_VIDEO_STREAM "sink_video_default"
 
+/* Frames are numbered with a row of black and white blocks in their top */
+#define LATENCY_WIDTH 320
+#define LATENCY_MARK_BITS 16
+#define LATENCY_MARK_WIDTH (LATENCY_WIDTH / LATENCY_MARK_BITS)
+#define LATENCY_MARK_HEIGHT 32
+#define LATENCY_WARMUP_FRAMES 15
+#define LATENCY_FRAMES 30
+#define LATENCY_CAPS "video/x-raw,format=I420,width=320,height=240"
+
 static GArray *
 create_codecs_array (gchar * codecs[])
 {
@@ -311,6 +324,253 @@ GST_START_TEST (loopback)
   g_free (receiver_sess_id);
 }
 
+GST_END_TEST
+typedef struct _LatencyData
+{
+  GMainLoop *loop;
+  GMutex mutex;
+  /* Capture time of each frame number */
+  gint64 *sent;
+  guint16 next;
+  guint received;
+  GArray *latencies;
+} LatencyData;
+
+static GstPadProbeReturn
+mark_frame_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  LatencyData *data = user_data;
+  GstBuffer *buffer;
+  GstMapInfo map;
+  guint16 mark;
+  guint row, bit;
+
+  buffer = gst_buffer_make_writable (GST_PAD_PROBE_INFO_BUFFER (info));
+  GST_PAD_PROBE_INFO_DATA (info) = buffer;
+
+  if (!gst_buffer_map (buffer, &map, GST_MAP_WRITE)) {
+    return GST_PAD_PROBE_OK;
+  }
+
+  g_mutex_lock (&data->mutex);
+  mark = data->next++;
+  data->sent[mark] = g_get_monotonic_time ();
+  g_mutex_unlock (&data->mutex);
+
+  /* Luma plane of I420, large blocks survive the encoder */
+  for (row = 0; row < LATENCY_MARK_HEIGHT; row++) {
+    for (bit = 0; bit < LATENCY_MARK_BITS; bit++) {
+      memset (map.data + row * LATENCY_WIDTH + bit * LATENCY_MARK_WIDTH,
+          (mark >> bit) & 1 ? 235 : 16, LATENCY_MARK_WIDTH);
+    }
+  }
+
+  gst_buffer_unmap (buffer, &map);
+
+  return GST_PAD_PROBE_OK;
+}
+
+static void
+latency_sink_hand_off (GstElement * fakesink, GstBuffer * buf, GstPad * pad,
+    gpointer user_data)
+{
+  LatencyData *data = user_data;
+  gint64 now = g_get_monotonic_time ();
+  const guint8 *row;
+  guint16 mark = 0;
+  GstMapInfo map;
+  gint64 latency;
+  guint bit;
+
+  if (!gst_buffer_map (buf, &map, GST_MAP_READ)) {
+    return;
+  }
+
+  row = map.data + (LATENCY_MARK_HEIGHT / 2) * LATENCY_WIDTH;
+
+  for (bit = 0; bit < LATENCY_MARK_BITS; bit++) {
+    if (row[bit * LATENCY_MARK_WIDTH + LATENCY_MARK_WIDTH / 2] > 128) {
+      mark |= 1 << bit;
+    }
+  }
+
+  gst_buffer_unmap (buf, &map);
+
+  g_mutex_lock (&data->mutex);
+
+  latency = now - data->sent[mark];
+
+  if (data->sent[mark] == 0 || ++data->received <= LATENCY_WARMUP_FRAMES
+      || data->latencies->len == LATENCY_FRAMES) {
+    g_mutex_unlock (&data->mutex);
+    return;
+  }
+
+  g_array_append_val (data->latencies, latency);
+
+  if (data->latencies->len == LATENCY_FRAMES) {
+    g_idle_add (quit_main_loop, data->loop);
+  }
+
+  g_mutex_unlock (&data->mutex);
+}
+
+static gint
+compare_latencies (gconstpointer a, gconstpointer b)
+{
+  gint64 la = *(const gint64 *) a;
+  gint64 lb = *(const gint64 *) b;
+
+  return (la > lb) - (la < lb);
+}
+
+/*
+ * Median time, in ms, from a frame being captured to it being rendered after
+ * going through an encoding rtpendpoint, UDP and a decoding rtpendpoint
+ */
+static gint64
+measure_latency (KmsLatencyProfile profile)
+{
+  GArray *video_codecs_array;
+  gchar *video_codecs[] = { "VP8/90000", NULL };
+  gchar *sender_sess_id, *receiver_sess_id;
+  GstSDPMessage *offer, *answer;
+  GstElement *pipeline = gst_pipeline_new (__FUNCTION__);
+  GstElement *videotestsrc = gst_element_factory_make ("videotestsrc", NULL);
+  GstElement *srccaps = gst_element_factory_make ("capsfilter", NULL);
+  GstElement *agnosticbin = gst_element_factory_make ("agnosticbin", NULL);
+  GstElement *sender = gst_element_factory_make ("rtpendpoint", NULL);
+  GstElement *receiver = gst_element_factory_make ("rtpendpoint", NULL);
+  GstElement *sinkcaps = gst_element_factory_make ("capsfilter", NULL);
+  GstElement *fakesink = gst_element_factory_make ("fakesink", NULL);
+  GstBus *bus = gst_pipeline_get_bus (GST_PIPELINE (pipeline));
+  GstContext *context;
+  LatencyData data;
+  gboolean answer_ok;
+  gint64 median;
+  GstCaps *caps;
+  GstPad *pad;
+
+  data.loop = g_main_loop_new (NULL, TRUE);
+  g_mutex_init (&data.mutex);
+  data.sent = g_new0 (gint64, 1 << LATENCY_MARK_BITS);
+  data.next = 0;
+  data.received = 0;
+  data.latencies = g_array_new (FALSE, FALSE, sizeof (gint64));
+
+  gst_bus_add_signal_watch (bus);
+  g_signal_connect (bus, "message", G_CALLBACK (bus_msg), pipeline);
+
+  /* Set first, so every element built afterwards takes the profile */
+  context = kms_latency_profile_context_new (profile);
+  gst_element_set_context (pipeline, context);
+  gst_context_unref (context);
+
+  video_codecs_array = create_codecs_array (video_codecs);
+  g_object_set (sender, "num-video-medias", 1, "video-codecs",
+      g_array_ref (video_codecs_array), NULL);
+  g_object_set (receiver, "num-video-medias", 1, "video-codecs",
+      g_array_ref (video_codecs_array), NULL);
+  g_array_unref (video_codecs_array);
+
+  g_object_set (videotestsrc, "is-live", TRUE, "pattern", 2 /* black */ ,
+      NULL);
+  caps = gst_caps_from_string (LATENCY_CAPS ",framerate=30/1");
+  g_object_set (srccaps, "caps", caps, NULL);
+  gst_caps_unref (caps);
+  caps = gst_caps_from_string (LATENCY_CAPS);
+  g_object_set (sinkcaps, "caps", caps, NULL);
+  gst_caps_unref (caps);
+
+  /* Rendered on time, as a real display would */
+  g_object_set (fakesink, "sync", TRUE, "async", FALSE, "signal-handoffs",
+      TRUE, NULL);
+  g_signal_connect (fakesink, "handoff", G_CALLBACK (latency_sink_hand_off),
+      &data);
+
+  pad = gst_element_get_static_pad (srccaps, "src");
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER, mark_frame_probe, &data,
+      NULL);
+  g_object_unref (pad);
+
+  connect_sink_async (sender, agnosticbin, pipeline, SINK_VIDEO_STREAM);
+
+  g_object_set_qdata (G_OBJECT (receiver), video_sink_quark (), sinkcaps);
+  g_signal_connect (receiver, "pad-added",
+      G_CALLBACK (connect_sink_on_srcpad_added), NULL);
+  fail_unless (kms_element_request_srcpad (receiver,
+          KMS_ELEMENT_PAD_TYPE_VIDEO));
+
+  gst_bin_add_many (GST_BIN (pipeline), videotestsrc, srccaps, agnosticbin,
+      sender, receiver, sinkcaps, fakesink, NULL);
+  gst_element_link_many (videotestsrc, srccaps, agnosticbin, NULL);
+  gst_element_link (sinkcaps, fakesink);
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  g_signal_emit_by_name (sender, "create-session", &sender_sess_id);
+  g_signal_emit_by_name (receiver, "create-session", &receiver_sess_id);
+
+  g_signal_emit_by_name (sender, "generate-offer", sender_sess_id, &offer);
+  fail_unless (offer != NULL);
+  g_signal_emit_by_name (receiver, "process-offer", receiver_sess_id, offer,
+      &answer);
+  fail_unless (answer != NULL);
+  g_signal_emit_by_name (sender, "process-answer", sender_sess_id, answer,
+      &answer_ok);
+  fail_unless (answer_ok);
+  gst_sdp_message_free (offer);
+  gst_sdp_message_free (answer);
+
+  mark_point ();
+  g_main_loop_run (data.loop);
+  mark_point ();
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+
+  g_array_sort (data.latencies, compare_latencies);
+  median = g_array_index (data.latencies, gint64, LATENCY_FRAMES / 2) / 1000;
+
+  gst_bus_remove_signal_watch (bus);
+  g_object_unref (bus);
+  g_object_unref (pipeline);
+  g_main_loop_unref (data.loop);
+  g_mutex_clear (&data.mutex);
+  g_free (data.sent);
+  g_array_unref (data.latencies);
+  g_free (sender_sess_id);
+  g_free (receiver_sess_id);
+
+  return median;
+}
+
+/* Glass-to-glass latency of each profile, through real encoding and RTP */
+GST_START_TEST (latency_profiles)
+{
+  gint64 interactive, standard, broadcast, recording;
+
+  interactive = measure_latency (KMS_LATENCY_PROFILE_INTERACTIVE);
+  standard = measure_latency (KMS_LATENCY_PROFILE_DEFAULT);
+  broadcast = measure_latency (KMS_LATENCY_PROFILE_BROADCAST);
+  recording = measure_latency (KMS_LATENCY_PROFILE_RECORDING);
+
+  GST_INFO ("Median glass-to-glass latency: interactive %" G_GINT64_FORMAT
+      " ms, default %" G_GINT64_FORMAT " ms, broadcast %" G_GINT64_FORMAT
+      " ms, recording %" G_GINT64_FORMAT " ms", interactive, standard,
+      broadcast, recording);
+
+  /* Jitter buffer targets are far enough apart to dominate the noise */
+  fail_unless (interactive < standard,
+      "Interactive %" G_GINT64_FORMAT " ms, default %" G_GINT64_FORMAT " ms",
+      interactive, standard);
+  fail_unless (standard < broadcast,
+      "Default %" G_GINT64_FORMAT " ms, broadcast %" G_GINT64_FORMAT " ms",
+      standard, broadcast);
+  fail_unless (broadcast < recording,
+      "Broadcast %" G_GINT64_FORMAT " ms, recording %" G_GINT64_FORMAT " ms",
+      broadcast, recording);
+}
+
 GST_END_TEST
 GST_START_TEST (negotiation_offerer)
 {
@@ -839,6 +1099,85 @@ GST_START_TEST (test_not_enough_ports)
   g_free (offerer_sess_id);
 }
 
+GST_END_TEST;
+
+GST_START_TEST (port_allocator_fill_range)
+{
+  GSocket *rtp[4], *rtcp[4], *extra_rtp = NULL, *extra_rtcp = NULL;
+  guint16 min_port = 51000, max_port = 51007;
+  GstStructure *stats;
+  guint in_use;
+  guint i;
+
+  kms_port_allocator_set_quarantine (0);
+
+  for (i = 0; i < G_N_ELEMENTS (rtp); i++) {
+    guint16 port;
+
+    fail_unless (kms_port_allocator_acquire_pair (min_port, max_port,
+            G_SOCKET_FAMILY_IPV4, &rtp[i], &rtcp[i]));
+
+    port = kms_socket_get_port (rtp[i]);
+    GST_DEBUG ("Pair %u: %u", i, port);
+    fail_unless (port % 2 == 0);
+    fail_unless_equals_int (kms_socket_get_port (rtcp[i]), port + 1);
+    fail_if (port < min_port);
+    fail_if (port + 1 > max_port);
+  }
+
+  /* Range is full */
+  fail_if (kms_port_allocator_acquire_pair (min_port, max_port,
+          G_SOCKET_FAMILY_IPV4, &extra_rtp, &extra_rtcp));
+
+  stats = kms_port_allocator_get_stats ();
+  fail_unless (gst_structure_get_uint (stats, "pairs-in-use", &in_use));
+  fail_unless_equals_int (in_use, G_N_ELEMENTS (rtp));
+  gst_structure_free (stats);
+
+  for (i = 0; i < G_N_ELEMENTS (rtp); i++) {
+    kms_socket_finalize (&rtp[i]);
+    kms_socket_finalize (&rtcp[i]);
+  }
+
+  /* Without quarantine, released pairs can be used again right away */
+  fail_unless (kms_port_allocator_acquire_pair (min_port, max_port,
+          G_SOCKET_FAMILY_IPV4, &extra_rtp, &extra_rtcp));
+  kms_socket_finalize (&extra_rtp);
+  kms_socket_finalize (&extra_rtcp);
+
+  stats = kms_port_allocator_get_stats ();
+  fail_unless (gst_structure_get_uint (stats, "pairs-in-use", &in_use));
+  fail_unless_equals_int (in_use, 0);
+  gst_structure_free (stats);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (port_allocator_quarantine)
+{
+  GSocket *rtp = NULL, *rtcp = NULL;
+  guint16 min_port = 52000, max_port = 52001;
+  GstStructure *stats;
+  guint quarantined;
+
+  kms_port_allocator_set_quarantine (60 * G_USEC_PER_SEC);
+
+  fail_unless (kms_port_allocator_acquire_pair (min_port, max_port,
+          G_SOCKET_FAMILY_IPV4, &rtp, &rtcp));
+  kms_socket_finalize (&rtp);
+  kms_socket_finalize (&rtcp);
+
+  /* The only pair in range was just released */
+  fail_if (kms_port_allocator_acquire_pair (min_port, max_port,
+          G_SOCKET_FAMILY_IPV4, &rtp, &rtcp));
+
+  stats = kms_port_allocator_get_stats ();
+  fail_unless (gst_structure_get_uint (stats, "pairs-quarantined",
+          &quarantined));
+  fail_unless_equals_int (quarantined, 1);
+  gst_structure_free (stats);
+}
+
 GST_END_TEST;
 /*
  * End of test cases
@@ -854,10 +1193,13 @@ sdp_suite (void)
   tcase_add_test (tc_chain, negotiation_offerer);
   tcase_add_test (tc_chain, negotiation_offerer_ipv6);
   tcase_add_test (tc_chain, loopback);
+  tcase_add_test (tc_chain, latency_profiles);
   tcase_add_test (tc_chain, process_bundle_offer);
   tcase_add_test (tc_chain, generate_offer_bw_limited);
   tcase_add_test (tc_chain, test_port_range);
   tcase_add_test (tc_chain, test_not_enough_ports);
+  tcase_add_test (tc_chain, port_allocator_fill_range);
+  tcase_add_test (tc_chain, port_allocator_quarantine);
 
   return s;
 }
@@ -0,0 +1,295 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/check/gstcheck.h>
+#include <gst/gst.h>
+
+#define KMS_ELEMENT_PAD_TYPE_AUDIO 1
+
+#define SINK_AUDIO_STREAM "sink_audio_default"
+
+#define BUFFERS_TO_RECEIVE 20
+#define UNKNOWN_PORT 1000
+
+static GstElement *pipeline;
+static GMainLoop *loop;
+static gchar *listener_pad;
+static gint buffers;
+
+static gboolean
+quit_main_loop_idle (gpointer data)
+{
+  g_main_loop_quit (data);
+  return FALSE;
+}
+
+static void
+handoff_cb (GstElement * object, GstBuffer * buffer, GstPad * pad,
+    gpointer user_data)
+{
+  if (g_atomic_int_add (&buffers, 1) + 1 == BUFFERS_TO_RECEIVE) {
+    g_idle_add (quit_main_loop_idle, loop);
+  }
+}
+
+static void
+srcpad_added (GstElement * hubport, GstPad * new_pad, gpointer user_data)
+{
+  GstElement *audiosrc, *fakesink;
+  GstPad *pad;
+  gchar *padname;
+
+  GST_INFO_OBJECT (hubport, "Pad added %" GST_PTR_FORMAT, new_pad);
+
+  padname = gst_pad_get_name (new_pad);
+  fail_if (padname == NULL);
+
+  if (g_strcmp0 (padname, SINK_AUDIO_STREAM) == 0) {
+    audiosrc = gst_element_factory_make ("audiotestsrc", NULL);
+    g_object_set (G_OBJECT (audiosrc), "is-live", TRUE, "freq",
+        GPOINTER_TO_INT (user_data) * 220.0, NULL);
+    gst_bin_add (GST_BIN (pipeline), audiosrc);
+
+    pad = gst_element_get_static_pad (audiosrc, "src");
+    fail_if (gst_pad_link (pad, new_pad) != GST_PAD_LINK_OK);
+    gst_element_sync_state_with_parent (audiosrc);
+    g_object_unref (pad);
+  } else if (g_strcmp0 (padname, listener_pad) == 0) {
+    fakesink = gst_element_factory_make ("fakesink", NULL);
+    g_object_set (G_OBJECT (fakesink), "async", FALSE, "sync", FALSE,
+        "signal-handoffs", TRUE, NULL);
+    g_signal_connect (fakesink, "handoff", G_CALLBACK (handoff_cb), NULL);
+    gst_bin_add (GST_BIN (pipeline), fakesink);
+
+    pad = gst_element_get_static_pad (fakesink, "sink");
+    fail_if (gst_pad_link (new_pad, pad) != GST_PAD_LINK_OK);
+    gst_element_sync_state_with_parent (fakesink);
+    g_object_unref (pad);
+  }
+
+  g_free (padname);
+}
+
+static guint
+count_audiomixers (GstElement * mixer)
+{
+  GValue item = G_VALUE_INIT;
+  gboolean done = FALSE;
+  GstIterator *it;
+  guint count = 0;
+
+  it = gst_bin_iterate_elements (GST_BIN (mixer));
+
+  while (!done) {
+    switch (gst_iterator_next (it, &item)) {
+      case GST_ITERATOR_OK:{
+        GstElement *element = g_value_get_object (&item);
+        GstElementFactory *factory = gst_element_get_factory (element);
+
+        if (factory != NULL
+            && g_strcmp0 (GST_OBJECT_NAME (factory), "audiomixerbin") == 0) {
+          count++;
+        }
+
+        g_value_reset (&item);
+        break;
+      }
+      case GST_ITERATOR_RESYNC:
+        gst_iterator_resync (it);
+        count = 0;
+        break;
+      case GST_ITERATOR_ERROR:
+      case GST_ITERATOR_DONE:
+        done = TRUE;
+        break;
+    }
+  }
+
+  g_value_unset (&item);
+  gst_iterator_free (it);
+
+  return count;
+}
+
+static void
+wait_for_audio (void)
+{
+  g_atomic_int_set (&buffers, 0);
+
+  mark_point ();
+  g_main_loop_run (loop);
+  mark_point ();
+}
+
+static GstElement *
+create_port (gint freq_factor)
+{
+  GstElement *hubport = gst_element_factory_make ("hubport", NULL);
+
+  gst_bin_add (GST_BIN (pipeline), hubport);
+  g_signal_connect (hubport, "pad-added", G_CALLBACK (srcpad_added),
+      GINT_TO_POINTER (freq_factor));
+
+  return hubport;
+}
+
+GST_START_TEST (connect_audio)
+{
+  GstElement *mixer, *hubport1, *hubport2, *hubport3;
+  gint id1, id2, id3;
+  gboolean ret;
+
+  loop = g_main_loop_new (NULL, FALSE);
+  pipeline = gst_pipeline_new (__FUNCTION__);
+  mixer = gst_element_factory_make ("selectablemixer", NULL);
+  gst_bin_add (GST_BIN (pipeline), mixer);
+
+  hubport1 = create_port (1);
+  hubport2 = create_port (2);
+  hubport3 = create_port (3);
+
+  g_signal_emit_by_name (hubport3, "request-new-pad",
+      KMS_ELEMENT_PAD_TYPE_AUDIO, NULL, GST_PAD_SRC, &listener_pad);
+  fail_if (listener_pad == NULL);
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  g_signal_emit_by_name (mixer, "handle-port", hubport1, &id1);
+  g_signal_emit_by_name (mixer, "handle-port", hubport2, &id2);
+  g_signal_emit_by_name (mixer, "handle-port", hubport3, &id3);
+
+  /* A single source is passed through, no mixer */
+  g_signal_emit_by_name (mixer, "connect-audio", id1, id3, &ret);
+  fail_unless (ret);
+  fail_unless (count_audiomixers (mixer) == 0);
+  wait_for_audio ();
+
+  /* Two sources are mixed */
+  g_signal_emit_by_name (mixer, "connect-audio", id2, id3, &ret);
+  fail_unless (ret);
+  fail_unless (count_audiomixers (mixer) == 1);
+  wait_for_audio ();
+
+  /* Connecting again changes nothing */
+  g_signal_emit_by_name (mixer, "connect-audio", id2, id3, &ret);
+  fail_unless (ret);
+  fail_unless (count_audiomixers (mixer) == 1);
+
+  /* Back to a single source, the mixer goes away and audio keeps flowing */
+  g_signal_emit_by_name (mixer, "disconnect-audio", id2, id3, &ret);
+  fail_unless (ret);
+  fail_unless (count_audiomixers (mixer) == 0);
+  wait_for_audio ();
+
+  g_signal_emit_by_name (mixer, "disconnect-audio", id1, id3, &ret);
+  fail_unless (ret);
+  fail_unless (count_audiomixers (mixer) == 0);
+
+  g_signal_emit_by_name (mixer, "unhandle-port", id1);
+  g_signal_emit_by_name (mixer, "unhandle-port", id2);
+  g_signal_emit_by_name (mixer, "unhandle-port", id3);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+  g_main_loop_unref (loop);
+  g_free (listener_pad);
+}
+
+GST_END_TEST
+GST_START_TEST (connect_audio_failures)
+{
+  GstElement *mixer, *hubport1, *hubport2, *hubport3;
+  gint id1, id2, id3;
+  gboolean ret;
+
+  loop = g_main_loop_new (NULL, FALSE);
+  pipeline = gst_pipeline_new (__FUNCTION__);
+  mixer = gst_element_factory_make ("selectablemixer", NULL);
+  gst_bin_add (GST_BIN (pipeline), mixer);
+
+  hubport1 = create_port (1);
+  hubport2 = create_port (2);
+  hubport3 = create_port (3);
+
+  g_signal_emit_by_name (hubport3, "request-new-pad",
+      KMS_ELEMENT_PAD_TYPE_AUDIO, NULL, GST_PAD_SRC, &listener_pad);
+  fail_if (listener_pad == NULL);
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+
+  g_signal_emit_by_name (mixer, "handle-port", hubport1, &id1);
+  g_signal_emit_by_name (mixer, "handle-port", hubport2, &id2);
+  g_signal_emit_by_name (mixer, "handle-port", hubport3, &id3);
+
+  g_signal_emit_by_name (mixer, "connect-audio", UNKNOWN_PORT, id3, &ret);
+  fail_if (ret);
+  g_signal_emit_by_name (mixer, "connect-audio", id1, UNKNOWN_PORT, &ret);
+  fail_if (ret);
+  g_signal_emit_by_name (mixer, "disconnect-audio", id1, id3, &ret);
+  fail_if (ret);
+  fail_unless (count_audiomixers (mixer) == 0);
+
+  /* Failures leave the current selection untouched */
+  g_signal_emit_by_name (mixer, "connect-audio", id1, id3, &ret);
+  fail_unless (ret);
+  g_signal_emit_by_name (mixer, "connect-audio", UNKNOWN_PORT, id3, &ret);
+  fail_if (ret);
+  fail_unless (count_audiomixers (mixer) == 0);
+  wait_for_audio ();
+
+  g_signal_emit_by_name (mixer, "connect-audio", id2, id3, &ret);
+  fail_unless (ret);
+  g_signal_emit_by_name (mixer, "disconnect-audio", UNKNOWN_PORT, id3, &ret);
+  fail_if (ret);
+  fail_unless (count_audiomixers (mixer) == 1);
+  wait_for_audio ();
+
+  /* Removing a mixed port drops it from the selection and the mixer */
+  g_signal_emit_by_name (mixer, "unhandle-port", id2);
+  fail_unless (count_audiomixers (mixer) == 0);
+  wait_for_audio ();
+
+  g_signal_emit_by_name (mixer, "unhandle-port", id1);
+  g_signal_emit_by_name (mixer, "unhandle-port", id3);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+  g_main_loop_unref (loop);
+  g_free (listener_pad);
+}
+
+GST_END_TEST
+/*
+ * End of test cases
+ */
+static Suite *
+selectable_mixer_suite (void)
+{
+  Suite *s = suite_create ("selectablemixer");
+  TCase *tc_chain = tcase_create ("element");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, connect_audio);
+  tcase_add_test (tc_chain, connect_audio_failures);
+
+  return s;
+}
+
+GST_CHECK_MAIN (selectable_mixer);
@@ -18,6 +18,7 @@
 #include <gst/check/gstcheck.h>
 #include <gst/sdp/gstsdpmessage.h>
 #include <webrtcendpoint/kmsicecandidate.h>
+#include <webrtcendpoint/kmsdtlscertificate.h>
 
 #include <commons/kmselementpadtype.h>
 #include <commons/kmsutils.h>
@@ -1858,6 +1859,46 @@ GST_START_TEST (test_vp8_sendonly_recvonly_ecdsa)
 }
 GST_END_TEST
 
+GST_START_TEST (test_dtls_certificate_cache)
+{
+  KmsDtlsCertificate *rsa, *rsa2, *ecdsa;
+  gchar *fingerprint;
+  guint count = kms_dtls_certificate_get_cached_count ();
+
+  rsa = kms_dtls_certificate_get (rsa_pem);
+  rsa2 = kms_dtls_certificate_get (rsa_pem);
+  ecdsa = kms_dtls_certificate_get (ecdsa_pem);
+
+  fail_unless (rsa != NULL && ecdsa != NULL);
+  fail_unless (rsa == rsa2);
+  fail_unless (rsa != ecdsa);
+  fail_unless (kms_dtls_certificate_get_x509 (rsa) != NULL);
+  fail_unless (kms_dtls_certificate_get_private_key (ecdsa) != NULL);
+  fail_unless_equals_int (kms_dtls_certificate_get_cached_count (),
+      count + 2);
+
+  /* Same fingerprint the SDP used to carry */
+  fingerprint = kms_utils_generate_fingerprint_from_pem (rsa_pem);
+  fail_unless_equals_string (kms_dtls_certificate_get_fingerprint (rsa),
+      fingerprint);
+  g_free (fingerprint);
+
+  fingerprint = kms_utils_generate_fingerprint_from_pem (ecdsa_pem);
+  fail_unless_equals_string (kms_dtls_certificate_get_fingerprint (ecdsa),
+      fingerprint);
+  g_free (fingerprint);
+
+  fail_unless (kms_dtls_certificate_get ("not a certificate") == NULL);
+
+  kms_dtls_certificate_unref (rsa);
+  fail_unless_equals_int (kms_dtls_certificate_get_cached_count (),
+      count + 2);
+  kms_dtls_certificate_unref (rsa2);
+  kms_dtls_certificate_unref (ecdsa);
+  fail_unless_equals_int (kms_dtls_certificate_get_cached_count (), count);
+}
+GST_END_TEST
+
 GST_START_TEST (test_vp8_sendrecv)
 {
   test_video_sendrecv ("vp8enc", vp8_expected_caps, "VP8/90000", FALSE, FALSE);
@@ -2500,6 +2541,7 @@ webrtcendpoint_test_suite (void)
   tcase_add_test (tc_chain, test_vp8_sendonly_recvonly);
   tcase_add_test (tc_chain, test_vp8_sendonly_recvonly_rsa);
   tcase_add_test (tc_chain, test_vp8_sendonly_recvonly_ecdsa);
+  tcase_add_test (tc_chain, test_dtls_certificate_cache);
   tcase_add_test (tc_chain, test_vp8_sendrecv);
   tcase_add_test (tc_chain, test_offerer_pcmu_vp8_answerer_vp8_sendrecv);
   tcase_add_test (tc_chain, test_pcmu_vp8_sendrecv);
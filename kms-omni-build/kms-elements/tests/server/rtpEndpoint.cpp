@@ -30,6 +30,7 @@
 #include <MediaElementImpl.hpp>
 #include <ConnectionState.hpp>
 #include <MediaState.hpp>
+#include <atomic>
 
 using namespace kurento;
 using namespace boost::unit_test;
@@ -247,6 +248,142 @@ connection_state_changes_ipv6 ()
   connection_state_changes_impl (true);
 }
 
+struct FlowData {
+  std::atomic<int> buffers{};
+  std::condition_variable cv;
+  std::mutex mtx;
+};
+
+static GstPadProbeReturn
+count_buffers (GstPad *pad, GstPadProbeInfo *info, gpointer user_data)
+{
+  FlowData *data = (FlowData *) user_data;
+
+  data->buffers++;
+  data->cv.notify_all();
+
+  return GST_PAD_PROBE_OK;
+}
+
+static bool
+wait_for_media (FlowData &data)
+{
+  std::unique_lock<std::mutex> lck (data.mtx);
+
+  data.buffers = 0;
+
+  return data.cv.wait_for (lck, std::chrono::seconds (5), [&] () {
+    return data.buffers.load() >= 10;
+  });
+}
+
+static GstState
+get_state (std::shared_ptr<MediaPipelineImpl> pipeline)
+{
+  GstState state;
+
+  gst_element_get_state (pipeline->getPipeline (), &state, nullptr,
+                         GST_SECOND);
+
+  return state;
+}
+
+static void
+idle_session_resumes ()
+{
+  std::string sessionId = "idleSession";
+  std::shared_ptr<MediaSet> mediaSet = MediaSet::getMediaSet();
+  auto start = std::chrono::steady_clock::now ();
+  auto elapsed = std::make_shared<std::atomic<int>> (0);
+  std::shared_ptr <MediaPipelineImpl> pipeline;
+  std::shared_ptr <RtpEndpointImpl> rtpEpOfferer, rtpEpAnswerer;
+  std::shared_ptr <MediaElementImpl> src, sink;
+  Json::Value constructorParams;
+  FlowData data;
+  gulong probeId;
+  GstPad *pad;
+
+  BOOST_TEST_MESSAGE ("Start test: idle_session_resumes");
+
+  MediaSet::setCollectorInterval (std::chrono::seconds (240) );
+  MediaSet::setIdleTimeouts (std::chrono::seconds (30),
+                             std::chrono::seconds (0) );
+  MediaSet::setClock ([start, elapsed] () {
+    return start + std::chrono::seconds (elapsed->load () );
+  });
+
+  pipeline = std::dynamic_pointer_cast <MediaPipelineImpl> (
+               moduleManager.getFactory ("MediaPipeline")->createObject (
+                 config, sessionId, Json::Value() ) );
+
+  constructorParams ["mediaPipeline"] = pipeline->getId();
+  rtpEpOfferer = std::dynamic_pointer_cast <RtpEndpointImpl> (
+                   moduleManager.getFactory ("RtpEndpoint")->createObject (
+                     config, sessionId, constructorParams) );
+  rtpEpAnswerer = std::dynamic_pointer_cast <RtpEndpointImpl> (
+                    moduleManager.getFactory ("RtpEndpoint")->createObject (
+                      config, sessionId, constructorParams) );
+
+  src = std::dynamic_pointer_cast <MediaElementImpl> (mediaSet->ref (
+          new MediaElementImpl (boost::property_tree::ptree(), pipeline,
+                                "dummysrc") ) );
+  mediaSet->ref (sessionId, src);
+  g_object_set (src->getGstreamerElement(), "video", TRUE, NULL);
+
+  sink = std::dynamic_pointer_cast <MediaElementImpl> (mediaSet->ref (
+           new MediaElementImpl (boost::property_tree::ptree(), pipeline,
+                                 "dummysink") ) );
+  mediaSet->ref (sessionId, sink);
+  g_object_set (sink->getGstreamerElement(), "video", TRUE, NULL);
+
+  pad = gst_element_get_static_pad (sink->getGstreamerElement(),
+                                    "sink_video_default");
+  BOOST_REQUIRE (pad != nullptr);
+  probeId = gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER, count_buffers,
+                               &data, nullptr);
+
+  src->connect (rtpEpOfferer);
+  rtpEpAnswerer->connect (sink);
+
+  std::string offer = rtpEpOfferer->generateOffer ();
+  std::string answer = rtpEpAnswerer->processOffer (offer);
+  rtpEpOfferer->processAnswer (answer);
+
+  BOOST_CHECK (wait_for_media (data) );
+
+  // The client goes away, the pipeline is paused
+  *elapsed = 31;
+  mediaSet->doGarbageCollection ();
+
+  BOOST_CHECK (mediaSet->getSessionStage (sessionId) ==
+               MediaSet::SessionStage::PAUSED);
+  BOOST_CHECK (get_state (pipeline) == GST_STATE_READY);
+
+  // And comes back, media has to flow again through the same endpoints
+  mediaSet->keepAliveSession (sessionId);
+  mediaSet->doGarbageCollection ();
+
+  BOOST_CHECK (mediaSet->getSessionStage (sessionId) ==
+               MediaSet::SessionStage::ACTIVE);
+  BOOST_CHECK (get_state (pipeline) == GST_STATE_PLAYING);
+  BOOST_CHECK (wait_for_media (data) );
+
+  gst_pad_remove_probe (pad, probeId);
+  g_object_unref (pad);
+
+  MediaSet::setClock (MediaSet::Clock () );
+  MediaSet::setIdleTimeouts (std::chrono::seconds (0),
+                             std::chrono::seconds (0) );
+  MediaSet::setCollectorInterval (std::chrono::seconds (5) );
+
+  src.reset();
+  sink.reset();
+  rtpEpOfferer.reset();
+  rtpEpAnswerer.reset();
+  pipeline.reset();
+  mediaSet->releaseSession (sessionId);
+}
+
 test_suite *
 init_unit_test_suite ( int , char *[] )
 {
@@ -260,6 +397,7 @@ init_unit_test_suite ( int , char *[] )
   test->add (BOOST_TEST_CASE ( &media_state_changes_ipv6 ), 0, /* timeout */ 15);
   test->add (BOOST_TEST_CASE ( &connection_state_changes_ipv6 ),
              0, /* timeout */ 15);
+  test->add (BOOST_TEST_CASE ( &idle_session_resumes ), 0, /* timeout */ 30);
 
   return test;
 }
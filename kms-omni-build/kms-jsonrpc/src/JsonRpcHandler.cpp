@@ -18,6 +18,11 @@
 #include "JsonRpcHandler.hpp"
 #include "JsonRpcConstants.hpp"
 
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+
 #define JSON_RPC_ERROR_INVALID_REQUEST "Invalid JSON-RPC request."
 
 namespace kurento
@@ -27,6 +32,21 @@ namespace JsonRpc
 
 using namespace ErrorCode;
 
+const std::string Handler::BATCH_EXCLUSIVE = "*";
+
+struct Handler::BatchState {
+  Json::Value msg;
+  std::vector<Json::Value> responses;
+  Completion done;
+
+  std::mutex mutex;
+  Json::Value::ArrayIndex finished = 0;
+
+  /* Requests each one is waiting for, and requests waiting for each one */
+  std::vector<size_t> blockers;
+  std::vector<std::vector<Json::Value::ArrayIndex>> dependents;
+};
+
 void
 Handler::addMethod (const std::string &name, Method method)
 {
@@ -76,30 +96,261 @@ Handler::checkProtocol (const Json::Value &msg, Json::Value &error)
 bool
 Handler::process (const Json::Value &msg, Json::Value &_response)
 {
-  Json::Value error;
-  std::string methodName;
+  /* An empty batch is rejected as an invalid request */
+  if (msg.isArray() && msg.size() > 0) {
+    return processBatch (msg, _response);
+  }
 
-  if (!checkProtocol (msg, error) ) {
-    _response = error;
+  return processRequest (msg, _response);
+}
+
+/* Responses keep the order of the requests, notifications have none */
+static void
+collectBatchResponses (const std::vector<Json::Value> &responses,
+                       Json::Value &_response)
+{
+  Json::Value::ArrayIndex j = 0;
+
+  for (auto &response : responses) {
+    if (response != Json::Value::null) {
+      _response[j] = response;
+      j++;
+    }
+  }
+}
+
+bool
+Handler::processBatch (const Json::Value &msg, Json::Value &_response)
+{
+  std::vector<Json::Value> responses (msg.size() );
+  Json::Value::ArrayIndex i = 0;
+
+  if (canRunConcurrently (msg) ) {
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool finished = false;
+
+    startBatch (msg, [&] (const Json::Value & response) {
+      std::unique_lock<std::mutex> lock (mutex);
+
+      _response = response;
+      finished = true;
+      cond.notify_all ();
+    });
+
+    std::unique_lock<std::mutex> lock (mutex);
+
+    cond.wait (lock, [&] () {
+      return finished;
+    });
+
+    return true;
+  }
+
+  for (i = 0 ; i < msg.size() ; i++) {
+    runBatchRequest (msg, i, responses);
+  }
+
+  collectBatchResponses (responses, _response);
+
+  return true;
+}
+
+bool
+Handler::processAsync (const Json::Value &msg, Completion done)
+{
+  if (!msg.isArray () || !canRunConcurrently (msg) ) {
     return false;
   }
 
-  if (msg.isArray() ) {
-    Json::Value::ArrayIndex i = 0;
-    Json::Value::ArrayIndex j = 0;
+  startBatch (msg, done);
+
+  return true;
+}
+
+bool
+Handler::canRunConcurrently (const Json::Value &msg)
+{
+  return batchExecutor && batchKeys && msg.size() > 1;
+}
+
+void
+Handler::startBatch (const Json::Value &msg, Completion done)
+{
+  std::shared_ptr<BatchState> state = std::make_shared<BatchState> ();
+  std::map<std::string, Json::Value::ArrayIndex> lastUser;
+  std::vector<Json::Value::ArrayIndex> sinceExclusive;
+  std::vector<std::vector<std::string>> batchKeyList;
+  Json::Value::ArrayIndex lastExclusive = 0;
+  bool exclusiveSeen = false;
+  Json::Value::ArrayIndex i;
+
+  state->msg = msg;
+  state->responses.resize (msg.size() );
+  state->done = done;
+  state->blockers.resize (msg.size() );
+  state->dependents.resize (msg.size() );
+
+  /* Each request waits for the last previous one that shares a key */
+  for (i = 0 ; i < msg.size() ; i++) {
+    std::set<Json::Value::ArrayIndex> deps;
+    std::vector<std::string> keys;
+
+    try {
+      keys = batchKeys (msg[i], i, batchKeyList);
+    } catch (...) {
+      keys.clear ();
+      keys.push_back (BATCH_EXCLUSIVE);
+    }
+
+    batchKeyList.push_back (keys);
 
-    for (i = 0 ; i < msg.size() ; i++) {
-      Json::Value ret;
+    if (exclusiveSeen) {
+      deps.insert (lastExclusive);
+    }
+
+    if (std::find (keys.begin(), keys.end(), BATCH_EXCLUSIVE) != keys.end() ) {
+      deps.insert (sinceExclusive.begin(), sinceExclusive.end() );
 
-      process (msg[i], ret);
+      sinceExclusive.clear ();
+      lastUser.clear ();
+      lastExclusive = i;
+      exclusiveSeen = true;
+    } else {
+      for (auto &key : keys) {
+        auto it = lastUser.find (key);
+
+        if (it != lastUser.end() ) {
+          deps.insert (it->second);
+        }
 
-      if (ret != Json::Value::null) {
-        _response[j] = ret;
-        j++;
+        lastUser[key] = i;
       }
+
+      sinceExclusive.push_back (i);
     }
 
-    return true;
+    for (auto dep : deps) {
+      state->dependents[dep].push_back (i);
+    }
+
+    state->blockers[i] = deps.size();
+  }
+
+  /* Find them all before starting any, running requests update blockers */
+  std::vector<Json::Value::ArrayIndex> ready;
+
+  for (i = 0 ; i < msg.size() ; i++) {
+    if (state->blockers[i] == 0) {
+      ready.push_back (i);
+    }
+  }
+
+  for (auto index : ready) {
+    batchExecutor (std::bind (&Handler::runBatchTask, this, state, index) );
+  }
+}
+
+void
+Handler::runBatchTask (std::shared_ptr<BatchState> state,
+                       Json::Value::ArrayIndex index)
+{
+  while (true) {
+    std::vector<Json::Value::ArrayIndex> ready;
+
+    runBatchRequest (state->msg, index, state->responses);
+
+    std::unique_lock<std::mutex> lock (state->mutex);
+
+    for (auto dep : state->dependents[index]) {
+      if (--state->blockers[dep] == 0) {
+        ready.push_back (dep);
+      }
+    }
+
+    state->finished++;
+
+    if (state->finished == state->msg.size() ) {
+      Json::Value response;
+
+      lock.unlock ();
+
+      /* Every other task is over, nobody else touches the responses */
+      collectBatchResponses (state->responses, response);
+      state->done (response);
+      return;
+    }
+
+    lock.unlock ();
+
+    if (ready.empty () ) {
+      return;
+    }
+
+    /* Keep running the first unblocked request in this thread */
+    for (size_t k = 1; k < ready.size(); k++) {
+      batchExecutor (std::bind (&Handler::runBatchTask, this, state,
+                                ready[k]) );
+    }
+
+    index = ready[0];
+  }
+}
+
+void
+Handler::runBatchRequest (const Json::Value &msg, Json::Value::ArrayIndex index,
+                          std::vector<Json::Value> &responses)
+{
+  Json::Value request = msg[index];
+  Json::Value &response = responses[index];
+
+  try {
+    if (batchPrepare && request.isObject () ) {
+      batchPrepare (request, index, responses);
+    }
+
+    processRequest (request, response);
+  } catch (CallException &e) {
+    Json::Value error;
+    Json::Value data;
+
+    response[JSON_RPC_ID] = request.isMember (JSON_RPC_ID) ? request[JSON_RPC_ID] :
+                            Json::Value::null;
+    response[JSON_RPC_PROTO] = JSON_RPC_PROTO_VERSION;
+
+    error[JSON_RPC_ERROR_CODE] = e.getCode();
+    error[JSON_RPC_ERROR_MESSAGE] = e.getMessage();
+
+    data = e.getData();
+
+    if (data != Json::Value::null) {
+      error[JSON_RPC_ERROR_DATA] = data;
+    }
+
+    response[JSON_RPC_ERROR] = error;
+  } catch (...) {
+    Json::Value error;
+
+    response[JSON_RPC_ID] = request.isMember (JSON_RPC_ID) ? request[JSON_RPC_ID] :
+                            Json::Value::null;
+    response[JSON_RPC_PROTO] = JSON_RPC_PROTO_VERSION;
+
+    error[JSON_RPC_ERROR_CODE] = INTERNAL_ERROR;
+    error[JSON_RPC_ERROR_MESSAGE] = "Unexpected error while processing method";
+
+    response[JSON_RPC_ERROR] = error;
+  }
+}
+
+bool
+Handler::processRequest (const Json::Value &msg, Json::Value &_response)
+{
+  Json::Value error;
+  std::string methodName;
+
+  if (!checkProtocol (msg, error) ) {
+    _response = error;
+    return false;
   }
 
   _response[JSON_RPC_ID] = msg.isMember (JSON_RPC_ID) ? msg[JSON_RPC_ID] :
@@ -247,5 +498,18 @@ Handler::setPostProcess (std::function
   postproc = func;
 }
 
+void
+Handler::setBatchExecutor (Executor executor, BatchKeys keys)
+{
+  batchExecutor = executor;
+  batchKeys = keys;
+}
+
+void
+Handler::setBatchPrepare (BatchPrepare func)
+{
+  batchPrepare = func;
+}
+
 } /* JsonRpc */
 } /* kurento */
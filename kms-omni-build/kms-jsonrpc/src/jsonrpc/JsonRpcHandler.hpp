@@ -22,6 +22,7 @@
 #include <functional>
 #include <memory>
 #include <map>
+#include <vector>
 
 #include <json/json.h>
 #include "JsonRpcException.hpp"
@@ -41,20 +42,76 @@ public:
   typedef std::function<void (const Json::Value &, Json::Value &) >
   Method;
 
+  /* Runs a task in some other thread */
+  typedef std::function<void (std::function<void () >) > Executor;
+
+  /*
+   * Names the resources touched by the request at the given index of a
+   * batch, given the keys of the requests before it. Requests that share
+   * any of them run in the order of the batch, the rest may run
+   * concurrently.
+   */
+  typedef std::function<std::vector<std::string> (const Json::Value &,
+          Json::Value::ArrayIndex,
+          const std::vector<std::vector<std::string>> &) > BatchKeys;
+
+  /*
+   * Called before running the request at the given index of a batch, with
+   * the responses of the batch. Only the responses of requests that share a
+   * key with this one are guaranteed to be complete.
+   */
+  typedef std::function<void (Json::Value &, Json::Value::ArrayIndex,
+                              const std::vector<Json::Value> &) > BatchPrepare;
+
+  /* Receives the response of a message processed asynchronously */
+  typedef std::function<void (const Json::Value &) > Completion;
+
+  /* Key of a batch request that has to run alone */
+  static const std::string BATCH_EXCLUSIVE;
+
   void addMethod (const std::string &name, Method method);
   bool process (const std::string &msg, std::string &_responseMsg);
   bool process (const Json::Value &msg, Json::Value &_response);
+
+  /*
+   * Starts a batch on the batch executor and returns true. The thread that
+   * runs its last request calls @done with the response. Returns false,
+   * doing nothing, if @msg is not a batch that can run concurrently.
+   */
+  bool processAsync (const Json::Value &msg, Completion done);
   void setPreProcess (std::function < bool (const Json::Value &, Json::Value &) >
                       func);
   void setPostProcess (std::function < void (const Json::Value &, Json::Value &) >
                        func);
+
+  /*
+   * Batches run their requests in sequence, unless an executor and a way to
+   * tell which requests depend on each other are given.
+   */
+  void setBatchExecutor (Executor executor, BatchKeys keys);
+  void setBatchPrepare (BatchPrepare func);
+
 private:
+  struct BatchState;
 
   std::map<std::string, Method> methods;
   bool checkProtocol (const Json::Value &root, Json::Value &error);
 
+  bool processRequest (const Json::Value &msg, Json::Value &_response);
+  bool processBatch (const Json::Value &msg, Json::Value &_response);
+  bool canRunConcurrently (const Json::Value &msg);
+  void startBatch (const Json::Value &msg, Completion done);
+  void runBatchRequest (const Json::Value &msg, Json::Value::ArrayIndex index,
+                        std::vector<Json::Value> &responses);
+  void runBatchTask (std::shared_ptr<BatchState> state,
+                     Json::Value::ArrayIndex index);
+
   std::function < bool (const Json::Value &, Json::Value &) > preproc;
   std::function < void (const Json::Value &, Json::Value &) > postproc;
+
+  Executor batchExecutor;
+  BatchKeys batchKeys;
+  BatchPrepare batchPrepare;
 };
 
 } /* JsonRpc */
@@ -22,6 +22,9 @@
 #include <jsonrpc/JsonRpcClient.hpp>
 #include <functional>
 #include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <algorithm>
 
 static const std::string MESSAGE = "message";
 
@@ -126,3 +129,150 @@ BOOST_AUTO_TEST_CASE (rpc_get_event)
                                 std::chrono::seconds (2) ) == std::cv_status::no_timeout);
   }
 }
+
+static Json::Value
+batchRequest (int id, const std::string &key)
+{
+  Json::Value request;
+
+  request["jsonrpc"] = "2.0";
+  request["id"] = id;
+  request["method"] = "work";
+  request["params"]["key"] = key;
+
+  return request;
+}
+
+BOOST_AUTO_TEST_CASE (rpc_batch_concurrent)
+{
+  JsonRpc::Handler handler;
+  Json::Value batch;
+  Json::Value response;
+  std::mutex mutex;
+  std::vector<std::string> done;
+  std::atomic<int> running (0);
+  std::atomic<int> maxRunning (0);
+  bool prepared = false;
+
+  handler.addMethod ("work", [&] (const Json::Value & params,
+  Json::Value & response) {
+    int now = ++running;
+
+    maxRunning = std::max (maxRunning.load (), now);
+    std::this_thread::sleep_for (std::chrono::milliseconds (100) );
+    running--;
+
+    std::unique_lock<std::mutex> lock (mutex);
+    done.push_back (params["key"].asString () + params["after"].asString () );
+    response = params["key"];
+  });
+
+  handler.setBatchExecutor ([] (std::function<void () > task) {
+    std::thread (task).detach ();
+  }, [] (const Json::Value & request, Json::Value::ArrayIndex index,
+  const std::vector<std::vector<std::string>> &previous) {
+    return std::vector<std::string> {request["params"]["key"].asString () };
+  });
+
+  handler.setBatchPrepare ([&] (Json::Value & request,
+                                Json::Value::ArrayIndex index,
+  const std::vector<Json::Value> &responses) {
+    if (index == 2) {
+      /* Shares its key with the first request, which is already done */
+      prepared = responses[0]["result"] == "a";
+      request["params"]["after"] = "2";
+    }
+  });
+
+  batch[0] = batchRequest (0, "a");
+  batch[1] = batchRequest (1, "b");
+  batch[2] = batchRequest (2, "a");
+  batch[3] = batchRequest (3, "c");
+
+  handler.process (batch, response);
+
+  BOOST_REQUIRE (response.isArray () );
+  BOOST_REQUIRE_EQUAL (response.size (), 4);
+
+  for (Json::Value::ArrayIndex i = 0; i < response.size (); i++) {
+    BOOST_CHECK_EQUAL (response[i]["id"].asUInt (), i);
+    BOOST_CHECK (response[i]["result"] == batch[i]["params"]["key"]);
+  }
+
+  BOOST_CHECK (prepared);
+  BOOST_CHECK (maxRunning > 1);
+  BOOST_CHECK (std::find (done.begin (), done.end (), "a") <
+               std::find (done.begin (), done.end (), "a2") );
+}
+
+BOOST_AUTO_TEST_CASE (rpc_batch_async)
+{
+  JsonRpc::Handler handler;
+  Json::Value batch;
+  Json::Value response;
+  std::mutex mutex;
+  std::condition_variable cond;
+  std::thread::id caller = std::this_thread::get_id ();
+  std::thread::id completer;
+  std::vector<std::string> previousKey;
+  bool release = false;
+  bool finished = false;
+
+  handler.addMethod ("work", [&] (const Json::Value & params,
+  Json::Value & response) {
+    std::unique_lock<std::mutex> lock (mutex);
+
+    /* Blocks until the caller got control back */
+    cond.wait (lock, [&] () {
+      return release;
+    });
+    response = params["key"];
+  });
+
+  handler.setBatchExecutor ([] (std::function<void () > task) {
+    std::thread (task).detach ();
+  }, [&] (const Json::Value & request, Json::Value::ArrayIndex index,
+  const std::vector<std::vector<std::string>> &previous) {
+    BOOST_CHECK_EQUAL (previous.size (), index);
+
+    if (index == 1) {
+      previousKey = previous[0];
+    }
+
+    return std::vector<std::string> {request["params"]["key"].asString () };
+  });
+
+  BOOST_CHECK (!handler.processAsync (batchRequest (0, "a"), [] (
+  const Json::Value &) {
+    BOOST_FAIL ("Single requests are not run asynchronously");
+  }) );
+
+  batch[0] = batchRequest (0, "a");
+  batch[1] = batchRequest (1, "b");
+
+  BOOST_REQUIRE (handler.processAsync (batch, [&] (const Json::Value & r) {
+    std::unique_lock<std::mutex> lock (mutex);
+
+    response = r;
+    completer = std::this_thread::get_id ();
+    finished = true;
+    cond.notify_all ();
+  }) );
+
+  std::unique_lock<std::mutex> lock (mutex);
+
+  BOOST_CHECK (!finished);
+  release = true;
+  cond.notify_all ();
+
+  BOOST_REQUIRE (cond.wait_for (lock, std::chrono::seconds (5), [&] () {
+    return finished;
+  }) );
+
+  BOOST_CHECK (completer != caller);
+  BOOST_CHECK (previousKey == std::vector<std::string> {"a"});
+  BOOST_REQUIRE (response.isArray () );
+  BOOST_REQUIRE_EQUAL (response.size (), 2);
+  BOOST_CHECK (response[0]["result"] == "a");
+  BOOST_CHECK (response[1]["result"] == "b");
+}
@@ -18,6 +18,7 @@
 #include <gst/gst.h>
 #include "ServerMethods.hpp"
 #include <MediaSet.hpp>
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <EventHandler.hpp>
@@ -39,6 +40,7 @@
 #include <ModuleInfo.hpp>
 #include <ServerType.hpp>
 #include <UUIDGenerator.hpp>
+#include <DeferredResponse.hpp>
 
 #include <ResourceManager.hpp>
 
@@ -62,6 +64,13 @@ static const std::string NEW_REF = "newref:";
 namespace kurento
 {
 
+static std::vector<std::string> getBatchKeys (const Json::Value &request,
+    Json::Value::ArrayIndex index,
+    const std::vector<std::vector<std::string>> &previous);
+static void prepareBatchRequest (Json::Value &request,
+                                 Json::Value::ArrayIndex index,
+                                 const std::vector<Json::Value> &responses);
+
 ServerMethods::ServerMethods (const boost::property_tree::ptree &config) :
   config (config), moduleManager (getModuleManager() )
 {
@@ -72,13 +81,24 @@ ServerMethods::ServerMethods (const boost::property_tree::ptree &config) :
   std::shared_ptr <ServerInfo> serverInfo;
   std::shared_ptr<MediaObjectImpl> serverManager;
   std::chrono::seconds collectorInterval{};
+  std::chrono::seconds pauseTimeout{};
+  std::chrono::seconds trimTimeout{};
   bool disableRequestCache;
+  bool parallelBatches;
 
   collectorInterval = std::chrono::seconds (
                         config.get<long> ("mediaServer.resources.garbageCollectorPeriod",
                                          MediaSet::getCollectorInterval().count() ) );
   MediaSet::setCollectorInterval (collectorInterval);
 
+  pauseTimeout = std::chrono::seconds (
+                   config.get<long> ("mediaServer.resources.idlePausePeriod",
+                                     MediaSet::getPauseTimeout().count() ) );
+  trimTimeout = std::chrono::seconds (
+                  config.get<long> ("mediaServer.resources.idleTrimPeriod",
+                                    MediaSet::getTrimTimeout().count() ) );
+  MediaSet::setIdleTimeouts (pauseTimeout, trimTimeout);
+
   disableRequestCache = config.get<bool> ("mediaServer.resources.disableRequestCache",
                                           false);
 
@@ -146,6 +166,18 @@ ServerMethods::ServerMethods (const boost::property_tree::ptree &config) :
     GST_INFO ("RPC Request Cache is DISABLED");
   }
 
+  parallelBatches = config.get<bool> ("mediaServer.resources.parallelBatches",
+                                      true);
+
+  if (parallelBatches) {
+    batchWorkers.reset (new WorkerPool () );
+    handler.setBatchExecutor ([this] (std::function<void () > task) {
+      batchWorkers->post (task);
+    }, getBatchKeys);
+  }
+
+  handler.setBatchPrepare (prepareBatchRequest);
+
   handler.addMethod ("connect", std::bind (&ServerMethods::connect, this,
                      std::placeholders::_1,
                      std::placeholders::_2) );
@@ -234,6 +266,16 @@ getSessionId (const Json::Value &resp)
 static void
 injectSessionId (Json::Value &req, const std::string &sessionId)
 {
+  if (req.isArray () ) {
+    for (auto &item : req) {
+      if (item.isObject () ) {
+        injectSessionId (item, sessionId);
+      }
+    }
+
+    return;
+  }
+
   try {
     Json::Value params;
 
@@ -257,12 +299,20 @@ injectSessionId (Json::Value &req, const std::string &sessionId)
 std::string
 ServerMethods::process (const std::string &requestStr, std::string &responseStr,
                         std::string &sessionId)
+{
+  return process (requestStr, responseStr, sessionId, nullptr);
+}
+
+std::string
+ServerMethods::process (const std::string &requestStr, std::string &responseStr,
+                        std::string &sessionId, ResponseCallback deferredResponse)
 {
   Json::Value response;
   Json::Value request;
   bool parse = false;
   Json::Reader reader;
   std::string newSessionId;
+  std::shared_ptr<DeferredResponse> deferred;
 
   parse = reader.parse (requestStr, request);
 
@@ -274,13 +324,49 @@ ServerMethods::process (const std::string &requestStr, std::string &responseStr,
     injectSessionId (request, sessionId);
   }
 
-  handler.process (request, response);
+  if (deferredResponse && request.isObject () ) {
+    /* Only single requests can have their response deferred */
+    DeferredResponse::Scope scope;
+
+    handler.process (request, response);
+    deferred = scope.getDeferred ();
+  } else if (deferredResponse
+             && handler.processAsync (request, std::bind (
+                 &ServerMethods::sendBatchResponse, this, requestStr,
+                 deferredResponse, std::placeholders::_1) ) ) {
+    /* The worker that runs the last request of the batch answers it */
+    GST_DEBUG ("Batch running in the background: %s", requestStr.c_str () );
+    return sessionId;
+  } else {
+    handler.process (request, response);
+  }
 
-  try {
-    newSessionId = getSessionId (response);
-  } catch (JsonRpc::CallException &ex) {
-    /* We could not get some of the required parameters. Ignore */
+  if (response.isArray () ) {
+    /* Batch responses do not carry a session for the connection */
     newSessionId = sessionId;
+  } else {
+    try {
+      newSessionId = getSessionId (response);
+    } catch (JsonRpc::CallException &ex) {
+      /* We could not get some of the required parameters. Ignore */
+      newSessionId = sessionId;
+    }
+  }
+
+  if (deferred) {
+    if (response.isMember (JSON_RPC_ERROR) ) {
+      /* Method failed after deferring, the error is the response */
+      deferred->cancel ();
+    } else if (response == Json::Value::null) {
+      /* Notification, nothing to answer */
+      deferred->arm ([] (const Json::Value &, std::exception_ptr) {});
+    } else {
+      GST_DEBUG ("Response deferred for request: %s", requestStr.c_str () );
+      deferred->arm (std::bind (&ServerMethods::sendDeferredResponse, this,
+                                request, response, deferredResponse,
+                                std::placeholders::_1, std::placeholders::_2) );
+      return newSessionId;
+    }
   }
 
   if (response != Json::Value::null) {
@@ -292,6 +378,80 @@ ServerMethods::process (const std::string &requestStr, std::string &responseStr,
   return newSessionId;
 }
 
+void
+ServerMethods::sendBatchResponse (const std::string &requestStr,
+                                  ResponseCallback deferredResponse, const Json::Value &response)
+{
+  Json::StreamWriterBuilder writerFactory;
+  writerFactory["indentation"] = "";
+
+  if (response.empty () ) {
+    /* Only notifications, nothing to answer */
+    return;
+  }
+
+  GST_DEBUG ("Batch completed: %s", requestStr.c_str () );
+
+  try {
+    deferredResponse (Json::writeString (writerFactory, response) );
+  } catch (std::exception &e) {
+    GST_ERROR ("Error sending batch response: %s", e.what () );
+  }
+}
+
+void
+ServerMethods::sendDeferredResponse (const Json::Value &request,
+                                     Json::Value response, ResponseCallback deferredResponse,
+                                     const Json::Value &value, std::exception_ptr error)
+{
+  if (error) {
+    Json::Value err;
+    Json::Value data;
+
+    try {
+      std::rethrow_exception (error);
+    } catch (KurentoException &ex) {
+      data[TYPE] = ex.getType();
+
+      err[JSON_RPC_ERROR_CODE] = ex.getCode ();
+      err[JSON_RPC_ERROR_MESSAGE] = ex.getMessage ();
+      err[JSON_RPC_ERROR_DATA] = data;
+    } catch (JsonRpc::CallException &ex) {
+      err[JSON_RPC_ERROR_CODE] = ex.getCode ();
+      err[JSON_RPC_ERROR_MESSAGE] = ex.getMessage ();
+
+      if (ex.getData () != Json::Value::null) {
+        err[JSON_RPC_ERROR_DATA] = ex.getData ();
+      }
+    } catch (std::exception &ex) {
+      err[JSON_RPC_ERROR_CODE] = JsonRpc::ErrorCode::INTERNAL_ERROR;
+      err[JSON_RPC_ERROR_MESSAGE] =
+        std::string ("Unexpected error while processing method: ") + ex.what ();
+    } catch (...) {
+      err[JSON_RPC_ERROR_CODE] = JsonRpc::ErrorCode::INTERNAL_ERROR;
+      err[JSON_RPC_ERROR_MESSAGE] = "Unexpected error while processing method";
+    }
+
+    response.removeMember (JSON_RPC_RESULT);
+    response[JSON_RPC_ERROR] = err;
+  } else {
+    response[JSON_RPC_RESULT][VALUE] = value;
+  }
+
+  /* Completion may run inside another request's deferrable scope, so do not
+   * go through postProcess here */
+  cacheResponse (request, response);
+
+  Json::StreamWriterBuilder writerFactory;
+  writerFactory["indentation"] = "";
+
+  try {
+    deferredResponse (Json::writeString (writerFactory, response) );
+  } catch (std::exception &e) {
+    GST_ERROR ("Error sending deferred response: %s", e.what () );
+  }
+}
+
 void
 ServerMethods::keepAliveSession (const std::string &sessionId)
 {
@@ -324,6 +484,18 @@ ServerMethods::preProcess (const Json::Value &request, Json::Value &response)
 
 void
 ServerMethods::postProcess (const Json::Value &request, Json::Value &response)
+{
+  if (DeferredResponse::isDeferred () ) {
+    /* Cached by sendDeferredResponse once the actual response is available */
+    return;
+  }
+
+  cacheResponse (request, response);
+}
+
+void
+ServerMethods::cacheResponse (const Json::Value &request,
+                              Json::Value &response)
 {
   std::string sessionId;
   std::string requestId;
@@ -681,12 +853,18 @@ ServerMethods::create (const Json::Value &params,
   }
 }
 
+template <typename Responses>
 void
-insertResult (Json::Value &value, Json::Value &responses, const int index)
+insertResult (Json::Value &value, const Responses &responses, const int index)
 {
   try {
     Json::Value result;
 
+    if (index < 0 || static_cast<size_t> (index) >= responses.size () ) {
+      throw JsonRpc::CallException (JsonRpc::ErrorCode::INVALID_PARAMS,
+                                    "No such request");
+    }
+
     JsonRpc::getValue (responses[index], JSON_RPC_RESULT, result);
     value = result[VALUE];
   } catch (JsonRpc::CallException e) {
@@ -704,8 +882,9 @@ insertResult (Json::Value &value, Json::Value &responses, const int index)
   }
 }
 
+template <typename Responses>
 void
-injectRefs (Json::Value &params, Json::Value &responses)
+injectRefs (Json::Value &params, const Responses &responses)
 {
   if (params.isObject () || params.isArray () ) {
     for (auto &param : params) {
@@ -736,6 +915,148 @@ injectRefs (Json::Value &params, Json::Value &responses)
   }
 }
 
+/* Part of an object id that is shared by all the objects of a pipeline */
+static bool
+getObjectRoot (const std::string &ref, std::string &root)
+{
+  static const size_t UUID_LENGTH = 36;
+
+  /* Ids look like "<uuid>_<module>.<type>[/<uuid>_<module>.<type>]" */
+  if (ref.size () <= UUID_LENGTH + 1 || ref[UUID_LENGTH] != '_') {
+    return false;
+  }
+
+  root = ref.substr (0, ref.find ('/') );
+  return true;
+}
+
+/*
+ * A reference to the result of a previous request of the batch stands for
+ * the pipeline root of that request, which is the first of its keys.
+ */
+static std::string
+getNewRefRoot (const std::string &ref,
+               const std::vector<std::vector<std::string>> &previous)
+{
+  size_t index;
+
+  try {
+    index = std::stoul (ref.substr (NEW_REF.size () ) );
+  } catch (std::exception &e) {
+    /* Rejected when the request is prepared */
+    return ref;
+  }
+
+  if (index >= previous.size () || previous[index].empty ()
+      || previous[index][0] == JsonRpc::Handler::BATCH_EXCLUSIVE) {
+    return ref;
+  }
+
+  return previous[index][0];
+}
+
+static void
+collectBatchKeys (const Json::Value &params,
+                  const std::vector<std::vector<std::string>> &previous,
+                  std::vector<std::string> &keys)
+{
+  if (params.isObject () ) {
+    for (auto it = params.begin (); it != params.end (); it++) {
+      if (it.name () != SESSION_ID) {
+        collectBatchKeys (*it, previous, keys);
+      }
+    }
+  } else if (params.isArray () ) {
+    for (auto &param : params) {
+      collectBatchKeys (param, previous, keys);
+    }
+  } else if (params.isString () ) {
+    std::string param = params.asString ();
+    std::string root;
+
+    if (param.compare (0, NEW_REF.size (), NEW_REF) == 0) {
+      root = getNewRefRoot (param, previous);
+    } else if (!getObjectRoot (param, root) ) {
+      return;
+    }
+
+    if (std::find (keys.begin (), keys.end (), root) == keys.end () ) {
+      keys.push_back (root);
+    }
+  }
+}
+
+/*
+ * Requests of a batch that touch the same pipeline run in order, however
+ * they name it: by id, or through "newref:<n>" to a previous request of the
+ * batch, which is resolved to the pipeline of that request. The first key is
+ * that pipeline. Requests that touch no object, like the creation of a
+ * pipeline, are their own root. Session wide requests run alone.
+ */
+static std::vector<std::string>
+getBatchKeys (const Json::Value &request, Json::Value::ArrayIndex index,
+              const std::vector<std::vector<std::string>> &previous)
+{
+  std::vector<std::string> keys;
+  std::string method;
+
+  if (!request.isObject () || !request[JSON_RPC_METHOD].isString () ) {
+    keys.push_back (JsonRpc::Handler::BATCH_EXCLUSIVE);
+    return keys;
+  }
+
+  method = request[JSON_RPC_METHOD].asString ();
+
+  if (method == "connect" || method == "closeSession") {
+    keys.push_back (JsonRpc::Handler::BATCH_EXCLUSIVE);
+    return keys;
+  }
+
+  collectBatchKeys (request[JSON_RPC_PARAMS], previous, keys);
+
+  if (keys.empty () ) {
+    keys.push_back (NEW_REF + std::to_string (index) );
+  }
+
+  return keys;
+}
+
+/* Responses of the requests that precede one in a batch */
+class PreviousResponses
+{
+public:
+  PreviousResponses (const std::vector<Json::Value> &responses,
+                     Json::Value::ArrayIndex count) : responses (responses),
+    count (count) {}
+
+  size_t size () const
+  {
+    return count;
+  }
+
+  const Json::Value &operator[] (int index) const
+  {
+    return responses[index];
+  }
+
+private:
+  const std::vector<Json::Value> &responses;
+  size_t count;
+};
+
+static void
+prepareBatchRequest (Json::Value &request, Json::Value::ArrayIndex index,
+                     const std::vector<Json::Value> &responses)
+{
+  /* Transactions resolve their own references */
+  if (!request.isMember (JSON_RPC_PARAMS)
+      || request[JSON_RPC_METHOD] == "transaction") {
+    return;
+  }
+
+  injectRefs (request[JSON_RPC_PARAMS], PreviousResponses (responses, index) );
+}
+
 void
 ServerMethods::transaction (const Json::Value &params, Json::Value &response)
 {
@@ -750,6 +1071,9 @@ ServerMethods::transaction (const Json::Value &params, Json::Value &response)
   JsonRpc::getArray (params, "operations", operations);
   Json::Value responses;
 
+  /* Operations run in order, each one must be complete before the next */
+  DeferredResponse::Scope syncScope (false);
+
   for (uint i = 0; i < operations.size(); i++) {
     bool ret;
 
@@ -23,6 +23,7 @@
 #include <ModuleManager.hpp>
 #include <boost/property_tree/ptree.hpp>
 #include <Processor.hpp>
+#include <WorkerPool.hpp>
 #include "RequestCache.hpp"
 
 namespace kurento
@@ -39,6 +40,8 @@ public:
 
   virtual std::string process (const std::string &request, std::string &response,
                                std::string &sessionId);
+  virtual std::string process (const std::string &request, std::string &response,
+                               std::string &sessionId, ResponseCallback deferredResponse);
 
   virtual void keepAliveSession (const std::string &sessionId);
 
@@ -64,6 +67,13 @@ private:
 
   bool preProcess (const Json::Value &request, Json::Value &response);
   void postProcess (const Json::Value &request, Json::Value &response);
+  void cacheResponse (const Json::Value &request, Json::Value &response);
+
+  void sendBatchResponse (const std::string &requestStr,
+                          ResponseCallback deferredResponse, const Json::Value &response);
+  void sendDeferredResponse (const Json::Value &request, Json::Value response,
+                             ResponseCallback deferredResponse, const Json::Value &value,
+                             std::exception_ptr error);
 
   void connect (const Json::Value &params, Json::Value &response);
   void create (const Json::Value &params, Json::Value &response);
@@ -89,6 +99,7 @@ private:
 
   ModuleManager &moduleManager;
   std::shared_ptr<RequestCache> cache;
+  std::unique_ptr<WorkerPool> batchWorkers;
   std::string instanceId;
 
   class StaticConstructor
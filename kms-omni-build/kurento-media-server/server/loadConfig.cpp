@@ -241,27 +241,46 @@ loadModulesConfig (boost::property_tree::ptree &config,
   }
 }
 
-void
-loadConfig (boost::property_tree::ptree &config, const std::string &file_name,
-            const std::string &modulesConfigPath)
+/*
+ * Parses the main config file and merges the modules configuration into
+ * @config. Shared by the initial load and the reloads, so both read the
+ * configuration the same way.
+ */
+static bool
+parseConfig (boost::property_tree::ptree &config, const std::string &file_name,
+             const std::string &modulesConfigPath, std::string &error)
 {
   boost::filesystem::path configFilePath (file_name);
-  GST_INFO ("Reading configuration from: %s", file_name.c_str () );
 
   try {
     loadFile (config, configFilePath);
   } catch (ParseException &e) {
-    GST_ERROR ("Error reading configuration: %s", e.what() );
-    std::cerr << "Error reading configuration: " << e.what() << std::endl;
-    exit (1);
+    error = e.what();
+    return false;
   } catch (boost::property_tree::ptree_error &e) {
-    GST_ERROR ("Error reading configuration: %s", e.what() );
-    std::cerr << "Error reading configuration: " << e.what() << std::endl;
-    exit (1);
+    error = e.what();
+    return false;
   }
 
   loadModulesConfig (config, configFilePath, modulesConfigPath);
 
+  return true;
+}
+
+void
+loadConfig (boost::property_tree::ptree &config, const std::string &file_name,
+            const std::string &modulesConfigPath)
+{
+  std::string error;
+
+  GST_INFO ("Reading configuration from: %s", file_name.c_str () );
+
+  if (!parseConfig (config, file_name, modulesConfigPath, error) ) {
+    GST_ERROR ("Error reading configuration: %s", error.c_str() );
+    std::cerr << "Error reading configuration: " << error << std::endl;
+    exit (1);
+  }
+
   GST_INFO ("Configuration loaded successfully");
 
   std::ostringstream oss;
@@ -271,6 +290,25 @@ loadConfig (boost::property_tree::ptree &config, const std::string &file_name,
   GST_INFO ("Loaded config in effect:\n%s", infoConfig.c_str() );
 }
 
+bool
+reloadConfig (boost::property_tree::ptree &config, const std::string &file_name,
+              const std::string &modulesConfigPath)
+{
+  std::string error;
+
+  GST_INFO ("Reloading configuration from: %s", file_name.c_str () );
+
+  if (!parseConfig (config, file_name, modulesConfigPath, error) ) {
+    GST_ERROR ("Error reloading configuration, keeping the current one: %s",
+               error.c_str() );
+    return false;
+  }
+
+  GST_INFO ("Configuration reloaded successfully");
+
+  return true;
+}
+
 } /* kurento */
 
 static void init_debug() __attribute__((constructor));
@@ -27,6 +27,14 @@ void
 loadConfig (boost::property_tree::ptree &config, const std::string &file_name,
             const std::string &modulesConfigPath);
 
+/*
+ * Like loadConfig(), but parse errors are reported by returning false instead
+ * of terminating the process, so it can be used on a running server.
+ */
+bool
+reloadConfig (boost::property_tree::ptree &config, const std::string &file_name,
+              const std::string &modulesConfigPath);
+
 void
 mergePropertyTrees (boost::property_tree::ptree &ptMerged,
                     const boost::property_tree::ptree &ptSecond, int level = 0 );
@@ -23,6 +23,7 @@
 #include <iostream>
 #include "version.hpp"
 #include <glib/gstdio.h>
+#include <glib-unix.h>
 #include <ftw.h>
 
 #include <boost/log/utility/setup/common_attributes.hpp>
@@ -42,6 +43,7 @@
 #include "loadConfig.hpp"
 
 #include "MediaSet.hpp"
+#include <ConfigSnapshot.hpp>
 
 #define GST_CAT_DEFAULT kurento_media_server
 GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
@@ -98,6 +100,29 @@ signal_handler (int signo)
   }
 }
 
+struct ConfigSource {
+  const boost::property_tree::ptree *config;
+  std::string confFile;
+  std::string modulesConfigPath;
+};
+
+static gboolean
+reload_config (gpointer user_data)
+{
+  auto source = static_cast<ConfigSource *> (user_data);
+  boost::property_tree::ptree newConfig;
+
+  GST_INFO ("SIGHUP received, reloading configuration");
+
+  if (reloadConfig (newConfig, source->confFile, source->modulesConfigPath) ) {
+    // New objects read the new values, the transport keeps its settings
+    ConfigSnapshot::publish (*source->config,
+                             std::make_shared<ConfigSnapshot> (newConfig) );
+  }
+
+  return G_SOURCE_CONTINUE;
+}
+
 static void
 kms_init_dependencies (int *argc, char ***argv)
 {
@@ -240,6 +265,10 @@ main (int argc, char **argv)
   GST_INFO ("Kurento Media Server version: %s", get_version () );
 
   loadConfig (config, confFile, modulesConfigPath);
+  ConfigSnapshot::publish (config, std::make_shared<ConfigSnapshot> (config) );
+
+  ConfigSource configSource {&config, confFile, modulesConfigPath};
+  g_unix_signal_add (SIGHUP, reload_config, &configSource);
 
   boost::optional<float> killResourceLimit =
     config.get_optional<float> ("mediaServer.resources.killLimit");
@@ -262,6 +291,7 @@ main (int argc, char **argv)
 
   transport->stop();
   MediaSet::deleteMediaSet();
+  ConfigSnapshot::publish (config, nullptr);
 
   GST_INFO ("Kurento Media Server stopped");
 
@@ -31,7 +31,7 @@ public:
   /**
    * Process the request
    *
-   * @param request The request to be proccessed
+   * @param request The request to be processed
    * @param response The response to be send
    * @param sessionId The sessionId associated with the channel that received
    *                  the request
@@ -41,6 +41,30 @@ public:
   virtual std::string process (const std::string &request, std::string &response,
                                std::string &sessionId) = 0;
 
+  typedef std::function<void (const std::string &response) > ResponseCallback;
+
+  /**
+   * Process the request, allowing its response to be deferred
+   *
+   * Methods that need to wait for the media side can defer their response
+   * instead of blocking the calling thread. In that case @response is left
+   * empty and @deferredResponse is called later, from any thread, with the
+   * response to be sent.
+   *
+   * @param request The request to be processed
+   * @param response The response to be sent, empty if it was deferred
+   * @param sessionId The sessionId associated with the channel that received
+   *                  the request
+   * @param deferredResponse Sends a response once its method completes
+   *
+   * @returns The sessionId of the request
+   */
+  virtual std::string process (const std::string &request, std::string &response,
+                               std::string &sessionId, ResponseCallback deferredResponse)
+  {
+    return process (request, response, sessionId);
+  }
+
   virtual void keepAliveSession (const std::string &sessionId) = 0;
   virtual void setEventSubscriptionHandler (std::function < std::string (
         std::shared_ptr<MediaObjectImpl> obj,
@@ -0,0 +1,155 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gst/gst.h>
+#include "WebSocketTlsContext.hpp"
+
+#include <openssl/ssl.h>
+
+#include <vector>
+
+#define GST_CAT_DEFAULT kurento_websocket_tls_context
+GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
+#define GST_DEFAULT_NAME "KurentoWebSocketTlsContext"
+
+namespace kurento
+{
+
+/* How often the certificate file is checked for changes */
+static const std::chrono::seconds CERTIFICATE_CHECK_INTERVAL (5);
+
+static const long SESSION_CACHE_SIZE = 20480;
+static const long SESSION_TIMEOUT = 300; /* seconds */
+
+static const unsigned char SESSION_ID_CONTEXT[] = "kurento";
+
+WebSocketTlsContext::context_ptr
+WebSocketTlsContext::create (const boost::filesystem::path &certificateFile,
+                             const std::string &password)
+{
+  context_ptr context (
+    new boost::asio::ssl::context (boost::asio::ssl::context::sslv23) );
+  SSL_CTX *ctx = context->native_handle ();
+
+  context->set_options (boost::asio::ssl::context::default_workarounds
+                        | boost::asio::ssl::context::single_dh_use
+
+                        // Disable SSLv2 and SSLv3, leaving OpenSSL to negotiate with the
+                        // client the highest version mutually supported among TLS 1.0,
+                        // TLS 1.1, and TLS 1.2. See:
+                        // https://www.openssl.org/docs/man1.0.2/man3/TLSv1_method.html
+                        | boost::asio::ssl::context::no_sslv2
+                        | boost::asio::ssl::context::no_sslv3);
+  context->set_password_callback (
+    std::bind ([password] () -> std::string { return password; }) );
+  context->use_certificate_chain_file (certificateFile.string () );
+  context->use_private_key_file (certificateFile.string (),
+                                 boost::asio::ssl::context::pem);
+
+  /* Let returning clients skip the full handshake */
+  SSL_CTX_set_session_cache_mode (ctx, SSL_SESS_CACHE_SERVER);
+  SSL_CTX_sess_set_cache_size (ctx, SESSION_CACHE_SIZE);
+  SSL_CTX_set_timeout (ctx, SESSION_TIMEOUT);
+  SSL_CTX_set_session_id_context (ctx, SESSION_ID_CONTEXT,
+                                  sizeof (SESSION_ID_CONTEXT) - 1);
+
+  return context;
+}
+
+static void
+copyTicketKeys (SSL_CTX *from, SSL_CTX *to)
+{
+  long size = SSL_CTX_get_tlsext_ticket_keys (from, nullptr, 0);
+  std::vector<unsigned char> keys (size > 0 ? size : 0);
+
+  if (keys.empty ()
+      || !SSL_CTX_get_tlsext_ticket_keys (from, keys.data (), size)
+      || !SSL_CTX_set_tlsext_ticket_keys (to, keys.data (), size) ) {
+    GST_WARNING ("Cannot keep TLS session tickets across certificate reload");
+  }
+}
+
+static std::time_t
+getModificationTime (const boost::filesystem::path &file)
+{
+  boost::system::error_code ec;
+  std::time_t time = boost::filesystem::last_write_time (file, ec);
+
+  return ec ? 0 : time;
+}
+
+WebSocketTlsContext::WebSocketTlsContext (const boost::filesystem::path
+    &certificateFile, const std::string &password) :
+  certificateFile (certificateFile), password (password)
+{
+  certificateTime = getModificationTime (certificateFile);
+  context = create (certificateFile, password);
+  lastCheck = std::chrono::steady_clock::now ();
+}
+
+void
+WebSocketTlsContext::reloadIfChanged ()
+{
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now ();
+  std::time_t time;
+
+  if (now - lastCheck < CERTIFICATE_CHECK_INTERVAL) {
+    return;
+  }
+
+  lastCheck = now;
+  time = getModificationTime (certificateFile);
+
+  if (time == 0 || time == certificateTime) {
+    return;
+  }
+
+  GST_INFO ("Certificate file changed, reloading: %s",
+            certificateFile.string ().c_str () );
+
+  try {
+    context_ptr newContext = create (certificateFile, password);
+
+    copyTicketKeys (context->native_handle (), newContext->native_handle () );
+    context = newContext;
+    certificateTime = time;
+  } catch (std::exception &e) {
+    /* Maybe the file is still being written, try again later */
+    GST_ERROR ("Error reloading certificate, keeping the previous one: %s",
+               e.what () );
+  }
+}
+
+WebSocketTlsContext::context_ptr
+WebSocketTlsContext::get ()
+{
+  std::unique_lock<std::mutex> lock (mutex);
+
+  reloadIfChanged ();
+
+  return context;
+}
+
+WebSocketTlsContext::StaticConstructor WebSocketTlsContext::staticConstructor;
+
+WebSocketTlsContext::StaticConstructor::StaticConstructor()
+{
+  GST_DEBUG_CATEGORY_INIT (GST_CAT_DEFAULT, GST_DEFAULT_NAME, 0,
+                           GST_DEFAULT_NAME);
+}
+
+} /* kurento */
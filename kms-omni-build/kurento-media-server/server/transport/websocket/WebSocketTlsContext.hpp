@@ -0,0 +1,77 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef __WEBSOCKET_TLS_CONTEXT_HPP__
+#define __WEBSOCKET_TLS_CONTEXT_HPP__
+
+#include <boost/asio/ssl/context.hpp>
+#include <boost/filesystem.hpp>
+
+#include <chrono>
+#include <ctime>
+#include <memory>
+#include <mutex>
+
+namespace kurento
+{
+
+/*
+ * TLS context shared by all the connections of the secure WebSocket server.
+ *
+ * The certificate is loaded once, and handshakes from returning clients are
+ * shortened with a session cache and session tickets. When the certificate
+ * file changes on disk, a new context is built and used for new connections;
+ * ticket keys are carried over so that clients can still resume.
+ */
+class WebSocketTlsContext
+{
+public:
+  typedef std::shared_ptr<boost::asio::ssl::context> context_ptr;
+
+  /* Throws if the certificate cannot be loaded */
+  WebSocketTlsContext (const boost::filesystem::path &certificateFile,
+                       const std::string &password);
+
+  context_ptr get ();
+
+  /* Builds a standalone context, loading the certificate now */
+  static context_ptr create (const boost::filesystem::path &certificateFile,
+                             const std::string &password);
+
+private:
+  void reloadIfChanged ();
+
+  boost::filesystem::path certificateFile;
+  std::string password;
+
+  std::mutex mutex;
+  context_ptr context;
+  std::time_t certificateTime;
+  std::chrono::steady_clock::time_point lastCheck;
+
+  class StaticConstructor
+  {
+  public:
+    StaticConstructor();
+  };
+
+  static StaticConstructor staticConstructor;
+};
+
+} /* kurento */
+
+#endif /* __WEBSOCKET_TLS_CONTEXT_HPP__ */
@@ -20,6 +20,7 @@
 #include "WebSocketTransport.hpp"
 #include "WebSocketEventHandler.hpp"
 #include "WebSocketRegistrar.hpp"
+#include "WebSocketTlsContext.hpp"
 #include <jsonrpc/JsonRpcUtils.hpp>
 #include <jsonrpc/JsonRpcConstants.hpp>
 #include <KurentoException.hpp>
@@ -38,6 +39,8 @@
 GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
 #define GST_DEFAULT_NAME "KurentoWebSocketTransport"
 
+#define FILTER "filter"
+
 typedef websocketpp::lib::shared_ptr<boost::asio::ssl::context> context_ptr;
 
 namespace kurento
@@ -269,32 +272,19 @@ WebSocketTransport::initSecureWebSocket (
           websocketpp::connection_hdl, SecureWebSocketServer::message_ptr))
           & WebSocketTransport::processMessage,
       this, &secureServer, std::placeholders::_1, std::placeholders::_2));
-  secureServer.set_tls_init_handler (
-      [password, certificateFile] (
-          websocketpp::connection_hdl hdl) -> context_ptr {
-        context_ptr context (
-            new boost::asio::ssl::context (boost::asio::ssl::context::sslv23));
-
-        try {
-          context->set_options (boost::asio::ssl::context::default_workarounds
-              | boost::asio::ssl::context::single_dh_use
-
-              // Disable SSLv2 and SSLv3, leaving OpenSSL to negotiate with the
-              // client the highest version mutually supported among TLS 1.0,
-              // TLS 1.1, and TLS 1.2. See:
-              // https://www.openssl.org/docs/man1.0.2/man3/TLSv1_method.html
-              | boost::asio::ssl::context::no_sslv2
-              | boost::asio::ssl::context::no_sslv3);
-          context->set_password_callback (
-              std::bind ([password] () -> std::string { return password; }));
-          context->use_certificate_chain_file (certificateFile.string ());
-          context->use_private_key_file (
-              certificateFile.string (), boost::asio::ssl::context::pem);
-        } catch (std::exception &e) {
-          GST_ERROR ("Error setting up TLS: %s", e.what ());
-        }
+  std::shared_ptr<WebSocketTlsContext> tlsContext;
+  try {
+    tlsContext = std::make_shared<WebSocketTlsContext> (certificateFile,
+        password);
+  } catch (std::exception &e) {
+    GST_ERROR ("Error setting up TLS: %s", e.what ());
+    return;
+  }
 
-        return context;
+  // All connections share the same context, loaded only once
+  secureServer.set_tls_init_handler (
+      [tlsContext] (websocketpp::connection_hdl hdl) -> context_ptr {
+        return tlsContext->get ();
       });
 
   // Connect to IPv6 if enabled, with fallback to IPv4 if v6 fails
@@ -396,7 +386,7 @@ void WebSocketTransport::keepAliveSessions()
     }
 
     lock.lock();
-    cond.wait_for (lock, MediaSet::getCollectorInterval() / 4);
+    cond.wait_for (lock, MediaSet::getCheckInterval() );
   }
 }
 
@@ -554,13 +544,37 @@ void WebSocketTransport::processMessage (ServerType *s,
     /* Ignore, there is no previous sessionId */
   }
 
+  std::weak_ptr<WebSocketTransport> weakThis = shared_from_this ();
+  auto deferredResponse = [weakThis, s, hdl] (const std::string & response) {
+    std::shared_ptr<WebSocketTransport> transport = weakThis.lock ();
+
+    if (!transport) {
+      return;
+    }
+
+    GST_DEBUG ("Deferred response: %s", response.c_str() );
+
+    try {
+      s->send (hdl, response, websocketpp::frame::opcode::TEXT);
+    } catch (websocketpp::exception &e) {
+      GST_ERROR ("Could not send deferred response to client: %s",
+                 e.code().message().c_str() );
+    }
+  };
+
   GST_DEBUG ("Message: %s", request.c_str() );
-  sessionId = processor->process (request, response, sessionId);
+  sessionId = processor->process (request, response, sessionId,
+                                  deferredResponse);
   GST_DEBUG ("Response: %s", response.c_str() );
 
   storeConnection (request, response, hdl,
                    std::is_same<ServerType, SecureWebSocketServer>::value, sessionId);
 
+  if (response.empty () ) {
+    /* Deferred response or notification, nothing to send now */
+    return;
+  }
+
   try {
     s->send (hdl, response, websocketpp::frame::opcode::TEXT);
   } catch (websocketpp::exception &e) {
@@ -604,6 +618,14 @@ WebSocketTransport::processSubscription (std::shared_ptr< MediaObjectImpl > obj,
   std::string subscriptionId;
   std::string eventId = sessionId + "|" + obj->getId() + "|" + eventType;
   std::shared_ptr <EventHandler> handler;
+  std::shared_ptr <EventFilter> filter;
+
+  if (params.isMember (FILTER) ) {
+    filter = std::make_shared <EventFilter> (params[FILTER]);
+    // Only subscriptions with the same filter can share a handler
+    eventId += "|" + filter->getKey ();
+  }
+
   std::unique_lock<std::recursive_mutex> lock (mutex);
 
   if (handlers.find (eventId) != handlers.end() ) {
@@ -613,6 +635,7 @@ WebSocketTransport::processSubscription (std::shared_ptr< MediaObjectImpl > obj,
   if (!handler) {
     handler = std::shared_ptr <EventHandler> (new WebSocketEventHandler (obj,
               shared_from_this(), sessionId) );
+    handler->setFilter (filter);
 
     subscriptionId = processor->connectEventHandler (obj, sessionId, eventType,
                      handler);
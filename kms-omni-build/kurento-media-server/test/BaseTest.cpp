@@ -80,6 +80,9 @@ F::write_config (const boost::filesystem::path &orig, uint port)
   resourceConfig.erase ("exceptionLimit");
   resourceConfig.add ("exceptionLimit", resourceLimit);
 
+  resourceConfig.erase ("parallelBatches");
+  resourceConfig.add ("parallelBatches", parallelBatches);
+
   boost::property_tree::json_parser::write_json (newConfigFile.string(), config);
 
   return newConfigFile;
@@ -223,7 +226,9 @@ Json::Value F::sendRequest (const Json::Value &request)
   client->send (connectionHdl, Json::writeString (writerFactory, request),
                 websocketpp::frame::opcode::text);
 
-  requestId = request[JSON_RPC_ID].asString();
+  /* Batches are identified by their first request */
+  requestId = request.isArray() ? request[0][JSON_RPC_ID].asString() :
+              request[JSON_RPC_ID].asString();
 
   if (!cond.wait_for (lock, REPLY_TIMEOUT, std::bind (&F::receivedResponse,
                       this, requestId ) ) ) {
@@ -326,7 +331,7 @@ void F::stop_client (std::unique_lock <std::mutex> &lock)
 
 bool F::isEvent (const Json::Value &message)
 {
-  if (message.isMember (JSON_RPC_METHOD)
+  if (message.isObject() && message.isMember (JSON_RPC_METHOD)
       && message[JSON_RPC_METHOD] == "onEvent") {
     return true;
   }
@@ -336,6 +341,10 @@ bool F::isEvent (const Json::Value &message)
 
 bool F::isResponse (const Json::Value &message, const std::string &requestId)
 {
+  if (message.isArray() ) {
+    return message.size() > 0 && isResponse (message[0], requestId);
+  }
+
   if (message.isMember (JSON_RPC_ERROR)
       || (message.isMember (JSON_RPC_RESULT)
           && message.isMember (JSON_RPC_ID)
@@ -376,6 +385,7 @@ F::start ()
   std::unique_lock <std::mutex> lock (mutex);
 
   id = 0;
+  terminate = false;
 
   start_server();
 
@@ -61,6 +61,11 @@ protected:
     resourceLimit = limit;
   }
 
+  void setParallelBatches (bool parallel)
+  {
+    parallelBatches = parallel;
+  }
+
   void stop();
   void start();
 
@@ -111,6 +116,7 @@ private:
   boost::filesystem::path configDir;
 
   float resourceLimit = 1.0;
+  bool parallelBatches = true;
 };
 
 } /* kurento */
@@ -0,0 +1,252 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "BaseTest.hpp"
+#include <boost/test/unit_test.hpp>
+
+#include <gst/gst.h>
+
+#include <json/json.h>
+
+#include <chrono>
+
+#define GST_CAT_DEFAULT _server_batch_benchmark_
+GST_DEBUG_CATEGORY_STATIC (GST_CAT_DEFAULT);
+#define GST_DEFAULT_NAME "test_server_batch_benchmark"
+
+#define PIPELINES 10
+#define ELEMENTS_PER_PIPELINE 10
+
+namespace kurento
+{
+
+class BatchBenchmark : public F
+{
+public:
+  BatchBenchmark() : F()
+  {
+    GST_DEBUG_CATEGORY_INIT (GST_CAT_DEFAULT, GST_DEFAULT_NAME, 0,
+                             GST_DEFAULT_NAME);
+  };
+
+  ~BatchBenchmark() override = default;
+
+protected:
+  std::string sessionId;
+
+  void connect ();
+  std::vector<std::string> createPipelines ();
+  Json::Value createElements (const std::vector<std::string> &pipelines);
+  std::chrono::milliseconds runBatch (bool parallel);
+  Json::Value batchRequest (const std::string &method,
+                            const Json::Value &params);
+};
+
+void
+BatchBenchmark::connect ()
+{
+  Json::Value request;
+  Json::Value response;
+
+  request["jsonrpc"] = "2.0";
+  request["id"] = getId();
+  request["method"] = "connect";
+  request["params"] = Json::Value (Json::objectValue);
+
+  response = sendRequest (request);
+
+  BOOST_REQUIRE (response.isMember ("result") );
+  sessionId = response["result"]["sessionId"].asString();
+}
+
+std::vector<std::string>
+BatchBenchmark::createPipelines ()
+{
+  std::vector<std::string> pipelines;
+  Json::Value batch;
+  Json::Value response;
+
+  for (int i = 0; i < PIPELINES; i++) {
+    Json::Value request;
+
+    request["jsonrpc"] = "2.0";
+    request["id"] = getId();
+    request["method"] = "create";
+    request["params"]["type"] = "MediaPipeline";
+    request["params"]["sessionId"] = sessionId;
+
+    batch[i] = request;
+  }
+
+  response = sendRequest (batch);
+
+  BOOST_REQUIRE (response.isArray () );
+  BOOST_REQUIRE_EQUAL (response.size (), PIPELINES);
+
+  for (auto &item : response) {
+    BOOST_REQUIRE (item.isMember ("result") );
+    pipelines.push_back (item["result"]["value"].asString () );
+  }
+
+  return pipelines;
+}
+
+/* Requests to fill each pipeline with some elements */
+Json::Value
+BatchBenchmark::createElements (const std::vector<std::string> &pipelines)
+{
+  Json::Value batch;
+  Json::Value::ArrayIndex index = 0;
+
+  for (int i = 0; i < ELEMENTS_PER_PIPELINE; i++) {
+    for (auto &pipeline : pipelines) {
+      Json::Value request;
+
+      request["jsonrpc"] = "2.0";
+      request["id"] = getId();
+      request["method"] = "create";
+      request["params"]["type"] = "PassThrough";
+      request["params"]["constructorParams"]["mediaPipeline"] = pipeline;
+      request["params"]["sessionId"] = sessionId;
+
+      batch[index++] = request;
+    }
+  }
+
+  return batch;
+}
+
+Json::Value
+BatchBenchmark::batchRequest (const std::string &method,
+                              const Json::Value &params)
+{
+  Json::Value request;
+
+  request["jsonrpc"] = "2.0";
+  request["id"] = getId();
+  request["method"] = method;
+  request["params"] = params;
+  request["params"]["sessionId"] = sessionId;
+
+  return request;
+}
+
+/*
+ * Starts a server with the given batch execution mode and times one batch
+ * that fills every pipeline with elements.
+ */
+std::chrono::milliseconds
+BatchBenchmark::runBatch (bool parallel)
+{
+  std::chrono::steady_clock::time_point begin;
+  std::chrono::milliseconds elapsed;
+  Json::Value requests;
+  Json::Value response;
+
+  setParallelBatches (parallel);
+  start ();
+  connect ();
+
+  requests = createElements (createPipelines () );
+  begin = std::chrono::steady_clock::now ();
+
+  response = sendRequest (requests);
+
+  elapsed = std::chrono::duration_cast<std::chrono::milliseconds>
+            (std::chrono::steady_clock::now () - begin);
+
+  BOOST_REQUIRE (response.isArray () );
+  BOOST_REQUIRE_EQUAL (response.size (), requests.size () );
+
+  /* Responses keep the order of the batch whatever the execution mode */
+  for (Json::Value::ArrayIndex i = 0; i < response.size (); i++) {
+    BOOST_CHECK (response[i]["id"] == requests[i]["id"]);
+    BOOST_CHECK (response[i].isMember ("result") );
+  }
+
+  stop ();
+
+  return elapsed;
+}
+
+BOOST_FIXTURE_TEST_SUITE ( server_batch_benchmark, BatchBenchmark)
+
+BOOST_AUTO_TEST_CASE ( parallel_vs_serial_batch )
+{
+  std::chrono::milliseconds serial, parallel;
+
+  serial = runBatch (false);
+  parallel = runBatch (true);
+
+  BOOST_TEST_MESSAGE ("Batch creating " << PIPELINES * ELEMENTS_PER_PIPELINE
+                      << " elements in " << PIPELINES << " pipelines: serial "
+                      << serial.count () << " ms, parallel "
+                      << parallel.count () << " ms");
+
+  /* Timing depends on the host, so a slower parallel run only warns */
+  BOOST_WARN_LE (parallel.count (), serial.count () );
+}
+
+/*
+ * The release and the lookup below reach the same pipeline through different
+ * newref chains, so they still have to run in batch order
+ */
+BOOST_AUTO_TEST_CASE ( newref_chains_keep_order )
+{
+  Json::Value batch;
+  Json::Value params;
+  Json::Value response;
+
+  setParallelBatches (true);
+  start ();
+  connect ();
+
+  params["type"] = "MediaPipeline";
+  batch[0] = batchRequest ("create", params);
+
+  params["type"] = "PassThrough";
+  params["constructorParams"]["mediaPipeline"] = "newref:0";
+  batch[1] = batchRequest ("create", params);
+  batch[2] = batchRequest ("create", params);
+
+  params = Json::Value ();
+  params["object"] = "newref:1";
+  batch[3] = batchRequest ("release", params);
+
+  params["object"] = "newref:0";
+  params["operation"] = "getChildren";
+  batch[4] = batchRequest ("invoke", params);
+
+  response = sendRequest (batch);
+
+  BOOST_REQUIRE (response.isArray () );
+  BOOST_REQUIRE_EQUAL (response.size (), batch.size () );
+
+  for (auto &item : response) {
+    BOOST_REQUIRE (item.isMember ("result") );
+  }
+
+  BOOST_REQUIRE_EQUAL (response[4]["result"]["value"].size (), 1);
+  BOOST_CHECK (response[4]["result"]["value"][0] ==
+               response[2]["result"]["value"]);
+
+  stop ();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} /* kurento */
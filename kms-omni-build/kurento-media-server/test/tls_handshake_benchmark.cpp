@@ -0,0 +1,180 @@
+/*
+ * (C) Copyright 2026 Kurento (http://kurento.org/)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <config.h>
+
+#define BOOST_TEST_MODULE TlsHandshakeBenchmark
+#include <boost/test/unit_test.hpp>
+
+#include <WebSocketTlsContext.hpp>
+
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/filesystem.hpp>
+#include <openssl/ssl.h>
+
+#include <chrono>
+#include <functional>
+#include <thread>
+
+using namespace kurento;
+using boost::asio::ip::tcp;
+
+typedef boost::asio::ssl::stream<tcp::socket> SslStream;
+typedef std::function<WebSocketTlsContext::context_ptr () > ContextProvider;
+
+static const int HANDSHAKES = 200;
+static const std::string PASSWORD = "";
+static const boost::filesystem::path
+CERTIFICATE_FILE (TEST_DIRECTORY "/testCertificate.pem");
+
+/*
+ * Marks the connection as cleanly closed without exchanging close_notify,
+ * otherwise OpenSSL invalidates its session when the stream is destroyed.
+ */
+static void
+closeQuietly (SslStream &stream)
+{
+  SSL_set_shutdown (stream.native_handle (),
+                    SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+}
+
+/*
+ * Runs `count` handshakes against a local server that takes its context
+ * from `provider`. Returns how many of them resumed a previous session.
+ */
+static int
+runHandshakes (ContextProvider provider, bool resume, int count,
+               std::chrono::milliseconds &elapsed)
+{
+  boost::asio::io_service ios;
+  tcp::acceptor acceptor (ios, tcp::endpoint (
+                            boost::asio::ip::address_v4::loopback (), 0) );
+  boost::asio::ssl::context clientContext (boost::asio::ssl::context::sslv23);
+  SSL_SESSION *session = nullptr;
+  int resumed = 0;
+
+  /* Up to TLS 1.2 session tickets arrive within the handshake */
+  SSL_CTX_set_max_proto_version (clientContext.native_handle (),
+                                 TLS1_2_VERSION);
+  clientContext.set_verify_mode (boost::asio::ssl::verify_none);
+
+  std::thread server ([&] () {
+    for (int i = 0; i < count; i++) {
+      WebSocketTlsContext::context_ptr context;
+      tcp::socket socket (ios);
+
+      acceptor.accept (socket);
+      context = provider ();
+
+      SslStream stream (std::move (socket), *context);
+      boost::system::error_code ec;
+
+      stream.handshake (boost::asio::ssl::stream_base::server, ec);
+      BOOST_CHECK (!ec);
+      closeQuietly (stream);
+    }
+  });
+
+  auto start = std::chrono::steady_clock::now ();
+
+  for (int i = 0; i < count; i++) {
+    SslStream stream (ios, clientContext);
+
+    stream.lowest_layer ().connect (acceptor.local_endpoint () );
+
+    if (resume && session != nullptr) {
+      SSL_set_session (stream.native_handle (), session);
+    }
+
+    stream.handshake (boost::asio::ssl::stream_base::client);
+
+    if (SSL_session_reused (stream.native_handle () ) ) {
+      resumed++;
+    }
+
+    if (session != nullptr) {
+      SSL_SESSION_free (session);
+    }
+
+    session = SSL_get1_session (stream.native_handle () );
+    closeQuietly (stream);
+  }
+
+  elapsed = std::chrono::duration_cast<std::chrono::milliseconds>
+            (std::chrono::steady_clock::now () - start);
+
+  server.join ();
+
+  if (session != nullptr) {
+    SSL_SESSION_free (session);
+  }
+
+  return resumed;
+}
+
+BOOST_AUTO_TEST_CASE (handshake_rate)
+{
+  WebSocketTlsContext shared (CERTIFICATE_FILE, PASSWORD);
+  std::chrono::milliseconds perConnection, reused;
+  int resumed;
+
+  /* What the server used to do: load the certificate for each connection */
+  resumed = runHandshakes ([] () {
+    return WebSocketTlsContext::create (CERTIFICATE_FILE, PASSWORD);
+  }, false, HANDSHAKES, perConnection);
+  BOOST_CHECK_EQUAL (resumed, 0);
+
+  resumed = runHandshakes ([&shared] () {
+    return shared.get ();
+  }, true, HANDSHAKES, reused);
+  BOOST_CHECK_EQUAL (resumed, HANDSHAKES - 1);
+
+  BOOST_TEST_MESSAGE (HANDSHAKES << " handshakes: context per connection "
+                      << perConnection.count () << " ms, shared context "
+                      << reused.count () << " ms");
+}
+
+BOOST_AUTO_TEST_CASE (certificate_reload)
+{
+  boost::filesystem::path file = boost::filesystem::unique_path (
+                                   boost::filesystem::temp_directory_path () / "kms_cert_%%%%%%%%.pem");
+  std::chrono::milliseconds elapsed;
+  WebSocketTlsContext::context_ptr first, second;
+
+  boost::filesystem::copy_file (CERTIFICATE_FILE, file);
+
+  WebSocketTlsContext shared (file, PASSWORD);
+
+  first = shared.get ();
+
+  boost::filesystem::last_write_time (file,
+                                      boost::filesystem::last_write_time (file) + 10);
+  std::this_thread::sleep_for (std::chrono::seconds (6) );
+
+  second = shared.get ();
+  BOOST_CHECK (first != second);
+
+  /* Tickets issued before the reload are still accepted */
+  int count = 0;
+
+  BOOST_CHECK_EQUAL (runHandshakes ([&] () {
+    return count++ == 0 ? first : shared.get ();
+  }, true, 2, elapsed), 1);
+
+  boost::filesystem::remove (file);
+}
@@ -385,6 +385,10 @@ public class KurentoModuleCreator {
       for (RemoteClass klass : module.getRemoteClasses()) {
         System.out.println("RemoteClass:\t" + klass.getName());
         digest.update(klass.getName().getBytes());
+        if (!klass.getConfig().isEmpty()) {
+          System.out.println("ConfigClass:\t" + klass.getName());
+          digest.update(("Config" + klass.getName()).getBytes());
+        }
       }
       for (Event event : module.getEvents()) {
         System.out.println("Event:\t" + event.getName());
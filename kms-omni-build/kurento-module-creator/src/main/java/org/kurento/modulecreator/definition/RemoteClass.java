@@ -29,6 +29,7 @@ public class RemoteClass extends Type {
   private List<Method> methods;
   private List<Property> properties;
   private List<TypeRef> events;
+  private List<Property> config;
   private boolean abstractClass;
 
   public RemoteClass(String name, String doc, TypeRef extendsProp) {
@@ -37,6 +38,7 @@ public class RemoteClass extends Type {
     this.methods = new ArrayList<Method>();
     this.properties = new ArrayList<Property>();
     this.events = new ArrayList<TypeRef>();
+    this.config = new ArrayList<Property>();
   }
 
   public RemoteClass(String name, String doc, TypeRef extendsProp, Method constructor,
@@ -47,6 +49,7 @@ public class RemoteClass extends Type {
     this.methods = methods;
     this.properties = properties;
     this.events = events;
+    this.config = new ArrayList<Property>();
   }
 
   public Method getConstructor() {
@@ -73,6 +76,14 @@ public class RemoteClass extends Type {
     return properties;
   }
 
+  /**
+   * Settings read from the server configuration, under
+   * <code>modules.&lt;module&gt;.&lt;class&gt;</code>.
+   */
+  public List<Property> getConfig() {
+    return config;
+  }
+
   public void addMethod(Method method) {
     this.methods.add(method);
   }
@@ -93,6 +104,10 @@ public class RemoteClass extends Type {
     this.properties = properties;
   }
 
+  public void setConfig(List<Property> config) {
+    this.config = config;
+  }
+
   public void setEvents(List<TypeRef> events) {
     this.events = events;
   }
@@ -129,6 +144,7 @@ public class RemoteClass extends Type {
     }
     children.addAll(methods);
     children.addAll(events);
+    children.addAll(config);
     return children;
   }
 
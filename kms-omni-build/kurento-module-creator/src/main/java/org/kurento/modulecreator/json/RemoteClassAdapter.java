@@ -75,6 +75,10 @@ public class RemoteClassAdapter
       object.add("events", context.serialize(src.getEvents()));
     }
 
+    if (!src.getConfig().isEmpty()) {
+      object.add("config", context.serialize(src.getConfig()));
+    }
+
     return object;
   }
 
@@ -92,6 +96,7 @@ public class RemoteClassAdapter
     List<Method> methods = new ArrayList<Method>();
     List<Property> properties = new ArrayList<Property>();
     List<TypeRef> events = new ArrayList<TypeRef>();
+    List<Property> config = new ArrayList<Property>();
 
     if (object.get("name") != null) {
       name = object.get("name").getAsString();
@@ -129,9 +134,15 @@ public class RemoteClassAdapter
       }.getType());
     }
 
+    if (object.get("config") != null) {
+      config = context.deserialize(object.get("config"), new TypeToken<List<Property>>() {
+      }.getType());
+    }
+
     RemoteClass remoteClass = new RemoteClass(name, doc, extendsValue, constructor, methods,
         properties, events);
     remoteClass.setAbstract(abstractValue);
+    remoteClass.setConfig(config);
     return remoteClass;
   }
 
@@ -78,6 +78,32 @@ ${event.name}::Serialize (JsonSerializer &s)
 </#list>
 }
 
+bool
+${event.name}::getField (const std::string &name, Json::Value &value)
+{
+<#list event.properties as property>
+  if (name == "${property.name}") {
+    JsonSerializer s (true);
+
+    <#if property.optional>
+    if (!_isSet${property.name?cap_first}) {
+      return false;
+    }
+
+    </#if>
+    s.SerializeNVP (${property.name});
+    value = s.JsonValue["${property.name}"];
+    return true;
+  }
+
+</#list>
+<#if event.extends??>
+  return ${event.extends.name}::getField (name, value);
+<#else>
+  return false;
+</#if>
+}
+
 <#list module.code.implementation["cppNamespace"]?split("::")?reverse as namespace>
 } /* ${namespace} */
 </#list>
@@ -125,6 +125,9 @@ public:
 
   <#if !event.extends??>virtual </#if>void Serialize (JsonSerializer &s)<#if event.extends??> override</#if>;
 
+  /* Serializes a single property, returns false if there is no such one */
+  <#if !event.extends??>virtual </#if>bool getField (const std::string &name, Json::Value &value)<#if event.extends??> override</#if>;
+
 protected:
 
   ${event.name}() = default;
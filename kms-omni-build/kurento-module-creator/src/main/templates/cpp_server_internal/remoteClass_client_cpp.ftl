@@ -0,0 +1,161 @@
+${remoteClass.name}Client.cpp
+/* Autogenerated with kurento-module-creator */
+
+<#list typeDependencies(remoteClass) as dependency>
+<#if module.remoteClasses?seq_contains(dependency)>
+#include "${dependency.name}Impl.hpp"
+<#else>
+#include "${dependency.name}.hpp"
+</#if>
+</#list>
+#include "${remoteClass.name}Client.hpp"
+#include "${remoteClass.name}ImplFactory.hpp"
+#include <KurentoException.hpp>
+#include <DeferredResponse.hpp>
+
+using kurento::KurentoException;
+using kurento::DeferredResponse;
+
+<#macro checkObjects params>
+  <#list params as param>
+  <#if param.type.module?? && !param.type.list && !param.type.map && param.type.module.remoteClasses?seq_contains(param.type.type)>
+  session->checkObject (${param.name});
+  </#if>
+  </#list>
+</#macro>
+<#list module.code.implementation["cppNamespace"]?split("::") as namespace>
+namespace ${namespace}
+{
+</#list>
+
+${remoteClass.name}Client::${remoteClass.name}Client (
+  std::shared_ptr<kurento::ClientSession> session,
+<#if remoteClass.extends??>
+  std::shared_ptr<${remoteClass.name}Impl> object) :
+  ${remoteClass.extends.name}Client (session, object)
+{
+}
+<#else>
+  std::shared_ptr<MediaObjectImpl> object) : session (session), object (object)
+{
+}
+</#if>
+<#if (!remoteClass.abstract) && remoteClass.constructor??>
+
+std::shared_ptr<${remoteClass.name}Client>
+${remoteClass.name}Client::create (
+  std::shared_ptr<kurento::ClientSession> session<#list remoteClass.constructor.params as param>,
+  ${getCppObjectType(param.type, true)}${param.name}</#list>)
+{
+  ${remoteClass.name}ImplFactory factory;
+  std::shared_ptr<MediaObjectImpl> object;
+
+<@checkObjects remoteClass.constructor.params />
+  session->keepAlive ();
+
+  object = session->adopt (factory.createObject (session->getConfig ()<#rt>
+     <#lt><#list remoteClass.constructor.params as param>, ${param.name}</#list>) );
+
+  return std::make_shared<${remoteClass.name}Client> (session,
+         std::static_pointer_cast<${remoteClass.name}Impl> (object) );
+}
+</#if>
+
+std::shared_ptr<${remoteClass.name}Client>
+${remoteClass.name}Client::get (std::shared_ptr<kurento::ClientSession> session,
+  const std::string &objectId)
+{
+  std::shared_ptr<${remoteClass.name}Impl> object;
+
+  object = std::dynamic_pointer_cast<${remoteClass.name}Impl> (
+             session->getObject (objectId) );
+
+  if (!object) {
+    throw KurentoException (MEDIA_OBJECT_NOT_FOUND,
+                            "Object '" + objectId + "' is not a ${remoteClass.name}");
+  }
+
+  return std::make_shared<${remoteClass.name}Client> (session, object);
+}
+<#if !remoteClass.extends??>
+
+void
+${remoteClass.name}Client::release ()
+{
+  session->release (object);
+}
+</#if>
+<#macro methodBody method>
+
+${getCppObjectType(method.return,false)}
+${remoteClass.name}Client::${method.name} (<#rt>
+    <#lt><#list method.params as param>${getCppObjectType(param.type)}${param.name}<#if param_has_next>, </#if></#list>)
+{
+  session->checkObject (object);
+<@checkObjects method.params />
+  session->keepAlive ();
+
+  /* Hide the caller's request, the result is needed right now */
+  DeferredResponse::Scope syncScope (false);
+
+  <#if method.return??>return </#if>getObject ()->${method.name} (<#rt>
+    <#lt><#list method.params as param>${param.name}<#if param_has_next>, </#if></#list>);
+}
+</#macro>
+<#list remoteClass.methods as method>
+  <#list method.expandIfOpsParams() as expandedMethod>
+<@methodBody expandedMethod />
+  </#list>
+<@methodBody method />
+</#list>
+<#list remoteClass.properties as property>
+
+${getCppObjectType (property.type, false)}
+${remoteClass.name}Client::get${property.name?cap_first} ()
+{
+  session->checkObject (object);
+  session->keepAlive ();
+
+  DeferredResponse::Scope syncScope (false);
+
+  return getObject ()->get${property.name?cap_first} ();
+}
+<#if !property.final && !property.readOnly>
+
+void
+${remoteClass.name}Client::set${property.name?cap_first} (${getCppObjectType (property.type, true)}${property.name})
+{
+  session->checkObject (object);
+<@checkObjects [property] />
+  session->keepAlive ();
+
+  DeferredResponse::Scope syncScope (false);
+
+  getObject ()->set${property.name?cap_first} (${property.name});
+}
+</#if>
+</#list>
+<#if ! ((remoteClass.extends??) && (remoteClass.extends.type.name?ends_with("OpenCVFilter")))>
+<#list remoteClass.events as event>
+
+sigc::connection
+${remoteClass.name}Client::connect${event.name} (
+  std::function<void (const ${event.name} &) > handler)
+{
+  session->checkObject (object);
+  session->keepAlive ();
+
+  return getObject ()->signal${event.name}.connect ([handler] (${event.name} event) {
+    std::shared_ptr<${event.name}> ev_ref (new ${event.name} (event) );
+
+    kurento::ClientSession::postEvent ([handler, ev_ref] () {
+      handler (*ev_ref);
+    });
+  });
+}
+</#list>
+</#if>
+
+<#list module.code.implementation["cppNamespace"]?split("::")?reverse as namespace>
+} /* ${namespace} */
+</#list>
@@ -0,0 +1,103 @@
+${remoteClass.name}Client.hpp
+/* Autogenerated with kurento-module-creator */
+
+#ifndef __${camelToUnderscore(remoteClass.name)}_CLIENT_HPP__
+#define __${camelToUnderscore(remoteClass.name)}_CLIENT_HPP__
+
+#include "${remoteClass.name}Impl.hpp"
+<#if remoteClass.extends??>
+#include "${remoteClass.extends.name}Client.hpp"
+</#if>
+#include <ClientSession.hpp>
+#include <functional>
+#include <memory>
+<#if remoteClass.events[0]??>
+#include <sigc++/sigc++.h>
+</#if>
+
+<#list module.code.implementation["cppNamespace"]?split("::") as namespace>
+namespace ${namespace}
+{
+</#list>
+
+/*
+ * Typed in-process access to a ${remoteClass.name}, with the same checks a
+ * request from a remote client gets but without going through JSON.
+ */
+class ${remoteClass.name}Client<#if remoteClass.extends??> : public ${remoteClass.extends.name}Client</#if>
+{
+public:
+  ${remoteClass.name}Client (std::shared_ptr<kurento::ClientSession> session,
+<#if remoteClass.extends??>
+      std::shared_ptr<${remoteClass.name}Impl> object);
+  ~${remoteClass.name}Client() override = default;
+<#else>
+      std::shared_ptr<MediaObjectImpl> object);
+  virtual ~${remoteClass.name}Client() = default;
+</#if>
+
+<#if (!remoteClass.abstract) && remoteClass.constructor??>
+  static std::shared_ptr<${remoteClass.name}Client> create (
+    std::shared_ptr<kurento::ClientSession> session<#list remoteClass.constructor.params as param>,
+    ${getCppObjectType(param.type, true)}${param.name}</#list>);
+</#if>
+  static std::shared_ptr<${remoteClass.name}Client> get (
+    std::shared_ptr<kurento::ClientSession> session,
+    const std::string &objectId);
+
+  std::shared_ptr<${remoteClass.name}Impl> getObject () const
+  {
+    return std::static_pointer_cast<${remoteClass.name}Impl> (object);
+  }
+<#if !remoteClass.extends??>
+
+  std::shared_ptr<kurento::ClientSession> getSession () const
+  {
+    return session;
+  }
+
+  void release ();
+</#if>
+  <#macro methodHeader method>
+  ${getCppObjectType(method.return,false)} ${method.name} (<#rt>
+      <#lt><#list method.params as param>${getCppObjectType(param.type)}${param.name}<#if param_has_next>, </#if></#list>);
+  </#macro>
+  <#list remoteClass.methods as method><#rt>
+    <#if method_index = 0 >
+
+    </#if>
+    <#list method.expandIfOpsParams() as expandedMethod ><#rt>
+      <#lt><@methodHeader expandedMethod />
+    </#list>
+    <#lt><@methodHeader method />
+  </#list>
+<#list remoteClass.properties as property>
+
+  ${getCppObjectType (property.type, false)} get${property.name?cap_first} ();
+  <#if !property.final && !property.readOnly>
+  void set${property.name?cap_first} (${getCppObjectType (property.type, true)}${property.name});
+  </#if>
+</#list>
+<#if ! ((remoteClass.extends??) && (remoteClass.extends.type.name?ends_with("OpenCVFilter")))>
+<#list remoteClass.events as event>
+  <#if event_index = 0 >
+
+  /* Handlers get a copy of the event, in the thread pool of remote events */
+  </#if>
+  sigc::connection connect${event.name} (
+    std::function<void (const ${event.name} &) > handler);
+</#list>
+</#if>
+<#if !remoteClass.extends??>
+
+protected:
+  std::shared_ptr<kurento::ClientSession> session;
+  std::shared_ptr<MediaObjectImpl> object;
+</#if>
+};
+
+<#list module.code.implementation["cppNamespace"]?split("::")?reverse as namespace>
+} /* ${namespace} */
+</#list>
+
+#endif /*  __${camelToUnderscore(remoteClass.name)}_CLIENT_HPP__ */
@@ -0,0 +1,40 @@
+<#if remoteClass.config[0]??>
+${remoteClass.name}Config.cpp
+/* Autogenerated with kurento-module-creator */
+
+#include "${remoteClass.name}Config.hpp"
+#include <json/json.h>
+
+#define CONFIG_PREFIX "modules.${module.name}.${remoteClass.name}."
+
+<#list module.code.implementation["cppNamespace"]?split("::") as namespace>
+namespace ${namespace}
+{
+</#list>
+
+${remoteClass.name}Config::${remoteClass.name}Config (const kurento::ConfigSnapshot &snapshot)
+{
+  <#list remoteClass.config as property>
+  __isSet${property.name?cap_first} = snapshot.read (&${property.name},
+      CONFIG_PREFIX "${property.name}");
+  <#if property.defaultValue??>
+
+  if (!__isSet${property.name?cap_first}) {
+    Json::Reader reader;
+    Json::Value defaultValue;
+
+    reader.parse ("${escapeString (property.defaultValue)}", defaultValue);
+    kurento::ConfigSnapshot::deserialize (&${property.name}, defaultValue,
+        CONFIG_PREFIX "${property.name}");
+  }
+  </#if>
+  <#if property_has_next>
+
+  </#if>
+  </#list>
+}
+
+<#list module.code.implementation["cppNamespace"]?split("::")?reverse as namespace>
+} /* ${namespace} */
+</#list>
+</#if>
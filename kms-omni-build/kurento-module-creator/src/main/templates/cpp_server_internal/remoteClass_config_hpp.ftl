@@ -0,0 +1,56 @@
+<#if remoteClass.config[0]??>
+${remoteClass.name}Config.hpp
+/* Autogenerated with kurento-module-creator */
+
+#ifndef __${camelToUnderscore(remoteClass.name)}_CONFIG_HPP__
+#define __${camelToUnderscore(remoteClass.name)}_CONFIG_HPP__
+
+<#list remoteClass.config as property>
+<#if property.type.type.typeFormat??>
+#include "${property.type.type.name}.hpp"
+</#if>
+</#list>
+#include <ConfigSnapshot.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+<#list module.code.implementation["cppNamespace"]?split("::") as namespace>
+namespace ${namespace}
+{
+</#list>
+
+/*
+ * Settings of ${remoteClass.name} under
+ * `modules.${module.name}.${remoteClass.name}`, deserialized once per
+ * configuration snapshot.
+ */
+class ${remoteClass.name}Config
+{
+public:
+  ${remoteClass.name}Config (const kurento::ConfigSnapshot &snapshot);
+
+  /* Shared section of the snapshot currently published for `config` */
+  static std::shared_ptr<const ${remoteClass.name}Config> get (
+    const boost::property_tree::ptree &config)
+  {
+    return kurento::ConfigSnapshot::getSection<${remoteClass.name}Config> (config);
+  }
+  <#list remoteClass.config as property>
+
+  <#if property.doc??>
+  /* ${property.doc?replace("\n", " ")} */
+  </#if>
+  ${getCppObjectType(property.type, false)} ${property.name} ${initializePropertiesValues(property.type)};
+  /* False if the key is not in the configuration<#if property.defaultValue??>, ${property.name} has its default value then</#if> */
+  bool __isSet${property.name?cap_first} = false;
+  </#list>
+};
+
+<#list module.code.implementation["cppNamespace"]?split("::")?reverse as namespace>
+} /* ${namespace} */
+</#list>
+
+#endif /*  __${camelToUnderscore(remoteClass.name)}_CONFIG_HPP__ */
+</#if>
@@ -17,6 +17,8 @@ namespace ${namespace}
 {
 </#list>
 
+class ${remoteClass.name}Client;
+
 class ${remoteClass.name}ImplFactory : public virtual <#if remoteClass.extends??>${remoteClass.extends.name}Impl<#else>kurento::</#if>Factory
 {
 public:
@@ -28,6 +30,7 @@ public:
 
 <#if (remoteClass.constructor)??>
 private:
+  friend class ${remoteClass.name}Client;
 
 </#if>
 <#if (!remoteClass.abstract) && (remoteClass.constructor)??>
@@ -14,8 +14,10 @@ ${remoteClass.name}ImplInternal.cpp
 #include "${remoteClass.name}Internal.hpp"
 #include <jsonrpc/JsonSerializer.hpp>
 #include <KurentoException.hpp>
+#include <DeferredResponse.hpp>
 
 using kurento::KurentoException;
+using kurento::DeferredResponse;
 
 <#list module.code.implementation["cppNamespace"]?split("::") as namespace>
 namespace ${namespace}
@@ -59,6 +61,12 @@ ${remoteClass.name}Impl::invoke (std::shared_ptr<MediaObjectImpl> obj, const std
     <#else><#rt>
     </#if>method.invoke (std::dynamic_pointer_cast<${remoteClass.name}> (obj) );
     <#if method.return??>
+
+    if (DeferredResponse::isDeferred () ) {
+      /* Result will be serialized when the method completes */
+      return;
+    }
+
     responseSerializer.SerializeNVP (ret);
     response = responseSerializer.JsonValue["ret"];
     </#if>
@@ -125,6 +133,13 @@ ${remoteClass.name}Impl::connect (const std::string &eventType, std::shared_ptr<
       if (!lh)
         return;
 
+      // Filtered out events are not even copied
+      if (!lh->accepts ([&event] (const std::string &field, Json::Value &value) {
+        return event.getField (field, value);
+      }) ) {
+        return;
+      }
+
       std::shared_ptr<${event.name}> ev_ref (new ${event.name}(event));
       auto object = this->shared_from_this();
 